@@ -0,0 +1,291 @@
+/**
+ * Copyright (c) 2021, Zoe J. Bare
+ *
+ * MIT License
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ */
+
+/*
+ * Compares filling a struct with micro_ini::bind_load_buffer() against the hand-written
+ * handler it replaces, which walks a chain of strcmp() calls on the section and key.
+ * Both convert values with the same micro_ini::convert(), so the difference is the
+ * dispatch alone.  A handler that does nothing is timed as well, to separate the cost
+ * of parsing from the cost of dispatching.  A service configuration of 24 bound keys
+ * and 8 keys the struct ignores is loaded many times over and the fastest run is
+ * reported.
+ *
+ * Converting the values costs more than finding their fields, so the handlers are
+ * also called directly on the parsed pairs, next to a loop that only runs each bound
+ * field's conversion, which leaves the cost of matching keys on its own.
+ *
+ * Build: c++ -std=c++17 -O2 -Isrc bench/bind_load.cpp src/micro_ini.c -o bind_load
+ * Usage: bind_load [loads]  (200000 by default)
+ */
+
+#include "micro_ini_bind.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <iterator>
+#include <string>
+#include <vector>
+
+struct service_config
+{
+	std::string serverHost;
+	int serverPort = 0;
+	int serverBacklog = 0;
+	int serverWorkers = 0;
+	bool serverReusePort = false;
+	double serverTimeout = 0.0;
+
+	std::string databaseHost;
+	int databasePort = 0;
+	std::string databaseName;
+	std::string databaseUser;
+	int databasePoolSize = 0;
+	double databaseTimeout = 0.0;
+
+	bool cacheEnabled = false;
+	int cacheCapacity = 0;
+	int cacheShards = 0;
+	double cacheTtl = 0.0;
+	std::string cachePolicy;
+	bool cacheStats = false;
+
+	std::string logLevel;
+	std::string logPath;
+	int logMaxSize = 0;
+	int logRotate = 0;
+	bool logColor = false;
+	bool logJson = false;
+};
+
+MICRO_INI_BIND(service_config,
+	(serverHost, "server", "host"),
+	(serverPort, "server", "port"),
+	(serverBacklog, "server", "backlog"),
+	(serverWorkers, "server", "workers"),
+	(serverReusePort, "server", "reuse_port"),
+	(serverTimeout, "server", "timeout"),
+	(databaseHost, "database", "host"),
+	(databasePort, "database", "port"),
+	(databaseName, "database", "name"),
+	(databaseUser, "database", "user"),
+	(databasePoolSize, "database", "pool_size"),
+	(databaseTimeout, "database", "timeout"),
+	(cacheEnabled, "cache", "enabled"),
+	(cacheCapacity, "cache", "capacity"),
+	(cacheShards, "cache", "shards"),
+	(cacheTtl, "cache", "ttl"),
+	(cachePolicy, "cache", "policy"),
+	(cacheStats, "cache", "stats"),
+	(logLevel, "log", "level"),
+	(logPath, "log", "path"),
+	(logMaxSize, "log", "max_size"),
+	(logRotate, "log", "rotate"),
+	(logColor, "log", "color"),
+	(logJson, "log", "json")
+);
+
+namespace
+{
+
+const char g_config[] =
+	"[server]\nhost = 0.0.0.0\nport = 8080\nbacklog = 512\nworkers = 16\nreuse_port = yes\ntimeout = 30.5\nbanner = internal\ndebug_port = 9090\n"
+	"[database]\nhost = db.internal\nport = 5432\nname = routes\nuser = router\npool_size = 32\ntimeout = 5\nsslmode = require\n"
+	"[cache]\nenabled = true\ncapacity = 100000\nshards = 64\nttl = 300\npolicy = lru\nstats = off\nwarmup = lazy\nprefetch = 4\n"
+	"[log]\nlevel = info\npath = /var/log/router.log\nmax_size = 104857600\nrotate = 7\ncolor = no\njson = yes\nsyslog = no\nfacility = local0\n";
+
+#define BENCH_MATCH(s, k) (std::strcmp(section, s) == 0 && std::strcmp(key, k) == 0)
+
+/**
+ * The hand-written handler: compare against every bound section and key in turn.
+ */
+void strcmp_handler(void* const pUserData, const char* const section, const char* const key, const char* const value)
+{
+	service_config& config = *static_cast<service_config*>(pUserData);
+
+	if(BENCH_MATCH("server", "host")) { micro_ini::convert(value, config.serverHost); }
+	else if(BENCH_MATCH("server", "port")) { micro_ini::convert(value, config.serverPort); }
+	else if(BENCH_MATCH("server", "backlog")) { micro_ini::convert(value, config.serverBacklog); }
+	else if(BENCH_MATCH("server", "workers")) { micro_ini::convert(value, config.serverWorkers); }
+	else if(BENCH_MATCH("server", "reuse_port")) { micro_ini::convert(value, config.serverReusePort); }
+	else if(BENCH_MATCH("server", "timeout")) { micro_ini::convert(value, config.serverTimeout); }
+	else if(BENCH_MATCH("database", "host")) { micro_ini::convert(value, config.databaseHost); }
+	else if(BENCH_MATCH("database", "port")) { micro_ini::convert(value, config.databasePort); }
+	else if(BENCH_MATCH("database", "name")) { micro_ini::convert(value, config.databaseName); }
+	else if(BENCH_MATCH("database", "user")) { micro_ini::convert(value, config.databaseUser); }
+	else if(BENCH_MATCH("database", "pool_size")) { micro_ini::convert(value, config.databasePoolSize); }
+	else if(BENCH_MATCH("database", "timeout")) { micro_ini::convert(value, config.databaseTimeout); }
+	else if(BENCH_MATCH("cache", "enabled")) { micro_ini::convert(value, config.cacheEnabled); }
+	else if(BENCH_MATCH("cache", "capacity")) { micro_ini::convert(value, config.cacheCapacity); }
+	else if(BENCH_MATCH("cache", "shards")) { micro_ini::convert(value, config.cacheShards); }
+	else if(BENCH_MATCH("cache", "ttl")) { micro_ini::convert(value, config.cacheTtl); }
+	else if(BENCH_MATCH("cache", "policy")) { micro_ini::convert(value, config.cachePolicy); }
+	else if(BENCH_MATCH("cache", "stats")) { micro_ini::convert(value, config.cacheStats); }
+	else if(BENCH_MATCH("log", "level")) { micro_ini::convert(value, config.logLevel); }
+	else if(BENCH_MATCH("log", "path")) { micro_ini::convert(value, config.logPath); }
+	else if(BENCH_MATCH("log", "max_size")) { micro_ini::convert(value, config.logMaxSize); }
+	else if(BENCH_MATCH("log", "rotate")) { micro_ini::convert(value, config.logRotate); }
+	else if(BENCH_MATCH("log", "color")) { micro_ini::convert(value, config.logColor); }
+	else if(BENCH_MATCH("log", "json")) { micro_ini::convert(value, config.logJson); }
+}
+
+void null_handler(void* const pUserData, const char* const section, const char* const key, const char* const value)
+{
+	static_cast<void>(pUserData);
+	static_cast<void>(section);
+	static_cast<void>(key);
+	static_cast<void>(value);
+}
+
+bool same(const service_config& a, const service_config& b)
+{
+	return a.serverHost == b.serverHost && a.serverPort == b.serverPort && a.serverBacklog == b.serverBacklog
+		&& a.serverWorkers == b.serverWorkers && a.serverReusePort == b.serverReusePort && a.serverTimeout == b.serverTimeout
+		&& a.databaseHost == b.databaseHost && a.databasePort == b.databasePort && a.databaseName == b.databaseName
+		&& a.databaseUser == b.databaseUser && a.databasePoolSize == b.databasePoolSize && a.databaseTimeout == b.databaseTimeout
+		&& a.cacheEnabled == b.cacheEnabled && a.cacheCapacity == b.cacheCapacity && a.cacheShards == b.cacheShards
+		&& a.cacheTtl == b.cacheTtl && a.cachePolicy == b.cachePolicy && a.cacheStats == b.cacheStats
+		&& a.logLevel == b.logLevel && a.logPath == b.logPath && a.logMaxSize == b.logMaxSize
+		&& a.logRotate == b.logRotate && a.logColor == b.logColor && a.logJson == b.logJson;
+}
+
+struct bench_pair
+{
+	std::string section;
+	std::string key;
+	std::string value;
+	int field;  /* Index of the bound field, or -1 when the pair is not bound. */
+};
+
+void collect_handler(void* const pUserData, const char* const section, const char* const key, const char* const value)
+{
+	constexpr auto& fields = micro_ini::binding<service_config>::fields;
+
+	bench_pair pair = { section, key, value, -1 };
+
+	for(int i = 0; i < static_cast<int>(std::size(fields)); ++i)
+	{
+		if(pair.section == fields[i].section && pair.key == fields[i].key)
+		{
+			pair.field = i;
+		}
+	}
+
+	static_cast<std::vector<bench_pair>*>(pUserData)->push_back(pair);
+}
+
+/**
+ * Time a number of loads, keeping the fastest of several runs.
+ */
+template<typename Load>
+double time_loads(const unsigned long loads, Load load)
+{
+	double best = 1e30;
+
+	for(int run = 0; run < 5; ++run)
+	{
+		const auto start = std::chrono::steady_clock::now();
+
+		for(unsigned long i = 0; i < loads; ++i)
+		{
+			load();
+		}
+
+		best = std::min(best, std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count());
+	}
+
+	return best / static_cast<double>(loads);
+}
+
+} /* namespace */
+
+int main(int argc, char** argv)
+{
+	const unsigned long loads = argc > 1 ? std::strtoul(argv[1], nullptr, 10) : 200000;
+	const size_t size = sizeof(g_config) - 1;
+
+	service_config bound;
+	service_config handwritten;
+
+	const double parseOnly = time_loads(loads, [&]() { micro_ini_load_buffer(g_config, size, 0, null_handler, nullptr, nullptr); });
+	const double strcmpTime = time_loads(loads, [&]() { micro_ini_load_buffer(g_config, size, 0, strcmp_handler, nullptr, &handwritten); });
+	const double bindTime = time_loads(loads, [&]() { micro_ini::bind_load_buffer(std::string_view(g_config, size), bound); });
+
+	if(!same(bound, handwritten) || bound.serverPort != 8080 || bound.logMaxSize != 104857600 || !bound.logJson)
+	{
+		std::fprintf(stderr, "The two handlers loaded different values.\n");
+		return EXIT_FAILURE;
+	}
+
+	std::printf("%lu loads of a %lu byte file with 24 bound and 8 unbound keys\n\n", loads, static_cast<unsigned long>(size));
+	std::printf("%-18s %12s %16s\n", "", "load (ns)", "dispatch (ns)");
+	std::printf("%-18s %12.0f %16s\n", "parse only", parseOnly * 1e9, "");
+	std::printf("%-18s %12.0f %16.0f\n", "strcmp chain", strcmpTime * 1e9, (strcmpTime - parseOnly) * 1e9);
+	std::printf("%-18s %12.0f %16.0f\n", "MICRO_INI_BIND", bindTime * 1e9, (bindTime - parseOnly) * 1e9);
+
+	/* Call the handlers on the pairs directly, and subtract the conversions they share. */
+	constexpr auto& fields = micro_ini::binding<service_config>::fields;
+
+	std::vector<bench_pair> pairs;
+	micro_ini_load_buffer(g_config, size, 0, collect_handler, nullptr, &pairs);
+
+	micro_ini::bind_context<service_config> context = { &bound, nullptr, nullptr, 0 };
+
+	const double convertOnly = time_loads(loads, [&]()
+	{
+		for(const bench_pair& pair : pairs)
+		{
+			if(pair.field >= 0)
+			{
+				fields[pair.field].assign(bound, pair.value.c_str());
+			}
+		}
+	});
+
+	const double strcmpCalls = time_loads(loads, [&]()
+	{
+		for(const bench_pair& pair : pairs)
+		{
+			strcmp_handler(&handwritten, pair.section.c_str(), pair.key.c_str(), pair.value.c_str());
+		}
+	});
+
+	const double bindCalls = time_loads(loads, [&]()
+	{
+		for(const bench_pair& pair : pairs)
+		{
+			micro_ini::bind_handler<service_config>(&context, pair.section.c_str(), pair.key.c_str(), pair.value.c_str());
+		}
+	});
+
+	std::printf("\n%-18s %12s %16s\n", "handler calls", "32 pairs (ns)", "matching (ns)");
+	std::printf("%-18s %12.0f %16s\n", "conversion only", convertOnly * 1e9, "");
+	std::printf("%-18s %12.0f %16.0f\n", "strcmp chain", strcmpCalls * 1e9, (strcmpCalls - convertOnly) * 1e9);
+	std::printf("%-18s %12.0f %16.0f\n", "MICRO_INI_BIND", bindCalls * 1e9, (bindCalls - convertOnly) * 1e9);
+
+	std::printf("\nload: %.2fx faster, matching keys: %.1fx faster\n", strcmpTime / bindTime, (strcmpCalls - convertOnly) / (bindCalls - convertOnly));
+
+	return EXIT_SUCCESS;
+}
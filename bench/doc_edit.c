@@ -0,0 +1,209 @@
+/**
+ * Copyright (c) 2021, Zoe J. Bare
+ *
+ * MIT License
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ */
+
+/*
+ * Measures how the cost of a committed edit batch grows with the number of sections it
+ * touches and with the size of the document it is based on.  Each batch sets one key in
+ * each of a number of evenly spread sections, commits a new version and releases it.
+ * Rebuilding the whole document from its text, which is what callers without edit
+ * batches do after every change, is reported for each document size for comparison.
+ *
+ * Build: cc -O2 -Isrc bench/doc_edit.c src/micro_ini.c src/micro_ini_alloc.c src/micro_ini_doc.c -o doc_edit
+ * Usage: doc_edit [largest sections]  (100000 by default, 8 keys each)
+ */
+
+#include "micro_ini_doc.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+/**
+ * @brief   Generate a routing table with eight keys per section.
+ * @return  Text of the ini file (free() it), or NULL if out of memory.
+ */
+static char* bench_generate(const unsigned long sections, size_t* const pOutSize)
+{
+	static const char* const interfaces[] = { "eth0", "eth1", "eth2", "eth3" };
+
+	const size_t capacity = (size_t) sections * 200 + 1;
+	char* const text = (char*) malloc(capacity);
+	unsigned long seed = 12345;
+	size_t size = 0;
+	unsigned long i;
+
+	if(!text)
+	{
+		return NULL;
+	}
+
+	for(i = 0; i < sections; ++i)
+	{
+		unsigned long r;
+
+		seed = seed * 1103515245ul + 12345ul;
+		r = (seed >> 8) & 0xFFFFFF;
+
+		size += (size_t) sprintf(text + size,
+			"[route.%lu]\ndestination = 10.%lu.%lu.0/24\ngateway = 10.0.%lu.1\ninterface = %s\nmetric = %lu\n"
+			"enabled = %s\ntable = main\nprotocol = static\nscope = global\n",
+			i, (i >> 8) & 0xFF, i & 0xFF, r & 15, interfaces[(r >> 4) & 3], (r >> 6) % 32, (r >> 11) & 1 ? "true" : "false");
+	}
+
+	(*pOutSize) = size;
+	return text;
+}
+
+/**
+ * @brief   Apply and commit one batch touching a number of evenly spread sections.
+ * @return  MICRO_INI_SUCCESS or an error code.
+ */
+static int bench_batch(const micro_ini_doc* const pBase, const unsigned long sections, const unsigned long batch, const unsigned long round)
+{
+	micro_ini_doc_edit* pEdit;
+	micro_ini_doc* pNext;
+	unsigned long i;
+	int err;
+
+	err = micro_ini_doc_edit_begin(&pEdit, pBase);
+	if(err != MICRO_INI_SUCCESS)
+	{
+		return err;
+	}
+
+	for(i = 0; i < batch; ++i)
+	{
+		char section[32];
+		char value[32];
+
+		sprintf(section, "route.%lu", (i * (sections / batch) + round) % sections);
+		sprintf(value, "%lu", (round + i) % 32);
+
+		err = micro_ini_doc_edit_set(pEdit, section, "metric", value);
+		if(err != MICRO_INI_SUCCESS)
+		{
+			micro_ini_doc_edit_abort(pEdit);
+			return err;
+		}
+	}
+
+	err = micro_ini_doc_edit_commit(pEdit, &pNext);
+	if(err != MICRO_INI_SUCCESS)
+	{
+		return err;
+	}
+
+	micro_ini_doc_free(pNext);
+	return MICRO_INI_SUCCESS;
+}
+
+int main(int argc, char** argv)
+{
+	static const unsigned long batches[] = { 1, 10, 100, 1000 };
+
+	const unsigned long largest = argc > 1 ? strtoul(argv[1], NULL, 10) : 100000;
+
+	unsigned long sections;
+
+	printf("%10s %10s %12s %12s %14s\n", "sections", "batch", "batch (us)", "per edit", "bytes copied");
+
+	for(sections = largest / 100; sections <= largest && sections > 0; sections *= 10)
+	{
+		micro_ini_allocator allocator;
+		micro_ini_doc_options options;
+		micro_ini_doc* pDoc;
+		size_t size;
+		char* text;
+		clock_t start;
+		double seconds;
+		int rounds;
+		int round;
+		size_t b;
+
+		text = bench_generate(sections, &size);
+		if(!text)
+		{
+			fprintf(stderr, "Out of memory.\n");
+			return EXIT_FAILURE;
+		}
+
+		micro_ini_allocator_init(&allocator);
+		memset(&options, 0, sizeof(options));
+		options.pAllocator = &allocator;
+
+		if(micro_ini_doc_load_buffer(&pDoc, text, size, 0, &options, NULL, NULL) != 0)
+		{
+			fprintf(stderr, "Loading failed.\n");
+			return EXIT_FAILURE;
+		}
+
+		for(b = 0; b < sizeof(batches) / sizeof(batches[0]); ++b)
+		{
+			const unsigned long batch = batches[b];
+
+			size_t peak;
+
+			if(batch > sections)
+			{
+				break;
+			}
+
+			/* The peak above the loaded document is what one version costs while it is alive. */
+			rounds = batch >= 100 ? 50 : 2000;
+			allocator.stats.peakBytes = allocator.stats.bytesInUse;
+			peak = allocator.stats.bytesInUse;
+
+			start = clock();
+			for(round = 0; round < rounds; ++round)
+			{
+				if(bench_batch(pDoc, sections, batch, (unsigned long) round) != MICRO_INI_SUCCESS)
+				{
+					fprintf(stderr, "Edit batch failed.\n");
+					return EXIT_FAILURE;
+				}
+			}
+
+			seconds = (double) (clock() - start) / rounds;
+			printf("%10lu %10lu %12.1f %12.2f %14lu\n", sections, batch, seconds * 1e6 / CLOCKS_PER_SEC,
+				seconds * 1e6 / CLOCKS_PER_SEC / (double) batch, (unsigned long) (allocator.stats.peakBytes - peak));
+		}
+
+		/* The alternative: build a whole new document for every change. */
+		micro_ini_doc_free(pDoc);
+		start = clock();
+		for(round = 0; round < 5; ++round)
+		{
+			micro_ini_doc_load_buffer(&pDoc, text, size, 0, &options, NULL, NULL);
+			micro_ini_doc_free(pDoc);
+		}
+
+		seconds = (double) (clock() - start) / 5;
+		printf("%10lu %10s %12.1f\n\n", sections, "reload", seconds * 1e6 / CLOCKS_PER_SEC);
+
+		free(text);
+	}
+
+	return EXIT_SUCCESS;
+}
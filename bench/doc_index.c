@@ -0,0 +1,257 @@
+/**
+ * Copyright (c) 2021, Zoe J. Bare
+ *
+ * MIT License
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ */
+
+/*
+ * Compares prefix and wildcard queries answered by micro_ini_doc_index against the
+ * callback-only alternative of parsing the whole file again and filtering every pair
+ * through the same patterns.  The index is built once from a loaded document, and
+ * its one-time cost is reported next to the query times.
+ *
+ * Build: cc -O2 -Isrc bench/doc_index.c src/micro_ini.c src/micro_ini_alloc.c src/micro_ini_doc.c -o doc_index
+ * Usage: doc_index [sections]  (50000 by default, one in fifty an upstream section)
+ */
+
+#include "micro_ini_doc.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+typedef struct bench_query
+{
+	const char* sectionPattern;
+	const char* keyPattern;
+} bench_query;
+
+typedef struct bench_filter
+{
+	const bench_query* pQuery;
+	size_t matches;
+} bench_filter;
+
+/**
+ * @brief   Match a string against a glob where '*' matches any run and '?' any one character.
+ * @return  Non-zero if the string matches (a NULL pattern matches everything).
+ */
+static int bench_glob(const char* pattern, const char* str)
+{
+	const char* pStar = NULL;
+	const char* pResume = NULL;
+
+	if(!pattern)
+	{
+		return 1;
+	}
+
+	while(*str)
+	{
+		if(*pattern == '*')
+		{
+			pStar = pattern++;
+			pResume = str;
+		}
+		else if(*pattern == '?' || *pattern == *str)
+		{
+			++pattern;
+			++str;
+		}
+		else if(pStar)
+		{
+			pattern = pStar + 1;
+			str = ++pResume;
+		}
+		else
+		{
+			return 0;
+		}
+	}
+
+	while(*pattern == '*')
+	{
+		++pattern;
+	}
+
+	return *pattern == '\0';
+}
+
+/**
+ * @brief  Count the pairs of a fresh parse that match the query.
+ */
+static void bench_filter_handler(void* pUserData, const char* section, const char* key, const char* value)
+{
+	bench_filter* const pFilter = (bench_filter*) pUserData;
+
+	(void) value;
+
+	if(key && bench_glob(pFilter->pQuery->sectionPattern, section) && bench_glob(pFilter->pQuery->keyPattern, key))
+	{
+		++pFilter->matches;
+	}
+}
+
+/**
+ * @brief   Generate route sections with an upstream section every fifty sections.
+ * @return  Text of the ini file (free() it), or NULL if out of memory.
+ */
+static char* bench_generate(const unsigned long sections, size_t* const pOutSize)
+{
+	static const char* const interfaces[] = { "eth0", "eth1", "eth2", "eth3" };
+
+	const size_t capacity = (size_t) sections * 220 + 1;
+	char* const text = (char*) malloc(capacity);
+	unsigned long seed = 12345;
+	size_t size = 0;
+	unsigned long i;
+
+	if(!text)
+	{
+		return NULL;
+	}
+
+	for(i = 0; i < sections; ++i)
+	{
+		unsigned long r;
+
+		seed = seed * 1103515245ul + 12345ul;
+		r = (seed >> 8) & 0xFFFFFF;
+
+		if(i % 50 == 0)
+		{
+			size += (size_t) sprintf(text + size,
+				"[upstream.%lu]\nserver = 10.1.%lu.%lu:8080\nweight = %lu\nmax_fails = 3\nroute_timeout = %lums\n",
+				i / 50, (i >> 8) & 0xFF, i & 0xFF, r & 7, 100 + (r >> 3) % 900);
+		}
+		else
+		{
+			size += (size_t) sprintf(text + size,
+				"[route.%lu]\ndestination = 10.%lu.%lu.0/24\ngateway = 10.0.%lu.1\ninterface = %s\nmetric = %lu\n"
+				"enabled = %s\nroute_table = main\nroute_protocol = static\nroute_scope = global\n",
+				i, (i >> 8) & 0xFF, i & 0xFF, r & 15, interfaces[(r >> 4) & 3], (r >> 6) % 32, (r >> 11) & 1 ? "true" : "false");
+		}
+	}
+
+	(*pOutSize) = size;
+	return text;
+}
+
+static double bench_seconds(const clock_t start)
+{
+	return (double) (clock() - start) / CLOCKS_PER_SEC;
+}
+
+int main(int argc, char** argv)
+{
+	static const bench_query queries[] =
+	{
+		{ "upstream.*", NULL },
+		{ NULL, "route_*" },
+		{ "upstream.1?", "*fail*" },
+		{ "route.4242", "metric" },
+	};
+
+	const unsigned long sections = argc > 1 ? strtoul(argv[1], NULL, 10) : 50000;
+	const int parseRuns = 5;
+	const int indexRuns = 200;
+
+	micro_ini_doc_index* pIndex;
+	micro_ini_doc* pDoc;
+	size_t size;
+	char* text;
+	clock_t start;
+	double loadTime;
+	size_t q;
+
+	text = bench_generate(sections, &size);
+	if(!text)
+	{
+		fprintf(stderr, "Out of memory.\n");
+		return EXIT_FAILURE;
+	}
+
+	start = clock();
+	if(micro_ini_doc_load_buffer(&pDoc, text, size, 0, NULL, NULL, NULL) != 0)
+	{
+		fprintf(stderr, "Loading failed.\n");
+		return EXIT_FAILURE;
+	}
+
+	loadTime = bench_seconds(start);
+
+	start = clock();
+	if(micro_ini_doc_index_build(&pIndex, pDoc) != MICRO_INI_SUCCESS)
+	{
+		fprintf(stderr, "Indexing failed.\n");
+		return EXIT_FAILURE;
+	}
+
+	printf("%lu sections, %lu bytes of text\n", sections, (unsigned long) size);
+	printf("document load %.2f ms, index build %.2f ms\n\n", loadTime * 1000.0, bench_seconds(start) * 1000.0);
+	printf("%-12s %-10s %9s %14s %14s %10s\n", "section", "key", "matches", "re-parse (ms)", "index (ms)", "speedup");
+
+	for(q = 0; q < sizeof(queries) / sizeof(queries[0]); ++q)
+	{
+		const bench_query* const pQuery = &queries[q];
+
+		bench_filter filter;
+		double parseTime;
+		double indexTime;
+		size_t matches = 0;
+		int run;
+
+		start = clock();
+		for(run = 0; run < parseRuns; ++run)
+		{
+			filter.pQuery = pQuery;
+			filter.matches = 0;
+			micro_ini_load_buffer(text, size, 0, bench_filter_handler, NULL, &filter);
+		}
+
+		parseTime = bench_seconds(start) / parseRuns;
+
+		start = clock();
+		for(run = 0; run < indexRuns; ++run)
+		{
+			matches = micro_ini_doc_index_query(pIndex, pQuery->sectionPattern, pQuery->keyPattern, NULL, NULL);
+		}
+
+		indexTime = bench_seconds(start) / indexRuns;
+
+		if(matches != filter.matches)
+		{
+			fprintf(stderr, "Match counts differ: %lu from the index, %lu from the re-parse.\n", (unsigned long) matches, (unsigned long) filter.matches);
+			return EXIT_FAILURE;
+		}
+
+		printf("%-12s %-10s %9lu %14.3f %14.4f %9.0fx\n",
+			pQuery->sectionPattern ? pQuery->sectionPattern : "*", pQuery->keyPattern ? pQuery->keyPattern : "*",
+			(unsigned long) matches, parseTime * 1000.0, indexTime * 1000.0, indexTime > 0.0 ? parseTime / indexTime : 0.0);
+	}
+
+	micro_ini_doc_index_free(pIndex);
+	micro_ini_doc_free(pDoc);
+	free(text);
+
+	return EXIT_SUCCESS;
+}
@@ -0,0 +1,280 @@
+/**
+ * Copyright (c) 2021, Zoe J. Bare
+ *
+ * MIT License
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ */
+
+/*
+ * Compares the memory a document takes against the usual way of holding a parsed ini
+ * file: a list of section nodes, each with a list of key nodes pointing at their own
+ * copies of the key and value.  Both are built from the same generated routing table
+ * through counting allocators, so the figures include the allocator's block headers.
+ *
+ * Build: cc -O2 -Isrc bench/doc_memory.c src/micro_ini.c src/micro_ini_alloc.c src/micro_ini_doc.c -o doc_memory
+ * Usage: doc_memory [sections]  (250000 by default, 8 keys each)
+ */
+
+#include "micro_ini_doc.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+typedef struct bench_pair
+{
+	struct bench_pair* pNext;
+	char* key;
+	char* value;
+} bench_pair;
+
+typedef struct bench_section
+{
+	struct bench_section* pNext;
+	char* name;
+	bench_pair* pFirst;
+	bench_pair* pLast;
+} bench_section;
+
+typedef struct bench_nodes
+{
+	micro_ini_allocator* pAllocator;
+	bench_section* pFirst;
+	bench_section* pLast;
+	int failed;
+} bench_nodes;
+
+/**
+ * @brief   Copy a string into a block of its own.
+ * @return  Copy of the string, or NULL if out of memory.
+ */
+static char* bench_strdup(micro_ini_allocator* const pAllocator, const char* const str)
+{
+	const size_t size = strlen(str) + 1;
+	char* const copy = (char*) micro_ini_allocator_alloc(pAllocator, size);
+
+	if(copy)
+	{
+		memcpy(copy, str, size);
+	}
+
+	return copy;
+}
+
+/**
+ * @brief  Append a pair to the node lists, starting a new section when the name changes.
+ */
+static void bench_nodes_handler(void* pUserData, const char* section, const char* key, const char* value)
+{
+	bench_nodes* const pNodes = (bench_nodes*) pUserData;
+	bench_section* pSection = pNodes->pLast;
+	bench_pair* pPair;
+
+	if(pNodes->failed)
+	{
+		return;
+	}
+
+	if(!pSection || strcmp(pSection->name, section) != 0)
+	{
+		pSection = (bench_section*) micro_ini_allocator_calloc(pNodes->pAllocator, 1, sizeof(bench_section));
+		if(!pSection || (pSection->name = bench_strdup(pNodes->pAllocator, section)) == NULL)
+		{
+			pNodes->failed = 1;
+			return;
+		}
+
+		if(pNodes->pLast)
+		{
+			pNodes->pLast->pNext = pSection;
+		}
+		else
+		{
+			pNodes->pFirst = pSection;
+		}
+
+		pNodes->pLast = pSection;
+	}
+
+	pPair = (bench_pair*) micro_ini_allocator_calloc(pNodes->pAllocator, 1, sizeof(bench_pair));
+	if(!pPair
+		|| (pPair->key = bench_strdup(pNodes->pAllocator, key)) == NULL
+		|| (pPair->value = bench_strdup(pNodes->pAllocator, value)) == NULL)
+	{
+		pNodes->failed = 1;
+		return;
+	}
+
+	if(pSection->pLast)
+	{
+		pSection->pLast->pNext = pPair;
+	}
+	else
+	{
+		pSection->pFirst = pPair;
+	}
+
+	pSection->pLast = pPair;
+}
+
+/**
+ * @brief  Release every node and string.
+ */
+static void bench_nodes_free(bench_nodes* const pNodes)
+{
+	bench_section* pSection = pNodes->pFirst;
+
+	while(pSection)
+	{
+		bench_section* const pNextSection = pSection->pNext;
+		bench_pair* pPair = pSection->pFirst;
+
+		while(pPair)
+		{
+			bench_pair* const pNextPair = pPair->pNext;
+
+			micro_ini_allocator_free(pNodes->pAllocator, pPair->key);
+			micro_ini_allocator_free(pNodes->pAllocator, pPair->value);
+			micro_ini_allocator_free(pNodes->pAllocator, pPair);
+			pPair = pNextPair;
+		}
+
+		micro_ini_allocator_free(pNodes->pAllocator, pSection->name);
+		micro_ini_allocator_free(pNodes->pAllocator, pSection);
+		pSection = pNextSection;
+	}
+}
+
+/**
+ * @brief   Generate a routing table with eight keys per section.
+ * @return  Text of the ini file (free() it), or NULL if out of memory.
+ */
+static char* bench_generate(const unsigned long sections, size_t* const pOutSize)
+{
+	static const char* const interfaces[] = { "eth0", "eth1", "eth2", "eth3" };
+
+	const size_t capacity = (size_t) sections * 200 + 1;
+	char* const text = (char*) malloc(capacity);
+	unsigned long seed = 12345;
+	size_t size = 0;
+	unsigned long i;
+
+	if(!text)
+	{
+		return NULL;
+	}
+
+	for(i = 0; i < sections; ++i)
+	{
+		unsigned long r;
+
+		seed = seed * 1103515245ul + 12345ul;
+		r = (seed >> 8) & 0xFFFFFF;
+
+		size += (size_t) sprintf(text + size,
+			"[route.%lu]\ndestination = 10.%lu.%lu.0/24\ngateway = 10.0.%lu.1\ninterface = %s\nmetric = %lu\n"
+			"enabled = %s\ntable = main\nprotocol = static\nscope = global\n",
+			i, (i >> 8) & 0xFF, i & 0xFF, r & 15, interfaces[(r >> 4) & 3], (r >> 6) % 32, (r >> 11) & 1 ? "true" : "false");
+	}
+
+	(*pOutSize) = size;
+	return text;
+}
+
+/**
+ * @brief  Print one row of the results.
+ */
+static void bench_report(const char* const label, const micro_ini_allocator* const pAllocator, const double seconds)
+{
+	printf("%-16s %14lu %10lu %9.3f\n", label, (unsigned long) pAllocator->stats.bytesInUse, (unsigned long) pAllocator->stats.allocations, seconds);
+}
+
+int main(int argc, char** argv)
+{
+	const unsigned long sections = argc > 1 ? strtoul(argv[1], NULL, 10) : 250000;
+
+	micro_ini_allocator nodeAllocator;
+	micro_ini_allocator docAllocator;
+	micro_ini_doc_options options;
+	bench_nodes nodes;
+	micro_ini_doc* pDoc;
+	size_t nodeBytes;
+	size_t docBytes;
+	size_t size;
+	char* text;
+	clock_t start;
+	unsigned long i;
+
+	text = bench_generate(sections, &size);
+	if(!text)
+	{
+		fprintf(stderr, "Out of memory.\n");
+		return EXIT_FAILURE;
+	}
+
+	printf("%lu sections, %lu keys, %lu bytes of text\n\n", sections, sections * 8, (unsigned long) size);
+	printf("%-16s %14s %10s %9s\n", "", "bytes", "blocks", "load (s)");
+
+	micro_ini_allocator_init(&nodeAllocator);
+	memset(&nodes, 0, sizeof(nodes));
+	nodes.pAllocator = &nodeAllocator;
+
+	start = clock();
+	micro_ini_load_buffer(text, size, 0, bench_nodes_handler, NULL, &nodes);
+	bench_report("pointer nodes", &nodeAllocator, (double) (clock() - start) / CLOCKS_PER_SEC);
+	nodeBytes = nodeAllocator.stats.bytesInUse;
+
+	micro_ini_allocator_init(&docAllocator);
+	memset(&options, 0, sizeof(options));
+	options.pAllocator = &docAllocator;
+
+	start = clock();
+	if(nodes.failed || micro_ini_doc_load_buffer(&pDoc, text, size, 0, &options, NULL, NULL) != 0)
+	{
+		fprintf(stderr, "Loading failed.\n");
+		return EXIT_FAILURE;
+	}
+
+	bench_report("document", &docAllocator, (double) (clock() - start) / CLOCKS_PER_SEC);
+	docBytes = docAllocator.stats.bytesInUse;
+
+	/* One typed lookup per section allocates the memo of every key in it. */
+	start = clock();
+	for(i = 0; i < sections; ++i)
+	{
+		char name[32];
+		long metric;
+
+		sprintf(name, "route.%lu", i);
+		micro_ini_doc_get_int(pDoc, name, "metric", &metric);
+	}
+
+	bench_report("document, typed", &docAllocator, (double) (clock() - start) / CLOCKS_PER_SEC);
+
+	printf("\npointer nodes / document: %.2fx (%.2fx after typed lookups)\n",
+		(double) nodeBytes / (double) docBytes, (double) nodeBytes / (double) docAllocator.stats.bytesInUse);
+
+	micro_ini_doc_free(pDoc);
+	bench_nodes_free(&nodes);
+	free(text);
+
+	return EXIT_SUCCESS;
+}
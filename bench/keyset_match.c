@@ -0,0 +1,335 @@
+/**
+ * Copyright (c) 2021, Zoe J. Bare
+ *
+ * MIT License
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ */
+
+/*
+ * Compares matching parsed keys against a registered key set with micro_ini_keyset
+ * against the two usual hand-written handlers: a chain of strcmp() calls over every
+ * known key, and bsearch() over the keys sorted up front.  Sets of 10 to 10,000 keys
+ * are generated with most keys 16 bytes or shorter, a quarter up to 32 bytes and a few
+ * longer, and one in ten parsed keys is not in the set.  Each handler is timed over a
+ * whole parse, next to a handler that does nothing, so the matching cost per pair is
+ * the difference between the two.
+ *
+ * Build: cc -O2 -Isrc bench/keyset_match.c src/micro_ini.c src/micro_ini_alloc.c src/micro_ini_keyset.c -o keyset_match
+ *        (add -mavx2 to compare with the AVX2 lanes)
+ * Usage: keyset_match
+ */
+
+#include "micro_ini_keyset.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#define BENCH_MAX_KEY_LENGTH 48
+
+typedef struct bench_keys
+{
+	char** ppKeys;        /* Keys in registration order. */
+	const char** ppSorted;  /* The same keys sorted for bsearch(). */
+	size_t count;
+	unsigned long matches;
+} bench_keys;
+
+static unsigned long g_seed = 12345;
+
+static unsigned long bench_random(void)
+{
+	g_seed = g_seed * 1103515245ul + 12345ul;
+	return (g_seed >> 8) & 0xFFFFFF;
+}
+
+/**
+ * @brief  Write a random key whose tail encodes a unique number.
+ *
+ * Keys in the set only use lowercase letters and digits; keys outside of it are marked
+ * with a '-' so they can never match.
+ */
+static void bench_make_key(char* const key, const unsigned long id, const int unknown)
+{
+	static const char alphabet[] = "abcdefghijklmnopqrstuvwxyz0123456789";
+
+	const unsigned long kind = bench_random() % 20;
+	const size_t length = kind < 14 ? 5 + bench_random() % 12 : (kind < 19 ? 17 + bench_random() % 16 : 33 + bench_random() % 16);
+	unsigned long rest = id;
+	size_t i;
+
+	for(i = 0; i < length; ++i)
+	{
+		key[i] = alphabet[bench_random() % 26];
+	}
+
+	/* Three base 36 digits at the end keep every generated key distinct. */
+	for(i = length - 3; i < length; ++i)
+	{
+		key[i] = alphabet[rest % 36];
+		rest /= 36;
+	}
+
+	if(unknown)
+	{
+		key[length / 2] = '-';
+	}
+
+	key[length] = '\0';
+}
+
+static int bench_compare(const void* pLeft, const void* pRight)
+{
+	return strcmp(*(const char* const*) pLeft, *(const char* const*) pRight);
+}
+
+static void bench_null_handler(void* pUserData, const char* section, const char* key, const char* value)
+{
+	(void) pUserData;
+	(void) section;
+	(void) key;
+	(void) value;
+}
+
+static void bench_strcmp_handler(void* pUserData, const char* section, const char* key, const char* value)
+{
+	bench_keys* const pKeys = (bench_keys*) pUserData;
+	size_t i;
+
+	(void) section;
+	(void) value;
+
+	for(i = 0; i < pKeys->count; ++i)
+	{
+		if(strcmp(key, pKeys->ppKeys[i]) == 0)
+		{
+			++pKeys->matches;
+			return;
+		}
+	}
+}
+
+static void bench_bsearch_handler(void* pUserData, const char* section, const char* key, const char* value)
+{
+	bench_keys* const pKeys = (bench_keys*) pUserData;
+
+	(void) section;
+	(void) value;
+
+	if(bsearch(&key, pKeys->ppSorted, pKeys->count, sizeof(const char*), bench_compare))
+	{
+		++pKeys->matches;
+	}
+}
+
+static void bench_keyset_match(void* pUserData, size_t keyIndex, const char* section, const char* key, const char* value)
+{
+	(void) keyIndex;
+	(void) section;
+	(void) key;
+	(void) value;
+
+	++((bench_keys*) pUserData)->matches;
+}
+
+/**
+ * @brief   Generate a file of pairs drawing nine in ten keys from the set.
+ * @return  Text of the ini file (free() it), or NULL if out of memory.
+ */
+static char* bench_generate(const bench_keys* const pKeys, const unsigned long pairs, size_t* const pOutSize)
+{
+	char* const text = (char*) malloc((size_t) pairs * (BENCH_MAX_KEY_LENGTH + 16) + pairs / 100 * 24 + 32);
+	size_t size = 0;
+	unsigned long i;
+
+	if(!text)
+	{
+		return NULL;
+	}
+
+	for(i = 0; i < pairs; ++i)
+	{
+		char unknown[BENCH_MAX_KEY_LENGTH + 1];
+		const char* key;
+
+		if(i % 100 == 0)
+		{
+			size += (size_t) sprintf(text + size, "[section.%lu]\n", i / 100);
+		}
+
+		if(bench_random() % 10 == 0)
+		{
+			bench_make_key(unknown, bench_random(), 1);
+			key = unknown;
+		}
+		else
+		{
+			key = pKeys->ppKeys[bench_random() % pKeys->count];
+		}
+
+		size += (size_t) sprintf(text + size, "%s = %lu\n", key, bench_random() & 0xFFFF);
+	}
+
+	(*pOutSize) = size;
+	return text;
+}
+
+/**
+ * @brief   Time the fastest of several parses with one handler.
+ * @return  Seconds taken by the fastest run.
+ */
+static double bench_time(const char* const text, const size_t size, const micro_ini_handler_fn handler, void* const pUserData)
+{
+	double best = 1e30;
+	int run;
+
+	for(run = 0; run < 5; ++run)
+	{
+		const clock_t start = clock();
+		double seconds;
+
+		micro_ini_load_buffer(text, size, 0, handler, NULL, pUserData);
+
+		seconds = (double) (clock() - start) / CLOCKS_PER_SEC;
+		if(seconds < best)
+		{
+			best = seconds;
+		}
+	}
+
+	return best;
+}
+
+int main(void)
+{
+	static const size_t sizes[] = { 10, 100, 1000, 10000 };
+
+	size_t s;
+
+	printf("%8s %10s %12s %12s %12s %12s %10s %10s\n", "keys", "pairs", "parse (ns)", "strcmp", "bsearch", "keyset", "vs strcmp", "vs bsearch");
+
+	for(s = 0; s < sizeof(sizes) / sizeof(sizes[0]); ++s)
+	{
+		const size_t count = sizes[s];
+
+		/* Keep the strcmp() chain over 10,000 keys from running for minutes. */
+		const unsigned long pairs = count <= 100 ? 1000000ul : 100000000ul / count;
+
+		micro_ini_keyset_dispatch dispatch;
+		micro_ini_keyset* pKeySet;
+		bench_keys keys;
+		unsigned long expected;
+		double parseTime;
+		double strcmpTime;
+		double bsearchTime;
+		double keysetTime;
+		size_t size;
+		char* text;
+		size_t i;
+
+		keys.ppKeys = (char**) malloc(count * sizeof(char*));
+		keys.ppSorted = (const char**) malloc(count * sizeof(const char*));
+		keys.count = count;
+
+		if(!keys.ppKeys || !keys.ppSorted)
+		{
+			fprintf(stderr, "Out of memory.\n");
+			return EXIT_FAILURE;
+		}
+
+		for(i = 0; i < count; ++i)
+		{
+			keys.ppKeys[i] = (char*) malloc(BENCH_MAX_KEY_LENGTH + 1);
+			if(!keys.ppKeys[i])
+			{
+				fprintf(stderr, "Out of memory.\n");
+				return EXIT_FAILURE;
+			}
+
+			bench_make_key(keys.ppKeys[i], (unsigned long) i, 0);
+			keys.ppSorted[i] = keys.ppKeys[i];
+		}
+
+		qsort(keys.ppSorted, count, sizeof(const char*), bench_compare);
+
+		if(micro_ini_keyset_create(&pKeySet, (const char* const*) keys.ppKeys, count, NULL) != MICRO_INI_SUCCESS)
+		{
+			fprintf(stderr, "Could not build the key set.\n");
+			return EXIT_FAILURE;
+		}
+
+		text = bench_generate(&keys, pairs, &size);
+		if(!text)
+		{
+			fprintf(stderr, "Out of memory.\n");
+			return EXIT_FAILURE;
+		}
+
+		dispatch.pKeySet = pKeySet;
+		dispatch.matchCallback = bench_keyset_match;
+		dispatch.otherCallback = NULL;
+		dispatch.pUserData = &keys;
+
+		parseTime = bench_time(text, size, bench_null_handler, NULL);
+
+		keys.matches = 0;
+		strcmpTime = bench_time(text, size, bench_strcmp_handler, &keys);
+		expected = keys.matches;
+
+		keys.matches = 0;
+		bsearchTime = bench_time(text, size, bench_bsearch_handler, &keys);
+		if(keys.matches != expected)
+		{
+			fprintf(stderr, "bsearch() found %lu matches instead of %lu.\n", keys.matches, expected);
+			return EXIT_FAILURE;
+		}
+
+		keys.matches = 0;
+		keysetTime = bench_time(text, size, micro_ini_keyset_handler, &dispatch);
+		if(keys.matches != expected)
+		{
+			fprintf(stderr, "The key set found %lu matches instead of %lu.\n", keys.matches, expected);
+			return EXIT_FAILURE;
+		}
+
+		/* Report the matching cost per pair on top of parsing. */
+		parseTime *= 1e9 / (double) pairs;
+		strcmpTime = strcmpTime * 1e9 / (double) pairs - parseTime;
+		bsearchTime = bsearchTime * 1e9 / (double) pairs - parseTime;
+		keysetTime = keysetTime * 1e9 / (double) pairs - parseTime;
+
+		printf("%8lu %10lu %12.1f %12.1f %12.1f %12.1f %9.1fx %9.1fx\n", (unsigned long) count, pairs, parseTime,
+			strcmpTime, bsearchTime, keysetTime, strcmpTime / keysetTime, bsearchTime / keysetTime);
+
+		micro_ini_keyset_free(pKeySet);
+		free(text);
+
+		for(i = 0; i < count; ++i)
+		{
+			free(keys.ppKeys[i]);
+		}
+
+		free(keys.ppKeys);
+		free(keys.ppSorted);
+	}
+
+	return EXIT_SUCCESS;
+}
@@ -0,0 +1,277 @@
+/**
+ * Copyright (c) 2021, Zoe J. Bare
+ *
+ * MIT License
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ */
+
+/*
+ * Compares reading a large ini stream from a pipe through micro_ini_load_fd(), through
+ * micro_ini_load_file() on the same pipe opened with fdopen(), and through
+ * micro_ini_load_stream() with fgets() and feof(), which locks the FILE object on every
+ * line the way micro_ini_load_file() used to.  A child process writes the same generated
+ * routing table into the pipe over and over until the requested size is reached.
+ *
+ * POSIX only.
+ * Build: cc -O2 -Isrc bench/load_fd.c src/micro_ini.c -o load_fd
+ * Usage: load_fd [megabytes]  (2048 by default)
+ */
+
+#define _POSIX_C_SOURCE 200112L
+
+#include "micro_ini.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include <sys/types.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#define BENCH_BLOCK_SIZE (1024 * 1024)
+
+enum BenchMethod
+{
+	BENCH_METHOD_FD,
+	BENCH_METHOD_FILE,
+	BENCH_METHOD_FGETS,
+
+	BENCH_METHOD_COUNT
+};
+
+static const char* const g_methodNames[BENCH_METHOD_COUNT] =
+{
+	"micro_ini_load_fd",
+	"micro_ini_load_file",
+	"fgets, feof",
+};
+
+/**
+ * @brief  Count the pairs so every method can be checked against the others.
+ */
+static void bench_count_handler(void* pUserData, const char* section, const char* key, const char* value)
+{
+	(void) section;
+	(void) key;
+	(void) value;
+
+	++(*(unsigned long*) pUserData);
+}
+
+static char* bench_fgets(char* str, int num, void* pStream)
+{
+	return fgets(str, num, (FILE*) pStream);
+}
+
+static int bench_feof(void* pStream)
+{
+	return feof((FILE*) pStream);
+}
+
+/**
+ * @brief   Fill a block with whole routing table sections.
+ * @return  Number of bytes used.
+ */
+static size_t bench_generate_block(char* const block)
+{
+	static const char* const interfaces[] = { "eth0", "eth1", "eth2", "eth3" };
+
+	unsigned long seed = 12345;
+	size_t size = 0;
+	unsigned long i;
+
+	for(i = 0; size + 256 < BENCH_BLOCK_SIZE; ++i)
+	{
+		unsigned long r;
+
+		seed = seed * 1103515245ul + 12345ul;
+		r = (seed >> 8) & 0xFFFFFF;
+
+		size += (size_t) sprintf(block + size,
+			"[route.%lu]\ndestination = 10.%lu.%lu.0/24\ngateway = 10.0.%lu.1\ninterface = %s\nmetric = %lu\n"
+			"enabled = %s\ntable = main\nprotocol = static\nscope = global\n",
+			i, (i >> 8) & 0xFF, i & 0xFF, r & 15, interfaces[(r >> 4) & 3], (r >> 6) % 32, (r >> 11) & 1 ? "true" : "false");
+	}
+
+	return size;
+}
+
+/**
+ * @brief  Write the block into a descriptor the given number of times, then exit.
+ */
+static void bench_writer(const int fd, const char* const block, const size_t blockSize, const unsigned long blocks)
+{
+	unsigned long i;
+
+	for(i = 0; i < blocks; ++i)
+	{
+		size_t written = 0;
+
+		while(written < blockSize)
+		{
+			const ssize_t result = write(fd, block + written, blockSize - written);
+
+			if(result <= 0)
+			{
+				_exit(EXIT_FAILURE);
+			}
+
+			written += (size_t) result;
+		}
+	}
+
+	close(fd);
+	_exit(EXIT_SUCCESS);
+}
+
+static double bench_now(void)
+{
+	struct timespec now;
+
+	clock_gettime(CLOCK_MONOTONIC, &now);
+	return (double) now.tv_sec + (double) now.tv_nsec / 1e9;
+}
+
+/**
+ * @brief   Parse the output of a writer process with one of the methods.
+ * @return  Result of the parse.
+ */
+static int bench_run(
+	const int method,
+	const char* const block,
+	const size_t blockSize,
+	const unsigned long blocks,
+	unsigned long* const pOutPairs,
+	double* const pOutSeconds)
+{
+	int fds[2];
+	pid_t child;
+	FILE* pFile = NULL;
+	double start;
+	int status;
+	int err;
+
+	if(pipe(fds) != 0)
+	{
+		return MICRO_INI_ERROR_SYSTEM;
+	}
+
+	child = fork();
+	if(child < 0)
+	{
+		return MICRO_INI_ERROR_SYSTEM;
+	}
+
+	if(child == 0)
+	{
+		close(fds[0]);
+		bench_writer(fds[1], block, blockSize, blocks);
+	}
+
+	close(fds[1]);
+
+	if(method != BENCH_METHOD_FD && (pFile = fdopen(fds[0], "r")) == NULL)
+	{
+		return MICRO_INI_ERROR_SYSTEM;
+	}
+
+	(*pOutPairs) = 0;
+	start = bench_now();
+
+	switch(method)
+	{
+		case BENCH_METHOD_FD:
+			err = micro_ini_load_fd(fds[0], 0, bench_count_handler, NULL, pOutPairs);
+			break;
+
+		case BENCH_METHOD_FILE:
+			err = micro_ini_load_file(pFile, 0, bench_count_handler, NULL, pOutPairs);
+			break;
+
+		default:
+			err = micro_ini_load_stream(pFile, 0, bench_count_handler, NULL, bench_fgets, bench_feof, pOutPairs);
+			break;
+	}
+
+	(*pOutSeconds) = bench_now() - start;
+
+	if(pFile)
+	{
+		fclose(pFile);
+	}
+	else
+	{
+		close(fds[0]);
+	}
+
+	waitpid(child, &status, 0);
+	return err;
+}
+
+int main(int argc, char** argv)
+{
+	const unsigned long megabytes = argc > 1 ? strtoul(argv[1], NULL, 10) : 2048;
+
+	unsigned long pairs[BENCH_METHOD_COUNT];
+	double seconds[BENCH_METHOD_COUNT];
+	size_t blockSize;
+	char* block;
+	int method;
+
+	block = (char*) malloc(BENCH_BLOCK_SIZE);
+	if(!block)
+	{
+		fprintf(stderr, "Out of memory.\n");
+		return EXIT_FAILURE;
+	}
+
+	blockSize = bench_generate_block(block);
+
+	printf("%lu MB through a pipe\n\n", (unsigned long) (((double) blockSize * megabytes) / (1024.0 * 1024.0)));
+	printf("%-20s %12s %10s %10s\n", "", "pairs", "time (s)", "MB/s");
+
+	for(method = 0; method < BENCH_METHOD_COUNT; ++method)
+	{
+		const int err = bench_run(method, block, blockSize, megabytes, &pairs[method], &seconds[method]);
+
+		if(err != MICRO_INI_SUCCESS)
+		{
+			fprintf(stderr, "%s failed with %d.\n", g_methodNames[method], err);
+			return EXIT_FAILURE;
+		}
+
+		if(pairs[method] != pairs[0])
+		{
+			fprintf(stderr, "%s reported %lu pairs instead of %lu.\n", g_methodNames[method], pairs[method], pairs[0]);
+			return EXIT_FAILURE;
+		}
+
+		printf("%-20s %12lu %10.2f %10.0f\n", g_methodNames[method], pairs[method], seconds[method],
+			(double) blockSize * megabytes / (1024.0 * 1024.0) / seconds[method]);
+	}
+
+	printf("\nfd / FILE: %.2fx, fd / fgets: %.2fx\n",
+		seconds[BENCH_METHOD_FILE] / seconds[BENCH_METHOD_FD], seconds[BENCH_METHOD_FGETS] / seconds[BENCH_METHOD_FD]);
+
+	free(block);
+	return EXIT_SUCCESS;
+}
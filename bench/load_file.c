@@ -0,0 +1,216 @@
+/**
+ * Copyright (c) 2021, Zoe J. Bare
+ *
+ * MIT License
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ */
+
+/*
+ * Compares micro_ini_load_file(), which locks the FILE object once and reads it in
+ * blocks without further locking, against reading the same FILE object a line at a
+ * time with fgets() and feof(), each of which takes the lock, which is how
+ * micro_ini_load_file() used to read.  Both parse a temporary file of one million
+ * lines that stays in the page cache, and the fastest of several runs is reported.
+ *
+ * Some C libraries, glibc among them, skip stdio locking entirely while a process has
+ * a single thread, so both methods are measured again after starting an idle thread,
+ * as in any multithreaded service.
+ *
+ * POSIX only.
+ * Build: cc -O2 -pthread -Isrc bench/load_file.c src/micro_ini.c -o load_file
+ * Usage: load_file [lines]  (1000000 by default)
+ */
+
+#define _POSIX_C_SOURCE 200112L
+
+#include "micro_ini.h"
+
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#define BENCH_RUNS 5
+
+/**
+ * @brief  Count the pairs so both methods can be checked against each other.
+ */
+static void bench_count_handler(void* pUserData, const char* section, const char* key, const char* value)
+{
+	(void) section;
+	(void) key;
+	(void) value;
+
+	++(*(unsigned long*) pUserData);
+}
+
+static char* bench_fgets(char* str, int num, void* pStream)
+{
+	return fgets(str, num, (FILE*) pStream);
+}
+
+static int bench_feof(void* pStream)
+{
+	return feof((FILE*) pStream);
+}
+
+/**
+ * @brief  Wait until the main thread is done, so that the process has a second thread.
+ */
+static void* bench_idle_thread(void* pArg)
+{
+	pthread_mutex_t* const pMutex = (pthread_mutex_t*) pArg;
+
+	pthread_mutex_lock(pMutex);
+	pthread_mutex_unlock(pMutex);
+	return NULL;
+}
+
+/**
+ * @brief   Parse the file several times with one method.
+ * @return  Fastest time in seconds, or a negative value if parsing failed.
+ */
+static double bench_method(FILE* const pFile, const int method, unsigned long* const pOutPairs)
+{
+	double best = 1e30;
+	int run;
+
+	for(run = 0; run < BENCH_RUNS; ++run)
+	{
+		clock_t start;
+		double seconds;
+		int err;
+
+		rewind(pFile);
+		(*pOutPairs) = 0;
+		start = clock();
+
+		if(method == 0)
+		{
+			err = micro_ini_load_file(pFile, 0, bench_count_handler, NULL, pOutPairs);
+		}
+		else
+		{
+			err = micro_ini_load_stream(pFile, 0, bench_count_handler, NULL, bench_fgets, bench_feof, pOutPairs);
+		}
+
+		seconds = (double) (clock() - start) / CLOCKS_PER_SEC;
+		if(err != MICRO_INI_SUCCESS)
+		{
+			fprintf(stderr, "Parsing failed with %d.\n", err);
+			return -1.0;
+		}
+
+		if(seconds < best)
+		{
+			best = seconds;
+		}
+	}
+
+	return best;
+}
+
+/**
+ * @brief   Write a routing table of the given number of lines.
+ * @return  Number of bytes written.
+ */
+static unsigned long bench_generate(FILE* const pFile, const unsigned long lines)
+{
+	static const char* const keys[] = { "destination", "gateway", "interface", "metric", "enabled", "table", "protocol", "scope" };
+
+	unsigned long seed = 12345;
+	unsigned long bytes = 0;
+	unsigned long section = 0;
+	unsigned long line;
+
+	for(line = 0; line < lines; ++line)
+	{
+		const unsigned long slot = line % 9;
+
+		seed = seed * 1103515245ul + 12345ul;
+
+		if(slot == 0)
+		{
+			bytes += (unsigned long) fprintf(pFile, "[route.%lu]\n", section++);
+		}
+		else
+		{
+			bytes += (unsigned long) fprintf(pFile, "%s = %lu\n", keys[slot - 1], (seed >> 8) & 0xFFFF);
+		}
+	}
+
+	return bytes;
+}
+
+int main(int argc, char** argv)
+{
+	const unsigned long lines = argc > 1 ? strtoul(argv[1], NULL, 10) : 1000000;
+
+	pthread_mutex_t mutex = PTHREAD_MUTEX_INITIALIZER;
+	pthread_t thread;
+	FILE* const pFile = tmpfile();
+	unsigned long bytes;
+	unsigned long pairs[2];
+	double best[2];
+	int threads;
+
+	if(!pFile)
+	{
+		fprintf(stderr, "Could not create a temporary file.\n");
+		return EXIT_FAILURE;
+	}
+
+	bytes = bench_generate(pFile, lines);
+	printf("%lu lines, %lu bytes\n\n", lines, bytes);
+	printf("%-8s %10s %22s %14s %9s\n", "threads", "pairs", "micro_ini_load_file", "fgets, feof", "speedup");
+
+	for(threads = 1; threads <= 2; ++threads)
+	{
+		if(threads == 2)
+		{
+			pthread_mutex_lock(&mutex);
+			if(pthread_create(&thread, NULL, bench_idle_thread, &mutex) != 0)
+			{
+				fprintf(stderr, "Could not start a thread.\n");
+				return EXIT_FAILURE;
+			}
+		}
+
+		if((best[0] = bench_method(pFile, 0, &pairs[0])) < 0.0 || (best[1] = bench_method(pFile, 1, &pairs[1])) < 0.0)
+		{
+			return EXIT_FAILURE;
+		}
+
+		if(pairs[0] != pairs[1])
+		{
+			fprintf(stderr, "The methods reported different numbers of pairs.\n");
+			return EXIT_FAILURE;
+		}
+
+		printf("%-8d %10lu %19.1f ms %11.1f ms %8.2fx\n", threads, pairs[0], best[0] * 1000.0, best[1] * 1000.0, best[1] / best[0]);
+	}
+
+	pthread_mutex_unlock(&mutex);
+	pthread_join(thread, NULL);
+
+	fclose(pFile);
+	return EXIT_SUCCESS;
+}
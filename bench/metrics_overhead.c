@@ -0,0 +1,205 @@
+/**
+ * Copyright (c) 2021, Zoe J. Bare
+ *
+ * MIT License
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ */
+
+/*
+ * Measures what recording load metrics costs: micro_ini_metrics_record() on its own,
+ * from one to eight threads recording at once, the clock read twice per load, and a
+ * small in-memory load with metrics detached and attached.  Building the program with
+ * and without MICRO_INI_ENABLE_METRICS compares against a parser that reads no clock.
+ * Recording from several threads is reported as processor time per call, so that
+ * contention shows up as a higher cost even on a machine with fewer cores than threads.
+ *
+ * POSIX only.
+ * Build: cc -O2 -pthread -DMICRO_INI_ENABLE_METRICS -Isrc bench/metrics_overhead.c src/micro_ini.c src/micro_ini_metrics.c -o metrics_overhead
+ *        cc -O2 -pthread -Isrc bench/metrics_overhead.c src/micro_ini.c src/micro_ini_metrics.c -o metrics_overhead_off
+ * Usage: metrics_overhead
+ */
+
+#define _POSIX_C_SOURCE 200112L
+
+#include "micro_ini_metrics.h"
+
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+#define BENCH_RECORDS 4000000ul
+#define BENCH_LOADS   1000000ul
+
+typedef struct bench_thread
+{
+	pthread_t thread;
+	micro_ini_metrics* pMetrics;
+} bench_thread;
+
+static const char g_payload[] =
+	"[route.42]\ndestination = 10.0.42.0/24\ngateway = 10.0.3.1\ninterface = eth2\nmetric = 17\n"
+	"enabled = true\ntable = main\nprotocol = static\nscope = global\n";
+
+static double bench_now(void)
+{
+	struct timespec now;
+
+	clock_gettime(CLOCK_MONOTONIC, &now);
+	return (double) now.tv_sec + (double) now.tv_nsec / 1e9;
+}
+
+static void bench_null_handler(void* pUserData, const char* section, const char* key, const char* value)
+{
+	(void) pUserData;
+	(void) section;
+	(void) key;
+	(void) value;
+}
+
+/**
+ * @brief  Record a spread of samples, as a busy loader thread would.
+ */
+static void* bench_record_thread(void* pArg)
+{
+	bench_thread* const pThread = (bench_thread*) pArg;
+	unsigned long i;
+
+	for(i = 0; i < BENCH_RECORDS; ++i)
+	{
+		micro_ini_metrics_record(pThread->pMetrics, 20000 + (i & 0xFFFF), 180 + (i & 0x3F), (int) (i & 1));
+	}
+
+	return NULL;
+}
+
+/**
+ * @brief   Time the fastest of several runs of small loads.
+ * @return  Nanoseconds per load.
+ */
+static double bench_loads(void)
+{
+	double best = 1e30;
+	int run;
+
+	for(run = 0; run < 5; ++run)
+	{
+		const double start = bench_now();
+		double seconds;
+		unsigned long i;
+
+		for(i = 0; i < BENCH_LOADS; ++i)
+		{
+			micro_ini_load_buffer(g_payload, sizeof(g_payload) - 1, 0, bench_null_handler, NULL, NULL);
+		}
+
+		seconds = bench_now() - start;
+		if(seconds < best)
+		{
+			best = seconds;
+		}
+	}
+
+	return best * 1e9 / (double) BENCH_LOADS;
+}
+
+int main(void)
+{
+	static micro_ini_metrics metrics;
+	static const int threadCounts[] = { 1, 2, 4, 8 };
+
+	micro_ini_metrics_shard total;
+	bench_thread threads[8];
+	double start;
+	double detached;
+	double attached;
+	uint64_t sink = 0;
+	unsigned long i;
+	size_t t;
+
+	printf("%ld processors online\n\n", sysconf(_SC_NPROCESSORS_ONLN));
+	printf("%-32s %12s\n", "micro_ini_metrics_record()", "CPU ns/call");
+
+	for(t = 0; t < sizeof(threadCounts) / sizeof(threadCounts[0]); ++t)
+	{
+		clock_t cpuStart;
+		char label[32];
+		int n;
+
+		micro_ini_metrics_reset(&metrics);
+		cpuStart = clock();
+
+		for(n = 0; n < threadCounts[t]; ++n)
+		{
+			threads[n].pMetrics = &metrics;
+			if(pthread_create(&threads[n].thread, NULL, bench_record_thread, &threads[n]) != 0)
+			{
+				fprintf(stderr, "Could not start a thread.\n");
+				return EXIT_FAILURE;
+			}
+		}
+
+		for(n = 0; n < threadCounts[t]; ++n)
+		{
+			pthread_join(threads[n].thread, NULL);
+		}
+
+		micro_ini_metrics_merge(&metrics, &total);
+		if(total.duration.count != BENCH_RECORDS * (unsigned long) threadCounts[t])
+		{
+			fprintf(stderr, "Lost samples: %lu recorded.\n", (unsigned long) total.duration.count);
+			return EXIT_FAILURE;
+		}
+
+		sprintf(label, "%d thread%s", threadCounts[t], threadCounts[t] > 1 ? "s" : "");
+		printf("%-32s %12.1f\n", label, (double) (clock() - cpuStart) / CLOCKS_PER_SEC * 1e9 / ((double) BENCH_RECORDS * threadCounts[t]));
+	}
+
+	start = bench_now();
+	for(i = 0; i < BENCH_RECORDS; ++i)
+	{
+		sink += micro_ini_metrics_clock();
+	}
+
+	printf("\n%-32s %12.1f\n", "micro_ini_metrics_clock()", (bench_now() - start) * 1e9 / (double) BENCH_RECORDS);
+
+#if defined(MICRO_INI_ENABLE_METRICS)
+	printf("\n%u byte load, MICRO_INI_ENABLE_METRICS defined\n", (unsigned) (sizeof(g_payload) - 1));
+#else
+	printf("\n%u byte load, MICRO_INI_ENABLE_METRICS not defined\n", (unsigned) (sizeof(g_payload) - 1));
+#endif
+
+	micro_ini_metrics_reset(&metrics);
+	micro_ini_metrics_attach(NULL);
+	detached = bench_loads();
+
+	micro_ini_metrics_attach(&metrics);
+	attached = bench_loads();
+	micro_ini_metrics_attach(NULL);
+
+	printf("%-32s %12.1f\n", "detached (ns per load)", detached);
+	printf("%-32s %12.1f\n", "attached (ns per load)", attached);
+	printf("%-32s %12.1f  (%.1f%%)\n", "recording overhead", attached - detached, (attached - detached) * 100.0 / detached);
+
+	/* Keep the clock reads from being optimized away. */
+	return sink == 0 ? EXIT_FAILURE : EXIT_SUCCESS;
+}
@@ -0,0 +1,294 @@
+/**
+ * Copyright (c) 2021, Zoe J. Bare
+ *
+ * MIT License
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ */
+
+/*
+ * Measures the latency of one run of the microini command line tool on a 50 MB file:
+ * with the index cache disabled (-n), which parses the whole file every time; cold,
+ * right after the file has changed, which parses it and writes a new index; and warm,
+ * which maps the saved index.  Every run is a separate process started with fork() and
+ * execv(), as a shell script would, with its own index cache in a temporary directory.
+ *
+ * POSIX only.
+ * Build: cc -O2 -Isrc tools/microini.c src/micro_ini.c src/micro_ini_alloc.c src/micro_ini_doc.c src/micro_ini_image.c -o microini
+ *        cc -O2 bench/microini_cli.c -o microini_cli
+ * Usage: microini_cli [path to microini] [megabytes]  (./microini and 50 by default)
+ */
+
+#define _XOPEN_SOURCE 700
+
+#include <dirent.h>
+#include <fcntl.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include <sys/stat.h>
+#include <sys/time.h>
+#include <sys/types.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#define BENCH_COLD_RUNS 5
+#define BENCH_WARM_RUNS 200
+
+static double bench_now(void)
+{
+	struct timespec now;
+
+	clock_gettime(CLOCK_MONOTONIC, &now);
+	return (double) now.tv_sec + (double) now.tv_nsec / 1e9;
+}
+
+/**
+ * @brief   Run the tool once with its output discarded.
+ * @return  Seconds the process took, or a negative value if it failed.
+ */
+static double bench_run(char* const* const argv)
+{
+	const double start = bench_now();
+	pid_t child;
+	int status;
+
+	child = fork();
+	if(child < 0)
+	{
+		return -1.0;
+	}
+
+	if(child == 0)
+	{
+		const int null = open("/dev/null", O_WRONLY);
+
+		if(null >= 0)
+		{
+			dup2(null, STDOUT_FILENO);
+		}
+
+		execv(argv[0], argv);
+		_exit(127);
+	}
+
+	if(waitpid(child, &status, 0) != child || !WIFEXITED(status) || WEXITSTATUS(status) != 0)
+	{
+		return -1.0;
+	}
+
+	return bench_now() - start;
+}
+
+static int bench_compare(const void* pA, const void* pB)
+{
+	const double a = *(const double*) pA;
+	const double b = *(const double*) pB;
+
+	return (a < b) ? -1 : ((a > b) ? 1 : 0);
+}
+
+/**
+ * @brief  Print the median and fastest of a set of timings.
+ */
+static void bench_report(const char* const label, double* const times, const int count)
+{
+	qsort(times, (size_t) count, sizeof(double), bench_compare);
+	printf("%-24s %6d %14.2f %14.2f\n", label, count, times[count / 2] * 1000.0, times[0] * 1000.0);
+}
+
+/**
+ * @brief   Write a routing table of about the requested size.
+ * @return  Number of sections written, or 0 on failure.
+ */
+static unsigned long bench_generate(const char* const path, const unsigned long megabytes)
+{
+	static const char* const interfaces[] = { "eth0", "eth1", "eth2", "eth3" };
+
+	FILE* const pFile = fopen(path, "w");
+	unsigned long seed = 12345;
+	unsigned long bytes = 0;
+	unsigned long i;
+
+	if(!pFile)
+	{
+		return 0;
+	}
+
+	for(i = 0; bytes < megabytes * 1024ul * 1024ul; ++i)
+	{
+		unsigned long r;
+		int written;
+
+		seed = seed * 1103515245ul + 12345ul;
+		r = (seed >> 8) & 0xFFFFFF;
+
+		written = fprintf(pFile,
+			"[route.%lu]\ndestination = 10.%lu.%lu.0/24\ngateway = 10.0.%lu.1\ninterface = %s\nmetric = %lu\n"
+			"enabled = %s\ntable = main\nprotocol = static\nscope = global\n",
+			i, (i >> 8) & 0xFF, i & 0xFF, r & 15, interfaces[(r >> 4) & 3], (r >> 6) % 32, (r >> 11) & 1 ? "true" : "false");
+
+		if(written < 0)
+		{
+			fclose(pFile);
+			return 0;
+		}
+
+		bytes += (unsigned long) written;
+	}
+
+	return (fclose(pFile) == 0) ? i : 0;
+}
+
+/**
+ * @brief  Remove the temporary directory along with the file and the saved indices.
+ */
+static void bench_cleanup(const char* const directory)
+{
+	char path[4096];
+	DIR* pDir;
+	struct dirent* pEntry;
+
+	sprintf(path, "%s/microini", directory);
+	pDir = opendir(path);
+
+	if(pDir)
+	{
+		while((pEntry = readdir(pDir)) != NULL)
+		{
+			if(strcmp(pEntry->d_name, ".") != 0 && strcmp(pEntry->d_name, "..") != 0)
+			{
+				sprintf(path, "%s/microini/%s", directory, pEntry->d_name);
+				unlink(path);
+			}
+		}
+
+		closedir(pDir);
+		sprintf(path, "%s/microini", directory);
+		rmdir(path);
+	}
+
+	sprintf(path, "%s/routes.ini", directory);
+	unlink(path);
+	rmdir(directory);
+}
+
+int main(int argc, char** argv)
+{
+	const unsigned long megabytes = argc > 2 ? strtoul(argv[2], NULL, 10) : 50;
+
+	char directory[] = "/tmp/microini_cli.XXXXXX";
+	char filePath[64];
+	char section[32];
+	char tool[4096];
+	char* cachedArgs[6];
+	char* uncachedArgs[7];
+	double cold[BENCH_COLD_RUNS];
+	double uncached[BENCH_COLD_RUNS];
+	double warm[BENCH_WARM_RUNS];
+	unsigned long sections;
+	struct stat info;
+	int failed = 0;
+	int i;
+
+	strncpy(tool, argc > 1 ? argv[1] : "./microini", sizeof(tool) - 1);
+	tool[sizeof(tool) - 1] = '\0';
+
+	if(access(tool, X_OK) != 0)
+	{
+		fprintf(stderr, "Cannot run '%s'; build tools/microini.c first.\n", tool);
+		return EXIT_FAILURE;
+	}
+
+	if(!mkdtemp(directory))
+	{
+		fprintf(stderr, "Cannot create a temporary directory.\n");
+		return EXIT_FAILURE;
+	}
+
+	/* Keep the indices of this run away from the user's cache. */
+	setenv("XDG_CACHE_HOME", directory, 1);
+
+	sprintf(filePath, "%s/routes.ini", directory);
+	sections = bench_generate(filePath, megabytes);
+	if(sections == 0 || stat(filePath, &info) != 0)
+	{
+		fprintf(stderr, "Cannot write the test file.\n");
+		bench_cleanup(directory);
+		return EXIT_FAILURE;
+	}
+
+	/* Ask for a key of the last section so nothing can stop early. */
+	sprintf(section, "route.%lu", sections - 1);
+
+	cachedArgs[0] = tool;
+	cachedArgs[1] = (char*) "get";
+	cachedArgs[2] = filePath;
+	cachedArgs[3] = section;
+	cachedArgs[4] = (char*) "gateway";
+	cachedArgs[5] = NULL;
+
+	uncachedArgs[0] = tool;
+	uncachedArgs[1] = (char*) "-n";
+	memcpy(uncachedArgs + 2, cachedArgs + 1, 5 * sizeof(char*));
+
+	printf("%lu sections, %lu bytes\n\n", sections, (unsigned long) info.st_size);
+	printf("%-24s %6s %14s %14s\n", "", "runs", "median (ms)", "fastest (ms)");
+
+	for(i = 0; i < BENCH_COLD_RUNS && !failed; ++i)
+	{
+		failed = (uncached[i] = bench_run(uncachedArgs)) < 0.0;
+	}
+
+	for(i = 0; i < BENCH_COLD_RUNS && !failed; ++i)
+	{
+		struct timeval times[2];
+
+		/* A new modification time makes the saved index stale, as an edit of the file would. */
+		gettimeofday(&times[0], NULL);
+		times[1] = times[0];
+		times[1].tv_sec += i + 1;
+		utimes(filePath, times);
+
+		failed = (cold[i] = bench_run(cachedArgs)) < 0.0;
+	}
+
+	for(i = 0; i < BENCH_WARM_RUNS && !failed; ++i)
+	{
+		failed = (warm[i] = bench_run(cachedArgs)) < 0.0;
+	}
+
+	if(failed)
+	{
+		fprintf(stderr, "A run of '%s' failed.\n", tool);
+		bench_cleanup(directory);
+		return EXIT_FAILURE;
+	}
+
+	bench_report("uncached (-n)", uncached, BENCH_COLD_RUNS);
+	bench_report("cold, builds the index", cold, BENCH_COLD_RUNS);
+	bench_report("warm, maps the index", warm, BENCH_WARM_RUNS);
+
+	printf("\nwarm / uncached: %.0fx faster\n", uncached[BENCH_COLD_RUNS / 2] / warm[BENCH_WARM_RUNS / 2]);
+
+	bench_cleanup(directory);
+	return EXIT_SUCCESS;
+}
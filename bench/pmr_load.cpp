@@ -0,0 +1,244 @@
+/**
+ * Copyright (c) 2021, Zoe J. Bare
+ *
+ * MIT License
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ */
+
+/*
+ * Compares loading into micro_ini::pmr_document backed by a monotonic arena against
+ * the usual callback that copies every pair into nested std::unordered_map and
+ * std::string containers.  Global operator new is replaced to count every heap
+ * allocation made by either side, including the blocks the arena takes from upstream,
+ * which are also counted on their own.  Each side is loaded several times and the fastest run is reported.
+ *
+ * Build: c++ -std=c++17 -O2 -Isrc bench/pmr_load.cpp src/micro_ini.c -o pmr_load
+ * Usage: pmr_load [sections]  (100000 by default, 8 keys each)
+ */
+
+#include "micro_ini_pmr.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <new>
+#include <string>
+#include <unordered_map>
+
+namespace
+{
+
+std::size_t g_newCount = 0;
+
+/**
+ * Memory resource counting the blocks it passes on to the heap.
+ */
+class counting_resource : public std::pmr::memory_resource
+{
+public:
+
+	std::size_t allocations = 0;
+	std::size_t bytes = 0;
+
+private:
+
+	void* do_allocate(const std::size_t size, const std::size_t alignment) override
+	{
+		++allocations;
+		bytes += size;
+		return std::pmr::new_delete_resource()->allocate(size, alignment);
+	}
+
+	void do_deallocate(void* const p, const std::size_t size, const std::size_t alignment) override
+	{
+		std::pmr::new_delete_resource()->deallocate(p, size, alignment);
+	}
+
+	bool do_is_equal(const std::pmr::memory_resource& other) const noexcept override
+	{
+		return this == &other;
+	}
+};
+
+using naive_section = std::unordered_map<std::string, std::string>;
+using naive_table = std::unordered_map<std::string, naive_section>;
+
+/**
+ * The callback most applications start with: look both names up and copy the value.
+ */
+void naive_handler(void* const pUserData, const char* const section, const char* const key, const char* const value)
+{
+	(*static_cast<naive_table*>(pUserData))[section][key] = value;
+}
+
+/**
+ * Generate the same routing table as bench/doc_memory.c.
+ */
+std::string generate(const unsigned long sections)
+{
+	static const char* const interfaces[] = { "eth0", "eth1", "eth2", "eth3" };
+
+	std::string text;
+	unsigned long seed = 12345;
+	char line[512];
+
+	text.reserve(sections * 200);
+
+	for(unsigned long i = 0; i < sections; ++i)
+	{
+		seed = seed * 1103515245ul + 12345ul;
+		const unsigned long r = (seed >> 8) & 0xFFFFFF;
+
+		std::snprintf(line, sizeof(line),
+			"[route.%lu]\ndestination = 10.%lu.%lu.0/24\ngateway = 10.0.%lu.1\ninterface = %s\nmetric = %lu\n"
+			"enabled = %s\ntable = main\nprotocol = static\nscope = global\n",
+			i, (i >> 8) & 0xFF, i & 0xFF, r & 15, interfaces[(r >> 4) & 3], (r >> 6) % 32, (r >> 11) & 1 ? "true" : "false");
+		text += line;
+	}
+
+	return text;
+}
+
+double seconds_since(const std::chrono::steady_clock::time_point start)
+{
+	return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+/**
+ * Results of the fastest of several runs.
+ */
+struct result
+{
+	std::size_t heapAllocations = 0;
+	std::size_t upstreamAllocations = 0;
+	double load = 1e30;
+	double release = 1e30;
+};
+
+void report(const char* const label, const result& row)
+{
+	std::printf("%-20s %12lu %10lu %10.2f %11.2f\n", label, static_cast<unsigned long>(row.heapAllocations),
+		static_cast<unsigned long>(row.upstreamAllocations), row.load * 1000.0, row.release * 1000.0);
+}
+
+} /* namespace */
+
+void* operator new(const std::size_t size)
+{
+	++g_newCount;
+
+	if(void* const p = std::malloc(size ? size : 1))
+	{
+		return p;
+	}
+
+	throw std::bad_alloc();
+}
+
+void* operator new(const std::size_t size, const std::align_val_t alignment)
+{
+	++g_newCount;
+
+	if(void* const p = std::aligned_alloc(static_cast<std::size_t>(alignment), (size + static_cast<std::size_t>(alignment) - 1) & ~(static_cast<std::size_t>(alignment) - 1)))
+	{
+		return p;
+	}
+
+	throw std::bad_alloc();
+}
+
+void operator delete(void* const p, std::align_val_t) noexcept
+{
+	std::free(p);
+}
+
+void operator delete(void* const p, std::size_t, std::align_val_t) noexcept
+{
+	std::free(p);
+}
+
+void operator delete(void* const p) noexcept
+{
+	std::free(p);
+}
+
+void operator delete(void* const p, std::size_t) noexcept
+{
+	std::free(p);
+}
+
+int main(int argc, char** argv)
+{
+	const unsigned long sections = argc > 1 ? std::strtoul(argv[1], nullptr, 10) : 100000;
+	const int runs = 5;
+
+	const std::string text = generate(sections);
+	result naive;
+	result arena;
+
+	std::printf("%lu sections, %lu keys, %lu bytes of text\n\n", sections, sections * 8, static_cast<unsigned long>(text.size()));
+	std::printf("%-20s %12s %10s %10s %11s\n", "", "heap allocs", "upstream", "load (ms)", "free (ms)");
+
+	for(int run = 0; run < runs; ++run)
+	{
+		{
+			naive_table* const pTable = new naive_table();
+
+			g_newCount = 0;
+			auto start = std::chrono::steady_clock::now();
+			micro_ini_load_buffer(text.data(), text.size(), 0, naive_handler, nullptr, pTable);
+			naive.load = std::min(naive.load, seconds_since(start));
+			naive.heapAllocations = g_newCount;
+
+			start = std::chrono::steady_clock::now();
+			delete pTable;
+			naive.release = std::min(naive.release, seconds_since(start));
+		}
+
+		{
+			counting_resource upstream;
+			std::pmr::monotonic_buffer_resource* const pArena = new std::pmr::monotonic_buffer_resource(&upstream);
+			micro_ini::pmr_document* const pDoc = new micro_ini::pmr_document(pArena);
+
+			g_newCount = 0;
+			auto start = std::chrono::steady_clock::now();
+			pDoc->load_buffer(text);
+			arena.load = std::min(arena.load, seconds_since(start));
+			arena.heapAllocations = g_newCount;
+			arena.upstreamAllocations = upstream.allocations;
+
+			/* The destructors still walk every node, but handing memory back to the arena does nothing. */
+			start = std::chrono::steady_clock::now();
+			delete pDoc;
+			delete pArena;
+			arena.release = std::min(arena.release, seconds_since(start));
+		}
+	}
+
+	report("unordered_map", naive);
+	report("pmr_document", arena);
+
+	std::printf("\nheap allocations: %.0fx fewer, load: %.2fx faster, free: %.1fx faster\n",
+		static_cast<double>(naive.heapAllocations) / static_cast<double>(arena.heapAllocations ? arena.heapAllocations : 1),
+		naive.load / arena.load, naive.release / arena.release);
+
+	return EXIT_SUCCESS;
+}
@@ -0,0 +1,450 @@
+/**
+ * Copyright (c) 2021, Zoe J. Bare
+ *
+ * MIT License
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ */
+
+/*
+ * perf_fuzz - libFuzzer target that looks for inputs which are slow rather than ones
+ * which crash.
+ *
+ * Every input is parsed with micro_ini_load_buffer(), again through a stream with
+ * micro_ini_resume_stream(), and loaded into a document whose every pair is then
+ * looked up, both in the document and in an image built from it, all with multi-line
+ * values and inheritance enabled.  The cost of the
+ * whole run is measured in retired instructions (from perf_event_open() on Linux, or
+ * in nanoseconds of processor time elsewhere) and divided by the size of the input
+ * plus a fixed allowance for setup.  An input costing more than the limit per byte
+ * aborts, which libFuzzer reports and saves like a crash.
+ *
+ * Build: clang -g -O1 -fsanitize=fuzzer -Isrc fuzz/perf_fuzz.c src/micro_ini.c src/micro_ini_alloc.c src/micro_ini_doc.c src/micro_ini_image.c -o perf_fuzz
+ * Run:   ./perf_fuzz -use_value_profile=1 -max_len=65536 -timeout=10 fuzz/corpus
+ *
+ * With -use_value_profile=1, libFuzzer also records the operands of the comparisons of
+ * each cost against the highest cost seen so far and the limit, so inputs with costs it
+ * has not seen before are kept and mutated further even when they reach no new code.
+ * MICRO_INI_FUZZ_COST_LIMIT in the environment overrides the limit.
+ *
+ * Building with -DMICRO_INI_FUZZ_MAIN instead of -fsanitize=fuzzer gives a program that
+ * runs the files named on its command line once each and prints their cost, which
+ * replays the corpus as a regression test with any compiler:
+ *
+ *     cc -O2 -DMICRO_INI_FUZZ_MAIN -Isrc fuzz/perf_fuzz.c src/micro_ini.c src/micro_ini_alloc.c src/micro_ini_doc.c src/micro_ini_image.c -o perf_replay
+ *     ./perf_replay fuzz/corpus/(any file)
+ *
+ * The corpus holds the worst cases found so far: deep inheritance chains and keys that
+ * collided in the unseeded key hash of earlier versions, along with long lines, runs
+ * of '=', open quotes, multi-line joins and repeated keys.
+ */
+
+#if defined(__linux__) && !defined(_GNU_SOURCE)
+	/* Expose syscall() for perf_event_open(). */
+	#define _GNU_SOURCE
+#elif !defined(_WIN32) && !defined(_POSIX_C_SOURCE) && !defined(_GNU_SOURCE)
+	/* Expose clock_gettime() even when compiling in strict ANSI mode. */
+	#define _POSIX_C_SOURCE 200112L
+#endif
+
+#include "micro_ini_image.h"
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#if defined(__linux__)
+	#include <linux/perf_event.h>
+	#include <sys/ioctl.h>
+	#include <sys/syscall.h>
+	#include <unistd.h>
+#endif
+
+/* Flags every input is parsed with. */
+#define MICRO_INI_FUZZ_FLAGS (MICRO_INI_FLAG_BOM | MICRO_INI_FLAG_MULTILINE | MICRO_INI_FLAG_INHERITANCE)
+
+/* Bytes added to the size of each input so the fixed cost of a run does not dominate small inputs. */
+#define MICRO_INI_FUZZ_ALLOWANCE 1024
+
+/* Default cost limits per byte, about three times what the corpus needs. */
+#define MICRO_INI_FUZZ_INSTRUCTION_LIMIT 1000
+#define MICRO_INI_FUZZ_NANOSECOND_LIMIT  250
+
+/**
+ * In-memory stream read by micro_ini_resume_stream().
+ */
+typedef struct micro_ini_fuzz_stream
+{
+	const char* pData;
+	size_t size;
+	size_t offset;
+} micro_ini_fuzz_stream;
+
+/**
+ * Lookups made while walking a document.
+ */
+typedef struct micro_ini_fuzz_walk
+{
+	const micro_ini_doc* pDoc;
+	const micro_ini_image* pImage;  /* Image of the document (NULL when it could not be built). */
+	size_t found;
+} micro_ini_fuzz_walk;
+
+static int fuzzCounter = -1;  /* perf_event_open() descriptor counting instructions (-1 before the first run, -2 when unavailable). */
+
+static unsigned long fuzzLimit = 0;    /* Cost limit per byte. */
+static unsigned long fuzzHighest = 0;  /* Highest cost per byte seen so far. */
+
+/**
+ * @brief  Handler that ignores every pair.
+ */
+static void prv_micro_ini_fuzz_ignore(void* pUserData, const char* section, const char* key, const char* value)
+{
+	(void) pUserData;
+	(void) section;
+	(void) key;
+	(void) value;
+}
+
+/**
+ * @brief  Handler that looks every pair up in a document, through its inheritance chain.
+ */
+static void prv_micro_ini_fuzz_lookup(void* pUserData, const char* section, const char* key, const char* value)
+{
+	micro_ini_fuzz_walk* const pWalk = (micro_ini_fuzz_walk*) pUserData;
+
+	(void) value;
+
+	if(micro_ini_doc_get(pWalk->pDoc, section, key))
+	{
+		++pWalk->found;
+	}
+
+	if(pWalk->pImage && key && micro_ini_image_get(pWalk->pImage, section, key))
+	{
+		++pWalk->found;
+	}
+}
+
+/**
+ * @brief   Read the next line of an in-memory stream, like fgets().
+ * @return  The destination string, or NULL at the end of the stream.
+ */
+static char* prv_micro_ini_fuzz_read(char* str, int num, void* pStream)
+{
+	micro_ini_fuzz_stream* const pFuzzStream = (micro_ini_fuzz_stream*) pStream;
+	int length = 0;
+
+	if(num <= 0 || pFuzzStream->offset >= pFuzzStream->size)
+	{
+		return NULL;
+	}
+
+	while(length < num - 1 && pFuzzStream->offset < pFuzzStream->size)
+	{
+		const char c = pFuzzStream->pData[pFuzzStream->offset++];
+
+		str[length++] = c;
+
+		if(c == '\n')
+		{
+			break;
+		}
+	}
+
+	str[length] = '\0';
+	return str;
+}
+
+/**
+ * @brief   Check whether an in-memory stream has been read to the end.
+ * @return  Non-zero at the end of the stream.
+ */
+static int prv_micro_ini_fuzz_eof(void* pStream)
+{
+	const micro_ini_fuzz_stream* const pFuzzStream = (const micro_ini_fuzz_stream*) pStream;
+
+	return pFuzzStream->offset >= pFuzzStream->size;
+}
+
+/**
+ * @brief   Read the processor time used by the process.
+ * @return  Processor time in nanoseconds.
+ */
+static uint64_t prv_micro_ini_fuzz_clock(void)
+{
+#if defined(CLOCK_PROCESS_CPUTIME_ID)
+	struct timespec now;
+
+	if(clock_gettime(CLOCK_PROCESS_CPUTIME_ID, &now) == 0)
+	{
+		return (uint64_t) now.tv_sec * 1000000000u + (uint64_t) now.tv_nsec;
+	}
+#endif
+
+	return (uint64_t) clock() * (1000000000u / CLOCKS_PER_SEC);
+}
+
+/**
+ * @brief   Start measuring the cost of a run.
+ * @return  Processor time in nanoseconds when instructions cannot be counted, 0 otherwise.
+ */
+static uint64_t prv_micro_ini_fuzz_begin(void)
+{
+#if defined(__linux__)
+	if(fuzzCounter == -1)
+	{
+		struct perf_event_attr attr;
+
+		memset(&attr, 0, sizeof(attr));
+		attr.type = PERF_TYPE_HARDWARE;
+		attr.size = sizeof(attr);
+		attr.config = PERF_COUNT_HW_INSTRUCTIONS;
+		attr.disabled = 1;
+		attr.exclude_kernel = 1;
+		attr.exclude_hv = 1;
+
+		fuzzCounter = (int) syscall(SYS_perf_event_open, &attr, 0, -1, -1, 0);
+		if(fuzzCounter < 0)
+		{
+			/* Containers and virtual machines often hide the hardware counters. */
+			fuzzCounter = -2;
+		}
+	}
+
+	if(fuzzCounter >= 0)
+	{
+		ioctl(fuzzCounter, PERF_EVENT_IOC_RESET, 0);
+		ioctl(fuzzCounter, PERF_EVENT_IOC_ENABLE, 0);
+		return 0;
+	}
+#else
+	fuzzCounter = -2;
+#endif
+
+	return prv_micro_ini_fuzz_clock();
+}
+
+/**
+ * @brief   Finish measuring the cost of a run.
+ * @return  Instructions retired, or nanoseconds of processor time, since prv_micro_ini_fuzz_begin().
+ */
+static uint64_t prv_micro_ini_fuzz_end(const uint64_t start)
+{
+#if defined(__linux__)
+	if(fuzzCounter >= 0)
+	{
+		uint64_t count = 0;
+
+		ioctl(fuzzCounter, PERF_EVENT_IOC_DISABLE, 0);
+		if(read(fuzzCounter, &count, sizeof(count)) != (ssize_t) sizeof(count))
+		{
+			count = 0;
+		}
+
+		return count;
+	}
+#endif
+
+	return prv_micro_ini_fuzz_clock() - start;
+}
+
+/**
+ * @brief  Parse and query one input in every way the harness covers.
+ */
+static void prv_micro_ini_fuzz_run(const char* const pData, const size_t size)
+{
+	micro_ini_fuzz_stream stream;
+	micro_ini_fuzz_walk walk;
+	micro_ini_image image;
+	micro_ini_state* pState;
+	micro_ini_doc* pDoc;
+	void* pImageData;
+	size_t imageSize;
+
+	micro_ini_load_buffer(pData, size, MICRO_INI_FUZZ_FLAGS, prv_micro_ini_fuzz_ignore, NULL, NULL);
+
+	/* The state holds two line buffers, too large for some fuzzing stacks. */
+	pState = (micro_ini_state*) malloc(sizeof(micro_ini_state));
+	if(pState)
+	{
+		stream.pData = pData;
+		stream.size = size;
+		stream.offset = 0;
+
+		micro_ini_state_init(pState);
+		micro_ini_resume_stream(
+			pState,
+			&stream,
+			MICRO_INI_FUZZ_FLAGS | MICRO_INI_FLAG_FINGERPRINT,
+			prv_micro_ini_fuzz_ignore,
+			NULL,
+			prv_micro_ini_fuzz_read,
+			prv_micro_ini_fuzz_eof,
+			NULL
+		);
+
+		free(pState);
+	}
+
+	if(micro_ini_doc_load_buffer(&pDoc, pData, size, MICRO_INI_FUZZ_FLAGS, NULL, NULL, NULL) >= 0)
+	{
+		walk.pDoc = pDoc;
+		walk.pImage = NULL;
+		walk.found = 0;
+
+		/* Images are what the CLI caches and the served daemon shares, so build one too. */
+		if(micro_ini_image_build(&pImageData, &imageSize, pDoc, NULL) == MICRO_INI_SUCCESS)
+		{
+			if(micro_ini_image_open(&image, pImageData, imageSize) == MICRO_INI_SUCCESS)
+			{
+				walk.pImage = &image;
+			}
+		}
+		else
+		{
+			pImageData = NULL;
+		}
+
+		micro_ini_load_buffer(pData, size, MICRO_INI_FUZZ_FLAGS, prv_micro_ini_fuzz_lookup, NULL, &walk);
+		free(pImageData);
+		micro_ini_doc_free(pDoc);
+	}
+}
+
+/**
+ * @brief   Measure the cost of one input per byte.
+ * @return  Cost per byte of the input.
+ */
+static unsigned long prv_micro_ini_fuzz_cost(const char* const pData, const size_t size)
+{
+	const uint64_t start = prv_micro_ini_fuzz_begin();
+	uint64_t cost;
+
+	prv_micro_ini_fuzz_run(pData, size);
+	cost = prv_micro_ini_fuzz_end(start);
+
+	if(fuzzLimit == 0)
+	{
+		const char* const limit = getenv("MICRO_INI_FUZZ_COST_LIMIT");
+
+		fuzzLimit = limit ? strtoul(limit, NULL, 10) : 0;
+		if(fuzzLimit == 0)
+		{
+			fuzzLimit = (fuzzCounter >= 0) ? MICRO_INI_FUZZ_INSTRUCTION_LIMIT : MICRO_INI_FUZZ_NANOSECOND_LIMIT;
+		}
+	}
+
+	return (unsigned long) (cost / (size + MICRO_INI_FUZZ_ALLOWANCE));
+}
+
+int LLVMFuzzerTestOneInput(const uint8_t* pData, size_t size);
+
+int LLVMFuzzerTestOneInput(const uint8_t* pData, size_t size)
+{
+	const unsigned long perByte = prv_micro_ini_fuzz_cost((const char*) pData, size);
+
+	if(perByte > fuzzHighest)
+	{
+		fuzzHighest = perByte;
+	}
+
+	if(perByte > fuzzLimit)
+	{
+		fprintf(stderr, "perf_fuzz: %lu %s per byte over %lu bytes exceeds the limit of %lu\n",
+			perByte, (fuzzCounter >= 0) ? "instructions" : "nanoseconds", (unsigned long) size, fuzzLimit);
+		abort();
+	}
+
+	return 0;
+}
+
+#if defined(MICRO_INI_FUZZ_MAIN)
+
+/* Number of times each file is run when replaying. */
+#define MICRO_INI_FUZZ_REPLAYS 5
+
+int main(int argc, char** argv)
+{
+	int failures = 0;
+	int arg;
+
+	for(arg = 1; arg < argc; ++arg)
+	{
+		FILE* const pFile = fopen(argv[arg], "rb");
+		char* pData = NULL;
+		size_t size = 0;
+		long length;
+		unsigned long perByte;
+		int run;
+
+		if(pFile && fseek(pFile, 0, SEEK_END) == 0 && (length = ftell(pFile)) >= 0 && fseek(pFile, 0, SEEK_SET) == 0)
+		{
+			size = (size_t) length;
+			pData = (char*) malloc(size + 1);
+
+			if(pData && fread(pData, 1, size, pFile) != size)
+			{
+				free(pData);
+				pData = NULL;
+			}
+		}
+
+		if(pFile)
+		{
+			fclose(pFile);
+		}
+
+		if(!pData)
+		{
+			fprintf(stderr, "%s: cannot be read\n", argv[arg]);
+			++failures;
+			continue;
+		}
+
+		/* The cheapest of a few runs filters out the noise of the processor time fallback. */
+		perByte = prv_micro_ini_fuzz_cost(pData, size);
+
+		for(run = 1; run < MICRO_INI_FUZZ_REPLAYS; ++run)
+		{
+			const unsigned long again = prv_micro_ini_fuzz_cost(pData, size);
+
+			if(again < perByte)
+			{
+				perByte = again;
+			}
+		}
+
+		printf("%-40s %8lu bytes %8lu %s per byte%s\n", argv[arg], (unsigned long) size, perByte,
+			(fuzzCounter >= 0) ? "instructions" : "nanoseconds", (perByte > fuzzLimit) ? "  OVER LIMIT" : "");
+
+		if(perByte > fuzzLimit)
+		{
+			++failures;
+		}
+
+		free(pData);
+	}
+
+	return failures ? EXIT_FAILURE : EXIT_SUCCESS;
+}
+
+#endif
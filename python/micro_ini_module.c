@@ -0,0 +1,504 @@
+/**
+ * Copyright (c) 2021, Zoe J. Bare
+ *
+ * MIT License
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ */
+
+#define PY_SSIZE_T_CLEAN
+#include <Python.h>
+#include <structmember.h>
+
+#include "micro_ini.h"
+#include "micro_ini_doc.h"
+
+#include <string.h>
+
+/**
+ * First parsing error of a parse that ran without the GIL (internal use only).
+ */
+typedef struct
+{
+	char line[MICRO_INI_MAX_LINE_LENGTH + 1];  /* Text of the line. */
+	int lineno;                                /* Line number (0 when there was no error). */
+} micro_ini_py_error;
+
+/**
+ * Lazy iterator over the key/value pairs of a buffer (internal use only).
+ */
+typedef struct
+{
+	PyObject_HEAD
+
+	Py_buffer view;     /* Buffer being parsed (held until the iterator is exhausted or released). */
+	int hasView;        /* Non-zero while the buffer is held. */
+	int flags;          /* Flags for configuring the parser. */
+	int hasEvent;       /* Set by the handler when it captures a pair. */
+	Py_ssize_t errors;  /* Number of parsing errors encountered so far. */
+
+	micro_ini_state state;
+
+	char section[MICRO_INI_MAX_LINE_LENGTH + 1];
+	char key[MICRO_INI_MAX_LINE_LENGTH + 1];
+	char value[MICRO_INI_MAX_LINE_LENGTH + 1];
+} micro_ini_py_events;
+
+static PyObject* prv_micro_ini_py_parse_error = NULL;
+static PyTypeObject* prv_micro_ini_py_events_type = NULL;
+
+/**
+ * @brief   Decode a string from the parser (internal use only).
+ * @return  New reference to a str object or NULL on failure.
+ *
+ * @param[in]  str  Null terminated string.
+ *
+ * Bytes that are not valid UTF-8 are kept as lone surrogates, so no input is rejected
+ * and the original bytes can be recovered with str.encode("utf-8", "surrogateescape").
+ */
+static PyObject* prv_micro_ini_py_str(const char* const str)
+{
+	return PyUnicode_DecodeUTF8(str, (Py_ssize_t) strlen(str), "surrogateescape");
+}
+
+/**
+ * @brief  Record the first parsing error (internal use only).
+ *
+ * @param[in]  pUserData  Pointer to the micro_ini_py_error receiving the error.
+ * @param[in]  line       Text of the line.
+ * @param[in]  lineno     Line number.
+ */
+static void prv_micro_ini_py_record_error(void* const pUserData, const char* const line, const int lineno)
+{
+	micro_ini_py_error* const pError = (micro_ini_py_error*) pUserData;
+
+	if(pError->lineno == 0)
+	{
+		/* Only the first error is reported; this runs without the GIL, so nothing here may touch Python objects. */
+		strncpy(pError->line, line, MICRO_INI_MAX_LINE_LENGTH);
+		pError->line[MICRO_INI_MAX_LINE_LENGTH] = '\0';
+		pError->lineno = lineno;
+	}
+}
+
+/**
+ * @brief   Raise the Python exception matching a parser error code (internal use only).
+ * @return  Always NULL.
+ *
+ * @param[in]  err  Error code returned by the parser.
+ */
+static PyObject* prv_micro_ini_py_raise(const int err)
+{
+	switch(err)
+	{
+		case MICRO_INI_ERROR_OUT_OF_MEMORY:
+		case MICRO_INI_ERROR_MEMORY_LIMIT:
+			return PyErr_NoMemory();
+
+		case MICRO_INI_ERROR_BUFFER_OVERFLOW:
+			PyErr_SetString(prv_micro_ini_py_parse_error, "line exceeds MICRO_INI_MAX_LINE_LENGTH");
+			return NULL;
+
+		default:
+			PyErr_Format(PyExc_RuntimeError, "parser failed with error code %d", err);
+			return NULL;
+	}
+}
+
+/**
+ * @brief   Raise a ParseError for a recorded parsing error (internal use only).
+ * @return  Always NULL.
+ *
+ * @param[in]  pError  Recorded error.
+ */
+static PyObject* prv_micro_ini_py_raise_parse_error(const micro_ini_py_error* const pError)
+{
+	PyObject* const line = prv_micro_ini_py_str(pError->line);
+	PyObject* exception = NULL;
+
+	if(!line)
+	{
+		return NULL;
+	}
+
+	exception = PyObject_CallFunction(prv_micro_ini_py_parse_error, "siO", "invalid line", pError->lineno, line);
+	Py_DECREF(line);
+
+	if(exception)
+	{
+		PyErr_SetObject(prv_micro_ini_py_parse_error, exception);
+		Py_DECREF(exception);
+	}
+
+	return NULL;
+}
+
+/**
+ * @brief   Convert a document to a dict of dicts (internal use only).
+ * @return  New reference to the dict or NULL on failure.
+ *
+ * @param[in]  pDoc  Document to convert.
+ */
+static PyObject* prv_micro_ini_py_doc_to_dict(const micro_ini_doc* const pDoc)
+{
+	PyObject* const result = PyDict_New();
+	const size_t sectionCount = micro_ini_doc_section_count(pDoc);
+	size_t sectionIndex = 0;
+
+	if(!result)
+	{
+		return NULL;
+	}
+
+	for(; sectionIndex < sectionCount; ++sectionIndex)
+	{
+		PyObject* const name = prv_micro_ini_py_str(micro_ini_doc_section_name(pDoc, sectionIndex));
+		PyObject* const pairs = PyDict_New();
+		size_t owner = sectionIndex;
+
+		if(!name || !pairs || PyDict_SetItem(result, name, pairs) < 0)
+		{
+			Py_XDECREF(name);
+			Py_XDECREF(pairs);
+			Py_DECREF(result);
+			return NULL;
+		}
+
+		Py_DECREF(name);
+		Py_DECREF(pairs);
+
+		/* Inherited sections are flattened, with the nearest section's value taking precedence. */
+		for(; owner != MICRO_INI_DOC_NPOS; owner = micro_ini_doc_section_parent(pDoc, owner))
+		{
+			const size_t keyCount = micro_ini_doc_key_count(pDoc, owner);
+			size_t keyIndex = 0;
+
+			for(; keyIndex < keyCount; ++keyIndex)
+			{
+				PyObject* const key = prv_micro_ini_py_str(micro_ini_doc_key(pDoc, owner, keyIndex));
+				PyObject* const value = prv_micro_ini_py_str(micro_ini_doc_value(pDoc, owner, keyIndex));
+
+				if(!key || !value || !PyDict_SetDefault(pairs, key, value))
+				{
+					Py_XDECREF(key);
+					Py_XDECREF(value);
+					Py_DECREF(result);
+					return NULL;
+				}
+
+				Py_DECREF(key);
+				Py_DECREF(value);
+			}
+		}
+	}
+
+	return result;
+}
+
+PyDoc_STRVAR(prv_micro_ini_py_parse_doc,
+"parse(data, flags=0, strict=False)\n"
+"--\n"
+"\n"
+"Parse an ini file held in a bytes-like object (bytes, bytearray, memoryview,\n"
+"mmap, ...) and return a dict mapping section names to dicts of key/value\n"
+"strings.  Keys outside of any section are under the \"\" section.\n"
+"\n"
+"The buffer is parsed in place and the GIL is released while parsing.  Lines\n"
+"that can't be parsed are skipped, unless strict is true, in which case the\n"
+"first one raises ParseError.");
+
+static PyObject* prv_micro_ini_py_parse(PyObject* const self, PyObject* const args, PyObject* const kwargs)
+{
+	static char* keywords[] = { "data", "flags", "strict", NULL };
+
+	micro_ini_py_error error;
+	micro_ini_doc* pDoc = NULL;
+	PyObject* result = NULL;
+	Py_buffer view;
+
+	int flags = 0;
+	int strict = 0;
+	int err = MICRO_INI_SUCCESS;
+
+	(void) self;
+
+	if(!PyArg_ParseTupleAndKeywords(args, kwargs, "y*|ip:parse", keywords, &view, &flags, &strict))
+	{
+		return NULL;
+	}
+
+	error.line[0] = '\0';
+	error.lineno = 0;
+
+	/* The exporter can't resize or free the buffer while the view is held, so it is safe to parse without the GIL. */
+	Py_BEGIN_ALLOW_THREADS
+	err = micro_ini_doc_load_buffer(&pDoc, (const char*) view.buf, (size_t) view.len, flags, NULL, prv_micro_ini_py_record_error, &error);
+	Py_END_ALLOW_THREADS
+
+	PyBuffer_Release(&view);
+
+	if(err < 0)
+	{
+		return prv_micro_ini_py_raise(err);
+	}
+
+	if(strict && error.lineno > 0)
+	{
+		result = prv_micro_ini_py_raise_parse_error(&error);
+	}
+	else
+	{
+		result = prv_micro_ini_py_doc_to_dict(pDoc);
+	}
+
+	micro_ini_doc_free(pDoc);
+
+	return result;
+}
+
+/**
+ * @brief  Capture a pair and stop the parser so it can be returned (internal use only).
+ */
+static void prv_micro_ini_py_events_handler(void* const pUserData, const char* const section, const char* const key, const char* const value)
+{
+	micro_ini_py_events* const pEvents = (micro_ini_py_events*) pUserData;
+
+	if(!key)
+	{
+		/* Parent links from FLAG_INHERITANCE aren't pairs. */
+		return;
+	}
+
+	strcpy(pEvents->section, section);
+	strcpy(pEvents->key, key);
+	strcpy(pEvents->value, value);
+
+	pEvents->hasEvent = 1;
+	micro_ini_state_stop(&pEvents->state);
+}
+
+/**
+ * @brief  Count a parsing error (internal use only).
+ */
+static void prv_micro_ini_py_events_error(void* const pUserData, const char* const line, const int lineno)
+{
+	micro_ini_py_events* const pEvents = (micro_ini_py_events*) pUserData;
+
+	(void) line;
+	(void) lineno;
+
+	++pEvents->errors;
+}
+
+/**
+ * @brief  Let go of the buffer being parsed (internal use only).
+ */
+static void prv_micro_ini_py_events_release(micro_ini_py_events* const pEvents)
+{
+	if(pEvents->hasView)
+	{
+		PyBuffer_Release(&pEvents->view);
+		pEvents->hasView = 0;
+	}
+}
+
+static void prv_micro_ini_py_events_dealloc(PyObject* const self)
+{
+	PyTypeObject* const pType = Py_TYPE(self);
+
+	prv_micro_ini_py_events_release((micro_ini_py_events*) self);
+	PyObject_Free(self);
+
+	/* Instances of heap types own a reference to their type. */
+	Py_DECREF(pType);
+}
+
+static PyObject* prv_micro_ini_py_events_next(PyObject* const self)
+{
+	micro_ini_py_events* const pEvents = (micro_ini_py_events*) self;
+	int err = MICRO_INI_SUCCESS;
+
+	if(!pEvents->hasView)
+	{
+		/* Already exhausted. */
+		return NULL;
+	}
+
+	pEvents->hasEvent = 0;
+
+	/* Each call parses up to and including the next pair, then the state stops the parser there. */
+	err = micro_ini_resume_buffer(
+		&pEvents->state,
+		(const char*) pEvents->view.buf,
+		(size_t) pEvents->view.len,
+		pEvents->flags,
+		prv_micro_ini_py_events_handler,
+		prv_micro_ini_py_events_error,
+		pEvents
+	);
+
+	if(err < 0)
+	{
+		prv_micro_ini_py_events_release(pEvents);
+		return prv_micro_ini_py_raise(err);
+	}
+
+	if(!pEvents->hasEvent)
+	{
+		/* End of the buffer, or stopped at the first error. */
+		prv_micro_ini_py_events_release(pEvents);
+		return NULL;
+	}
+
+	return Py_BuildValue(
+		"(NNN)",
+		prv_micro_ini_py_str(pEvents->section),
+		prv_micro_ini_py_str(pEvents->key),
+		prv_micro_ini_py_str(pEvents->value)
+	);
+}
+
+static PyMemberDef prv_micro_ini_py_events_members[] =
+{
+	{ "errors", T_PYSSIZET, offsetof(micro_ini_py_events, errors), READONLY, "Number of lines that could not be parsed so far." },
+	{ NULL, 0, 0, 0, NULL }
+};
+
+static PyType_Slot prv_micro_ini_py_events_slots[] =
+{
+	{ Py_tp_doc, (void*) "Iterator of (section, key, value) tuples returned by iterparse()." },
+	{ Py_tp_dealloc, (void*) prv_micro_ini_py_events_dealloc },
+	{ Py_tp_iter, (void*) PyObject_SelfIter },
+	{ Py_tp_iternext, (void*) prv_micro_ini_py_events_next },
+	{ Py_tp_members, (void*) prv_micro_ini_py_events_members },
+	{ 0, NULL }
+};
+
+static PyType_Spec prv_micro_ini_py_events_spec =
+{
+	"microini.EventIterator",
+	(int) sizeof(micro_ini_py_events),
+	0,
+	Py_TPFLAGS_DEFAULT,
+	prv_micro_ini_py_events_slots
+};
+
+PyDoc_STRVAR(prv_micro_ini_py_iterparse_doc,
+"iterparse(data, flags=0)\n"
+"--\n"
+"\n"
+"Return an iterator of (section, key, value) tuples from an ini file held in a\n"
+"bytes-like object.  The buffer is parsed in place, one pair at a time as the\n"
+"iterator advances, and is held until the iterator is exhausted.  The number\n"
+"of lines that couldn't be parsed so far is in the iterator's errors attribute.");
+
+static PyObject* prv_micro_ini_py_iterparse(PyObject* const self, PyObject* const args, PyObject* const kwargs)
+{
+	static char* keywords[] = { "data", "flags", NULL };
+
+	micro_ini_py_events* pEvents = NULL;
+	int flags = 0;
+
+	(void) self;
+
+	pEvents = PyObject_New(micro_ini_py_events, prv_micro_ini_py_events_type);
+	if(!pEvents)
+	{
+		return NULL;
+	}
+
+	pEvents->hasView = 0;
+
+	if(!PyArg_ParseTupleAndKeywords(args, kwargs, "y*|i:iterparse", keywords, &pEvents->view, &flags))
+	{
+		Py_DECREF(pEvents);
+		return NULL;
+	}
+
+	pEvents->hasView = 1;
+	pEvents->flags = flags;
+	pEvents->hasEvent = 0;
+	pEvents->errors = 0;
+
+	micro_ini_state_init(&pEvents->state);
+
+	return (PyObject*) pEvents;
+}
+
+static PyMethodDef prv_micro_ini_py_methods[] =
+{
+	{ "parse", (PyCFunction)(void(*)(void)) prv_micro_ini_py_parse, METH_VARARGS | METH_KEYWORDS, prv_micro_ini_py_parse_doc },
+	{ "iterparse", (PyCFunction)(void(*)(void)) prv_micro_ini_py_iterparse, METH_VARARGS | METH_KEYWORDS, prv_micro_ini_py_iterparse_doc },
+	{ NULL, NULL, 0, NULL }
+};
+
+static struct PyModuleDef prv_micro_ini_py_module =
+{
+	PyModuleDef_HEAD_INIT,
+	"microini",
+	"Python bindings for the MicroIni parser.",
+	-1,
+	prv_micro_ini_py_methods,
+	NULL,
+	NULL,
+	NULL,
+	NULL
+};
+
+PyMODINIT_FUNC PyInit_microini(void)
+{
+	PyObject* module = NULL;
+
+	prv_micro_ini_py_events_type = (PyTypeObject*) PyType_FromSpec(&prv_micro_ini_py_events_spec);
+	if(!prv_micro_ini_py_events_type)
+	{
+		return NULL;
+	}
+
+	module = PyModule_Create(&prv_micro_ini_py_module);
+	if(!module)
+	{
+		return NULL;
+	}
+
+	prv_micro_ini_py_parse_error = PyErr_NewExceptionWithDoc(
+		"microini.ParseError",
+		"Raised for lines that can't be parsed; args are (message, lineno, line).",
+		PyExc_ValueError,
+		NULL
+	);
+
+	if(!prv_micro_ini_py_parse_error ||
+		PyModule_AddObject(module, "ParseError", prv_micro_ini_py_parse_error) < 0 ||
+		PyModule_AddIntConstant(module, "FLAG_BOM", MICRO_INI_FLAG_BOM) < 0 ||
+		PyModule_AddIntConstant(module, "FLAG_MULTILINE", MICRO_INI_FLAG_MULTILINE) < 0 ||
+		PyModule_AddIntConstant(module, "FLAG_STOP_ON_FIRST_ERROR", MICRO_INI_FLAG_STOP_ON_FIRST_ERROR) < 0 ||
+		PyModule_AddIntConstant(module, "FLAG_INHERITANCE", MICRO_INI_FLAG_INHERITANCE) < 0 ||
+		PyModule_AddStringConstant(module, "__version__", MICRO_INI_VERSION_STR) < 0)
+	{
+		Py_XDECREF(prv_micro_ini_py_parse_error);
+		Py_DECREF(module);
+		return NULL;
+	}
+
+	/* PyModule_AddObject() stole a reference, so keep one for raising the exception. */
+	Py_INCREF(prv_micro_ini_py_parse_error);
+
+	return module;
+}
@@ -0,0 +1,69 @@
+# Copyright (c) 2021, Zoe J. Bare
+#
+# MIT License
+#
+# Permission is hereby granted, free of charge, to any person obtaining a
+# copy of this software and associated documentation files (the "Software"),
+# to deal in the Software without restriction, including without limitation
+# the rights to use, copy, modify, merge, publish, distribute, sublicense,
+# and/or sell copies of the Software, and to permit persons to whom the
+# Software is furnished to do so, subject to the following conditions:
+#
+# The above copyright notice and this permission notice shall be included in
+# all copies or substantial portions of the Software.
+#
+# THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+# IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+# FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+# AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+# LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+# FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+# DEALINGS IN THE SOFTWARE.
+
+"""Build script for the microini extension module.
+
+Build in place and run the tests and benchmarks from this directory with:
+
+    python setup.py build_ext --inplace
+    python -m pytest test_bench.py
+
+or install the module with "pip install ." from this directory.  The module is
+compiled along with the core parser, the allocator and the document module
+from ../src.
+"""
+
+import os
+import re
+
+from setuptools import Extension, setup
+
+SOURCE_DIR = os.path.join("..", "src")
+
+
+def read_version():
+    """Read the version from micro_ini.h so the two never disagree."""
+    with open(os.path.join(SOURCE_DIR, "micro_ini.h")) as header:
+        text = header.read()
+
+    parts = [re.search(r"#define MICRO_INI_VERSION_%s\s+(\d+)" % part, text).group(1) for part in ("MAJOR", "MINOR", "HOTFIX")]
+    return ".".join(parts)
+
+
+setup(
+    name="microini",
+    version=read_version(),
+    description="Zero-copy Python bindings for the MicroIni parser",
+    license="MIT",
+    ext_modules=[
+        Extension(
+            "microini",
+            sources=[
+                "micro_ini_module.c",
+                os.path.join(SOURCE_DIR, "micro_ini.c"),
+                os.path.join(SOURCE_DIR, "micro_ini_alloc.c"),
+                os.path.join(SOURCE_DIR, "micro_ini_doc.c"),
+            ],
+            include_dirs=[SOURCE_DIR],
+        )
+    ],
+)
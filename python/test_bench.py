@@ -0,0 +1,115 @@
+# Copyright (c) 2021, Zoe J. Bare
+#
+# MIT License
+#
+# Permission is hereby granted, free of charge, to any person obtaining a
+# copy of this software and associated documentation files (the "Software"),
+# to deal in the Software without restriction, including without limitation
+# the rights to use, copy, modify, merge, publish, distribute, sublicense,
+# and/or sell copies of the Software, and to permit persons to whom the
+# Software is furnished to do so, subject to the following conditions:
+#
+# The above copyright notice and this permission notice shall be included in
+# all copies or substantial portions of the Software.
+#
+# THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+# IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+# FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+# AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+# LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+# FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+# DEALINGS IN THE SOFTWARE.
+
+"""Parse-equality checks and benchmarks of microini against configparser.
+
+Build the module in place first, then run from this directory:
+
+    python setup.py build_ext --inplace
+    python -m pytest test_bench.py
+
+The benchmarks need pytest-benchmark and are skipped without it.  Both parsers
+are timed on the same generated document, with configparser set up so its
+grammar matches MicroIni's: case-sensitive keys, no interpolation and only
+whole-line comments.
+"""
+
+import configparser
+import random
+
+import pytest
+
+import microini
+
+try:
+    import pytest_benchmark
+except ImportError:
+    pytest_benchmark = None
+
+needs_benchmark = pytest.mark.skipif(pytest_benchmark is None, reason="pytest-benchmark is not installed")
+
+
+def make_document(sections, keysPerSection=8, seed=12345):
+    """Generate a routing-table style document both parsers read the same way."""
+    rng = random.Random(seed)
+    lines = ["; generated routing table", ""]
+    for index in range(sections):
+        lines.append("[route.%d]" % index)
+        lines.append("host = 10.%d.%d.%d" % (index >> 16 & 255, index >> 8 & 255, index & 255))
+        lines.append("port = %d" % rng.randint(1024, 65535))
+        lines.append("metric = %d" % rng.randint(0, 1000))
+        lines.append("weight = %d.%02d" % (rng.randint(0, 9), rng.randint(0, 99)))
+        lines.append("Enabled = %s" % rng.choice(("true", "false")))
+        lines.append("path = /srv/route/%d/index.html" % index)
+        lines.append("query = a=%d&b=%d" % (rng.randint(0, 99), rng.randint(0, 99)))
+        for extra in range(keysPerSection - 7):
+            lines.append("extra%d = value %d" % (extra, rng.randint(0, 1 << 30)))
+        lines.append("# end of route %d" % index)
+        lines.append("")
+    return "\n".join(lines)
+
+
+def configparser_parse(text):
+    parser = configparser.ConfigParser(interpolation=None, delimiters=("=",), comment_prefixes=(";", "#"), inline_comment_prefixes=None, strict=True, empty_lines_in_values=False, default_section="\0")
+    parser.optionxform = str
+    parser.read_string(text)
+    return {section: dict(parser.items(section)) for section in parser.sections()}
+
+
+SMALL = make_document(50)
+LARGE = make_document(2000)
+
+
+def test_parse_matches_configparser():
+    assert microini.parse(SMALL.encode()) == configparser_parse(SMALL)
+
+
+def test_iterparse_matches_configparser():
+    expected = [(section, key, value) for section, pairs in configparser_parse(SMALL).items() for key, value in pairs.items()]
+    assert list(microini.iterparse(SMALL.encode())) == expected
+
+
+@pytest.mark.parametrize("text", [
+    "[a]\nk = v\n",
+    "[a]\nk=\n",
+    "[a]\n  spaced key  =  spaced value  \n",
+    "[a]\nurl = http://host/?x=1&y=2\n",
+    "[a]\nMixed = Case\nmixed = case\n",
+    "[a]\nk = 1\n\n; comment\n# comment\n[b]\nk = 2\n",
+])
+def test_edge_cases_match_configparser(text):
+    assert microini.parse(text.encode()) == configparser_parse(text)
+
+
+@needs_benchmark
+def test_bench_microini(benchmark):
+    benchmark.group = "parse %d bytes" % len(LARGE)
+    data = LARGE.encode()
+    result = benchmark(microini.parse, data)
+    assert len(result) == 2000
+
+
+@needs_benchmark
+def test_bench_configparser(benchmark):
+    benchmark.group = "parse %d bytes" % len(LARGE)
+    result = benchmark(configparser_parse, LARGE)
+    assert len(result) == 2000
@@ -22,15 +22,102 @@
  * DEALINGS IN THE SOFTWARE.
  */
 
+#if !defined(_WIN32) && !defined(_POSIX_C_SOURCE) && !defined(_GNU_SOURCE)
+	/* Expose the POSIX I/O functions even when compiling in strict ANSI mode. */
+	#define _POSIX_C_SOURCE 200112L
+#endif
+
 #include "micro_ini.h"
 
 #include <ctype.h>
+#include <limits.h>
 #include <string.h>
 
+#if defined(MICRO_INI_VERIFY_PARSER)
+	#include <stdlib.h>
+#endif
+
+#if defined(_WIN32)
+	#include <io.h>
+	#define MICRO_INI_FD_SUPPORTED
+#elif defined(__unix__) || defined(__APPLE__)
+	#include <errno.h>
+	#include <fcntl.h>
+	#include <sys/stat.h>
+	#include <unistd.h>
+	#define MICRO_INI_FD_SUPPORTED
+#endif
+
+#if defined(_MSC_VER)
+	/* Lock a FILE object once for the whole parse and read it without taking the lock per character. */
+	#define MICRO_INI_LOCK_FILE(pFile)   _lock_file(pFile)
+	#define MICRO_INI_UNLOCK_FILE(pFile) _unlock_file(pFile)
+	#define MICRO_INI_GETC(pFile)        _getc_nolock(pFile)
+#elif defined(_POSIX_THREAD_SAFE_FUNCTIONS) && _POSIX_THREAD_SAFE_FUNCTIONS > 0
+	#define MICRO_INI_LOCK_FILE(pFile)   flockfile(pFile)
+	#define MICRO_INI_UNLOCK_FILE(pFile) funlockfile(pFile)
+	#define MICRO_INI_GETC(pFile)        getc_unlocked(pFile)
+#else
+	#define MICRO_INI_LOCK_FILE(pFile)
+	#define MICRO_INI_UNLOCK_FILE(pFile)
+	#define MICRO_INI_GETC(pFile)        getc(pFile)
+#endif
+
+#if defined(MICRO_INI_ENABLE_PROFILING)
+	#if defined(_WIN32)
+		#include <windows.h>
+	#else
+		#include <time.h>
+	#endif
+
+	/* The active profile is tracked per thread where the compiler allows it. */
+	#if defined(_MSC_VER)
+		#define MICRO_INI_THREAD_LOCAL __declspec(thread)
+	#elif defined(__GNUC__) || defined(__clang__)
+		#define MICRO_INI_THREAD_LOCAL __thread
+	#else
+		#define MICRO_INI_THREAD_LOCAL
+	#endif
+
+	#define MICRO_INI_CALL_HANDLER(handler, pUserData, section, key, value, lineno) \
+		prv_micro_ini_profile_call((handler), (pUserData), (section), (key), (value), (lineno))
+#else
+	#define MICRO_INI_CALL_HANDLER(handler, pUserData, section, key, value, lineno) \
+		(handler)((pUserData), (section), (key), (value))
+#endif
+
+#if defined(MICRO_INI_ENABLE_METRICS)
+	#include "micro_ini_metrics.h"
+
+	/* Loads are timed and recorded into the attached metrics once they return. */
+	#define MICRO_INI_METRICS_CLOCK()                       micro_ini_metrics_clock()
+	#define MICRO_INI_METRICS_OBSERVE(start, bytes, result) micro_ini_metrics_observe((start), (bytes), (result))
+#else
+	#define MICRO_INI_METRICS_CLOCK()                       0
+	#define MICRO_INI_METRICS_OBSERVE(start, bytes, result) ((void) (start), (result))
+#endif
+
+/**
+ * Block reader over a file descriptor or an in-memory buffer (internal use only).
+ */
+typedef struct
+{
+	const char* pData;  /* Data currently buffered. */
+	char* pBlock;       /* Block buffer refilled from the descriptor (NULL when reading from memory). */
+	size_t size;        /* Capacity of the block buffer. */
+	size_t pos;         /* Offset of the next unread byte in the buffered data. */
+	size_t end;         /* Number of valid bytes in the buffered data. */
+	int fd;             /* Descriptor being read. */
+	int eof;            /* Set once the end of the data has been reached. */
+	int error;          /* Set if a read failed. */
+} micro_ini_block_reader;
+
+#if defined(MICRO_INI_ENABLE_PROFILING)
 /**
- * Maximum length of a single line in the ini file.
+ * Profile receiving the handler timings of the calling thread, or NULL when not profiling.
  */
-#define MICRO_INI_MAX_LINE_LENGTH 512
+static MICRO_INI_THREAD_LOCAL micro_ini_profile* prv_micro_ini_active_profile = NULL;
+#endif
 
 /**
  * This enum stores the status for each parsed line (internal use only).
@@ -42,7 +129,8 @@ enum LineStatus
     LINE_ERROR,
     LINE_COMMENT,
     LINE_SECTION,
-    LINE_VALUE
+    LINE_VALUE,
+	LINE_PARENT
 };
 
 /**
@@ -101,10 +189,169 @@ static void prv_micro_ini_strstrip(char* const line)
 	}
 }
 
+/**
+ * @brief   Split a "child : parent" section name (internal use only).
+ * @return  LINE_SECTION when there is no parent, LINE_PARENT when one was split off, or LINE_ERROR when either name is empty.
+ *
+ * @param[in]  section  Section name, which is left holding only the child's name.
+ * @param[out] parent   Receives the parent's name.
+ */
+static int prv_micro_ini_split_parent(char* const section, char* const parent)
+{
+	char* const colon = strchr(section, ':');
+
+	if(!colon)
+	{
+		return LINE_SECTION;
+	}
+
+	strcpy(parent, colon + 1);
+	(*colon) = '\0';
+
+	prv_micro_ini_strstrip(section);
+	prv_micro_ini_strstrip(parent);
+
+	return (section[0] != '\0' && parent[0] != '\0') ? LINE_PARENT : LINE_ERROR;
+}
+
+/**
+ * @brief  Copy a range of characters with the surrounding whitespace removed (internal use only).
+ *
+ * @param[out] pOut   Output string.
+ * @param[in]  begin  First character of the range.
+ * @param[in]  end    Character just past the range.
+ */
+static void prv_micro_ini_copy_stripped(char* const pOut, const char* begin, const char* end)
+{
+	while(begin < end && isspace((unsigned char) *begin))
+	{
+		++begin;
+	}
+
+	while(begin < end && isspace((unsigned char) *(end - 1)))
+	{
+		--end;
+	}
+
+	memcpy(pOut, begin, (size_t) (end - begin));
+	pOut[end - begin] = '\0';
+}
+
 /**
  * @brief   Parse a line read from the ini file (internal use only).
  * @return  Type of the line that was parsed.
  *
+ * @param[in]  line     Line read from the ini file, with no whitespace at either end.
+ * @param[in]  len      Length of the input line.
+ * @param[out] section  Output string for the section.
+ * @param[out] key      Output string for the key.
+ * @param[out] value    Output string for the value.
+ *
+ * The return value will be one of the possible values in the LineStatus enum.
+ * This value will determine which of the output strings was written to.
+ *
+ * The line is scanned once, accepting exactly what the cascade of sscanf() patterns
+ * in prv_micro_ini_parse_line_reference() accepts:
+ *
+ *   "[name]"         A section; "[]" leaves the current section unchanged.
+ *   key = "value"    The value ends at the next matching quote (or the end of the
+ *   key = 'value'    line), unless the quotes are empty, in which case the value
+ *                    is parsed as if it were unquoted.
+ *   key = value      The value ends at the first ';' or '#'.
+ *   key =            Anything else after the equal sign gives an empty value.
+ *
+ * Keys and values are stripped of surrounding whitespace, and a line whose first
+ * character is an equal sign, or that has none, is a syntax error.
+ */
+static int prv_micro_ini_parse_line(
+	const char* const line,
+	const size_t len,
+	char* const section,
+	char* const key,
+	char* const value
+)
+{
+	const char* equals;
+	const char* p;
+	const char* end;
+	char quote;
+
+	if(len == 0)
+	{
+		/* Empty line. */
+		return LINE_EMPTY;
+	}
+	else if(line[0] == '#' || line[0] == ';')
+	{
+		/* Comment line. */
+		return LINE_COMMENT;
+	}
+	else if(line[0] == '[' && line[len - 1] == ']')
+	{
+		/* Section name, which ends at the first closing bracket. */
+		if(line[1] != ']')
+		{
+			end = (const char*) memchr(line + 1, ']', len - 1);
+			prv_micro_ini_copy_stripped(section, line + 1, end);
+		}
+
+		return LINE_SECTION;
+	}
+
+	equals = (const char*) memchr(line, '=', len);
+	if(!equals || equals == line)
+	{
+		/* Generate syntax error */
+		return LINE_ERROR;
+	}
+
+	prv_micro_ini_copy_stripped(key, line, equals);
+
+	for(p = equals + 1; isspace((unsigned char) *p); ++p)
+	{
+		/* Skip the whitespace in front of the value. */
+	}
+
+	if((p[0] == '"' || p[0] == '\'') && p[1] != p[0] && p[1] != '\0')
+	{
+		/* Quoted value, keeping what lies between the quotes. */
+		quote = *(p++);
+
+		for(end = p; *end != '\0' && *end != quote; ++end)
+		{
+		}
+
+		prv_micro_ini_copy_stripped(value, p, end);
+
+		if(!strcmp(value, "\"\"") || !strcmp(value, "''"))
+		{
+			value[0] = '\0';
+		}
+	}
+	else if(p[0] != '\0' && p[0] != ';' && p[0] != '#')
+	{
+		/* Unquoted value, with or without a comment. */
+		prv_micro_ini_copy_stripped(value, p, p + strcspn(p, ";#"));
+	}
+	else
+	{
+		/*
+		 * Special cases:
+		 * key=
+		 * key=;
+		 * key=#
+		 */
+		value[0] = '\0';
+	}
+
+	return LINE_VALUE;
+}
+
+#if defined(MICRO_INI_VERIFY_PARSER)
+/**
+ * @brief   Parse a line read from the ini file with sscanf() (reference parser, internal use only).
+ * @return  Type of the line that was parsed.
+ *
  * @param[in]  line     Line read from the ini file.
  * @param[in]  len      Length of the input line.
  * @param[in]  section  Output string for the section.
@@ -113,8 +360,11 @@ static void prv_micro_ini_strstrip(char* const line)
  *
  * The return value will be one of the possible values in the LineStatus enum.
  * This value will determine which of the output strings was written to.
+ *
+ * This is the original grammar of the parser.  It is only compiled with
+ * MICRO_INI_VERIFY_PARSER, which checks prv_micro_ini_parse_line() against it.
  */
-static int prv_micro_ini_parse_line(
+static int prv_micro_ini_parse_line_reference(
     const char* const line,
 	const size_t len,
     char* const section,
@@ -190,162 +440,1628 @@ static int prv_micro_ini_parse_line(
     return ret;
 }
 
-
-int micro_ini_load(
-	const char* const filePath,
-	const int flags,
-	const micro_ini_handler_fn handlerCallback,
-	const micro_ini_error_fn errorCallback,
-	void* const pUserData
+/**
+ * @brief   Parse a line with both parsers and abort if they disagree (internal use only).
+ * @return  Type of the line that was parsed.
+ *
+ * Every output that can be observed through the callbacks is compared: the type of
+ * the line, the section (including a section left unchanged by "[]"), and the key
+ * and value of a pair.
+ */
+static int prv_micro_ini_parse_line_verified(
+	const char* const line,
+	const size_t len,
+	char* const section,
+	char* const key,
+	char* const value
 )
 {
-	FILE* pFile = NULL;
-	int err = MICRO_INI_SUCCESS;
+	char refSection[MICRO_INI_MAX_LINE_LENGTH + 1];
+	char refKey[MICRO_INI_MAX_LINE_LENGTH + 1];
+	char refValue[MICRO_INI_MAX_LINE_LENGTH + 1];
+	char copy[MICRO_INI_MAX_LINE_LENGTH + 1];
 
-	if(!handlerCallback)
-	{
-		/* Invalid handler callback. */
-		return MICRO_INI_ERROR_INVALID_HANDLER_CALLBACK;
-	}
+	int status;
+	int refStatus;
 
-	pFile = fopen(filePath, "r");
-	if(!pFile)
+	strcpy(refSection, section);
+	memcpy(copy, line, len);
+	copy[len] = '\0';
+
+	status = prv_micro_ini_parse_line(line, len, section, key, value);
+	refStatus = prv_micro_ini_parse_line_reference(copy, len, refSection, refKey, refValue);
+
+	if(status != refStatus ||
+		strcmp(section, refSection) != 0 ||
+		(status == LINE_VALUE && (strcmp(key, refKey) != 0 || strcmp(value, refValue) != 0))
+	)
 	{
-		/* Could not open file. */
-		return MICRO_INI_ERROR_INVALID_FILE_OBJECT;
+		fprintf(stderr, "micro_ini: parser mismatch on line \"%s\": status %d/%d, section \"%s\"/\"%s\", key \"%s\"/\"%s\", value \"%s\"/\"%s\"\n",
+			copy, status, refStatus, section, refSection, key, refKey, value, refValue);
+		abort();
 	}
 
-	err = micro_ini_load_file(pFile, flags, handlerCallback, errorCallback, pUserData);
-	fclose(pFile);
-
-	return err;
+	return status;
 }
 
+	#define MICRO_INI_PARSE_LINE(line, len, section, key, value) prv_micro_ini_parse_line_verified((line), (len), (section), (key), (value))
+#else
+	#define MICRO_INI_PARSE_LINE(line, len, section, key, value) prv_micro_ini_parse_line((line), (len), (section), (key), (value))
+#endif
 
-int micro_ini_load_file(
-	FILE* const pFile,
-	const int flags,
-	const micro_ini_handler_fn handlerCallback,
-	const micro_ini_error_fn errorCallback,
-	void* const pUserData
-)
+
+/**
+ * @brief   Strip the whitespace from both ends of a list of segments (internal use only).
+ * @return  Number of segments left.
+ *
+ * @param[in]  pSegments  Segments to strip (updated in place).
+ * @param[in]  count      Number of segments.
+ *
+ * Segments left empty are removed from the list.
+ */
+static size_t prv_micro_ini_strip_segments(micro_ini_segment* const pSegments, size_t count)
 {
-	if(!pFile)
-	{
-		/* Invalid file object. */
-		return MICRO_INI_ERROR_INVALID_FILE_OBJECT;
-	}
-	else if(!handlerCallback)
+	size_t first = 0;
+	size_t index = 0;
+
+	while(first < count)
 	{
-		/* Invalid handler callback. */
-		return MICRO_INI_ERROR_INVALID_HANDLER_CALLBACK;
-	}
+		micro_ini_segment* const pFirst = &pSegments[first];
 
-	return micro_ini_load_stream(pFile, flags, handlerCallback, errorCallback, (micro_ini_reader_fn) fgets, (micro_ini_eof_fn) feof, pUserData);
-}
+		while(pFirst->length > 0 && isspace((unsigned char) pFirst->data[0]))
+		{
+			/* Skip whitespace at the beginning of the value. */
+			++pFirst->data;
+			--pFirst->length;
+		}
 
+		if(pFirst->length > 0)
+		{
+			break;
+		}
 
-int micro_ini_load_stream(
-	void* const pStream,
-	const int flags,
-	const micro_ini_handler_fn handlerCallback,
-	const micro_ini_error_fn errorCallback,
-	const micro_ini_reader_fn readerCallback,
-	const micro_ini_eof_fn eofCallback,
-	void* const pUserData
-)
-{
-	char line    [MICRO_INI_MAX_LINE_LENGTH + 1];
-	char section [MICRO_INI_MAX_LINE_LENGTH + 1];
-	char key     [MICRO_INI_MAX_LINE_LENGTH + 1];
-	char val     [MICRO_INI_MAX_LINE_LENGTH + 1];
+		++first;
+	}
 
-	char* start = NULL;
+	while(count > first)
+	{
+		micro_ini_segment* const pLast = &pSegments[count - 1];
 
-	int last      = 0;
-	int len       = 0;
-	int lineno    = 0;
-	int firstLine = 1;
-	int numErrors = 0;
+		while(pLast->length > 0 && isspace((unsigned char) pLast->data[pLast->length - 1]))
+		{
+			/* Ignore whitespace at the end of the value. */
+			--pLast->length;
+		}
 
-	if(!pStream)
-	{
-		/* Invalid stream object. */
-		return MICRO_INI_ERROR_INVALID_STREAM_OBJECT;
+		if(pLast->length > 0)
+		{
+			break;
+		}
+
+		--count;
 	}
-	else if(!handlerCallback)
+
+	for(; first < count; ++first)
 	{
-		/* Invalid handler callback. */
-		return MICRO_INI_ERROR_INVALID_HANDLER_CALLBACK;
+		if(pSegments[first].length > 0)
+		{
+			/* Shift the non-empty segments to the beginning of the list. */
+			pSegments[index] = pSegments[first];
+			++index;
+		}
 	}
-	else if(!readerCallback)
+
+	return index;
+}
+
+/**
+ * @brief   Find the first of a set of characters in a list of segments (internal use only).
+ * @return  Non-zero if one of the characters was found.
+ *
+ * @param[in]     pSegments  Segments to search.
+ * @param[in]     count      Number of segments.
+ * @param[in]     set        Characters to search for.
+ * @param[in,out] pSegment   Segment to start searching from, then the segment where the character was found.
+ * @param[in,out] pOffset    Offset to start searching from, then the offset where the character was found.
+ */
+static int prv_micro_ini_find_in_segments(
+	const micro_ini_segment* const pSegments,
+	const size_t count,
+	const char* const set,
+	size_t* const pSegment,
+	size_t* const pOffset
+)
+{
+	size_t segment = *pSegment;
+	size_t offset = *pOffset;
+
+	for(; segment < count; ++segment, offset = 0)
 	{
-		/* Invalid reader callback. */
-		return MICRO_INI_ERROR_INVALID_READER_CALLBACK;
+		for(; offset < pSegments[segment].length; ++offset)
+		{
+			const char c = pSegments[segment].data[offset];
+
+			if(c != '\0' && strchr(set, c))
+			{
+				*pSegment = segment;
+				*pOffset = offset;
+				return 1;
+			}
+		}
 	}
-	else if(!eofCallback)
+
+	return 0;
+}
+
+/**
+ * @brief   Copy part of a list of segments into a string (internal use only).
+ * @return  Non-zero if the text fit in the string.
+ *
+ * @param[out] out          Output string with room for MICRO_INI_MAX_LINE_LENGTH characters.
+ * @param[in]  pSegments    Segments to copy from.
+ * @param[in]  firstOffset  Offset in the first segment where the copy starts.
+ * @param[in]  lastSegment  Segment where the copy ends.
+ * @param[in]  lastOffset   Offset in the last segment where the copy ends (exclusive).
+ */
+static int prv_micro_ini_copy_segments(
+	char* const out,
+	const micro_ini_segment* const pSegments,
+	const size_t firstOffset,
+	const size_t lastSegment,
+	const size_t lastOffset
+)
+{
+	size_t length = 0;
+	size_t segment = 0;
+
+	for(; segment <= lastSegment; ++segment)
 	{
-		/* Invalid eof callback. */
-		return MICRO_INI_ERROR_INVALID_EOF_CALLBACK;
+		const size_t begin = (segment == 0) ? firstOffset : 0;
+		const size_t end = (segment == lastSegment) ? lastOffset : pSegments[segment].length;
+
+		if(end - begin > MICRO_INI_MAX_LINE_LENGTH - length)
+		{
+			return 0;
+		}
+
+		memcpy(out + length, pSegments[segment].data + begin, end - begin);
+		length += end - begin;
 	}
 
-	/* Clear the temporary data. */
-	line[0] = '\0';
-	section[0] = '\0';
-	key[0] = '\0';
-	val[0] = '\0';
+	out[length] = '\0';
 
-	/* Read each line of the file. */
-	while(readerCallback(line + last, MICRO_INI_MAX_LINE_LENGTH - last, pStream) != NULL)
-	{
-		++lineno;
+	return 1;
+}
 
-		start = line;
-		len = (int) strlen(line) - 1;
+/**
+ * @brief   Parse a multi-line value that is too long to join (internal use only).
+ * @return  Type of the line that was parsed or an error code.
+ *
+ * @param[in]     pReader        In-memory reader positioned at the first line of the value.
+ * @param[in]     flags          Flags for configuring the parser.
+ * @param[in]     firstLine      Non-zero if this is the first line of the file (used to detect the byte order marker).
+ * @param[in,out] pLineno        Number of lines read so far.
+ * @param[out]    line           Output string for a copy of the start of the line (used when reporting errors).
+ * @param[out]    section        Output string for the section.
+ * @param[out]    key            Output string for the key.
+ * @param[out]    pSegments      Output segments for the value.
+ * @param[in]     maxSegments    Number of elements in pSegments.
+ * @param[out]    pSegmentCount  Number of segments in the value.
+ *
+ * Each line is described by a segment pointing straight into the reader's data,
+ * so nothing is copied and there is no limit on the length of the value.  The
+ * segments are then reduced the same way prv_micro_ini_parse_line() reduces a
+ * joined line: the key runs up to the first equal sign, a quoted value keeps
+ * what is between the quotes, an unquoted value ends at the first comment
+ * character, and surrounding whitespace is removed.
+ */
+static int prv_micro_ini_parse_long_value(
+	micro_ini_block_reader* const pReader,
+	const int flags,
+	const int firstLine,
+	uint32_t* const pLineno,
+	char* const line,
+	char* const section,
+	char* const key,
+	micro_ini_segment* const pSegments,
+	const size_t maxSegments,
+	size_t* const pSegmentCount
+)
+{
+	const char* const pEndOfData = pReader->pData + pReader->end;
+	const char* pCursor = pReader->pData + pReader->pos;
 
-		if(firstLine && (flags & MICRO_INI_FLAG_BOM) &&
-			(unsigned char) start[0] == 0xEF &&
-			(unsigned char) start[1] == 0xBB &&
-			(unsigned char) start[2] == 0xBF
-		)
+	size_t count = 0;
+	size_t length = 0;
+	size_t segment = 0;
+	size_t offset = 0;
+
+	char quote[2];
+	int more = 1;
+
+	/* Describe each line with a segment, leaving out the backslash that continues it. */
+	while(more)
+	{
+		const char* const pLine = pCursor;
+		const char* pEnd = NULL;
+
+		if(pCursor == pEndOfData)
 		{
-			/* Move the line just past the byte order marker. */
-			start += 3;
+			/* The data ended part way through the value, which micro_ini_resume_stream() ignores as well. */
+			pReader->pos = pReader->end;
+			return LINE_EMPTY;
 		}
-
-		if(len <= 0)
+		else if(count == maxSegments)
 		{
-			/* Skip empty lines. */
-			continue;
+			/* Not enough room to describe the value. */
+			return MICRO_INI_ERROR_BUFFER_OVERFLOW;
 		}
 
-		/* Safety check against buffer overflows. */
-		if(line[len] != '\n' && eofCallback(pStream) == 0)
+		pEnd = (const char*) memchr(pLine, '\n', (size_t)(pEndOfData - pLine));
+		pCursor = pEnd ? pEnd + 1 : pEndOfData;
+		pEnd = pCursor;
+
+		++(*pLineno);
+
+		while(pEnd > pLine && isspace((unsigned char) *(pEnd - 1)))
 		{
-			/* A buffer overflow occurs when the last character in the line is not '\n' and not at the end of the file stream. */
-			return MICRO_INI_ERROR_BUFFER_OVERFLOW;
+			/* Ignore whitespace at the end of the line (including newline characters). */
+			--pEnd;
 		}
 
-		/* Get rid of any whitespace characters at end of line (including newline characters). */
-		while((len >= 0) && isspace((unsigned char) line[len]))
+		more = (pEnd > pLine && *(pEnd - 1) == '\\');
+
+		if(pEnd > pLine)
 		{
-			line[len] = '\0';
-			--len;
+			pSegments[count].data = pLine;
+			pSegments[count].length = (size_t)(pEnd - pLine) - (more ? 1 : 0);
+			++count;
 		}
 
-		/* Detect multi-line. */
-		if(line[len] == '\\' && (flags & MICRO_INI_FLAG_MULTILINE))
+		/* A blank line leaves the end of the previous lines exposed, and the stream parser checks that for a backslash too. */
+		while(pEnd == pLine && count > 0)
+		{
+			micro_ini_segment* const pPrevious = &pSegments[count - 1];
+
+			while(pPrevious->length > 0 && isspace((unsigned char) pPrevious->data[pPrevious->length - 1]))
+			{
+				--pPrevious->length;
+			}
+
+			if(pPrevious->length > 0)
+			{
+				if(pPrevious->data[pPrevious->length - 1] == '\\')
+				{
+					--pPrevious->length;
+					more = 1;
+				}
+
+				break;
+			}
+
+			/* Segments that end up empty are dropped, which keeps this linear. */
+			--count;
+		}
+	}
+
+	pReader->pos = (size_t)(pCursor - pReader->pData);
+
+	if(firstLine && (flags & MICRO_INI_FLAG_BOM))
+	{
+		static const unsigned char bom[3] = { 0xEF, 0xBB, 0xBF };
+
+		size_t matched = 0;
+
+		segment = 0;
+		offset = 0;
+
+		/* The byte order marker is checked at the start of the joined line, so it may be split across segments. */
+		while(matched < 3 && segment < count)
+		{
+			if(offset == pSegments[segment].length)
+			{
+				++segment;
+				offset = 0;
+			}
+			else if((unsigned char) pSegments[segment].data[offset] == bom[matched])
+			{
+				++offset;
+				++matched;
+			}
+			else
+			{
+				break;
+			}
+		}
+
+		if(matched == 3)
+		{
+			/* Move the line just past the byte order marker. */
+			memmove(pSegments, pSegments + segment, (count - segment) * sizeof(micro_ini_segment));
+			count -= segment;
+
+			pSegments[0].data += offset;
+			pSegments[0].length -= offset;
+		}
+	}
+
+	/* Remove whitespace from both ends of the joined line. */
+	count = prv_micro_ini_strip_segments(pSegments, count);
+
+	if(count == 0)
+	{
+		/* Line was composed entirely of whitespace characters. */
+		return LINE_EMPTY;
+	}
+
+	/* Keep a copy of the start of the line for the error callback. */
+	length = (pSegments[0].length < MICRO_INI_MAX_LINE_LENGTH) ? pSegments[0].length : MICRO_INI_MAX_LINE_LENGTH;
+	memcpy(line, pSegments[0].data, length);
+	line[length] = '\0';
+
+	if(pSegments[0].data[0] == '#' || pSegments[0].data[0] == ';')
+	{
+		/* Comment line. */
+		return LINE_COMMENT;
+	}
+	else if(pSegments[0].data[0] == '[' && pSegments[count - 1].data[pSegments[count - 1].length - 1] == ']')
+	{
+		/* Section name. */
+		segment = 0;
+		offset = 1;
+
+		prv_micro_ini_find_in_segments(pSegments, count, "]", &segment, &offset);
+
+		if(segment > 0 || offset > 1)
+		{
+			if(!prv_micro_ini_copy_segments(section, pSegments, 1, segment, offset))
+			{
+				/* Section name is too long. */
+				return MICRO_INI_ERROR_BUFFER_OVERFLOW;
+			}
+
+			prv_micro_ini_strstrip(section);
+		}
+
+		return LINE_SECTION;
+	}
+
+	segment = 0;
+	offset = 0;
+
+	if(!prv_micro_ini_find_in_segments(pSegments, count, "=", &segment, &offset) || (segment == 0 && offset == 0))
+	{
+		/* Generate syntax error */
+		return LINE_ERROR;
+	}
+
+	if(!prv_micro_ini_copy_segments(key, pSegments, 0, segment, offset))
+	{
+		/* Key is too long. */
+		return MICRO_INI_ERROR_BUFFER_OVERFLOW;
+	}
+
+	prv_micro_ini_strstrip(key);
+
+	/* The value starts just after the equal sign. */
+	pSegments[segment].data += offset + 1;
+	pSegments[segment].length -= offset + 1;
+
+	memmove(pSegments, pSegments + segment, (count - segment) * sizeof(micro_ini_segment));
+	count = prv_micro_ini_strip_segments(pSegments, count - segment);
+
+	if(count > 0 && (pSegments[0].data[0] == '"' || pSegments[0].data[0] == '\''))
+	{
+		quote[0] = pSegments[0].data[0];
+		quote[1] = '\0';
+
+		segment = 0;
+		offset = 1;
+
+		if(!prv_micro_ini_find_in_segments(pSegments, count, quote, &segment, &offset))
+		{
+			/* Like sscanf(), a missing closing quote takes the rest of the value. */
+			segment = count - 1;
+			offset = pSegments[segment].length;
+		}
+
+		if((segment == 0) ? (offset > 1) : (pSegments[0].length > 1 || segment > 1 || offset > 0))
+		{
+			/* Quoted value, so keep only what lies between the quotes. */
+			pSegments[segment].length = offset;
+			++pSegments[0].data;
+			--pSegments[0].length;
+
+			*pSegmentCount = prv_micro_ini_strip_segments(pSegments, segment + 1);
+			return LINE_VALUE;
+		}
+	}
+
+	segment = 0;
+	offset = 0;
+
+	if(prv_micro_ini_find_in_segments(pSegments, count, ";#", &segment, &offset))
+	{
+		/* The value ends where the comment begins. */
+		pSegments[segment].length = offset;
+		count = segment + 1;
+	}
+
+	*pSegmentCount = prv_micro_ini_strip_segments(pSegments, count);
+
+	return LINE_VALUE;
+}
+
+
+/**
+ * @brief   Seek a FILE object to an absolute byte offset (internal use only).
+ * @return  Non-zero on success.
+ *
+ * @param[in]  pFile   File to seek.
+ * @param[in]  offset  Byte offset from the beginning of the file.
+ *
+ * Offsets beyond the range of a long are supported where the platform provides a
+ * 64-bit seek function.
+ */
+static int prv_micro_ini_seek(FILE* const pFile, const uint64_t offset)
+{
+#if defined(_MSC_VER)
+	return _fseeki64(pFile, (__int64) offset, SEEK_SET) == 0;
+#elif defined(_POSIX_VERSION) && _POSIX_VERSION >= 200112L
+	return fseeko(pFile, (off_t) offset, SEEK_SET) == 0;
+#else
+	if(offset > (uint64_t) LONG_MAX)
+	{
+		return 0;
+	}
+
+	return fseek(pFile, (long) offset, SEEK_SET) == 0;
+#endif
+}
+
+
+/**
+ * @brief   Read a line from a FILE object (internal use only).
+ * @return  The output string or NULL if nothing could be read.
+ *
+ * @param[out] str      Output string.
+ * @param[in]  num      Size of the output string, including the null terminator.
+ * @param[in]  pStream  FILE object to read from.
+ *
+ * This conforms to fgets(), but expects the caller to hold the lock on the
+ * FILE object.  Reading stops just after the newline, so the FILE position
+ * is exactly what fgets() would have left behind.
+ */
+static char* prv_micro_ini_file_gets(char* const str, const int num, void* const pStream)
+{
+	FILE* const pFile = (FILE*) pStream;
+	int count = 0;
+	int c = 0;
+
+	if(num <= 1)
+	{
+		return NULL;
+	}
+
+	while(count < num - 1)
+	{
+		c = MICRO_INI_GETC(pFile);
+		if(c == EOF)
+		{
+			break;
+		}
+
+		str[count] = (char) c;
+		++count;
+
+		if(c == '\n')
+		{
+			break;
+		}
+	}
+
+	if(count == 0 || (c == EOF && ferror(pFile)))
+	{
+		/* Like fgets(), a read error discards any partial line. */
+		return NULL;
+	}
+
+	str[count] = '\0';
+
+	return str;
+}
+
+/**
+ * @brief   Check a FILE object for the end of the file (internal use only).
+ * @return  Non-zero once the end of the file has been reached.
+ *
+ * @param[in]  pStream  FILE object to check.
+ */
+static int prv_micro_ini_file_eof(void* const pStream)
+{
+	return feof((FILE*) pStream);
+}
+
+
+/**
+ * @brief  Initialize a block reader (internal use only).
+ *
+ * @param[out] pReader  Reader to initialize.
+ * @param[in]  pData    Data that is already available (NULL when reading from a descriptor).
+ * @param[in]  end      Number of bytes available in pData.
+ * @param[in]  pBlock   Block buffer to refill from the descriptor (NULL when reading from memory).
+ * @param[in]  size     Capacity of the block buffer.
+ * @param[in]  fd       Descriptor to read from (ignored when reading from memory).
+ */
+static void prv_micro_ini_block_init(
+	micro_ini_block_reader* const pReader,
+	const char* const pData,
+	const size_t end,
+	char* const pBlock,
+	const size_t size,
+	const int fd
+)
+{
+	pReader->pData = pData;
+	pReader->pBlock = pBlock;
+	pReader->size = size;
+	pReader->pos = 0;
+	pReader->end = end;
+	pReader->fd = fd;
+	pReader->eof = 0;
+	pReader->error = 0;
+}
+
+/**
+ * @brief   Refill the buffered data of a block reader (internal use only).
+ * @return  Non-zero if any data was read.
+ *
+ * @param[in]  pReader  Reader to refill.
+ */
+static int prv_micro_ini_block_refill(micro_ini_block_reader* const pReader)
+{
+	long count = 0;
+
+	if(pReader->eof || !pReader->pBlock)
+	{
+		/* Don't read past the end again (a terminal would block waiting for more input). */
+		pReader->eof = 1;
+		return 0;
+	}
+
+	pReader->pos = 0;
+	pReader->end = 0;
+
+#ifdef MICRO_INI_FD_SUPPORTED
+	for(;;)
+	{
+#if defined(_WIN32)
+		count = (long) _read(pReader->fd, pReader->pBlock, (unsigned int) pReader->size);
+#else
+		count = (long) read(pReader->fd, pReader->pBlock, pReader->size);
+		if(count < 0 && errno == EINTR)
+		{
+			/* Interrupted before any data arrived. */
+			continue;
+		}
+#endif
+
+		break;
+	}
+#endif
+
+	if(count <= 0)
+	{
+		/* End of file or read error; either way, mimic feof() from here on. */
+		pReader->eof = 1;
+		pReader->error = (count < 0);
+		return 0;
+	}
+
+	pReader->pData = pReader->pBlock;
+	pReader->end = (size_t) count;
+
+	return 1;
+}
+
+/**
+ * @brief   Read a line from a block reader (internal use only).
+ * @return  The output string or NULL if nothing could be read.
+ *
+ * @param[out] str      Output string.
+ * @param[in]  num      Size of the output string, including the null terminator.
+ * @param[in]  pStream  Reader to read from.
+ *
+ * This conforms to fgets() so the reader can be given to micro_ini_resume_stream().
+ */
+static char* prv_micro_ini_block_gets(char* const str, const int num, void* const pStream)
+{
+	micro_ini_block_reader* const pReader = (micro_ini_block_reader*) pStream;
+	size_t count = 0;
+
+	if(num <= 1)
+	{
+		return NULL;
+	}
+
+	while(count < (size_t)(num - 1))
+	{
+		const char* pData = NULL;
+		const char* pNewline = NULL;
+		size_t length = 0;
+
+		if(pReader->pos == pReader->end && !prv_micro_ini_block_refill(pReader))
+		{
+			break;
+		}
+
+		pData = pReader->pData + pReader->pos;
+		length = pReader->end - pReader->pos;
+
+		if(length > (size_t)(num - 1) - count)
+		{
+			/* Never read more than fits in the output string. */
+			length = (size_t)(num - 1) - count;
+		}
+
+		pNewline = (const char*) memchr(pData, '\n', length);
+		if(pNewline)
+		{
+			/* Stop just after the end of the line. */
+			length = (size_t)(pNewline - pData) + 1;
+		}
+
+		memcpy(str + count, pData, length);
+		pReader->pos += length;
+		count += length;
+
+		if(pNewline)
+		{
+			break;
+		}
+	}
+
+	if(count == 0)
+	{
+		return NULL;
+	}
+
+	str[count] = '\0';
+
+	return str;
+}
+
+/**
+ * @brief   Check a block reader for the end of the data (internal use only).
+ * @return  Non-zero once the end of the file has been reached.
+ *
+ * @param[in]  pStream  Reader to check.
+ */
+static int prv_micro_ini_block_eof(void* const pStream)
+{
+	return ((const micro_ini_block_reader*) pStream)->eof;
+}
+
+
+/**
+ * Build a 64-bit constant from two 32-bit halves (C89 has no 64-bit literals).
+ */
+#define MICRO_INI_UINT64(high, low) (((uint64_t) (high) << 32) | (uint64_t) (low))
+
+/**
+ * @brief   Mix the bits of a 64-bit value (MurmurHash3 finalizer, internal use only).
+ * @return  Mixed value.
+ */
+static uint64_t prv_micro_ini_fingerprint_mix(uint64_t value)
+{
+	value ^= value >> 33;
+	value *= MICRO_INI_UINT64(0xFF51AFD7u, 0xED558CCDu);
+	value ^= value >> 33;
+	value *= MICRO_INI_UINT64(0xC4CEB9FEu, 0x1A85EC53u);
+	value ^= value >> 33;
+
+	return value;
+}
+
+/**
+ * @brief  Absorb one 64-bit word into the two lanes of a pair hash (internal use only).
+ */
+static void prv_micro_ini_fingerprint_word(uint64_t* const pLanes, const uint64_t word)
+{
+	pLanes[0] = (pLanes[0] ^ word) * MICRO_INI_UINT64(0x87C37B91u, 0x114253D5u);
+	pLanes[0] = (pLanes[0] << 31) | (pLanes[0] >> 33);
+
+	pLanes[1] = (pLanes[1] + word) * MICRO_INI_UINT64(0x4CF5AD43u, 0x2745937Fu);
+	pLanes[1] = ((pLanes[1] << 27) | (pLanes[1] >> 37)) ^ pLanes[0];
+}
+
+/**
+ * @brief  Absorb a string into the two lanes of a pair hash (internal use only).
+ *
+ * Bytes are packed eight at a time in little-endian order, so the result is the same on
+ * every platform.  The last word carries the length of the string in its top byte,
+ * which keeps ("ab", "c") apart from ("a", "bc").
+ */
+static void prv_micro_ini_fingerprint_string(uint64_t* const pLanes, const char* const str)
+{
+	const char* p = str;
+	uint64_t word = 0;
+	unsigned shift = 0;
+
+	for(; *p; ++p)
+	{
+		word |= (uint64_t) (unsigned char) (*p) << shift;
+		shift += 8;
+
+		if(shift == 64)
+		{
+			prv_micro_ini_fingerprint_word(pLanes, word);
+			word = 0;
+			shift = 0;
+		}
+	}
+
+	prv_micro_ini_fingerprint_word(pLanes, word | ((uint64_t) ((size_t) (p - str) & 0xFF) << 56));
+}
+
+
+#if defined(MICRO_INI_ENABLE_PROFILING)
+/**
+ * @brief   Read the monotonic clock (internal use only).
+ * @return  Current time in nanoseconds from an arbitrary starting point.
+ */
+static uint64_t prv_micro_ini_profile_now(void)
+{
+#if defined(_WIN32)
+	LARGE_INTEGER counter;
+	LARGE_INTEGER frequency;
+
+	QueryPerformanceCounter(&counter);
+	QueryPerformanceFrequency(&frequency);
+
+	/* Split the conversion so the multiplication cannot overflow. */
+	return (uint64_t) (counter.QuadPart / frequency.QuadPart) * 1000000000u
+		+ (uint64_t) (counter.QuadPart % frequency.QuadPart) * 1000000000u / (uint64_t) frequency.QuadPart;
+#else
+	struct timespec now;
+
+	clock_gettime(CLOCK_MONOTONIC, &now);
+
+	return (uint64_t) now.tv_sec * 1000000000u + (uint64_t) now.tv_nsec;
+#endif
+}
+
+/**
+ * @brief  Copy a name into a profile entry, truncating it if necessary (internal use only).
+ *
+ * @param[out] pOut  Buffer of MICRO_INI_PROFILE_NAME_LENGTH + 1 characters.
+ * @param[in]  name  Name to copy.
+ */
+static void prv_micro_ini_profile_copy_name(char* const pOut, const char* const name)
+{
+	size_t i;
+
+	for(i = 0; i < MICRO_INI_PROFILE_NAME_LENGTH && name[i]; ++i)
+	{
+		pOut[i] = name[i];
+	}
+
+	pOut[i] = '\0';
+}
+
+/**
+ * @brief  Add the timing of one handler call to a profile (internal use only).
+ *
+ * @param[in]  pProfile     Profile to update.
+ * @param[in]  section      Section of the pair.
+ * @param[in]  key          Key of the pair.
+ * @param[in]  nanoseconds  Time spent in the handler.
+ * @param[in]  lineno       Line number of the pair.
+ */
+static void prv_micro_ini_profile_record(
+	micro_ini_profile* const pProfile,
+	const char* const section,
+	const char* const key,
+	const uint64_t nanoseconds,
+	const uint32_t lineno
+)
+{
+	micro_ini_profile_entry* pEntry;
+	const char* p;
+	uint32_t hash = 2166136261u;
+	uint32_t slot;
+	uint32_t probe;
+
+	/* FNV-1a over both names, with the section's terminator keeping ("ab", "c") apart from ("a", "bc"). */
+	for(p = section; ; ++p)
+	{
+		hash = (hash ^ (unsigned char) (*p)) * 16777619u;
+		if(!(*p))
+		{
+			break;
+		}
+	}
+
+	for(p = key; (*p); ++p)
+	{
+		hash = (hash ^ (unsigned char) (*p)) * 16777619u;
+	}
+
+	slot = hash & (MICRO_INI_PROFILE_SLOTS - 1);
+
+	for(probe = 0; probe < MICRO_INI_PROFILE_SLOTS; ++probe)
+	{
+		pEntry = &pProfile->entries[(slot + probe) & (MICRO_INI_PROFILE_SLOTS - 1)];
+
+		if(pEntry->calls == 0)
+		{
+			/* First call for this pair. */
+			prv_micro_ini_profile_copy_name(pEntry->section, section);
+			prv_micro_ini_profile_copy_name(pEntry->key, key);
+			pEntry->hash = hash;
+			++pProfile->used;
+			break;
+		}
+
+		if(pEntry->hash == hash
+			&& strncmp(pEntry->section, section, MICRO_INI_PROFILE_NAME_LENGTH) == 0
+			&& strncmp(pEntry->key, key, MICRO_INI_PROFILE_NAME_LENGTH) == 0)
+		{
+			break;
+		}
+	}
+
+	if(probe == MICRO_INI_PROFILE_SLOTS)
+	{
+		/* Every slot is taken by another pair. */
+		++pProfile->overflowCalls;
+		pProfile->overflowNanoseconds += nanoseconds;
+		return;
+	}
+
+	++pEntry->calls;
+	pEntry->totalNanoseconds += nanoseconds;
+
+	if(nanoseconds >= pEntry->maxNanoseconds)
+	{
+		pEntry->maxNanoseconds = nanoseconds;
+		pEntry->maxLineno = lineno;
+	}
+}
+
+/**
+ * @brief  Call a handler, timing it when a profile is active on this thread (internal use only).
+ *
+ * @param[in]  handlerCallback  Callback for handling parsed key/value pairs.
+ * @param[in]  pUserData        Pointer to user data that is passed to the callback.
+ * @param[in]  section          Section of the pair.
+ * @param[in]  key              Key of the pair.
+ * @param[in]  value            Value of the pair.
+ * @param[in]  lineno           Line number of the pair.
+ */
+static void prv_micro_ini_profile_call(
+	const micro_ini_handler_fn handlerCallback,
+	void* const pUserData,
+	const char* const section,
+	const char* const key,
+	const char* const value,
+	const uint32_t lineno
+)
+{
+	micro_ini_profile* const pProfile = prv_micro_ini_active_profile;
+	uint64_t start;
+
+	if(!pProfile)
+	{
+		handlerCallback(pUserData, section, key, value);
+		return;
+	}
+
+	start = prv_micro_ini_profile_now();
+	handlerCallback(pUserData, section, key, value);
+
+	prv_micro_ini_profile_record(pProfile, section, key, prv_micro_ini_profile_now() - start, lineno);
+}
+#endif
+
+
+int micro_ini_load(
+	const char* const filePath,
+	const int flags,
+	const micro_ini_handler_fn handlerCallback,
+	const micro_ini_error_fn errorCallback,
+	void* const pUserData
+)
+{
+	FILE* pFile = NULL;
+	int err = MICRO_INI_SUCCESS;
+
+	if(!handlerCallback)
+	{
+		/* Invalid handler callback. */
+		return MICRO_INI_ERROR_INVALID_HANDLER_CALLBACK;
+	}
+
+	pFile = fopen(filePath, "r");
+	if(!pFile)
+	{
+		/* Could not open file. */
+		return MICRO_INI_ERROR_INVALID_FILE_OBJECT;
+	}
+
+	err = micro_ini_load_file(pFile, flags, handlerCallback, errorCallback, pUserData);
+	fclose(pFile);
+
+	return err;
+}
+
+
+int micro_ini_load_file(
+	FILE* const pFile,
+	const int flags,
+	const micro_ini_handler_fn handlerCallback,
+	const micro_ini_error_fn errorCallback,
+	void* const pUserData
+)
+{
+	const uint64_t start = MICRO_INI_METRICS_CLOCK();
+	micro_ini_state state;
+	int result;
+
+	micro_ini_state_init(&state);
+
+	result = micro_ini_resume_file(&state, pFile, flags, handlerCallback, errorCallback, pUserData);
+
+	return MICRO_INI_METRICS_OBSERVE(start, state.offset, result);
+}
+
+
+int micro_ini_load_stream(
+	void* const pStream,
+	const int flags,
+	const micro_ini_handler_fn handlerCallback,
+	const micro_ini_error_fn errorCallback,
+	const micro_ini_reader_fn readerCallback,
+	const micro_ini_eof_fn eofCallback,
+	void* const pUserData
+)
+{
+	const uint64_t start = MICRO_INI_METRICS_CLOCK();
+	micro_ini_state state;
+	int result;
+
+	micro_ini_state_init(&state);
+
+	result = micro_ini_resume_stream(&state, pStream, flags, handlerCallback, errorCallback, readerCallback, eofCallback, pUserData);
+
+	return MICRO_INI_METRICS_OBSERVE(start, state.offset, result);
+}
+
+
+int micro_ini_load_fd(
+	const int fd,
+	const int flags,
+	const micro_ini_handler_fn handlerCallback,
+	const micro_ini_error_fn errorCallback,
+	void* const pUserData
+)
+{
+	const uint64_t start = MICRO_INI_METRICS_CLOCK();
+	micro_ini_state state;
+	int result;
+
+	micro_ini_state_init(&state);
+
+	result = micro_ini_resume_fd(&state, fd, flags, handlerCallback, errorCallback, pUserData);
+
+	return MICRO_INI_METRICS_OBSERVE(start, state.offset, result);
+}
+
+
+int micro_ini_load_buffer(
+	const char* const pData,
+	const size_t size,
+	const int flags,
+	const micro_ini_handler_fn handlerCallback,
+	const micro_ini_error_fn errorCallback,
+	void* const pUserData
+)
+{
+	const uint64_t start = MICRO_INI_METRICS_CLOCK();
+	micro_ini_state state;
+	int result;
+
+	micro_ini_state_init(&state);
+
+	result = micro_ini_resume_buffer(&state, pData, size, flags, handlerCallback, errorCallback, pUserData);
+
+	return MICRO_INI_METRICS_OBSERVE(start, state.offset, result);
+}
+
+
+int micro_ini_load_buffer_segments(
+	const char* const pData,
+	const size_t size,
+	const int flags,
+	micro_ini_segment* const pSegments,
+	const size_t maxSegments,
+	const micro_ini_segment_handler_fn segmentCallback,
+	const micro_ini_error_fn errorCallback,
+	void* const pUserData
+)
+{
+	char line[MICRO_INI_MAX_LINE_LENGTH + 1];
+	char section[MICRO_INI_MAX_LINE_LENGTH + 1];
+	char key[MICRO_INI_MAX_LINE_LENGTH + 1];
+	char val[MICRO_INI_MAX_LINE_LENGTH + 1];
+
+	micro_ini_block_reader reader;
+	micro_ini_segment single;
+
+	uint32_t lineno = 0;
+	int numErrors = 0;
+	int firstLine = 1;
+
+	if(!pData && size > 0)
+	{
+		/* Invalid buffer. */
+		return MICRO_INI_ERROR_INVALID_STREAM_OBJECT;
+	}
+	else if(!segmentCallback)
+	{
+		/* Invalid handler callback. */
+		return MICRO_INI_ERROR_INVALID_HANDLER_CALLBACK;
+	}
+
+	prv_micro_ini_block_init(&reader, pData, size, NULL, 0, -1);
+
+	/* Clear the temporary data. */
+	line[0] = '\0';
+	section[0] = '\0';
+	key[0] = '\0';
+	val[0] = '\0';
+
+	for(;;)
+	{
+		const micro_ini_segment* pValue = NULL;
+		char* start = NULL;
+
+		size_t logicalStart = reader.pos;
+		size_t valueCount = 0;
+		uint32_t logicalLineno = lineno;
+
+		int status = LINE_UNPROCESSED;
+		int last = 0;
+		int len = 0;
+
+		/* Read the lines of a value the same way micro_ini_resume_stream() does, joining them while they fit. */
+		while(prv_micro_ini_block_gets(line + last, MICRO_INI_MAX_LINE_LENGTH - last, &reader) != NULL)
+		{
+			++lineno;
+			len = (int) strlen(line) - 1;
+
+			if(len <= 0)
+			{
+				/* Skip empty lines. */
+				logicalStart = reader.pos;
+				logicalLineno = lineno;
+				continue;
+			}
+
+			if(line[len] != '\n' && !reader.eof)
+			{
+				if(last == 0)
+				{
+					/* A single line that doesn't fit is still an error. */
+					return MICRO_INI_ERROR_BUFFER_OVERFLOW;
+				}
+
+				/* The joined value doesn't fit, so start over at its first line and describe it with segments instead. */
+				reader.pos = logicalStart;
+				reader.eof = 0;
+				lineno = logicalLineno;
+
+				status = prv_micro_ini_parse_long_value(&reader, flags, firstLine, &lineno, line, section, key, pSegments, maxSegments, &valueCount);
+				pValue = pSegments;
+				break;
+			}
+
+			/* Get rid of any whitespace characters at end of line (including newline characters). */
+			while((len >= 0) && isspace((unsigned char) line[len]))
+			{
+				line[len] = '\0';
+				--len;
+			}
+
+			/* Detect multi-line (a line made entirely of whitespace leaves nothing to check). */
+			if(len >= 0 && line[len] == '\\' && (flags & MICRO_INI_FLAG_MULTILINE))
+			{
+				last = len;
+				continue;
+			}
+
+			start = line;
+
+			if(firstLine && (flags & MICRO_INI_FLAG_BOM) &&
+				(unsigned char) start[0] == 0xEF &&
+				(unsigned char) start[1] == 0xBB &&
+				(unsigned char) start[2] == 0xBF
+			)
+			{
+				/* Move the line just past the byte order marker. */
+				start += 3;
+			}
+
+			len -= (int)(start - line);
+
+			/* Remove whitespace at the beginning of the line. */
+			while((len >= 0) && isspace((unsigned char) *start))
+			{
+				++start;
+				--len;
+			}
+
+			/* Fix the length so the line can be parsed correctly. */
+			len = (len < 0) ? 0 : len + 1;
+
+			status = MICRO_INI_PARSE_LINE(start, (size_t) len, section, key, val);
+
+			single.data = val;
+			single.length = strlen(val);
+
+			pValue = &single;
+			valueCount = (single.length > 0) ? 1 : 0;
+			break;
+		}
+
+		if(status < 0)
+		{
+			/* Error code from parsing a long value. */
+			return status;
+		}
+		else if(status == LINE_SECTION && (flags & MICRO_INI_FLAG_INHERITANCE))
+		{
+			status = prv_micro_ini_split_parent(section, val);
+		}
+		else if(status == LINE_UNPROCESSED)
+		{
+			/* Reached the end of the data. */
+			break;
+		}
+
+		firstLine = 0;
+
+		if(status == LINE_VALUE)
+		{
+			segmentCallback(pUserData, section, key, pValue, valueCount);
+		}
+		else if(status == LINE_PARENT)
+		{
+			single.data = val;
+			single.length = strlen(val);
+
+			segmentCallback(pUserData, section, NULL, &single, 1);
+		}
+		else if(status == LINE_ERROR)
+		{
+			if(errorCallback)
+			{
+				/* Call the error function if it was provided. */
+				errorCallback(pUserData, line, (int) lineno);
+			}
+
+			/* Keep track of the number of errors that have occurred. */
+			++numErrors;
+
+			if(flags & MICRO_INI_FLAG_STOP_ON_FIRST_ERROR)
+			{
+				break;
+			}
+		}
+
+		line[0] = '\0';
+	}
+
+	return MICRO_INI_SUCCESS + numErrors;
+}
+
+
+size_t micro_ini_join_segments(
+	char* const pOut,
+	const size_t outSize,
+	const micro_ini_segment* const pSegments,
+	const size_t segmentCount
+)
+{
+	size_t total = 0;
+	size_t written = 0;
+	size_t index = 0;
+
+	for(; index < segmentCount; ++index)
+	{
+		const size_t length = pSegments[index].length;
+
+		if(pOut && written + 1 < outSize)
+		{
+			/* Copy as much of the segment as fits. */
+			const size_t room = outSize - 1 - written;
+			const size_t copy = (length < room) ? length : room;
+
+			memcpy(pOut + written, pSegments[index].data, copy);
+			written += copy;
+		}
+
+		total += length;
+	}
+
+	if(pOut && outSize > 0)
+	{
+		pOut[written] = '\0';
+	}
+
+	return total;
+}
+
+
+void micro_ini_state_init(micro_ini_state* const pState)
+{
+	if(pState)
+	{
+		memset(pState, 0, sizeof(micro_ini_state));
+		pState->firstLine = 1;
+	}
+}
+
+
+void micro_ini_state_stop(micro_ini_state* const pState)
+{
+	if(pState)
+	{
+		pState->stopRequested = 1;
+	}
+}
+
+
+void micro_ini_fingerprint_add(
+	micro_ini_fingerprint* const pFingerprint,
+	const char* const section,
+	const char* const key,
+	const char* const value
+)
+{
+	uint64_t lanes[2];
+	uint64_t low;
+	uint64_t high;
+
+	if(!pFingerprint)
+	{
+		return;
+	}
+
+	/* A parent link hashes differently from a pair whose key is empty. */
+	lanes[0] = MICRO_INI_UINT64(0x9E3779B9u, 0x7F4A7C15u);
+	lanes[1] = key ? MICRO_INI_UINT64(0x6A09E667u, 0xF3BCC909u) : MICRO_INI_UINT64(0xBB67AE85u, 0x84CAA73Bu);
+
+	prv_micro_ini_fingerprint_string(lanes, section ? section : "");
+	prv_micro_ini_fingerprint_string(lanes, key ? key : "");
+	prv_micro_ini_fingerprint_string(lanes, value ? value : "");
+
+	lanes[0] += lanes[1];
+	lanes[1] += lanes[0];
+	low = prv_micro_ini_fingerprint_mix(lanes[0]);
+	high = prv_micro_ini_fingerprint_mix(lanes[1]);
+	low += high;
+	high += low;
+
+	/* Adding the pair hashes as one 128-bit number makes the fingerprint independent of their order. */
+	pFingerprint->low += low;
+	pFingerprint->high += high + (pFingerprint->low < low);
+}
+
+
+int micro_ini_resume(
+	micro_ini_state* const pState,
+	const char* const filePath,
+	const int flags,
+	const micro_ini_handler_fn handlerCallback,
+	const micro_ini_error_fn errorCallback,
+	void* const pUserData
+)
+{
+	FILE* pFile = NULL;
+	int err = MICRO_INI_SUCCESS;
+
+	if(!pState)
+	{
+		/* Invalid state object. */
+		return MICRO_INI_ERROR_INVALID_STATE_OBJECT;
+	}
+	else if(!handlerCallback)
+	{
+		/* Invalid handler callback. */
+		return MICRO_INI_ERROR_INVALID_HANDLER_CALLBACK;
+	}
+
+	/* Binary mode keeps the recorded offset an exact byte position on every platform. */
+	pFile = fopen(filePath, "rb");
+	if(!pFile)
+	{
+		/* Could not open file. */
+		return MICRO_INI_ERROR_INVALID_FILE_OBJECT;
+	}
+
+	if(pState->offset > 0 && !prv_micro_ini_seek(pFile, pState->offset))
+	{
+		/* Could not skip the part of the file that was already parsed. */
+		fclose(pFile);
+		return MICRO_INI_ERROR_INVALID_FILE_OBJECT;
+	}
+
+	err = micro_ini_resume_file(pState, pFile, flags, handlerCallback, errorCallback, pUserData);
+	fclose(pFile);
+
+	return err;
+}
+
+
+int micro_ini_resume_file(
+	micro_ini_state* const pState,
+	FILE* const pFile,
+	const int flags,
+	const micro_ini_handler_fn handlerCallback,
+	const micro_ini_error_fn errorCallback,
+	void* const pUserData
+)
+{
+	int err = MICRO_INI_SUCCESS;
+
+	if(!pFile)
+	{
+		/* Invalid file object. */
+		return MICRO_INI_ERROR_INVALID_FILE_OBJECT;
+	}
+	else if(!handlerCallback)
+	{
+		/* Invalid handler callback. */
+		return MICRO_INI_ERROR_INVALID_HANDLER_CALLBACK;
+	}
+
+	/* Take the stream lock once for the whole parse instead of once per line. */
+	MICRO_INI_LOCK_FILE(pFile);
+	err = micro_ini_resume_stream(pState, pFile, flags, handlerCallback, errorCallback, prv_micro_ini_file_gets, prv_micro_ini_file_eof, pUserData);
+	MICRO_INI_UNLOCK_FILE(pFile);
+
+	return err;
+}
+
+
+int micro_ini_resume_fd(
+	micro_ini_state* const pState,
+	const int fd,
+	const int flags,
+	const micro_ini_handler_fn handlerCallback,
+	const micro_ini_error_fn errorCallback,
+	void* const pUserData
+)
+{
+#ifdef MICRO_INI_FD_SUPPORTED
+	char block[MICRO_INI_READ_BLOCK_SIZE];
+
+	micro_ini_block_reader reader;
+	int err = MICRO_INI_SUCCESS;
+
+	if(fd < 0)
+	{
+		/* Invalid file descriptor. */
+		return MICRO_INI_ERROR_INVALID_FILE_OBJECT;
+	}
+
+	prv_micro_ini_block_init(&reader, NULL, 0, block, sizeof(block), fd);
+
+#if defined(POSIX_FADV_SEQUENTIAL)
+	{
+		struct stat info;
+
+		if(fstat(fd, &info) == 0 && S_ISREG(info.st_mode))
+		{
+			/* Let the kernel read ahead aggressively; this is only a hint, so failures don't matter. */
+			(void) posix_fadvise(fd, 0, 0, POSIX_FADV_SEQUENTIAL);
+		}
+	}
+#endif
+
+	err = micro_ini_resume_stream(pState, &reader, flags, handlerCallback, errorCallback, prv_micro_ini_block_gets, prv_micro_ini_block_eof, pUserData);
+
+	if(reader.end > reader.pos)
+	{
+		/* Hand back the data that was read ahead so seekable descriptors stay at the parsed offset (this fails harmlessly on pipes). */
+#if defined(_WIN32)
+		(void) _lseeki64(fd, -(__int64)(reader.end - reader.pos), SEEK_CUR);
+#else
+		(void) lseek(fd, -(off_t)(reader.end - reader.pos), SEEK_CUR);
+#endif
+	}
+
+	if(err >= 0 && reader.error)
+	{
+		/* Don't report a truncated parse as a success. */
+		return MICRO_INI_ERROR_READ_FAILED;
+	}
+
+	return err;
+#else
+	(void) pState;
+	(void) fd;
+	(void) flags;
+	(void) handlerCallback;
+	(void) errorCallback;
+	(void) pUserData;
+
+	/* File descriptors are not available on this platform. */
+	return MICRO_INI_ERROR_INVALID_FILE_OBJECT;
+#endif
+}
+
+
+int micro_ini_resume_buffer(
+	micro_ini_state* const pState,
+	const char* const pData,
+	const size_t size,
+	const int flags,
+	const micro_ini_handler_fn handlerCallback,
+	const micro_ini_error_fn errorCallback,
+	void* const pUserData
+)
+{
+	micro_ini_block_reader reader;
+
+	if(!pState)
+	{
+		/* Invalid state object. */
+		return MICRO_INI_ERROR_INVALID_STATE_OBJECT;
+	}
+	else if(!pData && size > 0)
+	{
+		/* Invalid buffer. */
+		return MICRO_INI_ERROR_INVALID_STREAM_OBJECT;
+	}
+
+	prv_micro_ini_block_init(&reader, pData, size, NULL, 0, -1);
+
+	if(pState->offset < (uint64_t) size)
+	{
+		/* Skip the part of the buffer that was already parsed. */
+		reader.pos = (size_t) pState->offset;
+	}
+	else
+	{
+		reader.pos = size;
+	}
+
+	return micro_ini_resume_stream(pState, &reader, flags, handlerCallback, errorCallback, prv_micro_ini_block_gets, prv_micro_ini_block_eof, pUserData);
+}
+
+
+int micro_ini_resume_stream(
+	micro_ini_state* const pState,
+	void* const pStream,
+	const int flags,
+	const micro_ini_handler_fn handlerCallback,
+	const micro_ini_error_fn errorCallback,
+	const micro_ini_reader_fn readerCallback,
+	const micro_ini_eof_fn eofCallback,
+	void* const pUserData
+)
+{
+	char key[MICRO_INI_MAX_LINE_LENGTH + 1];
+	char val[MICRO_INI_MAX_LINE_LENGTH + 1];
+
+	char* line = NULL;
+	char* section = NULL;
+	char* start = NULL;
+
+	int last = 0;
+	int len  = 0;
+	int status = LINE_UNPROCESSED;
+
+	if(!pState)
+	{
+		/* Invalid state object. */
+		return MICRO_INI_ERROR_INVALID_STATE_OBJECT;
+	}
+	else if(!pStream)
+	{
+		/* Invalid stream object. */
+		return MICRO_INI_ERROR_INVALID_STREAM_OBJECT;
+	}
+	else if(!handlerCallback)
+	{
+		/* Invalid handler callback. */
+		return MICRO_INI_ERROR_INVALID_HANDLER_CALLBACK;
+	}
+	else if(!readerCallback)
+	{
+		/* Invalid reader callback. */
+		return MICRO_INI_ERROR_INVALID_READER_CALLBACK;
+	}
+	else if(!eofCallback)
+	{
+		/* Invalid eof callback. */
+		return MICRO_INI_ERROR_INVALID_EOF_CALLBACK;
+	}
+
+	/* The current line and section live in the state so they survive between calls. */
+	line = pState->pending;
+	section = pState->section;
+	last = (int) pState->pendingLength;
+
+	/* Clear the temporary data. */
+	line[last] = '\0';
+	key[0] = '\0';
+	val[0] = '\0';
+
+	pState->stopRequested = 0;
+	pState->finished = 0;
+
+	/* Read each line of the file. */
+	while(readerCallback(line + last, MICRO_INI_MAX_LINE_LENGTH - last, pStream) != NULL)
+	{
+		int stop = 0;
+
+		++pState->lineno;
+		pState->offset += strlen(line + last);
+
+		start = line;
+		len = (int) strlen(line) - 1;
+
+		if(pState->firstLine && (flags & MICRO_INI_FLAG_BOM) &&
+			(unsigned char) start[0] == 0xEF &&
+			(unsigned char) start[1] == 0xBB &&
+			(unsigned char) start[2] == 0xBF
+		)
+		{
+			/* Move the line just past the byte order marker. */
+			start += 3;
+		}
+
+		if(len <= 0)
+		{
+			/* Skip empty lines. */
+			continue;
+		}
+
+		/* Safety check against buffer overflows. */
+		if(line[len] != '\n' && eofCallback(pStream) == 0)
+		{
+			/* A buffer overflow occurs when the last character in the line is not '\n' and not at the end of the file stream. */
+			return MICRO_INI_ERROR_BUFFER_OVERFLOW;
+		}
+
+		/* Get rid of any whitespace characters at end of line (including newline characters). */
+		while((len >= 0) && isspace((unsigned char) line[len]))
+		{
+			line[len] = '\0';
+			--len;
+		}
+
+		/* Detect multi-line (a line made entirely of whitespace leaves nothing to check). */
+		if(len >= 0 && line[len] == '\\' && (flags & MICRO_INI_FLAG_MULTILINE))
 		{
 			/* Multi-line value. */
 			last = len;
+			pState->pendingLength = (uint32_t) last;
 			continue;
 		}
 		else
 		{
 			last = 0;
-			firstLine = 0;
+			pState->pendingLength = 0;
+			pState->firstLine = 0;
 		}
 
+		/* The length was measured from the start of the buffer, so account for a skipped byte order marker. */
+		len -= (int)(start - line);
+
 		/* Remove whitespace at the beginning of the line.  This must be done after checking for multi-line values. */
 		while((len >= 0) && isspace((unsigned char) *start))
 		{
@@ -365,31 +2081,50 @@ int micro_ini_load_stream(
 		}
 
 		/* Parse the line. */
-		switch(prv_micro_ini_parse_line(start, len, section, key, val))
+		status = MICRO_INI_PARSE_LINE(start, len, section, key, val);
+
+		if(status == LINE_SECTION && (flags & MICRO_INI_FLAG_INHERITANCE))
+		{
+			status = prv_micro_ini_split_parent(section, val);
+		}
+
+		switch(status)
 		{
 			case LINE_VALUE:
-				handlerCallback(pUserData, section, key, val);
+				if(flags & MICRO_INI_FLAG_FINGERPRINT)
+				{
+					micro_ini_fingerprint_add(&pState->fingerprint, section, key, val);
+				}
+
+				MICRO_INI_CALL_HANDLER(handlerCallback, pUserData, section, key, val, pState->lineno);
+				break;
+
+			case LINE_PARENT:
+				if(flags & MICRO_INI_FLAG_FINGERPRINT)
+				{
+					micro_ini_fingerprint_add(&pState->fingerprint, section, NULL, val);
+				}
+
+				handlerCallback(pUserData, section, NULL, val);
 				break;
 
 			case LINE_ERROR:
 				if(errorCallback)
 				{
 					/* Call the error function if it was provided. */
-					errorCallback(pUserData, line, lineno);
+					errorCallback(pUserData, line, (int) pState->lineno);
 				}
 
 				/* Keep track of the number of errors that have occurred. */
-				++numErrors;
+				++pState->numErrors;
 
 				if(flags & MICRO_INI_FLAG_STOP_ON_FIRST_ERROR)
 				{
-					return numErrors;
-				}
-				else
-				{
-					break;
+					stop = 1;
 				}
 
+				break;
+
 			case LINE_EMPTY:
 			case LINE_COMMENT:
 			case LINE_SECTION:
@@ -401,7 +2136,102 @@ int micro_ini_load_stream(
 
 		line[0] = '\0';
 		last = 0;
+
+		if(stop)
+		{
+			return MICRO_INI_SUCCESS + (int) pState->numErrors;
+		}
+		else if(pState->stopRequested)
+		{
+			/* Stopping only between lines leaves the state ready to be resumed. */
+			pState->stopRequested = 0;
+			return MICRO_INI_SUCCESS + (int) pState->numErrors;
+		}
 	}
 
-	return MICRO_INI_SUCCESS + numErrors;
+	pState->finished = 1;
+
+	return MICRO_INI_SUCCESS + (int) pState->numErrors;
+}
+
+
+#if defined(MICRO_INI_ENABLE_PROFILING)
+void micro_ini_profile_reset(micro_ini_profile* const pProfile)
+{
+	if(pProfile)
+	{
+		memset(pProfile, 0, sizeof(micro_ini_profile));
+	}
+}
+
+
+void micro_ini_profile_begin(micro_ini_profile* const pProfile)
+{
+	prv_micro_ini_active_profile = pProfile;
+}
+
+
+void micro_ini_profile_end(void)
+{
+	prv_micro_ini_active_profile = NULL;
+}
+
+
+size_t micro_ini_profile_top(
+	const micro_ini_profile* const pProfile,
+	const int order,
+	const micro_ini_profile_entry** const ppOutEntries,
+	const size_t maxEntries
+)
+{
+	const micro_ini_profile_entry* pEntry;
+	size_t count = 0;
+	size_t position;
+	size_t i;
+	uint64_t weight;
+
+	if(!pProfile || !ppOutEntries)
+	{
+		return 0;
+	}
+
+	/* Insertion into a short sorted list; the table is small and N is usually smaller. */
+	for(i = 0; i < MICRO_INI_PROFILE_SLOTS; ++i)
+	{
+		pEntry = &pProfile->entries[i];
+		if(pEntry->calls == 0)
+		{
+			continue;
+		}
+
+		weight = (order == MICRO_INI_PROFILE_BY_MAX) ? pEntry->maxNanoseconds : pEntry->totalNanoseconds;
+
+		for(position = count; position > 0; --position)
+		{
+			const micro_ini_profile_entry* const pOther = ppOutEntries[position - 1];
+
+			if(((order == MICRO_INI_PROFILE_BY_MAX) ? pOther->maxNanoseconds : pOther->totalNanoseconds) >= weight)
+			{
+				break;
+			}
+
+			if(position < maxEntries)
+			{
+				ppOutEntries[position] = pOther;
+			}
+		}
+
+		if(position < maxEntries)
+		{
+			ppOutEntries[position] = pEntry;
+
+			if(count < maxEntries)
+			{
+				++count;
+			}
+		}
+	}
+
+	return count;
 }
+#endif
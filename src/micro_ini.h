@@ -24,6 +24,7 @@
 
 #pragma once
 
+#include <stdint.h>
 #include <stdio.h>
 
 #define MICRO_INI_VERSION_MAJOR  1
@@ -38,6 +39,33 @@
 	MICRO_INI_STR(MICRO_INI_VERSION_MINOR) "." \
 	MICRO_INI_STR(MICRO_INI_VERSION_HOTFIX)
 
+/**
+ * Maximum length of a single line in the ini file.
+ */
+#define MICRO_INI_MAX_LINE_LENGTH 512
+
+/**
+ * Size of the block buffer used when reading from a file descriptor.
+ */
+#ifndef MICRO_INI_READ_BLOCK_SIZE
+	#define MICRO_INI_READ_BLOCK_SIZE 65536
+#endif
+
+/**
+ * Number of distinct (section, key) pairs a profile can hold (must be a power of two).
+ * Only used when MICRO_INI_ENABLE_PROFILING is defined.
+ */
+#ifndef MICRO_INI_PROFILE_SLOTS
+	#define MICRO_INI_PROFILE_SLOTS 128
+#endif
+
+/**
+ * Number of characters of each section and key name kept in a profile.
+ */
+#ifndef MICRO_INI_PROFILE_NAME_LENGTH
+	#define MICRO_INI_PROFILE_NAME_LENGTH 47
+#endif
+
 #define MICRO_INI_SUCCESS                         0 /* Parsing succeeded. */
 #define MICRO_INI_ERROR_INVALID_FILE_OBJECT      -1 /* FILE object is null. */
 #define MICRO_INI_ERROR_INVALID_STREAM_OBJECT    -2 /* Stream object is null. */
@@ -45,10 +73,25 @@
 #define MICRO_INI_ERROR_INVALID_READER_CALLBACK  -4 /* Reader callback is null. */
 #define MICRO_INI_ERROR_INVALID_EOF_CALLBACK     -5 /* EOF callback is null. */
 #define MICRO_INI_ERROR_BUFFER_OVERFLOW          -6 /* Attempting to read a line resulted in a string exceeding the maximum allowed length. */
+#define MICRO_INI_ERROR_OUT_OF_MEMORY            -7 /* An optional module was unable to allocate memory. */
+#define MICRO_INI_ERROR_INVALID_DOCUMENT         -8 /* Document output pointer is null. */
+#define MICRO_INI_ERROR_MEMORY_LIMIT             -9 /* An optional module would have exceeded its memory budget. */
+#define MICRO_INI_ERROR_INVALID_STATE_OBJECT    -10 /* Parser state object is null. */
+#define MICRO_INI_ERROR_READ_FAILED             -11 /* Reading from a file descriptor failed. */
+#define MICRO_INI_ERROR_INVALID_KEYSET          -12 /* Key set output pointer or key array is null. */
+#define MICRO_INI_ERROR_DUPLICATE_KEY           -13 /* The same key was registered more than once. */
+#define MICRO_INI_ERROR_KEY_NOT_FOUND           -14 /* The requested section or key does not exist. */
+#define MICRO_INI_ERROR_INVALID_VALUE           -15 /* A value could not be converted to the requested type. */
+#define MICRO_INI_ERROR_INVALID_ENUM_SET        -16 /* Enum set pointer, name or value array is null. */
+#define MICRO_INI_ERROR_WRITE_FAILED            -17 /* Writing a file failed. */
+#define MICRO_INI_ERROR_INVALID_IMAGE           -18 /* Image data is truncated, corrupt or from another platform. */
+#define MICRO_INI_ERROR_SYSTEM                  -19 /* A system call failed (errno holds the reason). */
 
 #define MICRO_INI_FLAG_BOM                 0x1 /* Enable support for the byte order marker in files with UTF-8 encoding. */
 #define MICRO_INI_FLAG_MULTILINE           0x2 /* Enable support for multi-line parsing. */
 #define MICRO_INI_FLAG_STOP_ON_FIRST_ERROR 0x4 /* Stop parsing when the first error has been reached. */
+#define MICRO_INI_FLAG_INHERITANCE         0x8 /* Enable "[child : parent]" section headers (see micro_ini_handler_fn). */
+#define MICRO_INI_FLAG_FINGERPRINT         0x10 /* Fingerprint the parsed pairs into the parser state (see micro_ini_fingerprint). */
 
 #ifdef _WIN32
 	#ifdef MICRO_INI_API_EXPORT
@@ -66,7 +109,13 @@
 extern "C" {
 #endif
 
-/* Key/value handling function. */
+/*
+ * Key/value handling function.
+ *
+ * With MICRO_INI_FLAG_INHERITANCE, a "[child : parent]" header opens the section "child"
+ * and is reported once with a NULL key and the parent's name as the value, before any
+ * of the section's keys.  Handlers that enable the flag must check for a NULL key.
+ */
 typedef void (*micro_ini_handler_fn)(void* pUserData, const char* section, const char* key, const char* value);
 
 /* Error handling function. */
@@ -78,6 +127,100 @@ typedef char* (*micro_ini_reader_fn)(char* str, int num, void* pStream);
 /* An feof-style function. */
 typedef int (*micro_ini_eof_fn)(void* pStream);
 
+/**
+ * Contiguous piece of a value (see micro_ini_load_buffer_segments()).
+ */
+typedef struct micro_ini_segment
+{
+	const char* data;  /* Start of the piece (not null terminated). */
+	size_t length;     /* Number of bytes in the piece. */
+} micro_ini_segment;
+
+#if defined(MICRO_INI_ENABLE_PROFILING)
+
+#define MICRO_INI_PROFILE_BY_TOTAL 0 /* Order a profile report by total time spent in the handler. */
+#define MICRO_INI_PROFILE_BY_MAX   1 /* Order a profile report by the slowest single call. */
+
+/**
+ * Time spent in the handler for one (section, key) pair.
+ */
+typedef struct micro_ini_profile_entry
+{
+	char section[MICRO_INI_PROFILE_NAME_LENGTH + 1];  /* Section name (truncated if too long). */
+	char key[MICRO_INI_PROFILE_NAME_LENGTH + 1];      /* Key name (truncated if too long). */
+
+	uint32_t hash;                /* Hash of the full section and key names (internal use only). */
+	uint32_t calls;               /* Number of handler calls. */
+	uint64_t totalNanoseconds;    /* Time spent in every call. */
+	uint64_t maxNanoseconds;      /* Time spent in the slowest call. */
+	uint32_t maxLineno;           /* Line number of the slowest call. */
+} micro_ini_profile_entry;
+
+/**
+ * Fixed-size table of handler timings, filled in while the profile is active (see
+ * micro_ini_profile_begin()).  Pairs arriving once every slot is taken are only
+ * counted in the overflow totals.
+ */
+typedef struct micro_ini_profile
+{
+	micro_ini_profile_entry entries[MICRO_INI_PROFILE_SLOTS];
+	uint32_t used;                      /* Number of slots taken. */
+	uint32_t overflowCalls;             /* Handler calls for pairs that did not fit in the table. */
+	uint64_t overflowNanoseconds;       /* Time spent in those calls. */
+} micro_ini_profile;
+
+#endif
+
+/* Key/value handling function that receives the value as a list of segments (a parent section is reported as a single segment). */
+typedef void (*micro_ini_segment_handler_fn)(void* pUserData, const char* section, const char* key, const micro_ini_segment* pSegments, size_t segmentCount);
+
+/**
+ * 128-bit fingerprint of the semantic content of an ini file: every section, key and
+ * value that is reported to the handler, along with "[child : parent]" links.
+ *
+ * Each pair is hashed on its own and the hashes are added together, so the fingerprint
+ * does not depend on the order of sections or keys and is unaffected by comments,
+ * blank lines, whitespace around names and values, quoting and line endings.  Two
+ * files with equal fingerprints can be treated as having the same content, so a
+ * reload can skip all further work after comparing both halves.  The hash is not
+ * cryptographic and should not be relied upon against deliberately crafted files.
+ *
+ * A key that appears more than once contributes each of its values; the document
+ * module's micro_ini_doc_fingerprint() only counts the final value of each key.
+ */
+typedef struct micro_ini_fingerprint
+{
+	uint64_t low;
+	uint64_t high;
+} micro_ini_fingerprint;
+
+/**
+ * Complete state of a parse in progress, used to stop parsing part way through a
+ * stream and resume it later.
+ *
+ * The state contains no pointers, so it may be copied byte for byte to a file or
+ * another process running on the same platform and resumed from there.  To resume,
+ * position the stream at the byte offset recorded in the state (micro_ini_resume()
+ * does this automatically) and pass the state to one of the micro_ini_resume*
+ * functions.  A partially joined multi-line value is carried in the state, so a
+ * stream may also be resumed after more data has been appended to it.
+ */
+typedef struct micro_ini_state
+{
+	uint64_t offset;         /* Number of bytes consumed from the stream. */
+	uint32_t lineno;         /* Number of lines read from the stream. */
+	uint32_t numErrors;      /* Number of parsing errors that have occurred. */
+	uint32_t firstLine;      /* Non-zero until the first complete line has been read (used to detect the byte order marker). */
+	uint32_t pendingLength;  /* Length of the multi-line value joined so far (0 when there is none). */
+	uint32_t stopRequested;  /* Set by micro_ini_state_stop() to stop parsing after the current line. */
+	uint32_t finished;       /* Set once the end of the stream has been reached. */
+
+	micro_ini_fingerprint fingerprint;  /* Fingerprint of the pairs parsed so far (only with MICRO_INI_FLAG_FINGERPRINT). */
+
+	char section[MICRO_INI_MAX_LINE_LENGTH + 1];  /* Name of the current section. */
+	char pending[MICRO_INI_MAX_LINE_LENGTH + 1];  /* Multi-line value joined so far. */
+} micro_ini_state;
+
 /**
  * @brief   Parse an ini file.
  * @return  Error code or number of parsing errors that occurred.
@@ -117,6 +260,9 @@ MICRO_INI_API int micro_ini_load(
  * will be INI_SUCCESS when parsing succeeds.  A return value less
  * than 0 will be a specific error (INI_ERROR_*) and above 0 indicates
  * the number of parsing errors that occurred.
+ *
+ * The FILE object stays locked for the duration of the parse, so the
+ * callbacks must not wait on another thread that uses the same FILE object.
  */
 MICRO_INI_API int micro_ini_load_file(
 	FILE* const pFile,
@@ -157,6 +303,312 @@ MICRO_INI_API int micro_ini_load_stream(
 	void* const pUserData
 );
 
+/**
+ * @brief   Parse an ini file that has already been loaded into memory.
+ * @return  Error code or number of parsing errors that occurred.
+ *
+ * @param[in]  pData            Contents of the ini file (does not need to be null terminated).
+ * @param[in]  size             Number of bytes in the ini file.
+ * @param[in]  flags            Flags for configuring the parser.
+ * @param[in]  handlerCallback  Callback for handling parsed key/value pairs.
+ * @param[in]  errorCallback    Callback for handling parsing errors (this callback is optional and may be NULL if unneeded).
+ * @param[in]  pUserData        Pointer to user data that is passed to the callbacks.
+ *
+ * The results are identical to parsing the same bytes with micro_ini_load_stream().
+ */
+MICRO_INI_API int micro_ini_load_buffer(
+	const char* const pData,
+	const size_t size,
+	const int flags,
+	const micro_ini_handler_fn handlerCallback,
+	const micro_ini_error_fn errorCallback,
+	void* const pUserData
+);
+
+/**
+ * @brief   Parse an in-memory ini file, receiving values as segments.
+ * @return  Error code or number of parsing errors that occurred.
+ *
+ * @param[in]  pData            Contents of the ini file (does not need to be null terminated).
+ * @param[in]  size             Number of bytes in the ini file.
+ * @param[in]  flags            Flags for configuring the parser.
+ * @param[in]  pSegments        Scratch array used to describe values that span several lines.
+ * @param[in]  maxSegments      Number of elements in the scratch array.
+ * @param[in]  segmentCallback  Callback for handling parsed key/value pairs.
+ * @param[in]  errorCallback    Callback for handling parsing errors (this callback is optional and may be NULL if unneeded).
+ * @param[in]  pUserData        Pointer to user data that is passed to the callbacks.
+ *
+ * Values are given to the callback as a list of segments that are only valid
+ * until the callback returns; micro_ini_join_segments() copies them into a
+ * single string when one is needed.  Empty values have no segments.
+ *
+ * Every value that fits within MICRO_INI_MAX_LINE_LENGTH is parsed exactly
+ * like micro_ini_load_buffer() and given as a single segment.  When
+ * MICRO_INI_FLAG_MULTILINE is set and a multi-line value is too long to
+ * join, it is not copied at all.  Instead, the value is given as one
+ * segment per line pointing into pData, with the trailing backslash of each
+ * continued line left out, so values of any length are parsed in linear
+ * time.  As usual, the value ends at the first unquoted ';' or '#', and the
+ * whitespace around it is removed.  A value needs at most one segment per line, so the scratch
+ * array only runs out (MICRO_INI_ERROR_BUFFER_OVERFLOW) when a value spans
+ * more than maxSegments lines.
+ */
+MICRO_INI_API int micro_ini_load_buffer_segments(
+	const char* const pData,
+	const size_t size,
+	const int flags,
+	micro_ini_segment* const pSegments,
+	const size_t maxSegments,
+	const micro_ini_segment_handler_fn segmentCallback,
+	const micro_ini_error_fn errorCallback,
+	void* const pUserData
+);
+
+/**
+ * @brief   Join a list of segments into a single null terminated string.
+ * @return  Total length of the joined segments, not counting the null terminator.
+ *
+ * @param[out] pOut          Output string (may be NULL when outSize is 0).
+ * @param[in]  outSize       Size of the output string, including the null terminator.
+ * @param[in]  pSegments     Segments to join.
+ * @param[in]  segmentCount  Number of segments to join.
+ *
+ * Like snprintf(), the output is truncated to fit and the return value is the
+ * length the complete string would have, so a first call with an outSize of 0
+ * may be used to size the output string.
+ */
+MICRO_INI_API size_t micro_ini_join_segments(
+	char* const pOut,
+	const size_t outSize,
+	const micro_ini_segment* const pSegments,
+	const size_t segmentCount
+);
+
+/**
+ * @brief   Parse an ini file from a file descriptor.
+ * @return  Error code or number of parsing errors that occurred.
+ *
+ * @param[in]  fd               Open file descriptor referencing the ini file.
+ * @param[in]  flags            Flags for configuring the parser.
+ * @param[in]  handlerCallback  Callback for handling parsed key/value pairs.
+ * @param[in]  errorCallback    Callback for handling parsing errors (this callback is optional and may be NULL if unneeded).
+ * @param[in]  pUserData        Pointer to user data that is passed to the callbacks.
+ *
+ * The descriptor is consumed with large reads into a block buffer of
+ * MICRO_INI_READ_BLOCK_SIZE bytes rather than through stdio, which makes this
+ * the preferred entry point for pipes, sockets and standard input.  Regular
+ * files are advised for sequential access where the platform supports it.
+ * When the descriptor is seekable, it is left positioned just past the last
+ * line that was parsed.  The descriptor is not closed.
+ */
+MICRO_INI_API int micro_ini_load_fd(
+	const int fd,
+	const int flags,
+	const micro_ini_handler_fn handlerCallback,
+	const micro_ini_error_fn errorCallback,
+	void* const pUserData
+);
+
+/**
+ * @brief  Prepare a parser state for parsing a stream from the beginning.
+ *
+ * @param[out] pState  State to initialize.
+ */
+MICRO_INI_API void micro_ini_state_init(micro_ini_state* const pState);
+
+/**
+ * @brief  Ask a parse in progress to stop once the current line has been handled.
+ *
+ * @param[in]  pState  State of the parse to stop.
+ *
+ * This is intended to be called from the handler or error callbacks (for example,
+ * once a time budget has run out).  The micro_ini_resume* function that is running
+ * returns after the current line, leaving the state ready to be resumed.
+ */
+MICRO_INI_API void micro_ini_state_stop(micro_ini_state* const pState);
+
+/**
+ * @brief  Add one pair to a fingerprint.
+ *
+ * @param[in]  pFingerprint  Fingerprint to update (initialize it to zero).
+ * @param[in]  section       Section of the pair.
+ * @param[in]  key           Key of the pair, or NULL for a "[child : parent]" link.
+ * @param[in]  value         Value of the pair, or the name of the parent section.
+ *
+ * The micro_ini_resume* functions call this for every pair when MICRO_INI_FLAG_FINGERPRINT
+ * is set, accumulating into the state.  It is public so that content held elsewhere can
+ * be fingerprinted the same way and compared against a parse.
+ */
+MICRO_INI_API void micro_ini_fingerprint_add(
+	micro_ini_fingerprint* const pFingerprint,
+	const char* const section,
+	const char* const key,
+	const char* const value
+);
+
+/**
+ * @brief   Parse or resume parsing an ini file.
+ * @return  Error code or total number of parsing errors that have occurred in the stream.
+ *
+ * @param[in]  pState           Parser state (updated in place).
+ * @param[in]  filePath         Path to the ini file to read.
+ * @param[in]  flags            Flags for configuring the parser.
+ * @param[in]  handlerCallback  Callback for handling parsed key/value pairs.
+ * @param[in]  errorCallback    Callback for handling parsing errors (this callback is optional and may be NULL if unneeded).
+ * @param[in]  pUserData        Pointer to user data that is passed to the callbacks.
+ *
+ * The file is opened in binary mode and positioned at the byte offset recorded in
+ * the state, so none of the lines that were already parsed are read again.  Check
+ * the state's finished field to tell whether the end of the file was reached.
+ */
+MICRO_INI_API int micro_ini_resume(
+	micro_ini_state* const pState,
+	const char* const filePath,
+	const int flags,
+	const micro_ini_handler_fn handlerCallback,
+	const micro_ini_error_fn errorCallback,
+	void* const pUserData
+);
+
+/**
+ * @brief   Parse or resume parsing an ini file from a FILE object.
+ * @return  Error code or total number of parsing errors that have occurred in the stream.
+ *
+ * @param[in]  pState           Parser state (updated in place).
+ * @param[in]  pFile            Pointer to an existing FILE object, positioned at the offset recorded in the state.
+ * @param[in]  flags            Flags for configuring the parser.
+ * @param[in]  handlerCallback  Callback for handling parsed key/value pairs.
+ * @param[in]  errorCallback    Callback for handling parsing errors (this callback is optional and may be NULL if unneeded).
+ * @param[in]  pUserData        Pointer to user data that is passed to the callbacks.
+ */
+MICRO_INI_API int micro_ini_resume_file(
+	micro_ini_state* const pState,
+	FILE* const pFile,
+	const int flags,
+	const micro_ini_handler_fn handlerCallback,
+	const micro_ini_error_fn errorCallback,
+	void* const pUserData
+);
+
+/**
+ * @brief   Parse or resume parsing an ini file from a file descriptor.
+ * @return  Error code or total number of parsing errors that have occurred in the stream.
+ *
+ * @param[in]  pState           Parser state (updated in place).
+ * @param[in]  fd               Open file descriptor, positioned at the offset recorded in the state.
+ * @param[in]  flags            Flags for configuring the parser.
+ * @param[in]  handlerCallback  Callback for handling parsed key/value pairs.
+ * @param[in]  errorCallback    Callback for handling parsing errors (this callback is optional and may be NULL if unneeded).
+ * @param[in]  pUserData        Pointer to user data that is passed to the callbacks.
+ *
+ * Data read past the point where parsing stopped is handed back to seekable
+ * descriptors, so the descriptor stays positioned at the offset recorded in
+ * the state.  On pipes and sockets that data is lost, so stopping part way
+ * through is only useful there when the rest of the stream is abandoned.
+ */
+MICRO_INI_API int micro_ini_resume_fd(
+	micro_ini_state* const pState,
+	const int fd,
+	const int flags,
+	const micro_ini_handler_fn handlerCallback,
+	const micro_ini_error_fn errorCallback,
+	void* const pUserData
+);
+
+/**
+ * @brief   Parse or resume parsing an in-memory ini file.
+ * @return  Error code or total number of parsing errors that have occurred in the stream.
+ *
+ * @param[in]  pState           Parser state (updated in place).
+ * @param[in]  pData            Contents of the ini file, from the very beginning (does not need to be null terminated).
+ * @param[in]  size             Number of bytes in the ini file.
+ * @param[in]  flags            Flags for configuring the parser.
+ * @param[in]  handlerCallback  Callback for handling parsed key/value pairs.
+ * @param[in]  errorCallback    Callback for handling parsing errors (this callback is optional and may be NULL if unneeded).
+ * @param[in]  pUserData        Pointer to user data that is passed to the callbacks.
+ *
+ * Parsing picks up at the byte offset recorded in the state, which makes this a
+ * cheap way to walk a buffer a few pairs at a time with micro_ini_state_stop().
+ */
+MICRO_INI_API int micro_ini_resume_buffer(
+	micro_ini_state* const pState,
+	const char* const pData,
+	const size_t size,
+	const int flags,
+	const micro_ini_handler_fn handlerCallback,
+	const micro_ini_error_fn errorCallback,
+	void* const pUserData
+);
+
+/**
+ * @brief   Parse or resume parsing an ini file from a custom stream object.
+ * @return  Error code or total number of parsing errors that have occurred in the stream.
+ *
+ * @param[in]  pState           Parser state (updated in place).
+ * @param[in]  pStream          Pointer to an existing stream object, positioned at the offset recorded in the state.
+ * @param[in]  flags            Flags for configuring the parser.
+ * @param[in]  handlerCallback  Callback for handling parsed key/value pairs.
+ * @param[in]  errorCallback    Callback for handling parsing errors (this callback is optional and may be NULL if unneeded).
+ * @param[in]  readerCallback   Callback for reading lines in the ini file (must conform to fgets() functionality).
+ * @param[in]  eofCallback      Callback for checking if the end of the ini file has been reached (must conform to feof() functionality).
+ * @param[in]  pUserData        Pointer to user data that is passed to the callbacks.
+ */
+MICRO_INI_API int micro_ini_resume_stream(
+	micro_ini_state* const pState,
+	void* const pStream,
+	const int flags,
+	const micro_ini_handler_fn handlerCallback,
+	const micro_ini_error_fn errorCallback,
+	const micro_ini_reader_fn readerCallback,
+	const micro_ini_eof_fn eofCallback,
+	void* const pUserData
+);
+
+#if defined(MICRO_INI_ENABLE_PROFILING)
+
+/**
+ * @brief  Clear a profile.
+ *
+ * @param[in]  pProfile  Profile to clear.
+ */
+MICRO_INI_API void micro_ini_profile_reset(micro_ini_profile* const pProfile);
+
+/**
+ * @brief  Start timing handler calls on the calling thread.
+ *
+ * @param[in]  pProfile  Profile receiving the timings (cleared with micro_ini_profile_reset() beforehand).
+ *
+ * Every key/value pair passed to a handler by the load and resume functions on this
+ * thread is timed with a monotonic clock until micro_ini_profile_end() is called, so
+ * timings from several loads accumulate in the same profile.  Define
+ * MICRO_INI_ENABLE_PROFILING when building both MicroIni and the code using it; without
+ * it, none of this is compiled and handlers are called directly.
+ */
+MICRO_INI_API void micro_ini_profile_begin(micro_ini_profile* const pProfile);
+
+/**
+ * @brief  Stop timing handler calls on the calling thread.
+ */
+MICRO_INI_API void micro_ini_profile_end(void);
+
+/**
+ * @brief   Find the pairs that spent the most time in the handler.
+ * @return  Number of entries written.
+ *
+ * @param[in]  pProfile      Profile to report on.
+ * @param[in]  order         MICRO_INI_PROFILE_BY_TOTAL or MICRO_INI_PROFILE_BY_MAX.
+ * @param[out] ppOutEntries  Array receiving pointers to the entries, slowest first.
+ * @param[in]  maxEntries    Number of entries to report.
+ */
+MICRO_INI_API size_t micro_ini_profile_top(
+	const micro_ini_profile* const pProfile,
+	const int order,
+	const micro_ini_profile_entry** const ppOutEntries,
+	const size_t maxEntries
+);
+
+#endif
+
 #ifdef __cplusplus
 }
 #endif
@@ -0,0 +1,333 @@
+/**
+ * Copyright (c) 2021, Zoe J. Bare
+ *
+ * MIT License
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ */
+
+#include "micro_ini_alloc.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+/* Value of micro_ini_arena::last before the first block has been handed out. */
+#define MICRO_INI_ARENA_NO_BLOCK ((size_t) -1)
+
+/**
+ * Header stored in front of every block allocated through an allocator (internal use only).
+ * The union keeps the block that follows it aligned for any type.
+ */
+typedef union micro_ini_allocator_block
+{
+	size_t size;
+	double alignDouble;
+	void*  alignPointer;
+	long   alignLong;
+} micro_ini_allocator_block;
+
+/**
+ * @brief   Allocate from the system heap (internal use only).
+ * @return  New block, or NULL if out of memory.
+ */
+static void* prv_micro_ini_heap_allocate(void* const pUserData, const size_t size)
+{
+	(void) pUserData;
+
+	return malloc(size);
+}
+
+/**
+ * @brief   Resize a block of the system heap (internal use only).
+ * @return  Resized block, or NULL if out of memory.
+ */
+static void* prv_micro_ini_heap_reallocate(void* const pUserData, void* const pBlock, const size_t oldSize, const size_t newSize)
+{
+	(void) pUserData;
+	(void) oldSize;
+
+	return realloc(pBlock, newSize);
+}
+
+/**
+ * @brief  Release a block of the system heap (internal use only).
+ */
+static void prv_micro_ini_heap_deallocate(void* const pUserData, void* const pBlock, const size_t size)
+{
+	(void) pUserData;
+	(void) size;
+
+	free(pBlock);
+}
+
+/**
+ * @brief   Round a size up so the next block stays aligned for any type (internal use only).
+ * @return  Rounded size, or 0 if it would overflow.
+ */
+static size_t prv_micro_ini_arena_round(const size_t size)
+{
+	const size_t alignment = sizeof(micro_ini_allocator_block);
+
+	if(size > ((size_t) -1) - (alignment - 1))
+	{
+		return 0;
+	}
+
+	return (size + alignment - 1) / alignment * alignment;
+}
+
+/**
+ * @brief   Check whether a block is the most recent block of an arena (internal use only).
+ * @return  Non-zero if it is.
+ */
+static int prv_micro_ini_arena_is_last(const micro_ini_arena* const pArena, const void* const pBlock)
+{
+	return pArena->last != MICRO_INI_ARENA_NO_BLOCK && (const unsigned char*) pBlock == pArena->pBuffer + pArena->last;
+}
+
+/**
+ * @brief   Carve a block from an arena (internal use only).
+ * @return  New block, or NULL if the arena is full.
+ */
+static void* prv_micro_ini_arena_allocate(void* const pUserData, const size_t size)
+{
+	micro_ini_arena* const pArena = (micro_ini_arena*) pUserData;
+	const size_t rounded = prv_micro_ini_arena_round(size);
+
+	if(rounded == 0 || rounded > pArena->size - pArena->used)
+	{
+		return NULL;
+	}
+
+	pArena->last = pArena->used;
+	pArena->used += rounded;
+
+	return pArena->pBuffer + pArena->last;
+}
+
+/**
+ * @brief   Resize a block of an arena, in place when it is the most recent one (internal use only).
+ * @return  Resized block, or NULL if the arena is full.
+ */
+static void* prv_micro_ini_arena_reallocate(void* const pUserData, void* const pBlock, const size_t oldSize, const size_t newSize)
+{
+	micro_ini_arena* const pArena = (micro_ini_arena*) pUserData;
+	const size_t rounded = prv_micro_ini_arena_round(newSize);
+	unsigned char* pNewBlock;
+
+	if(prv_micro_ini_arena_is_last(pArena, pBlock))
+	{
+		if(rounded == 0 || rounded > pArena->size - pArena->last)
+		{
+			return NULL;
+		}
+
+		pArena->used = pArena->last + rounded;
+
+		return pBlock;
+	}
+
+	pNewBlock = (unsigned char*) prv_micro_ini_arena_allocate(pArena, newSize);
+	if(pNewBlock)
+	{
+		memcpy(pNewBlock, pBlock, (oldSize < newSize) ? oldSize : newSize);
+	}
+
+	return pNewBlock;
+}
+
+/**
+ * @brief  Release a block of an arena, which only gives memory back for the most recent block (internal use only).
+ */
+static void prv_micro_ini_arena_deallocate(void* const pUserData, void* const pBlock, const size_t size)
+{
+	micro_ini_arena* const pArena = (micro_ini_arena*) pUserData;
+
+	(void) size;
+
+	if(prv_micro_ini_arena_is_last(pArena, pBlock))
+	{
+		pArena->used = pArena->last;
+	}
+}
+
+/**
+ * @brief  Count a change in the memory held by an allocator (internal use only).
+ */
+static void prv_micro_ini_allocator_account(micro_ini_allocator* const pAllocator, const size_t oldSize, const size_t newSize)
+{
+	pAllocator->stats.bytesInUse = pAllocator->stats.bytesInUse - oldSize + newSize;
+
+	if(pAllocator->stats.bytesInUse > pAllocator->stats.peakBytes)
+	{
+		pAllocator->stats.peakBytes = pAllocator->stats.bytesInUse;
+	}
+}
+
+
+void micro_ini_allocator_init(micro_ini_allocator* const pAllocator)
+{
+	if(pAllocator)
+	{
+		memset(pAllocator, 0, sizeof(micro_ini_allocator));
+
+		pAllocator->allocate = prv_micro_ini_heap_allocate;
+		pAllocator->reallocate = prv_micro_ini_heap_reallocate;
+		pAllocator->deallocate = prv_micro_ini_heap_deallocate;
+	}
+}
+
+
+void* micro_ini_allocator_alloc(micro_ini_allocator* const pAllocator, const size_t size)
+{
+	return micro_ini_allocator_realloc(pAllocator, NULL, size);
+}
+
+
+void* micro_ini_allocator_calloc(micro_ini_allocator* const pAllocator, const size_t count, const size_t size)
+{
+	void* pBlock;
+
+	if(size != 0 && count > ((size_t) -1) / size)
+	{
+		return NULL;
+	}
+
+	pBlock = micro_ini_allocator_alloc(pAllocator, count * size);
+	if(pBlock)
+	{
+		memset(pBlock, 0, count * size);
+	}
+
+	return pBlock;
+}
+
+
+void* micro_ini_allocator_realloc(micro_ini_allocator* const pAllocator, void* const pBlock, const size_t size)
+{
+	micro_ini_allocator_block* const pHeader = pBlock ? ((micro_ini_allocator_block*) pBlock) - 1 : NULL;
+	micro_ini_allocator_block* pNewHeader;
+	size_t oldSize;
+
+	if(!pAllocator)
+	{
+		return realloc(pBlock, size);
+	}
+
+	if(size > ((size_t) -1) - sizeof(micro_ini_allocator_block))
+	{
+		++pAllocator->stats.failures;
+		return NULL;
+	}
+
+	oldSize = pHeader ? sizeof(micro_ini_allocator_block) + pHeader->size : 0;
+
+	pNewHeader = pHeader
+		? (micro_ini_allocator_block*) pAllocator->reallocate(pAllocator->pUserData, pHeader, oldSize, sizeof(micro_ini_allocator_block) + size)
+		: (micro_ini_allocator_block*) pAllocator->allocate(pAllocator->pUserData, sizeof(micro_ini_allocator_block) + size);
+
+	if(!pNewHeader)
+	{
+		++pAllocator->stats.failures;
+		return NULL;
+	}
+
+	if(pHeader)
+	{
+		++pAllocator->stats.reallocations;
+	}
+	else
+	{
+		++pAllocator->stats.allocations;
+	}
+
+	pNewHeader->size = size;
+	prv_micro_ini_allocator_account(pAllocator, oldSize, sizeof(micro_ini_allocator_block) + size);
+
+	return pNewHeader + 1;
+}
+
+
+void micro_ini_allocator_free(micro_ini_allocator* const pAllocator, void* const pBlock)
+{
+	micro_ini_allocator_block* pHeader;
+	size_t size;
+
+	if(!pAllocator)
+	{
+		free(pBlock);
+		return;
+	}
+
+	if(!pBlock)
+	{
+		return;
+	}
+
+	pHeader = ((micro_ini_allocator_block*) pBlock) - 1;
+	size = sizeof(micro_ini_allocator_block) + pHeader->size;
+
+	++pAllocator->stats.frees;
+	prv_micro_ini_allocator_account(pAllocator, size, 0);
+
+	pAllocator->deallocate(pAllocator->pUserData, pHeader, size);
+}
+
+
+void micro_ini_arena_init(micro_ini_arena* const pArena, void* const pBuffer, const size_t size)
+{
+	size_t skip;
+
+	if(!pArena)
+	{
+		return;
+	}
+
+	memset(pArena, 0, sizeof(micro_ini_arena));
+
+	pArena->allocator.allocate = prv_micro_ini_arena_allocate;
+	pArena->allocator.reallocate = prv_micro_ini_arena_reallocate;
+	pArena->allocator.deallocate = prv_micro_ini_arena_deallocate;
+	pArena->allocator.pUserData = pArena;
+
+	if(pBuffer)
+	{
+		/* Start at the first suitably aligned address of the buffer. */
+		skip = (sizeof(micro_ini_allocator_block) - (size_t) pBuffer % sizeof(micro_ini_allocator_block)) % sizeof(micro_ini_allocator_block);
+
+		if(size > skip)
+		{
+			pArena->pBuffer = (unsigned char*) pBuffer + skip;
+			pArena->size = size - skip;
+		}
+	}
+
+	pArena->last = MICRO_INI_ARENA_NO_BLOCK;
+}
+
+
+void micro_ini_arena_reset(micro_ini_arena* const pArena)
+{
+	if(pArena)
+	{
+		pArena->used = 0;
+		pArena->last = MICRO_INI_ARENA_NO_BLOCK;
+		memset(&pArena->allocator.stats, 0, sizeof(micro_ini_allocator_stats));
+	}
+}
@@ -0,0 +1,159 @@
+/**
+ * Copyright (c) 2021, Zoe J. Bare
+ *
+ * MIT License
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ */
+
+#pragma once
+
+#include "micro_ini.h"
+
+#include <stddef.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * Allocation statistics kept by an allocator.  Every size includes the small header
+ * placed in front of each block.
+ */
+typedef struct micro_ini_allocator_stats
+{
+	size_t allocations;    /* Blocks allocated. */
+	size_t reallocations;  /* Blocks resized. */
+	size_t frees;          /* Blocks released. */
+	size_t failures;       /* Requests that could not be satisfied. */
+	size_t bytesInUse;     /* Bytes currently allocated. */
+	size_t peakBytes;      /* Highest value bytesInUse has reached. */
+} micro_ini_allocator_stats;
+
+/**
+ * Memory allocator accepted by the optional modules (the document, image, compat,
+ * key set, enum and served modules).  The core parser never allocates.
+ *
+ * Passing NULL wherever an allocator is accepted uses malloc(), realloc() and free()
+ * directly.  Otherwise every block is requested from the callbacks along with its
+ * size, so pools and arenas don't have to record sizes themselves, and is counted in
+ * the allocator's statistics.  Giving each module its own allocator therefore measures
+ * the memory of each module separately.
+ *
+ * The statistics are updated without synchronization, so an allocator must not be
+ * used by several threads at once (its callbacks are only called from the module
+ * functions that allocate, never from lookups).  An allocator must outlive every
+ * object that was created with it.
+ */
+typedef struct micro_ini_allocator
+{
+	/* Allocate a block suitably aligned for any type, or return NULL. */
+	void* (*allocate)(void* pUserData, size_t size);
+
+	/* Resize a block, preserving its contents, or return NULL and leave it untouched. */
+	void* (*reallocate)(void* pUserData, void* pBlock, size_t oldSize, size_t newSize);
+
+	/* Release a block. */
+	void (*deallocate)(void* pUserData, void* pBlock, size_t size);
+
+	void* pUserData;  /* Passed to each callback. */
+
+	micro_ini_allocator_stats stats;
+} micro_ini_allocator;
+
+/**
+ * Bump allocator over a caller-supplied buffer.  Blocks are carved from the buffer in
+ * order and only released all at once by micro_ini_arena_reset(); releasing or resizing
+ * the most recent block is the exception and happens in place.  The arena never calls
+ * malloc(), so it suits targets without a heap, and loading a document into a fresh
+ * arena makes freeing it free.
+ */
+typedef struct micro_ini_arena
+{
+	micro_ini_allocator allocator;  /* Pass &arena.allocator to the modules. */
+
+	unsigned char* pBuffer;
+	size_t size;
+	size_t used;  /* Bytes handed out so far. */
+	size_t last;  /* Offset of the most recent block. */
+} micro_ini_arena;
+
+/**
+ * @brief  Set up an allocator backed by malloc(), realloc() and free() that keeps statistics.
+ *
+ * @param[out] pAllocator  Allocator to initialize.
+ */
+MICRO_INI_API void micro_ini_allocator_init(micro_ini_allocator* const pAllocator);
+
+/**
+ * @brief   Allocate a block.
+ * @return  New block, or NULL if out of memory.
+ *
+ * @param[in]  pAllocator  Allocator to use (NULL for malloc()).
+ * @param[in]  size        Size of the block in bytes.
+ */
+MICRO_INI_API void* micro_ini_allocator_alloc(micro_ini_allocator* const pAllocator, const size_t size);
+
+/**
+ * @brief   Allocate a zero-filled array.
+ * @return  New block, or NULL if out of memory.
+ *
+ * @param[in]  pAllocator  Allocator to use (NULL for calloc()).
+ * @param[in]  count       Number of elements.
+ * @param[in]  size        Size of each element in bytes.
+ */
+MICRO_INI_API void* micro_ini_allocator_calloc(micro_ini_allocator* const pAllocator, const size_t count, const size_t size);
+
+/**
+ * @brief   Resize a block.
+ * @return  Resized block, or NULL if out of memory (the original block is left untouched).
+ *
+ * @param[in]  pAllocator  Allocator the block came from (NULL for realloc()).
+ * @param[in]  pBlock      Block to resize (NULL to allocate a new block).
+ * @param[in]  size        New size of the block in bytes.
+ */
+MICRO_INI_API void* micro_ini_allocator_realloc(micro_ini_allocator* const pAllocator, void* const pBlock, const size_t size);
+
+/**
+ * @brief  Release a block.
+ *
+ * @param[in]  pAllocator  Allocator the block came from (NULL for free()).
+ * @param[in]  pBlock      Block to release (may be NULL).
+ */
+MICRO_INI_API void micro_ini_allocator_free(micro_ini_allocator* const pAllocator, void* const pBlock);
+
+/**
+ * @brief  Set up an arena over a buffer.
+ *
+ * @param[out] pArena   Arena to initialize.
+ * @param[in]  pBuffer  Memory the arena hands out, which must outlive it.
+ * @param[in]  size     Size of the buffer in bytes.
+ */
+MICRO_INI_API void micro_ini_arena_init(micro_ini_arena* const pArena, void* const pBuffer, const size_t size);
+
+/**
+ * @brief  Release every block of an arena at once and clear its statistics.
+ *
+ * @param[in]  pArena  Arena to reset (nothing allocated from it may be used afterwards).
+ */
+MICRO_INI_API void micro_ini_arena_reset(micro_ini_arena* const pArena);
+
+#ifdef __cplusplus
+}
+#endif
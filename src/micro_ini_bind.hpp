@@ -0,0 +1,675 @@
+/**
+ * Copyright (c) 2021, Zoe J. Bare
+ *
+ * MIT License
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ */
+
+#pragma once
+
+#include "micro_ini.h"
+
+#include <cerrno>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <iterator>
+#include <limits>
+#include <string>
+#include <string_view>
+#include <type_traits>
+
+/**
+ * Seeds tried for each bucket of a bound struct's perfect hash before giving up.  A
+ * bucket rarely needs more than a handful, so running out means the table can't be
+ * built and MICRO_INI_BIND fails to compile, rather than the compiler searching all
+ * 2^32 seeds.
+ */
+#ifndef MICRO_INI_BIND_MAX_SEEDS
+	#define MICRO_INI_BIND_MAX_SEEDS 4096
+#endif
+
+namespace micro_ini
+{
+
+/* Conversion failure handling function. */
+typedef void (*bind_error_fn)(void* pUserData, const char* section, const char* key, const char* value);
+
+/**
+ * Converts a value string to a field type.  Specialize this for types the built-in
+ * converters don't cover; the specialization needs a static
+ * bool parse(const char* value, T& out) that returns false when the value is invalid.
+ */
+template<typename T, typename = void>
+struct converter;
+
+/* Signed and unsigned integers, in decimal, hexadecimal (0x) or octal (leading 0). */
+template<typename T>
+struct converter<T, std::enable_if_t<std::is_integral_v<T> && !std::is_same_v<T, bool>>>
+{
+	static bool parse(const char* const value, T& out)
+	{
+		char* end = nullptr;
+
+		errno = 0;
+
+		if constexpr(std::is_signed_v<T>)
+		{
+			const long long parsed = std::strtoll(value, &end, 0);
+
+			if(end == value || *end != '\0' || errno == ERANGE ||
+				parsed < static_cast<long long>(std::numeric_limits<T>::min()) ||
+				parsed > static_cast<long long>(std::numeric_limits<T>::max()))
+			{
+				return false;
+			}
+
+			out = static_cast<T>(parsed);
+		}
+		else
+		{
+			const unsigned long long parsed = std::strtoull(value, &end, 0);
+
+			if(end == value || *end != '\0' || errno == ERANGE || value[0] == '-' ||
+				parsed > static_cast<unsigned long long>(std::numeric_limits<T>::max()))
+			{
+				return false;
+			}
+
+			out = static_cast<T>(parsed);
+		}
+
+		return true;
+	}
+};
+
+/* Floating point numbers. */
+template<typename T>
+struct converter<T, std::enable_if_t<std::is_floating_point_v<T>>>
+{
+	static bool parse(const char* const value, T& out)
+	{
+		char* end = nullptr;
+		const long double parsed = std::strtold(value, &end);
+
+		if(end == value || *end != '\0')
+		{
+			return false;
+		}
+
+		out = static_cast<T>(parsed);
+
+		return true;
+	}
+};
+
+/* Booleans: true/false, yes/no, on/off and 1/0, in any case. */
+template<>
+struct converter<bool>
+{
+	static bool parse(const char* const value, bool& out)
+	{
+		static const char* const names[] = { "true", "false", "yes", "no", "on", "off", "1", "0" };
+
+		for(std::size_t index = 0; index < std::size(names); ++index)
+		{
+			const char* a = value;
+			const char* b = names[index];
+
+			while(*a && *b && (*a | 0x20) == *b)
+			{
+				++a;
+				++b;
+			}
+
+			if(*a == '\0' && *b == '\0')
+			{
+				/* Even entries are the true names. */
+				out = (index % 2) == 0;
+				return true;
+			}
+		}
+
+		return false;
+	}
+};
+
+/* Strings are copied as they are. */
+template<typename Traits, typename Allocator>
+struct converter<std::basic_string<char, Traits, Allocator>>
+{
+	static bool parse(const char* const value, std::basic_string<char, Traits, Allocator>& out)
+	{
+		out.assign(value);
+		return true;
+	}
+};
+
+/**
+ * @brief   Convert a value string with the converter for the output's type.
+ * @return  False if the value is not valid for the type.
+ *
+ * @param[in]  value  Value string.
+ * @param[out] out    Converted value (left untouched on failure).
+ */
+template<typename T>
+bool convert(const char* const value, T& out)
+{
+	T converted = out;
+
+	if(!converter<T>::parse(value, converted))
+	{
+		return false;
+	}
+
+	out = std::move(converted);
+
+	return true;
+}
+
+/**
+ * Field of a bound struct (internal use only; produced by MICRO_INI_BIND).
+ */
+template<typename T>
+struct bind_field
+{
+	const char* section;
+	const char* key;
+	std::size_t sectionLength;
+	std::size_t keyLength;
+	bool (*assign)(T& object, const char* value);
+};
+
+/**
+ * Compile-time key table of a struct.  Only specialized by MICRO_INI_BIND.
+ */
+template<typename T>
+struct binding;
+
+/* Mix the bits of a hash (internal use only). */
+constexpr std::uint32_t prv_bind_mix(std::uint32_t h)
+{
+	h ^= h >> 16;
+	h *= 0x7FEB352DU;
+	h ^= h >> 15;
+	h *= 0x846CA68BU;
+	h ^= h >> 16;
+
+	return h;
+}
+
+/* Hash a section and key pair, the same way at compile time and at run time (internal use only). */
+constexpr std::uint32_t prv_bind_hash(const char* const section, const std::size_t sectionLength, const char* const key, const std::size_t keyLength)
+{
+	std::uint32_t h = 2166136261U;
+	std::size_t index = 0;
+
+	for(index = 0; index < sectionLength; ++index)
+	{
+		h = (h ^ static_cast<unsigned char>(section[index])) * 16777619U;
+	}
+
+	/* Separate the names so ("ab", "c") and ("a", "bc") differ. */
+	h = (h ^ 0xFFU) * 16777619U;
+
+	for(index = 0; index < keyLength; ++index)
+	{
+		h = (h ^ static_cast<unsigned char>(key[index])) * 16777619U;
+	}
+
+	return h;
+}
+
+/* Round up to a power of two (internal use only). */
+constexpr std::size_t prv_bind_pow2(const std::size_t value)
+{
+	std::size_t result = 1;
+
+	while(result < value)
+	{
+		result <<= 1;
+	}
+
+	return result;
+}
+
+/**
+ * Perfect hash over the fields of a bound struct (internal use only).
+ *
+ * Fields are first split into buckets by their hash, then every bucket gets the
+ * smallest seed that sends all of its fields to free slots (hash and displace).
+ * A lookup hashes the names once, picks the bucket's seed and lands on the only
+ * field that could match.
+ */
+template<std::size_t Count>
+struct bind_layout
+{
+	static constexpr std::size_t bucketCount = prv_bind_pow2(Count);
+	static constexpr std::size_t slotCount = prv_bind_pow2(Count * 2);
+
+	std::uint32_t seeds[bucketCount] = {};
+	std::uint16_t slots[slotCount] = {};  /* Field index + 1, or 0 for an empty slot. */
+	bool duplicate = false;
+	bool complete = false;
+
+	static constexpr std::size_t slot(const std::uint32_t hash, const std::uint32_t seed)
+	{
+		return prv_bind_mix(hash + seed * 0x9E3779B9U) & (slotCount - 1);
+	}
+};
+
+/* Compare two names at compile time (internal use only). */
+constexpr bool prv_bind_equal(const char* const a, const std::size_t aLength, const char* const b, const std::size_t bLength)
+{
+	std::size_t index = 0;
+
+	if(aLength != bLength)
+	{
+		return false;
+	}
+
+	for(; index < aLength; ++index)
+	{
+		if(a[index] != b[index])
+		{
+			return false;
+		}
+	}
+
+	return true;
+}
+
+/* Build the perfect hash for a bound struct, trying up to maxSeeds seeds per bucket (internal use only). */
+template<typename T>
+constexpr auto prv_bind_build(const std::uint32_t maxSeeds)
+{
+	constexpr auto& fields = binding<T>::fields;
+	constexpr std::size_t count = std::size(fields);
+
+	using layout_type = bind_layout<count>;
+
+	layout_type layout {};
+	std::uint32_t hashes[count] = {};
+	std::size_t bucketSizes[layout_type::bucketCount] = {};
+	std::size_t largest = 0;
+	std::size_t index = 0;
+	std::size_t other = 0;
+
+	static_assert(count < 0xFFFF, "Too many fields bound to one struct.");
+
+	for(index = 0; index < count; ++index)
+	{
+		for(other = index + 1; other < count; ++other)
+		{
+			if(prv_bind_equal(fields[index].section, fields[index].sectionLength, fields[other].section, fields[other].sectionLength) &&
+				prv_bind_equal(fields[index].key, fields[index].keyLength, fields[other].key, fields[other].keyLength))
+			{
+				layout.duplicate = true;
+				return layout;
+			}
+		}
+
+		hashes[index] = prv_bind_hash(fields[index].section, fields[index].sectionLength, fields[index].key, fields[index].keyLength);
+
+		const std::size_t size = ++bucketSizes[hashes[index] & (layout_type::bucketCount - 1)];
+		largest = (size > largest) ? size : largest;
+	}
+
+	/* Place the largest buckets first, while there are still plenty of free slots. */
+	for(std::size_t size = largest; size > 0; --size)
+	{
+		for(std::size_t bucket = 0; bucket < layout_type::bucketCount; ++bucket)
+		{
+			std::uint32_t seed = 0;
+
+			if(bucketSizes[bucket] != size)
+			{
+				continue;
+			}
+
+			for(seed = 1; seed != 0 && seed <= maxSeeds; ++seed)
+			{
+				bool placed = true;
+
+				for(index = 0; index < count && placed; ++index)
+				{
+					if((hashes[index] & (layout_type::bucketCount - 1)) != bucket)
+					{
+						continue;
+					}
+
+					const std::size_t slot = layout_type::slot(hashes[index], seed);
+					placed = (layout.slots[slot] == 0);
+
+					if(placed)
+					{
+						/* Claim the slot now so later fields of the bucket see it as taken. */
+						layout.slots[slot] = static_cast<std::uint16_t>(index + 1);
+					}
+				}
+
+				if(placed)
+				{
+					break;
+				}
+
+				for(other = 0; other < layout_type::slotCount; ++other)
+				{
+					/* Release the slots claimed with the rejected seed. */
+					if(layout.slots[other] != 0 && (hashes[layout.slots[other] - 1] & (layout_type::bucketCount - 1)) == bucket)
+					{
+						layout.slots[other] = 0;
+					}
+				}
+			}
+
+			if(seed == 0 || seed > maxSeeds)
+			{
+				/* Ran out of seeds without placing the bucket. */
+				return layout;
+			}
+
+			layout.seeds[bucket] = seed;
+		}
+	}
+
+	layout.complete = true;
+
+	return layout;
+}
+
+/**
+ * Perfect hash of a bound struct, computed once at compile time.
+ */
+template<typename T>
+inline constexpr auto bind_layout_v = prv_bind_build<T>(MICRO_INI_BIND_MAX_SEEDS);
+
+/**
+ * State handed to bind_handler() through the parser's user data pointer.
+ */
+template<typename T>
+struct bind_context
+{
+	T* pObject;                     /* Struct being loaded. */
+	bind_error_fn convertCallback;  /* Callback for values that can't be converted (optional). */
+	void* pUserData;                /* Pointer to user data that is passed to the conversion callback. */
+	int numErrors;                  /* Number of values that could not be converted. */
+};
+
+/**
+ * @brief  Key/value handler that stores values in the fields of a bound struct.
+ *
+ * @param[in]  pUserData  Pointer to a bind_context for the struct.
+ * @param[in]  section    Section of the pair.
+ * @param[in]  key        Key of the pair.
+ * @param[in]  value      Value of the pair.
+ *
+ * This is an ordinary micro_ini_handler_fn, so it may be given to any of the
+ * micro_ini_load* and micro_ini_resume* functions.  Each pair is hashed once and
+ * checked against the single field it could belong to with memcmp; pairs without
+ * a bound field are ignored.
+ */
+template<typename T>
+void bind_handler(void* const pUserData, const char* const section, const char* const key, const char* const value)
+{
+	using layout_type = std::remove_cv_t<decltype(bind_layout_v<T>)>;
+
+	constexpr auto& fields = binding<T>::fields;
+	constexpr auto& layout = bind_layout_v<T>;
+
+	bind_context<T>& context = *static_cast<bind_context<T>*>(pUserData);
+
+	if(!key)
+	{
+		/* Parent links from MICRO_INI_FLAG_INHERITANCE don't bind to a field. */
+		return;
+	}
+
+	const std::size_t sectionLength = std::strlen(section);
+	const std::size_t keyLength = std::strlen(key);
+	const std::uint32_t hash = prv_bind_hash(section, sectionLength, key, keyLength);
+	const std::size_t slot = layout_type::slot(hash, layout.seeds[hash & (layout_type::bucketCount - 1)]);
+	const std::size_t index = layout.slots[slot];
+
+	if(index == 0)
+	{
+		/* No field is bound to this pair. */
+		return;
+	}
+
+	const bind_field<T>& field = fields[index - 1];
+
+	if(field.sectionLength != sectionLength || field.keyLength != keyLength ||
+		std::memcmp(field.section, section, sectionLength) != 0 ||
+		std::memcmp(field.key, key, keyLength) != 0)
+	{
+		/* Landed on a different field, so this pair isn't bound. */
+		return;
+	}
+
+	if(!field.assign(*context.pObject, value))
+	{
+		if(context.convertCallback)
+		{
+			context.convertCallback(context.pUserData, section, key, value);
+		}
+
+		++context.numErrors;
+	}
+}
+
+/* Combine the parser result with the conversion failures (internal use only). */
+inline int prv_bind_result(const int err, const int numErrors)
+{
+	return (err < 0) ? err : err + numErrors;
+}
+
+/**
+ * @brief   Parse an ini file into a bound struct.
+ * @return  Error code or number of parsing and conversion errors that occurred.
+ *
+ * @param[in]  filePath         Path to the ini file to read.
+ * @param[out] object           Struct to load (fields without a value in the file are left untouched).
+ * @param[in]  flags            Flags for configuring the parser.
+ * @param[in]  errorCallback    Callback for handling parsing errors (this callback is optional and may be NULL if unneeded).
+ * @param[in]  convertCallback  Callback for values that can't be converted to their field's type (optional).
+ * @param[in]  pUserData        Pointer to user data that is passed to the callbacks.
+ */
+template<typename T>
+int bind_load(
+	const char* const filePath,
+	T& object,
+	const int flags = 0,
+	const micro_ini_error_fn errorCallback = nullptr,
+	const bind_error_fn convertCallback = nullptr,
+	void* const pUserData = nullptr
+)
+{
+	bind_context<T> context = { &object, convertCallback, pUserData, 0 };
+	const int err = micro_ini_load(filePath, flags, bind_handler<T>, errorCallback, &context);
+
+	return prv_bind_result(err, context.numErrors);
+}
+
+/**
+ * @brief   Parse an ini file from a FILE object into a bound struct.
+ * @return  Error code or number of parsing and conversion errors that occurred.
+ *
+ * @param[in]  pFile            Pointer to an existing FILE object.
+ * @param[out] object           Struct to load (fields without a value in the file are left untouched).
+ * @param[in]  flags            Flags for configuring the parser.
+ * @param[in]  errorCallback    Callback for handling parsing errors (this callback is optional and may be NULL if unneeded).
+ * @param[in]  convertCallback  Callback for values that can't be converted to their field's type (optional).
+ * @param[in]  pUserData        Pointer to user data that is passed to the callbacks.
+ */
+template<typename T>
+int bind_load_file(
+	FILE* const pFile,
+	T& object,
+	const int flags = 0,
+	const micro_ini_error_fn errorCallback = nullptr,
+	const bind_error_fn convertCallback = nullptr,
+	void* const pUserData = nullptr
+)
+{
+	bind_context<T> context = { &object, convertCallback, pUserData, 0 };
+	const int err = micro_ini_load_file(pFile, flags, bind_handler<T>, errorCallback, &context);
+
+	return prv_bind_result(err, context.numErrors);
+}
+
+/**
+ * @brief   Parse an in-memory ini file into a bound struct.
+ * @return  Error code or number of parsing and conversion errors that occurred.
+ *
+ * @param[in]  data             Contents of the ini file.
+ * @param[out] object           Struct to load (fields without a value in the file are left untouched).
+ * @param[in]  flags            Flags for configuring the parser.
+ * @param[in]  errorCallback    Callback for handling parsing errors (this callback is optional and may be NULL if unneeded).
+ * @param[in]  convertCallback  Callback for values that can't be converted to their field's type (optional).
+ * @param[in]  pUserData        Pointer to user data that is passed to the callbacks.
+ */
+template<typename T>
+int bind_load_buffer(
+	const std::string_view data,
+	T& object,
+	const int flags = 0,
+	const micro_ini_error_fn errorCallback = nullptr,
+	const bind_error_fn convertCallback = nullptr,
+	void* const pUserData = nullptr
+)
+{
+	bind_context<T> context = { &object, convertCallback, pUserData, 0 };
+	const int err = micro_ini_load_buffer(data.data(), data.size(), flags, bind_handler<T>, errorCallback, &context);
+
+	return prv_bind_result(err, context.numErrors);
+}
+
+} /* namespace micro_ini */
+
+/* Apply a macro to each of up to 64 arguments (internal use only). */
+#define MICRO_INI_PRV_FOR_EACH_1(m, x) m(x)
+#define MICRO_INI_PRV_FOR_EACH_2(m, x, ...) m(x) MICRO_INI_PRV_EXPAND(MICRO_INI_PRV_FOR_EACH_1(m, __VA_ARGS__))
+#define MICRO_INI_PRV_FOR_EACH_3(m, x, ...) m(x) MICRO_INI_PRV_EXPAND(MICRO_INI_PRV_FOR_EACH_2(m, __VA_ARGS__))
+#define MICRO_INI_PRV_FOR_EACH_4(m, x, ...) m(x) MICRO_INI_PRV_EXPAND(MICRO_INI_PRV_FOR_EACH_3(m, __VA_ARGS__))
+#define MICRO_INI_PRV_FOR_EACH_5(m, x, ...) m(x) MICRO_INI_PRV_EXPAND(MICRO_INI_PRV_FOR_EACH_4(m, __VA_ARGS__))
+#define MICRO_INI_PRV_FOR_EACH_6(m, x, ...) m(x) MICRO_INI_PRV_EXPAND(MICRO_INI_PRV_FOR_EACH_5(m, __VA_ARGS__))
+#define MICRO_INI_PRV_FOR_EACH_7(m, x, ...) m(x) MICRO_INI_PRV_EXPAND(MICRO_INI_PRV_FOR_EACH_6(m, __VA_ARGS__))
+#define MICRO_INI_PRV_FOR_EACH_8(m, x, ...) m(x) MICRO_INI_PRV_EXPAND(MICRO_INI_PRV_FOR_EACH_7(m, __VA_ARGS__))
+#define MICRO_INI_PRV_FOR_EACH_9(m, x, ...) m(x) MICRO_INI_PRV_EXPAND(MICRO_INI_PRV_FOR_EACH_8(m, __VA_ARGS__))
+#define MICRO_INI_PRV_FOR_EACH_10(m, x, ...) m(x) MICRO_INI_PRV_EXPAND(MICRO_INI_PRV_FOR_EACH_9(m, __VA_ARGS__))
+#define MICRO_INI_PRV_FOR_EACH_11(m, x, ...) m(x) MICRO_INI_PRV_EXPAND(MICRO_INI_PRV_FOR_EACH_10(m, __VA_ARGS__))
+#define MICRO_INI_PRV_FOR_EACH_12(m, x, ...) m(x) MICRO_INI_PRV_EXPAND(MICRO_INI_PRV_FOR_EACH_11(m, __VA_ARGS__))
+#define MICRO_INI_PRV_FOR_EACH_13(m, x, ...) m(x) MICRO_INI_PRV_EXPAND(MICRO_INI_PRV_FOR_EACH_12(m, __VA_ARGS__))
+#define MICRO_INI_PRV_FOR_EACH_14(m, x, ...) m(x) MICRO_INI_PRV_EXPAND(MICRO_INI_PRV_FOR_EACH_13(m, __VA_ARGS__))
+#define MICRO_INI_PRV_FOR_EACH_15(m, x, ...) m(x) MICRO_INI_PRV_EXPAND(MICRO_INI_PRV_FOR_EACH_14(m, __VA_ARGS__))
+#define MICRO_INI_PRV_FOR_EACH_16(m, x, ...) m(x) MICRO_INI_PRV_EXPAND(MICRO_INI_PRV_FOR_EACH_15(m, __VA_ARGS__))
+#define MICRO_INI_PRV_FOR_EACH_17(m, x, ...) m(x) MICRO_INI_PRV_EXPAND(MICRO_INI_PRV_FOR_EACH_16(m, __VA_ARGS__))
+#define MICRO_INI_PRV_FOR_EACH_18(m, x, ...) m(x) MICRO_INI_PRV_EXPAND(MICRO_INI_PRV_FOR_EACH_17(m, __VA_ARGS__))
+#define MICRO_INI_PRV_FOR_EACH_19(m, x, ...) m(x) MICRO_INI_PRV_EXPAND(MICRO_INI_PRV_FOR_EACH_18(m, __VA_ARGS__))
+#define MICRO_INI_PRV_FOR_EACH_20(m, x, ...) m(x) MICRO_INI_PRV_EXPAND(MICRO_INI_PRV_FOR_EACH_19(m, __VA_ARGS__))
+#define MICRO_INI_PRV_FOR_EACH_21(m, x, ...) m(x) MICRO_INI_PRV_EXPAND(MICRO_INI_PRV_FOR_EACH_20(m, __VA_ARGS__))
+#define MICRO_INI_PRV_FOR_EACH_22(m, x, ...) m(x) MICRO_INI_PRV_EXPAND(MICRO_INI_PRV_FOR_EACH_21(m, __VA_ARGS__))
+#define MICRO_INI_PRV_FOR_EACH_23(m, x, ...) m(x) MICRO_INI_PRV_EXPAND(MICRO_INI_PRV_FOR_EACH_22(m, __VA_ARGS__))
+#define MICRO_INI_PRV_FOR_EACH_24(m, x, ...) m(x) MICRO_INI_PRV_EXPAND(MICRO_INI_PRV_FOR_EACH_23(m, __VA_ARGS__))
+#define MICRO_INI_PRV_FOR_EACH_25(m, x, ...) m(x) MICRO_INI_PRV_EXPAND(MICRO_INI_PRV_FOR_EACH_24(m, __VA_ARGS__))
+#define MICRO_INI_PRV_FOR_EACH_26(m, x, ...) m(x) MICRO_INI_PRV_EXPAND(MICRO_INI_PRV_FOR_EACH_25(m, __VA_ARGS__))
+#define MICRO_INI_PRV_FOR_EACH_27(m, x, ...) m(x) MICRO_INI_PRV_EXPAND(MICRO_INI_PRV_FOR_EACH_26(m, __VA_ARGS__))
+#define MICRO_INI_PRV_FOR_EACH_28(m, x, ...) m(x) MICRO_INI_PRV_EXPAND(MICRO_INI_PRV_FOR_EACH_27(m, __VA_ARGS__))
+#define MICRO_INI_PRV_FOR_EACH_29(m, x, ...) m(x) MICRO_INI_PRV_EXPAND(MICRO_INI_PRV_FOR_EACH_28(m, __VA_ARGS__))
+#define MICRO_INI_PRV_FOR_EACH_30(m, x, ...) m(x) MICRO_INI_PRV_EXPAND(MICRO_INI_PRV_FOR_EACH_29(m, __VA_ARGS__))
+#define MICRO_INI_PRV_FOR_EACH_31(m, x, ...) m(x) MICRO_INI_PRV_EXPAND(MICRO_INI_PRV_FOR_EACH_30(m, __VA_ARGS__))
+#define MICRO_INI_PRV_FOR_EACH_32(m, x, ...) m(x) MICRO_INI_PRV_EXPAND(MICRO_INI_PRV_FOR_EACH_31(m, __VA_ARGS__))
+#define MICRO_INI_PRV_FOR_EACH_33(m, x, ...) m(x) MICRO_INI_PRV_EXPAND(MICRO_INI_PRV_FOR_EACH_32(m, __VA_ARGS__))
+#define MICRO_INI_PRV_FOR_EACH_34(m, x, ...) m(x) MICRO_INI_PRV_EXPAND(MICRO_INI_PRV_FOR_EACH_33(m, __VA_ARGS__))
+#define MICRO_INI_PRV_FOR_EACH_35(m, x, ...) m(x) MICRO_INI_PRV_EXPAND(MICRO_INI_PRV_FOR_EACH_34(m, __VA_ARGS__))
+#define MICRO_INI_PRV_FOR_EACH_36(m, x, ...) m(x) MICRO_INI_PRV_EXPAND(MICRO_INI_PRV_FOR_EACH_35(m, __VA_ARGS__))
+#define MICRO_INI_PRV_FOR_EACH_37(m, x, ...) m(x) MICRO_INI_PRV_EXPAND(MICRO_INI_PRV_FOR_EACH_36(m, __VA_ARGS__))
+#define MICRO_INI_PRV_FOR_EACH_38(m, x, ...) m(x) MICRO_INI_PRV_EXPAND(MICRO_INI_PRV_FOR_EACH_37(m, __VA_ARGS__))
+#define MICRO_INI_PRV_FOR_EACH_39(m, x, ...) m(x) MICRO_INI_PRV_EXPAND(MICRO_INI_PRV_FOR_EACH_38(m, __VA_ARGS__))
+#define MICRO_INI_PRV_FOR_EACH_40(m, x, ...) m(x) MICRO_INI_PRV_EXPAND(MICRO_INI_PRV_FOR_EACH_39(m, __VA_ARGS__))
+#define MICRO_INI_PRV_FOR_EACH_41(m, x, ...) m(x) MICRO_INI_PRV_EXPAND(MICRO_INI_PRV_FOR_EACH_40(m, __VA_ARGS__))
+#define MICRO_INI_PRV_FOR_EACH_42(m, x, ...) m(x) MICRO_INI_PRV_EXPAND(MICRO_INI_PRV_FOR_EACH_41(m, __VA_ARGS__))
+#define MICRO_INI_PRV_FOR_EACH_43(m, x, ...) m(x) MICRO_INI_PRV_EXPAND(MICRO_INI_PRV_FOR_EACH_42(m, __VA_ARGS__))
+#define MICRO_INI_PRV_FOR_EACH_44(m, x, ...) m(x) MICRO_INI_PRV_EXPAND(MICRO_INI_PRV_FOR_EACH_43(m, __VA_ARGS__))
+#define MICRO_INI_PRV_FOR_EACH_45(m, x, ...) m(x) MICRO_INI_PRV_EXPAND(MICRO_INI_PRV_FOR_EACH_44(m, __VA_ARGS__))
+#define MICRO_INI_PRV_FOR_EACH_46(m, x, ...) m(x) MICRO_INI_PRV_EXPAND(MICRO_INI_PRV_FOR_EACH_45(m, __VA_ARGS__))
+#define MICRO_INI_PRV_FOR_EACH_47(m, x, ...) m(x) MICRO_INI_PRV_EXPAND(MICRO_INI_PRV_FOR_EACH_46(m, __VA_ARGS__))
+#define MICRO_INI_PRV_FOR_EACH_48(m, x, ...) m(x) MICRO_INI_PRV_EXPAND(MICRO_INI_PRV_FOR_EACH_47(m, __VA_ARGS__))
+#define MICRO_INI_PRV_FOR_EACH_49(m, x, ...) m(x) MICRO_INI_PRV_EXPAND(MICRO_INI_PRV_FOR_EACH_48(m, __VA_ARGS__))
+#define MICRO_INI_PRV_FOR_EACH_50(m, x, ...) m(x) MICRO_INI_PRV_EXPAND(MICRO_INI_PRV_FOR_EACH_49(m, __VA_ARGS__))
+#define MICRO_INI_PRV_FOR_EACH_51(m, x, ...) m(x) MICRO_INI_PRV_EXPAND(MICRO_INI_PRV_FOR_EACH_50(m, __VA_ARGS__))
+#define MICRO_INI_PRV_FOR_EACH_52(m, x, ...) m(x) MICRO_INI_PRV_EXPAND(MICRO_INI_PRV_FOR_EACH_51(m, __VA_ARGS__))
+#define MICRO_INI_PRV_FOR_EACH_53(m, x, ...) m(x) MICRO_INI_PRV_EXPAND(MICRO_INI_PRV_FOR_EACH_52(m, __VA_ARGS__))
+#define MICRO_INI_PRV_FOR_EACH_54(m, x, ...) m(x) MICRO_INI_PRV_EXPAND(MICRO_INI_PRV_FOR_EACH_53(m, __VA_ARGS__))
+#define MICRO_INI_PRV_FOR_EACH_55(m, x, ...) m(x) MICRO_INI_PRV_EXPAND(MICRO_INI_PRV_FOR_EACH_54(m, __VA_ARGS__))
+#define MICRO_INI_PRV_FOR_EACH_56(m, x, ...) m(x) MICRO_INI_PRV_EXPAND(MICRO_INI_PRV_FOR_EACH_55(m, __VA_ARGS__))
+#define MICRO_INI_PRV_FOR_EACH_57(m, x, ...) m(x) MICRO_INI_PRV_EXPAND(MICRO_INI_PRV_FOR_EACH_56(m, __VA_ARGS__))
+#define MICRO_INI_PRV_FOR_EACH_58(m, x, ...) m(x) MICRO_INI_PRV_EXPAND(MICRO_INI_PRV_FOR_EACH_57(m, __VA_ARGS__))
+#define MICRO_INI_PRV_FOR_EACH_59(m, x, ...) m(x) MICRO_INI_PRV_EXPAND(MICRO_INI_PRV_FOR_EACH_58(m, __VA_ARGS__))
+#define MICRO_INI_PRV_FOR_EACH_60(m, x, ...) m(x) MICRO_INI_PRV_EXPAND(MICRO_INI_PRV_FOR_EACH_59(m, __VA_ARGS__))
+#define MICRO_INI_PRV_FOR_EACH_61(m, x, ...) m(x) MICRO_INI_PRV_EXPAND(MICRO_INI_PRV_FOR_EACH_60(m, __VA_ARGS__))
+#define MICRO_INI_PRV_FOR_EACH_62(m, x, ...) m(x) MICRO_INI_PRV_EXPAND(MICRO_INI_PRV_FOR_EACH_61(m, __VA_ARGS__))
+#define MICRO_INI_PRV_FOR_EACH_63(m, x, ...) m(x) MICRO_INI_PRV_EXPAND(MICRO_INI_PRV_FOR_EACH_62(m, __VA_ARGS__))
+#define MICRO_INI_PRV_FOR_EACH_64(m, x, ...) m(x) MICRO_INI_PRV_EXPAND(MICRO_INI_PRV_FOR_EACH_63(m, __VA_ARGS__))
+
+#define MICRO_INI_PRV_EXPAND(x) x
+#define MICRO_INI_PRV_CONCAT2(a, b) a##b
+#define MICRO_INI_PRV_CONCAT(a, b) MICRO_INI_PRV_CONCAT2(a, b)
+#define MICRO_INI_PRV_COUNT_N(_1, _2, _3, _4, _5, _6, _7, _8, _9, _10, _11, _12, _13, _14, _15, _16, _17, _18, _19, _20, _21, _22, _23, _24, _25, _26, _27, _28, _29, _30, _31, _32, _33, _34, _35, _36, _37, _38, _39, _40, _41, _42, _43, _44, _45, _46, _47, _48, _49, _50, _51, _52, _53, _54, _55, _56, _57, _58, _59, _60, _61, _62, _63, _64, n, ...) n
+#define MICRO_INI_PRV_COUNT(...) MICRO_INI_PRV_EXPAND(MICRO_INI_PRV_COUNT_N(__VA_ARGS__, 64, 63, 62, 61, 60, 59, 58, 57, 56, 55, 54, 53, 52, 51, 50, 49, 48, 47, 46, 45, 44, 43, 42, 41, 40, 39, 38, 37, 36, 35, 34, 33, 32, 31, 30, 29, 28, 27, 26, 25, 24, 23, 22, 21, 20, 19, 18, 17, 16, 15, 14, 13, 12, 11, 10, 9, 8, 7, 6, 5, 4, 3, 2, 1))
+#define MICRO_INI_PRV_FOR_EACH(m, ...) MICRO_INI_PRV_EXPAND(MICRO_INI_PRV_CONCAT(MICRO_INI_PRV_FOR_EACH_, MICRO_INI_PRV_COUNT(__VA_ARGS__))(m, __VA_ARGS__))
+
+/* Expand one (member, "section", "key") entry into a field (internal use only). */
+#define MICRO_INI_PRV_BIND_FIELD(entry) MICRO_INI_PRV_BIND_FIELD_I entry
+#define MICRO_INI_PRV_BIND_FIELD_I(member, section, key) \
+	::micro_ini::bind_field<type> { \
+		section, \
+		key, \
+		std::char_traits<char>::length(section), \
+		std::char_traits<char>::length(key), \
+		[](type& object, const char* const value) { return ::micro_ini::convert(value, object.member); } \
+	},
+
+/**
+ * Bind the fields of a struct to ini sections and keys at compile time.
+ *
+ * Usage, at global namespace scope:
+ *
+ *   MICRO_INI_BIND(MyConfig,
+ *       (port, "server", "port"),
+ *       (host, "server", "host"),
+ *       (verbose, "", "verbose")
+ *   );
+ *
+ * Up to 64 fields may be bound.  Field types need a micro_ini::converter (integers,
+ * floating point numbers, bool and std::string are built in).  Binding the same
+ * section and key twice is a compile error, as is a set of keys for which no bucket
+ * seed up to MICRO_INI_BIND_MAX_SEEDS gives a perfect hash.
+ */
+#define MICRO_INI_BIND(Type, ...) \
+	template<> \
+	struct micro_ini::binding<Type> \
+	{ \
+		using type = Type; \
+		static constexpr ::micro_ini::bind_field<Type> fields[] = { MICRO_INI_PRV_FOR_EACH(MICRO_INI_PRV_BIND_FIELD, __VA_ARGS__) }; \
+	}; \
+	static_assert(!::micro_ini::bind_layout_v<Type>.duplicate, "The same section and key are bound to more than one field of " #Type "."); \
+	static_assert(::micro_ini::bind_layout_v<Type>.duplicate || ::micro_ini::bind_layout_v<Type>.complete, "Could not build the key table for " #Type " within MICRO_INI_BIND_MAX_SEEDS seeds per bucket; define a larger MICRO_INI_BIND_MAX_SEEDS.")
@@ -0,0 +1,1158 @@
+/**
+ * Copyright (c) 2021, Zoe J. Bare
+ *
+ * MIT License
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ */
+
+#if !defined(_WIN32) && !defined(_POSIX_C_SOURCE) && !defined(_GNU_SOURCE)
+	/* Expose stat(), the nanosecond file times and the POSIX threads functions even when compiling in strict ANSI mode. */
+	#define _POSIX_C_SOURCE 200809L
+#endif
+
+#include "micro_ini_compat.h"
+#include "micro_ini_doc.h"
+
+#include <ctype.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/types.h>
+#include <sys/stat.h>
+
+#if defined(_WIN32)
+	#include <windows.h>
+
+	typedef struct _stat64 micro_ini_compat_stat;
+
+	#define MICRO_INI_COMPAT_STAT(path, pStat) _stat64((path), (pStat))
+
+	static SRWLOCK prv_micro_ini_compat_lock = SRWLOCK_INIT;
+
+	#define MICRO_INI_COMPAT_LOCK()   AcquireSRWLockExclusive(&prv_micro_ini_compat_lock)
+	#define MICRO_INI_COMPAT_UNLOCK() ReleaseSRWLockExclusive(&prv_micro_ini_compat_lock)
+#else
+	#include <pthread.h>
+
+	typedef struct stat micro_ini_compat_stat;
+
+	#define MICRO_INI_COMPAT_STAT(path, pStat) stat((path), (pStat))
+
+	static pthread_mutex_t prv_micro_ini_compat_lock = PTHREAD_MUTEX_INITIALIZER;
+
+	#define MICRO_INI_COMPAT_LOCK()   pthread_mutex_lock(&prv_micro_ini_compat_lock)
+	#define MICRO_INI_COMPAT_UNLOCK() pthread_mutex_unlock(&prv_micro_ini_compat_lock)
+#endif
+
+/**
+ * Flags used for every file read by this module.
+ */
+#define MICRO_INI_COMPAT_FLAGS MICRO_INI_FLAG_BOM
+
+/**
+ * Identity of a version of a file (internal use only).  A cached document is only
+ * used while the file still matches the stamp it was loaded from.
+ */
+typedef struct micro_ini_compat_stamp
+{
+	uint64_t device;
+	uint64_t inode;
+	uint64_t size;
+	uint64_t modifiedSeconds;
+	uint64_t modifiedNanoseconds;  /* Zero where the platform only keeps whole seconds. */
+	uint64_t changedSeconds;
+} micro_ini_compat_stamp;
+
+/**
+ * Cached document of a single file (internal use only).
+ */
+typedef struct micro_ini_compat_entry
+{
+	struct micro_ini_compat_entry* pNext;
+
+	char* path;
+	micro_ini_doc* pDoc;  /* Section and key names are folded to lower case. */
+	micro_ini_compat_stamp stamp;
+} micro_ini_compat_entry;
+
+/**
+ * Names gathered when listing sections or keys (internal use only).
+ */
+typedef struct micro_ini_compat_list
+{
+	const char* section;  /* Section whose keys are listed, or NULL to list the sections. */
+
+	char*  pOutBuffer;
+	size_t bufferSize;
+	size_t length;
+	int    truncated;
+} micro_ini_compat_list;
+
+/**
+ * Pair read back from a line written to a file (internal use only).
+ */
+typedef struct micro_ini_compat_pair
+{
+	char key[MICRO_INI_MAX_LINE_LENGTH + 1];
+	char value[MICRO_INI_MAX_LINE_LENGTH + 1];
+	int  found;
+} micro_ini_compat_pair;
+
+/**
+ * Every cached document, most recently used first.
+ */
+static micro_ini_compat_entry* prv_micro_ini_compat_cache = NULL;
+
+/**
+ * Allocator for the cache, its documents and the copies of files being rewritten (NULL for malloc()).
+ */
+static micro_ini_allocator* prv_micro_ini_compat_allocator = NULL;
+
+/**
+ * @brief   Compare two names without regard to case (internal use only).
+ * @return  Non-zero when the names are equal.
+ *
+ * @param[in]  a  Null terminated name.
+ * @param[in]  b  Name of n characters, which does not need to be null terminated.
+ * @param[in]  n  Length of the second name.
+ */
+static int prv_micro_ini_compat_equal(const char* a, const char* b, size_t n)
+{
+	while(n > 0 && (*a) && tolower((unsigned char) (*a)) == tolower((unsigned char) (*b)))
+	{
+		++a;
+		++b;
+		--n;
+	}
+
+	return n == 0 && (*a) == '\0';
+}
+
+/**
+ * @brief   Fold a name to lower case (internal use only).
+ * @return  Non-zero if the name fit in the output buffer.
+ *
+ * @param[out] pOut  Buffer of MICRO_INI_MAX_LINE_LENGTH + 1 characters receiving the folded name.
+ * @param[in]  name  Name to fold.
+ */
+static int prv_micro_ini_compat_fold(char* const pOut, const char* const name)
+{
+	size_t i;
+
+	for(i = 0; name[i]; ++i)
+	{
+		if(i == MICRO_INI_MAX_LINE_LENGTH)
+		{
+			/* No line this long can be in the document. */
+			return 0;
+		}
+
+		pOut[i] = (char) tolower((unsigned char) name[i]);
+	}
+
+	pOut[i] = '\0';
+
+	return 1;
+}
+
+/**
+ * @brief  Fold the section or key name of a line to lower case (internal use only).
+ *
+ * @param[in]  line  Line to update in place.
+ */
+static void prv_micro_ini_compat_fold_line(char* line)
+{
+	char end;
+
+	while(isspace((unsigned char) (*line)))
+	{
+		++line;
+	}
+
+	if((*line) == '[')
+	{
+		end = ']';
+	}
+	else if((*line) == '#' || (*line) == ';' || !strchr(line, '='))
+	{
+		/* Comments are left as they are. */
+		return;
+	}
+	else
+	{
+		end = '=';
+	}
+
+	while((*line) && (*line) != end)
+	{
+		(*line) = (char) tolower((unsigned char) (*line));
+		++line;
+	}
+}
+
+/**
+ * @brief   Read the next line of a file with its names folded to lower case (internal use only).
+ * @return  The line, or NULL at the end of the file.
+ *
+ * @param[out] str      Buffer receiving the line.
+ * @param[in]  num      Size of the buffer.
+ * @param[in]  pStream  FILE object to read from.
+ */
+static char* prv_micro_ini_compat_read_line(char* str, int num, void* pStream)
+{
+	if(!fgets(str, num, (FILE*) pStream))
+	{
+		return NULL;
+	}
+
+	prv_micro_ini_compat_fold_line(str);
+
+	return str;
+}
+
+/**
+ * @brief   Check if the end of a file has been reached (internal use only).
+ * @return  Non-zero at the end of the file.
+ *
+ * @param[in]  pStream  FILE object to check.
+ */
+static int prv_micro_ini_compat_eof(void* pStream)
+{
+	return feof((FILE*) pStream);
+}
+
+/**
+ * @brief   Read the stamp of a file (internal use only).
+ * @return  Non-zero if the file exists.
+ *
+ * @param[in]  filePath   Path to the file.
+ * @param[out] pOutStamp  Receives the stamp.
+ */
+static int prv_micro_ini_compat_stamp_file(const char* const filePath, micro_ini_compat_stamp* const pOutStamp)
+{
+	micro_ini_compat_stat info;
+
+	if(MICRO_INI_COMPAT_STAT(filePath, &info) != 0)
+	{
+		return 0;
+	}
+
+	memset(pOutStamp, 0, sizeof(micro_ini_compat_stamp));
+	pOutStamp->device = (uint64_t) info.st_dev;
+	pOutStamp->inode = (uint64_t) info.st_ino;
+	pOutStamp->size = (uint64_t) info.st_size;
+	pOutStamp->modifiedSeconds = (uint64_t) info.st_mtime;
+	pOutStamp->changedSeconds = (uint64_t) info.st_ctime;
+
+	/* A rewrite within the same second that keeps the size is only told apart by the finer times. */
+#if defined(__APPLE__)
+	pOutStamp->modifiedNanoseconds = (uint64_t) info.st_mtimespec.tv_nsec;
+#elif !defined(_WIN32) && defined(st_mtime)
+	/* st_mtime is a macro for st_mtim.tv_sec when the nanosecond times are available. */
+	pOutStamp->modifiedNanoseconds = (uint64_t) info.st_mtim.tv_nsec;
+#endif
+
+	return 1;
+}
+
+/**
+ * @brief   Check if two stamps belong to the same version of a file (internal use only).
+ * @return  Non-zero if the stamps are equal.
+ *
+ * @param[in]  pA  First stamp.
+ * @param[in]  pB  Second stamp.
+ */
+static int prv_micro_ini_compat_stamp_equal(const micro_ini_compat_stamp* const pA, const micro_ini_compat_stamp* const pB)
+{
+	return pA->size == pB->size
+		&& pA->modifiedSeconds == pB->modifiedSeconds
+		&& pA->modifiedNanoseconds == pB->modifiedNanoseconds
+		&& pA->changedSeconds == pB->changedSeconds
+		&& pA->inode == pB->inode
+		&& pA->device == pB->device;
+}
+
+/**
+ * @brief  Remove a document from the cache and release it (internal use only).
+ *
+ * @param[in]  pEntry  Entry to remove.
+ */
+static void prv_micro_ini_compat_drop(micro_ini_compat_entry* const pEntry)
+{
+	micro_ini_compat_entry** ppLink = &prv_micro_ini_compat_cache;
+
+	while((*ppLink) != pEntry)
+	{
+		ppLink = &(*ppLink)->pNext;
+	}
+
+	(*ppLink) = pEntry->pNext;
+
+	micro_ini_doc_free(pEntry->pDoc);
+	micro_ini_allocator_free(prv_micro_ini_compat_allocator, pEntry->path);
+	micro_ini_allocator_free(prv_micro_ini_compat_allocator, pEntry);
+}
+
+/**
+ * @brief   Find the cached entry of a file, moving it to the front of the cache (internal use only).
+ * @return  The entry, or NULL if the file is not cached.
+ *
+ * @param[in]  filePath  Path to the file.
+ */
+static micro_ini_compat_entry* prv_micro_ini_compat_find(const char* const filePath)
+{
+	micro_ini_compat_entry** ppLink = &prv_micro_ini_compat_cache;
+	micro_ini_compat_entry* pEntry;
+
+	while((*ppLink) && strcmp((*ppLink)->path, filePath) != 0)
+	{
+		ppLink = &(*ppLink)->pNext;
+	}
+
+	pEntry = (*ppLink);
+	if(pEntry && pEntry != prv_micro_ini_compat_cache)
+	{
+		(*ppLink) = pEntry->pNext;
+		pEntry->pNext = prv_micro_ini_compat_cache;
+		prv_micro_ini_compat_cache = pEntry;
+	}
+
+	return pEntry;
+}
+
+/**
+ * @brief   Get the up to date document of a file, parsing it only when it has changed (internal use only).
+ * @return  The document, or NULL if the file does not exist or could not be loaded.
+ *
+ * @param[in]  filePath  Path to the file.
+ *
+ * Must be called with the cache locked.
+ */
+static const micro_ini_doc* prv_micro_ini_compat_load(const char* const filePath)
+{
+	micro_ini_compat_entry* pEntry = prv_micro_ini_compat_find(filePath);
+	micro_ini_compat_stamp stamp;
+	micro_ini_doc_options options;
+	micro_ini_doc* pDoc;
+	FILE* pFile;
+	size_t length;
+	int result;
+
+	if(!prv_micro_ini_compat_stamp_file(filePath, &stamp))
+	{
+		if(pEntry)
+		{
+			/* The file has been removed. */
+			prv_micro_ini_compat_drop(pEntry);
+		}
+
+		return NULL;
+	}
+
+	if(pEntry && prv_micro_ini_compat_stamp_equal(&pEntry->stamp, &stamp))
+	{
+		return pEntry->pDoc;
+	}
+
+	/* The stamp is taken before reading, so a change made while reading is noticed next time. */
+	pFile = fopen(filePath, "r");
+	if(!pFile)
+	{
+		if(pEntry)
+		{
+			prv_micro_ini_compat_drop(pEntry);
+		}
+
+		return NULL;
+	}
+
+	memset(&options, 0, sizeof(options));
+	options.pAllocator = prv_micro_ini_compat_allocator;
+
+	result = micro_ini_doc_load_stream(
+		&pDoc,
+		pFile,
+		MICRO_INI_COMPAT_FLAGS,
+		&options,
+		NULL,
+		prv_micro_ini_compat_read_line,
+		prv_micro_ini_compat_eof,
+		NULL
+	);
+
+	fclose(pFile);
+
+	if(result < 0)
+	{
+		if(pEntry)
+		{
+			prv_micro_ini_compat_drop(pEntry);
+		}
+
+		return NULL;
+	}
+
+	if(!pEntry)
+	{
+		length = strlen(filePath);
+
+		pEntry = (micro_ini_compat_entry*) micro_ini_allocator_alloc(prv_micro_ini_compat_allocator, sizeof(micro_ini_compat_entry));
+		if(!pEntry)
+		{
+			micro_ini_doc_free(pDoc);
+			return NULL;
+		}
+
+		pEntry->path = (char*) micro_ini_allocator_alloc(prv_micro_ini_compat_allocator, length + 1);
+		if(!pEntry->path)
+		{
+			micro_ini_allocator_free(prv_micro_ini_compat_allocator, pEntry);
+			micro_ini_doc_free(pDoc);
+			return NULL;
+		}
+
+		memcpy(pEntry->path, filePath, length + 1);
+
+		pEntry->pDoc = NULL;
+		pEntry->pNext = prv_micro_ini_compat_cache;
+		prv_micro_ini_compat_cache = pEntry;
+	}
+
+	micro_ini_doc_free(pEntry->pDoc);
+
+	pEntry->pDoc = pDoc;
+	pEntry->stamp = stamp;
+
+	return pDoc;
+}
+
+/**
+ * @brief   Look up the value of a key (internal use only).
+ * @return  The value, or NULL if it does not exist.
+ *
+ * @param[in]  section   Section name.
+ * @param[in]  key       Key name.
+ * @param[in]  filePath  Path to the ini file.
+ *
+ * Must be called with the cache locked.
+ */
+static const char* prv_micro_ini_compat_get(const char* const section, const char* const key, const char* const filePath)
+{
+	char foldedSection[MICRO_INI_MAX_LINE_LENGTH + 1];
+	char foldedKey[MICRO_INI_MAX_LINE_LENGTH + 1];
+	const micro_ini_doc* pDoc;
+
+	if(!prv_micro_ini_compat_fold(foldedSection, section) || !prv_micro_ini_compat_fold(foldedKey, key))
+	{
+		return NULL;
+	}
+
+	pDoc = prv_micro_ini_compat_load(filePath);
+	if(!pDoc)
+	{
+		return NULL;
+	}
+
+	return micro_ini_doc_get(pDoc, foldedSection, foldedKey);
+}
+
+/**
+ * @brief   Copy a string into a caller's buffer, truncating it if necessary (internal use only).
+ * @return  Number of characters copied, not including the terminating null.
+ *
+ * @param[out] pOutBuffer  Buffer receiving the string.
+ * @param[in]  bufferSize  Size of the buffer.
+ * @param[in]  str         String to copy.
+ * @param[in]  length      Length of the string.
+ */
+static size_t prv_micro_ini_compat_copy(char* const pOutBuffer, const size_t bufferSize, const char* const str, size_t length)
+{
+	if(bufferSize == 0)
+	{
+		return 0;
+	}
+
+	if(length >= bufferSize)
+	{
+		length = bufferSize - 1;
+	}
+
+	memcpy(pOutBuffer, str, length);
+	pOutBuffer[length] = '\0';
+
+	return length;
+}
+
+/**
+ * @brief  Key/value handler adding section or key names to a list (internal use only).
+ *
+ * @param[in]  pUserData  Pointer to a micro_ini_compat_list.
+ * @param[in]  section    Section of the pair.
+ * @param[in]  key        Key of the pair.
+ * @param[in]  value      Value of the pair (unused).
+ */
+static void prv_micro_ini_compat_list_handler(void* pUserData, const char* section, const char* key, const char* value)
+{
+	micro_ini_compat_list* const pList = (micro_ini_compat_list*) pUserData;
+	const char* const name = pList->section ? key : section;
+	const char* pListed;
+	size_t length;
+	size_t i;
+
+	(void) value;
+
+	if(!key || pList->truncated)
+	{
+		return;
+	}
+
+	if(pList->section && !prv_micro_ini_compat_equal(section, pList->section, strlen(pList->section)))
+	{
+		return;
+	}
+
+	length = strlen(name);
+
+	for(pListed = pList->pOutBuffer; pListed < pList->pOutBuffer + pList->length; pListed += strlen(pListed) + 1)
+	{
+		if(prv_micro_ini_compat_equal(pListed, name, length))
+		{
+			/* Already listed. */
+			return;
+		}
+	}
+
+	/* Room is always kept for the final pair of nulls. */
+	for(i = 0; i <= length; ++i)
+	{
+		if(pList->length + 2 > pList->bufferSize)
+		{
+			pList->truncated = 1;
+			return;
+		}
+
+		pList->pOutBuffer[pList->length] = name[i];
+		++pList->length;
+	}
+}
+
+/**
+ * @brief   List the sections of a file, or the keys of one of its sections (internal use only).
+ * @return  Number of characters written, not including the final null.
+ *
+ * @param[in]  section     Section whose keys are listed, or NULL to list the sections.
+ * @param[out] pOutBuffer  Buffer receiving the names.
+ * @param[in]  bufferSize  Size of the buffer.
+ * @param[in]  filePath    Path to the ini file.
+ *
+ * Names are listed with their original case, so the file is read directly instead of
+ * through its cached document.
+ */
+static size_t prv_micro_ini_compat_list_names(const char* const section, char* const pOutBuffer, const size_t bufferSize, const char* const filePath)
+{
+	micro_ini_compat_list list;
+
+	if(bufferSize < 2)
+	{
+		if(bufferSize == 1)
+		{
+			pOutBuffer[0] = '\0';
+		}
+
+		return 0;
+	}
+
+	list.section = section;
+	list.pOutBuffer = pOutBuffer;
+	list.bufferSize = bufferSize;
+	list.length = 0;
+	list.truncated = 0;
+
+	micro_ini_load(filePath, MICRO_INI_COMPAT_FLAGS, prv_micro_ini_compat_list_handler, NULL, &list);
+
+	if(list.truncated)
+	{
+		pOutBuffer[bufferSize - 2] = '\0';
+		pOutBuffer[bufferSize - 1] = '\0';
+
+		return bufferSize - 2;
+	}
+
+	if(list.length == 0)
+	{
+		/* An empty list is a pair of nulls. */
+		pOutBuffer[1] = '\0';
+	}
+
+	pOutBuffer[list.length] = '\0';
+
+	return list.length;
+}
+
+/**
+ * @brief  Key/value handler keeping the last pair it is given (internal use only).
+ *
+ * @param[in]  pUserData  Pointer to a micro_ini_compat_pair.
+ * @param[in]  section    Section of the pair (unused).
+ * @param[in]  key        Key of the pair.
+ * @param[in]  value      Value of the pair.
+ */
+static void prv_micro_ini_compat_pair_handler(void* pUserData, const char* section, const char* key, const char* value)
+{
+	micro_ini_compat_pair* const pPair = (micro_ini_compat_pair*) pUserData;
+
+	(void) section;
+
+	if(key)
+	{
+		strcpy(pPair->key, key);
+		strcpy(pPair->value, value);
+		pPair->found = 1;
+	}
+}
+
+/**
+ * @brief   Read a whole file into memory (internal use only).
+ * @return  MICRO_INI_SUCCESS or an error code.
+ *
+ * @param[in]  filePath   Path to the file.
+ * @param[out] ppOutData  Receives the contents (NULL when the file does not exist), released with
+ *                        micro_ini_allocator_free() on the cache's allocator.
+ * @param[out] pOutSize   Receives the number of bytes read.
+ */
+static int prv_micro_ini_compat_read_file(const char* const filePath, char** const ppOutData, size_t* const pOutSize)
+{
+	FILE* const pFile = fopen(filePath, "rb");
+	size_t capacity = 4096;
+	char* pData;
+	char* pGrown;
+
+	(*ppOutData) = NULL;
+	(*pOutSize) = 0;
+
+	if(!pFile)
+	{
+		/* A missing file is written from scratch. */
+		return MICRO_INI_SUCCESS;
+	}
+
+	pData = (char*) micro_ini_allocator_alloc(prv_micro_ini_compat_allocator, capacity);
+	if(!pData)
+	{
+		fclose(pFile);
+		return MICRO_INI_ERROR_OUT_OF_MEMORY;
+	}
+
+	for(;;)
+	{
+		(*pOutSize) += fread(pData + (*pOutSize), 1, capacity - (*pOutSize), pFile);
+		if((*pOutSize) < capacity)
+		{
+			break;
+		}
+
+		pGrown = (char*) micro_ini_allocator_realloc(prv_micro_ini_compat_allocator, pData, capacity * 2);
+		if(!pGrown)
+		{
+			micro_ini_allocator_free(prv_micro_ini_compat_allocator, pData);
+			fclose(pFile);
+			return MICRO_INI_ERROR_OUT_OF_MEMORY;
+		}
+
+		pData = pGrown;
+		capacity *= 2;
+	}
+
+	if(ferror(pFile))
+	{
+		micro_ini_allocator_free(prv_micro_ini_compat_allocator, pData);
+		fclose(pFile);
+		return MICRO_INI_ERROR_READ_FAILED;
+	}
+
+	fclose(pFile);
+
+	(*ppOutData) = pData;
+
+	return MICRO_INI_SUCCESS;
+}
+
+/**
+ * @brief   Find the name of a section header or key line (internal use only).
+ * @return  1 for a section header, 2 for a key line and 0 for anything else.
+ *
+ * @param[in]  pLine        Start of the line.
+ * @param[in]  pEnd         End of the line, not including the line break.
+ * @param[out] ppOutName    Receives the start of the name.
+ * @param[out] pOutLength   Receives the length of the name.
+ *
+ * This mirrors the way the parser reads lines, without copying them.
+ */
+static int prv_micro_ini_compat_classify(const char* pLine, const char* pEnd, const char** const ppOutName, size_t* const pOutLength)
+{
+	const char* pStop;
+	int kind;
+
+	while(pLine < pEnd && isspace((unsigned char) (*pLine)))
+	{
+		++pLine;
+	}
+
+	while(pEnd > pLine && isspace((unsigned char) pEnd[-1]))
+	{
+		--pEnd;
+	}
+
+	if(pLine == pEnd || (*pLine) == '#' || (*pLine) == ';')
+	{
+		return 0;
+	}
+
+	if((*pLine) == '[' && pEnd[-1] == ']')
+	{
+		++pLine;
+		pStop = (const char*) memchr(pLine, ']', (size_t) (pEnd - pLine));
+		kind = 1;
+	}
+	else
+	{
+		pStop = (const char*) memchr(pLine, '=', (size_t) (pEnd - pLine));
+		if(!pStop)
+		{
+			return 0;
+		}
+
+		kind = 2;
+	}
+
+	while(pLine < pStop && isspace((unsigned char) (*pLine)))
+	{
+		++pLine;
+	}
+
+	while(pStop > pLine && isspace((unsigned char) pStop[-1]))
+	{
+		--pStop;
+	}
+
+	(*ppOutName) = pLine;
+	(*pOutLength) = (size_t) (pStop - pLine);
+
+	return kind;
+}
+
+/**
+ * @brief   Write the new contents of a file with a single key or section changed (internal use only).
+ * @return  Non-zero if every write succeeded.
+ *
+ * @param[in]  pFile    File to write.
+ * @param[in]  pData    Current contents of the file (may be NULL when size is zero).
+ * @param[in]  size     Number of bytes in the current contents.
+ * @param[in]  section  Section name.
+ * @param[in]  key      Key name, or NULL to remove the section.
+ * @param[in]  value    New value, or NULL to remove the key.
+ */
+static int prv_micro_ini_compat_rewrite(
+	FILE* const pFile,
+	const char* const pData,
+	const size_t size,
+	const char* const section,
+	const char* const key,
+	const char* const value
+)
+{
+	const char* const pEnd = pData + size;
+	const char* const newline = (pData && memchr(pData, '\r', size)) ? "\r\n" : "\n";
+	const char* pInsert = NULL;
+	const char* pLine;
+	const char* pBreak;
+	const char* pNext;
+	const char* name;
+	size_t nameLength;
+	int inSection = 0;
+	int sectionSeen = 0;
+	int keyWritten = 0;
+	int ok = 1;
+	int kind;
+
+	/* Find where a new key goes: after the last line of the first copy of its section. */
+	for(pLine = pData; pLine < pEnd; pLine = pNext)
+	{
+		pBreak = (const char*) memchr(pLine, '\n', (size_t) (pEnd - pLine));
+		pNext = pBreak ? pBreak + 1 : pEnd;
+
+		kind = prv_micro_ini_compat_classify(pLine, pBreak ? pBreak : pEnd, &name, &nameLength);
+		if(kind == 1)
+		{
+			if(inSection)
+			{
+				break;
+			}
+
+			inSection = prv_micro_ini_compat_equal(section, name, nameLength);
+		}
+
+		if(inSection && kind != 0)
+		{
+			pInsert = pNext;
+		}
+	}
+
+	inSection = 0;
+
+	for(pLine = pData; pLine < pEnd; pLine = pNext)
+	{
+		pBreak = (const char*) memchr(pLine, '\n', (size_t) (pEnd - pLine));
+		pNext = pBreak ? pBreak + 1 : pEnd;
+
+		kind = prv_micro_ini_compat_classify(pLine, pBreak ? pBreak : pEnd, &name, &nameLength);
+		if(kind == 1)
+		{
+			inSection = prv_micro_ini_compat_equal(section, name, nameLength);
+			sectionSeen |= inSection;
+		}
+
+		if(inSection && !key)
+		{
+			/* Every line of the section is removed. */
+			continue;
+		}
+
+		if(inSection && kind == 2 && prv_micro_ini_compat_equal(key, name, nameLength))
+		{
+			if(value && !keyWritten)
+			{
+				ok &= fprintf(pFile, "%s=%s%s", key, value, newline) >= 0;
+				keyWritten = 1;
+			}
+
+			/* Removed keys and later copies of a replaced key are dropped. */
+			continue;
+		}
+
+		ok &= fwrite(pLine, 1, (size_t) (pNext - pLine), pFile) == (size_t) (pNext - pLine);
+
+		if(pNext == pInsert && key && value && !keyWritten)
+		{
+			if(!pBreak)
+			{
+				ok &= fputs(newline, pFile) >= 0;
+			}
+
+			ok &= fprintf(pFile, "%s=%s%s", key, value, newline) >= 0;
+			keyWritten = 1;
+		}
+	}
+
+	if(key && value && !sectionSeen)
+	{
+		if(size > 0 && pEnd[-1] != '\n')
+		{
+			ok &= fputs(newline, pFile) >= 0;
+		}
+
+		ok &= fprintf(pFile, "[%s]%s%s=%s%s", section, newline, key, value, newline) >= 0;
+	}
+
+	return ok;
+}
+
+/**
+ * @brief   Apply a write to the cached document of a file (internal use only).
+ * @return  MICRO_INI_SUCCESS or an error code (the cached document is unchanged on failure).
+ *
+ * @param[in]  pEntry   Cache entry of the file, which must match the file as it was before the write.
+ * @param[in]  section  Section name.
+ * @param[in]  key      Key name, or NULL to remove the section.
+ * @param[in]  value    New value, or NULL to remove the key.
+ *
+ * Only the written section is copied.  New pairs are run through the parser so the
+ * cached document holds exactly what a fresh parse of the file would.
+ */
+static int prv_micro_ini_compat_update(micro_ini_compat_entry* const pEntry, const char* const section, const char* const key, const char* const value)
+{
+	char foldedSection[MICRO_INI_MAX_LINE_LENGTH + 1];
+	char line[MICRO_INI_MAX_LINE_LENGTH + 1];
+	micro_ini_compat_pair pair;
+	micro_ini_doc_edit* pEdit;
+	micro_ini_doc* pDoc;
+	size_t sectionIndex;
+	size_t keyCount;
+	size_t i;
+	int result;
+
+	if(!prv_micro_ini_compat_fold(foldedSection, section))
+	{
+		return MICRO_INI_ERROR_BUFFER_OVERFLOW;
+	}
+
+	if(key && !prv_micro_ini_compat_fold(line, key))
+	{
+		return MICRO_INI_ERROR_BUFFER_OVERFLOW;
+	}
+
+	if(key && value)
+	{
+		if(strlen(line) + strlen(value) + 1 > MICRO_INI_MAX_LINE_LENGTH || strpbrk(line, "\r\n") || strpbrk(value, "\r\n"))
+		{
+			/* The parser would not read this pair back from a single line. */
+			return MICRO_INI_ERROR_INVALID_VALUE;
+		}
+
+		strcat(line, "=");
+		strcat(line, value);
+
+		pair.found = 0;
+		micro_ini_load_buffer(line, strlen(line), 0, prv_micro_ini_compat_pair_handler, NULL, &pair);
+		if(!pair.found)
+		{
+			return MICRO_INI_ERROR_INVALID_VALUE;
+		}
+	}
+
+	result = micro_ini_doc_edit_begin(&pEdit, pEntry->pDoc);
+	if(result != MICRO_INI_SUCCESS)
+	{
+		return result;
+	}
+
+	if(!key)
+	{
+		sectionIndex = micro_ini_doc_find_section(pEntry->pDoc, foldedSection);
+		keyCount = (sectionIndex != MICRO_INI_DOC_NPOS) ? micro_ini_doc_key_count(pEntry->pDoc, sectionIndex) : 0;
+
+		for(i = 0; i < keyCount && result == MICRO_INI_SUCCESS; ++i)
+		{
+			result = micro_ini_doc_edit_remove(pEdit, foldedSection, micro_ini_doc_key(pEntry->pDoc, sectionIndex, i));
+		}
+	}
+	else if(!value)
+	{
+		result = micro_ini_doc_edit_remove(pEdit, foldedSection, line);
+	}
+	else
+	{
+		result = micro_ini_doc_edit_set(pEdit, foldedSection, pair.key, pair.value);
+	}
+
+	if(result == MICRO_INI_SUCCESS)
+	{
+		result = micro_ini_doc_edit_commit(pEdit, &pDoc);
+	}
+
+	if(result != MICRO_INI_SUCCESS)
+	{
+		micro_ini_doc_edit_abort(pEdit);
+		return result;
+	}
+
+	micro_ini_doc_free(pEntry->pDoc);
+	pEntry->pDoc = pDoc;
+
+	return MICRO_INI_SUCCESS;
+}
+
+
+size_t micro_ini_get_profile_string(
+	const char* const section,
+	const char* const key,
+	const char* const defaultValue,
+	char* const pOutBuffer,
+	const size_t bufferSize,
+	const char* const filePath
+)
+{
+	const char* value;
+	size_t length;
+
+	if(!pOutBuffer || !filePath)
+	{
+		return 0;
+	}
+
+	MICRO_INI_COMPAT_LOCK();
+
+	if(!section || !key)
+	{
+		length = prv_micro_ini_compat_list_names(section, pOutBuffer, bufferSize, filePath);
+	}
+	else
+	{
+		value = prv_micro_ini_compat_get(section, key, filePath);
+		if(value)
+		{
+			length = prv_micro_ini_compat_copy(pOutBuffer, bufferSize, value, strlen(value));
+		}
+		else
+		{
+			value = defaultValue ? defaultValue : "";
+			length = strlen(value);
+
+			while(length > 0 && isspace((unsigned char) value[length - 1]))
+			{
+				--length;
+			}
+
+			length = prv_micro_ini_compat_copy(pOutBuffer, bufferSize, value, length);
+		}
+	}
+
+	MICRO_INI_COMPAT_UNLOCK();
+
+	return length;
+}
+
+
+long micro_ini_get_profile_int(
+	const char* const section,
+	const char* const key,
+	const long defaultValue,
+	const char* const filePath
+)
+{
+	const char* value;
+	long result = defaultValue;
+
+	if(!section || !key || !filePath)
+	{
+		return defaultValue;
+	}
+
+	MICRO_INI_COMPAT_LOCK();
+
+	value = prv_micro_ini_compat_get(section, key, filePath);
+	if(value)
+	{
+		/* strtol() stops at the first character that is not a digit and returns 0 when there are none. */
+		result = strtol(value, NULL, 10);
+	}
+
+	MICRO_INI_COMPAT_UNLOCK();
+
+	return result;
+}
+
+
+int micro_ini_write_profile_string(
+	const char* const section,
+	const char* const key,
+	const char* const value,
+	const char* const filePath
+)
+{
+	micro_ini_compat_entry* pEntry;
+	micro_ini_compat_stamp stamp;
+	FILE* pFile;
+	char* pData;
+	size_t size;
+	int current;
+	int result;
+
+	if(!filePath)
+	{
+		/* Invalid file path. */
+		return MICRO_INI_ERROR_INVALID_FILE_OBJECT;
+	}
+
+	if(!section)
+	{
+		/* Nothing to write. */
+		return MICRO_INI_ERROR_KEY_NOT_FOUND;
+	}
+
+	MICRO_INI_COMPAT_LOCK();
+
+	/* The cached document can only be updated in place if it matches the file being rewritten. */
+	pEntry = prv_micro_ini_compat_find(filePath);
+	current = pEntry
+		&& prv_micro_ini_compat_stamp_file(filePath, &stamp)
+		&& prv_micro_ini_compat_stamp_equal(&pEntry->stamp, &stamp);
+
+	result = prv_micro_ini_compat_read_file(filePath, &pData, &size);
+	if(result == MICRO_INI_SUCCESS)
+	{
+		pFile = fopen(filePath, "wb");
+		if(!pFile)
+		{
+			result = MICRO_INI_ERROR_WRITE_FAILED;
+		}
+		else
+		{
+			if(!prv_micro_ini_compat_rewrite(pFile, pData, size, section, key, value))
+			{
+				result = MICRO_INI_ERROR_WRITE_FAILED;
+			}
+
+			if(fclose(pFile) != 0)
+			{
+				result = MICRO_INI_ERROR_WRITE_FAILED;
+			}
+		}
+
+		micro_ini_allocator_free(prv_micro_ini_compat_allocator, pData);
+	}
+
+	if(pEntry)
+	{
+		if(result == MICRO_INI_SUCCESS
+			&& current
+			&& prv_micro_ini_compat_update(pEntry, section, key, value) == MICRO_INI_SUCCESS
+			&& prv_micro_ini_compat_stamp_file(filePath, &pEntry->stamp))
+		{
+			/* The cached document is current again without parsing the file. */
+		}
+		else
+		{
+			/* The next lookup parses the file again. */
+			prv_micro_ini_compat_drop(pEntry);
+		}
+	}
+
+	MICRO_INI_COMPAT_UNLOCK();
+
+	return result;
+}
+
+
+void micro_ini_flush_profile_cache(void)
+{
+	MICRO_INI_COMPAT_LOCK();
+
+	while(prv_micro_ini_compat_cache)
+	{
+		prv_micro_ini_compat_drop(prv_micro_ini_compat_cache);
+	}
+
+	MICRO_INI_COMPAT_UNLOCK();
+}
+
+
+void micro_ini_set_profile_allocator(micro_ini_allocator* const pAllocator)
+{
+	MICRO_INI_COMPAT_LOCK();
+
+	while(prv_micro_ini_compat_cache)
+	{
+		prv_micro_ini_compat_drop(prv_micro_ini_compat_cache);
+	}
+
+	prv_micro_ini_compat_allocator = pAllocator;
+
+	MICRO_INI_COMPAT_UNLOCK();
+}
@@ -0,0 +1,138 @@
+/**
+ * Copyright (c) 2021, Zoe J. Bare
+ *
+ * MIT License
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ */
+
+#pragma once
+
+#include "micro_ini.h"
+#include "micro_ini_alloc.h"
+
+#include <stddef.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*
+ * Drop-in replacements for the GetPrivateProfileString(), GetPrivateProfileInt() and
+ * WritePrivateProfileString() family.  This is an optional module layered on top of
+ * the document module; unlike the parser, it allocates memory.
+ *
+ * Every file is parsed once into a document that is cached by path.  Each call checks
+ * the file's size, modification time and inode with stat() and only parses it again
+ * when one of them has changed, so repeated lookups cost a stat() and a hash probe.
+ * Section and key names are matched without regard to case, as on Windows.  Writes
+ * go straight through to the file and update the cached document by copying only
+ * the section being written, so the next lookup does not parse the file again.
+ *
+ * Unlike the Windows functions, when a key appears more than once in the same section
+ * the last value wins, and section names listed by micro_ini_get_profile_string() only
+ * include sections holding at least one key.  The cache is protected by a single lock,
+ * so all of the functions may be called from multiple threads.
+ */
+
+/**
+ * @brief   Retrieve a string from an ini file.
+ * @return  Number of characters copied to the output buffer, not including the terminating null.
+ *
+ * @param[in]  section       Section name, or NULL to list the names of every section.
+ * @param[in]  key           Key name, or NULL to list the keys of the section.
+ * @param[in]  defaultValue  String copied when the key does not exist (may be NULL for an empty string).
+ * @param[out] pOutBuffer    Buffer receiving the string.
+ * @param[in]  bufferSize    Size of the output buffer in characters.
+ * @param[in]  filePath      Path to the ini file.
+ *
+ * Trailing blanks are removed from the default value.  A string that does not fit is
+ * truncated and bufferSize - 1 is returned.  Lists of names are written one after
+ * another, each followed by a null, with an extra null after the last one; a list that
+ * does not fit is truncated and bufferSize - 2 is returned.
+ */
+MICRO_INI_API size_t micro_ini_get_profile_string(
+	const char* const section,
+	const char* const key,
+	const char* const defaultValue,
+	char* const pOutBuffer,
+	const size_t bufferSize,
+	const char* const filePath
+);
+
+/**
+ * @brief   Retrieve an integer from an ini file.
+ * @return  Value of the key, or the default value when the key does not exist.
+ *
+ * @param[in]  section       Section name.
+ * @param[in]  key           Key name.
+ * @param[in]  defaultValue  Value returned when the key does not exist.
+ * @param[in]  filePath      Path to the ini file.
+ *
+ * Like GetPrivateProfileInt(), only the leading decimal digits of the value are
+ * converted and a value that does not start with a number is read as zero.
+ */
+MICRO_INI_API long micro_ini_get_profile_int(
+	const char* const section,
+	const char* const key,
+	const long defaultValue,
+	const char* const filePath
+);
+
+/**
+ * @brief   Write a string to an ini file.
+ * @return  MICRO_INI_SUCCESS or an error code.
+ *
+ * @param[in]  section   Section name.
+ * @param[in]  key       Key name, or NULL to remove the whole section.
+ * @param[in]  value     New value, or NULL to remove the key.
+ * @param[in]  filePath  Path to the ini file, which is created when it does not exist.
+ *
+ * The file is rewritten with every other line left untouched.  An existing key keeps
+ * its place, later copies of it in the same section are removed, and a new key is
+ * added after the last line of its section (or in a new section at the end of the file).
+ */
+MICRO_INI_API int micro_ini_write_profile_string(
+	const char* const section,
+	const char* const key,
+	const char* const value,
+	const char* const filePath
+);
+
+/**
+ * @brief  Release every cached document.
+ *
+ * Cached documents are otherwise kept until the program exits.
+ */
+MICRO_INI_API void micro_ini_flush_profile_cache(void);
+
+/**
+ * @brief  Set the allocator used for the cache.
+ *
+ * @param[in]  pAllocator  Allocator for the cached documents and the copies of files being rewritten (NULL for malloc()).
+ *
+ * Every cached document is released first, so nothing allocated by the previous
+ * allocator outlives the call.  The allocator is only ever called with the cache
+ * locked, so it does not need to be thread safe itself.
+ */
+MICRO_INI_API void micro_ini_set_profile_allocator(micro_ini_allocator* const pAllocator);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,3131 @@
+/**
+ * Copyright (c) 2021, Zoe J. Bare
+ *
+ * MIT License
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ */
+
+#include "micro_ini_doc.h"
+
+#include <ctype.h>
+#include <errno.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#if !defined(MICRO_INI_DOC_NO_TYPED_CACHE)
+	#if defined(__GNUC__) || defined(__clang__)
+		typedef int micro_ini_doc_atomic;
+
+		#define MICRO_INI_DOC_ATOMIC_LOAD(pAtomic)            __atomic_load_n((pAtomic), __ATOMIC_ACQUIRE)
+		#define MICRO_INI_DOC_ATOMIC_STORE(pAtomic, value)    __atomic_store_n((pAtomic), (value), __ATOMIC_RELEASE)
+		#define MICRO_INI_DOC_ATOMIC_CLAIM(pAtomic, pExpected, desired) \
+			__atomic_compare_exchange_n((pAtomic), (pExpected), (desired), 0, __ATOMIC_ACQUIRE, __ATOMIC_RELAXED)
+		#define MICRO_INI_DOC_ATOMIC_LOAD_POINTER(ppPointer)           __atomic_load_n((ppPointer), __ATOMIC_ACQUIRE)
+		#define MICRO_INI_DOC_ATOMIC_STORE_POINTER(ppPointer, pValue)  __atomic_store_n((ppPointer), (pValue), __ATOMIC_RELEASE)
+
+	#elif defined(_MSC_VER) && (defined(_M_IX86) || defined(_M_X64))
+		#include <intrin.h>
+
+		typedef volatile long micro_ini_doc_atomic;
+
+		/* Volatile accesses have acquire and release semantics on x86 and x64. */
+		#define MICRO_INI_DOC_ATOMIC_LOAD(pAtomic)            (*(pAtomic))
+		#define MICRO_INI_DOC_ATOMIC_STORE(pAtomic, value)    (*(pAtomic) = (value))
+		#define MICRO_INI_DOC_ATOMIC_CLAIM(pAtomic, pExpected, desired) \
+			(_InterlockedCompareExchange((pAtomic), (desired), *(pExpected)) == *(pExpected))
+		#define MICRO_INI_DOC_ATOMIC_LOAD_POINTER(ppPointer)           (*(void* volatile*) (ppPointer))
+		#define MICRO_INI_DOC_ATOMIC_STORE_POINTER(ppPointer, pValue)  (*(void* volatile*) (ppPointer) = (pValue))
+
+	#else
+		/* Without a known way to publish results atomically, typed values are decoded on every lookup. */
+		#define MICRO_INI_DOC_NO_TYPED_CACHE
+	#endif
+#endif
+
+#if defined(MICRO_INI_DOC_NO_TYPED_CACHE)
+	typedef int micro_ini_doc_atomic;
+
+	#define MICRO_INI_DOC_LOCK(pMemory)    ((void) 0)
+	#define MICRO_INI_DOC_UNLOCK(pMemory)  ((void) 0)
+#else
+	/* Typed lookups allocate from reading threads, so the memory accounting is updated under a spin lock. */
+	#define MICRO_INI_DOC_LOCK(pMemory) \
+		do { micro_ini_doc_atomic unlocked = 0; while(!MICRO_INI_DOC_ATOMIC_CLAIM(&(pMemory)->lock, &unlocked, 1)) { unlocked = 0; } } while(0)
+	#define MICRO_INI_DOC_UNLOCK(pMemory)  MICRO_INI_DOC_ATOMIC_STORE(&(pMemory)->lock, 0)
+#endif
+
+/**
+ * Smallest number of slots allocated for a hash table.
+ */
+#define MICRO_INI_DOC_MIN_SLOTS 8
+
+/**
+ * Initial capacity of a string pool.
+ */
+#define MICRO_INI_DOC_MIN_POOL_CAPACITY 256
+
+/**
+ * Number of distinct strings a pool interns before checking that enough strings repeat
+ * for interning to pay off.  Pools where fewer than one string was a repeat for every
+ * four distinct strings stop interning at that point and at every doubling after it.
+ */
+#define MICRO_INI_DOC_INTERN_CHECK 4096
+
+/**
+ * Parent offset of a section that does not inherit from another section.
+ */
+#define MICRO_INI_DOC_NO_PARENT 0xFFFFFFFFu
+
+/**
+ * Memory accounting shared by a document and every version derived from it (internal use only).
+ */
+typedef struct micro_ini_doc_memory
+{
+	int refCount;
+
+	size_t limit;  /* Maximum number of bytes that may be allocated (0 for no limit). */
+	size_t used;   /* Number of bytes currently allocated. */
+	size_t peak;   /* Highest number of bytes allocated at once. */
+
+	int limitReached;  /* Set when an allocation fails because of the limit rather than the system. */
+
+	uint32_t seed;  /* Hash seed shared by every table of the documents using this accounting. */
+
+	micro_ini_allocator* pAllocator;  /* Allocator every block is requested from (NULL for malloc()). */
+
+	micro_ini_doc_atomic lock;  /* Held while the fields above are updated (see MICRO_INI_DOC_LOCK). */
+} micro_ini_doc_memory;
+
+/**
+ * Header stored in front of every block allocated for a document (internal use only).
+ * The union keeps the block that follows it aligned for any type.
+ */
+typedef union micro_ini_doc_block
+{
+	size_t size;
+	double alignDouble;
+	void*  alignPointer;
+	long   alignLong;
+} micro_ini_doc_block;
+
+/**
+ * Open-addressed hash table mapping a hash to a dense entry index (internal use only).
+ *
+ * The hashes and entry indices are kept in separate arrays so a probe only walks
+ * the hash array until a match is found.  A hash of zero marks an empty slot.
+ */
+typedef struct micro_ini_doc_table
+{
+	uint32_t  mask;     /* Number of slots minus one (the slot count is always a power of two). */
+	uint32_t* hashes;   /* Hash stored in each slot. */
+	uint32_t* entries;  /* Dense entry index stored in each slot. */
+} micro_ini_doc_table;
+
+/**
+ * Contiguous string storage shared by one or more sections (internal use only).
+ *
+ * Every section created by a load shares a single pool.  Sections copied by an
+ * edit get a pool of their own so they can grow without affecting other versions.
+ *
+ * While a load or a compaction fills a pool, its distinct strings are interned so
+ * that repeated names and values are stored once and share an offset.  Pooled
+ * strings are never modified, so lookups cannot tell shared strings apart.
+ */
+typedef struct micro_ini_doc_pool
+{
+	int refCount;
+
+	micro_ini_doc_memory* pMemory;
+
+	uint32_t size;
+	uint32_t capacity;
+	char*    data;
+
+	int       interning;       /* Non-zero while identical strings are being stored once. */
+	uint32_t  internHits;      /* Number of strings that were found already in the pool. */
+	uint32_t  internCount;     /* Number of distinct strings. */
+	uint32_t  internCapacity;  /* Capacity of the interned array. */
+	uint32_t* interned;        /* Pool offset of each distinct string. */
+
+	micro_ini_doc_table internTable;
+} micro_ini_doc_pool;
+
+/**
+ * Type of a decoded value (internal use only).
+ */
+enum TypedKind
+{
+	TYPED_KIND_INT = 1,
+	TYPED_KIND_DOUBLE,
+	TYPED_KIND_BOOL,
+	TYPED_KIND_DURATION
+};
+
+/**
+ * Bits of the state of a typed value slot (internal use only).  An empty slot is zero.
+ */
+#define MICRO_INI_DOC_TYPED_CLAIMED 0x1  /* A reader is decoding the value; others decode it themselves rather than wait. */
+#define MICRO_INI_DOC_TYPED_READY   0x2  /* The slot holds a decoded value whose kind is stored above MICRO_INI_DOC_TYPED_SHIFT. */
+#define MICRO_INI_DOC_TYPED_INVALID 0x4  /* The value could not be decoded as its kind. */
+#define MICRO_INI_DOC_TYPED_SHIFT   4
+
+/**
+ * Decoded form of a value (internal use only).
+ */
+typedef union micro_ini_doc_typed
+{
+	long   integer;   /* TYPED_KIND_INT and TYPED_KIND_BOOL. */
+	double number;    /* TYPED_KIND_DOUBLE and TYPED_KIND_DURATION (in seconds). */
+} micro_ini_doc_typed;
+
+/**
+ * Memoized decoded value of a single key (internal use only).
+ *
+ * The first reader to claim an empty slot writes the value and then publishes it with
+ * a release store of the state, so a reader that observes a ready state with an
+ * acquire load also sees the value.  The value is never written again while the
+ * section may be shared; edits only reset slots of sections they own exclusively.
+ */
+typedef struct micro_ini_doc_typed_slot
+{
+	micro_ini_doc_atomic state;
+	micro_ini_doc_typed  value;
+} micro_ini_doc_typed_slot;
+
+/**
+ * Keys and values belonging to a single section (internal use only).
+ *
+ * Sections are reference counted so unchanged sections can be shared between
+ * document versions.  A section is only modified in place when neither it nor
+ * its pool is shared.
+ */
+typedef struct micro_ini_doc_section
+{
+	int refCount;
+
+	micro_ini_doc_pool* pPool;
+
+	uint32_t  name;      /* Pool offset of the section name. */
+	uint32_t  count;     /* Number of keys in the section. */
+	uint32_t  capacity;  /* Capacity of the dense key and value arrays. */
+	uint32_t* keys;      /* Pool offset of each key, in insertion order. */
+	uint32_t* values;    /* Pool offset of each value, in insertion order. */
+
+	micro_ini_doc_typed_slot* typed;  /* Memoized decoded value of each key, allocated on the first typed lookup (NULL before). */
+
+	uint32_t parent;      /* Pool offset of the parent section's name (MICRO_INI_DOC_NO_PARENT when there is none). */
+	uint32_t parentLine;  /* Line of the header naming the parent. */
+
+	micro_ini_doc_table table;
+} micro_ini_doc_section;
+
+struct micro_ini_doc
+{
+	micro_ini_doc_memory* pMemory;
+
+	uint32_t sectionCount;
+	uint32_t sectionCapacity;
+
+	micro_ini_doc_section** ppSections;  /* Sections in insertion order. */
+
+	micro_ini_doc_table sectionTable;
+
+	/*
+	 * Index of the parent of each section (MICRO_INI_DOC_NO_PARENT when it has none).
+	 * Lookups search a section and then follow these links, nearest ancestor first.  NULL
+	 * when no section has a parent, in which case each section searches only itself.
+	 */
+	uint32_t* parents;
+};
+
+struct micro_ini_doc_edit
+{
+	micro_ini_doc* pWork;  /* Working copy that becomes the new version on commit. */
+};
+
+/**
+ * Single key/value pair referenced by a sorted index (internal use only).
+ */
+typedef struct micro_ini_doc_index_entry
+{
+	const char* section;
+	const char* key;
+	const char* value;
+} micro_ini_doc_index_entry;
+
+struct micro_ini_doc_index
+{
+	micro_ini_doc_memory* pMemory;
+
+	size_t count;
+
+	micro_ini_doc_index_entry*  pBySection;  /* Entries sorted by section, then key. */
+	micro_ini_doc_index_entry** ppByKey;     /* Entries sorted by key, then section. */
+};
+
+/**
+ * Order in which a sorted index is searched (internal use only).
+ */
+enum IndexOrder
+{
+	INDEX_ORDER_SECTION,
+	INDEX_ORDER_KEY
+};
+
+/**
+ * State used while building a document from parser callbacks (internal use only).
+ */
+typedef struct micro_ini_doc_builder
+{
+	micro_ini_doc*      pDoc;
+	micro_ini_doc_pool* pPool;  /* Pool shared by every section created during the load. */
+
+	micro_ini_error_fn errorCallback;
+	void*              pUserData;
+
+	micro_ini_doc_section* pCurrentSection;  /* Section that received the last key. */
+
+	micro_ini_state state;  /* Parser state, used for the line numbers of parent links. */
+
+	int err;
+} micro_ini_doc_builder;
+
+/**
+ * @brief   Hash a string (seeded FNV-1a with a final mix, internal use only).
+ * @return  Non-zero hash of the string.
+ *
+ * @param[in]  pMemory  Memory accounting holding the seed.
+ * @param[in]  str      String to hash.
+ * @param[in]  len      Length of the string.
+ *
+ * Tables pick slots from the low bits of the hash.  Without the seed, keys sharing those
+ * bits are cheap to search for offline, and a file made of them would turn every insert
+ * into a scan of one long probe run; the final mix spreads the seed into every bit.
+ */
+static uint32_t prv_micro_ini_doc_hash(const micro_ini_doc_memory* const pMemory, const char* const str, const size_t len)
+{
+	uint32_t hash = 2166136261u ^ pMemory->seed;
+	size_t index = 0;
+
+	for(; index < len; ++index)
+	{
+		hash ^= (unsigned char) str[index];
+		hash *= 16777619u;
+	}
+
+	hash ^= hash >> 16;
+	hash *= 0x85EBCA6Bu;
+	hash ^= hash >> 13;
+	hash *= 0xC2B2AE35u;
+	hash ^= hash >> 16;
+
+	/* Zero is reserved for empty slots. */
+	return (hash != 0) ? hash : 1;
+}
+
+/**
+ * @brief   Create the memory accounting for a new document (internal use only).
+ * @return  New accounting with a single reference, or NULL if out of memory.
+ *
+ * @param[in]  pOptions  Options for the document (may be NULL).
+ */
+static micro_ini_doc_memory* prv_micro_ini_doc_memory_create(const micro_ini_doc_options* const pOptions)
+{
+	micro_ini_allocator* const pAllocator = pOptions ? pOptions->pAllocator : NULL;
+	micro_ini_doc_memory* const pMemory = (micro_ini_doc_memory*) micro_ini_allocator_calloc(pAllocator, 1, sizeof(micro_ini_doc_memory));
+
+	if(pMemory)
+	{
+		pMemory->pAllocator = pAllocator;
+		pMemory->refCount = 1;
+		pMemory->limit = pOptions ? pOptions->memoryLimit : 0;
+		pMemory->used = sizeof(micro_ini_doc_memory);
+		pMemory->peak = pMemory->used;
+
+		/* Different for each family of documents; the address varies between runs with address space randomization. */
+		pMemory->seed = ((uint32_t) time(NULL) * 0x9E3779B1u) ^ ((uint32_t) clock() * 0x85EBCA6Bu) ^ (uint32_t) (size_t) pMemory;
+	}
+
+	return pMemory;
+}
+
+/**
+ * @brief  Drop a reference to memory accounting, releasing it with the last reference (internal use only).
+ */
+static void prv_micro_ini_doc_memory_release(micro_ini_doc_memory* const pMemory)
+{
+	if(pMemory && --pMemory->refCount == 0)
+	{
+		micro_ini_allocator_free(pMemory->pAllocator, pMemory);
+	}
+}
+
+/**
+ * @brief   Get the error code describing the most recent allocation failure (internal use only).
+ * @return  MICRO_INI_ERROR_MEMORY_LIMIT or MICRO_INI_ERROR_OUT_OF_MEMORY.
+ */
+static int prv_micro_ini_doc_memory_error(micro_ini_doc_memory* const pMemory)
+{
+	const int limitReached = pMemory && pMemory->limitReached;
+
+	if(pMemory)
+	{
+		pMemory->limitReached = 0;
+	}
+
+	return limitReached ? MICRO_INI_ERROR_MEMORY_LIMIT : MICRO_INI_ERROR_OUT_OF_MEMORY;
+}
+
+/**
+ * @brief   Resize a block of memory while holding the accounting lock (internal use only).
+ * @return  Resized block, or NULL if out of memory (the original block is left untouched).
+ *
+ * @param[in]  pMemory  Memory accounting to charge.
+ * @param[in]  pBlock   Block to resize (NULL to allocate a new block).
+ * @param[in]  size     New size of the block in bytes.
+ */
+static void* prv_micro_ini_doc_mem_realloc_locked(micro_ini_doc_memory* const pMemory, void* const pBlock, const size_t size)
+{
+	micro_ini_doc_block* pHeader = pBlock ? ((micro_ini_doc_block*) pBlock) - 1 : NULL;
+	const size_t oldSize = pHeader ? pHeader->size : 0;
+	micro_ini_doc_block* pNewHeader;
+
+	if(size > ((size_t) -1) - sizeof(micro_ini_doc_block))
+	{
+		return NULL;
+	}
+
+	if(size > oldSize
+		&& pMemory->limit > 0
+		&& (size - oldSize > pMemory->limit || pMemory->used > pMemory->limit - (size - oldSize)))
+	{
+		/* Fail before touching the system allocator so the document never exceeds its budget. */
+		pMemory->limitReached = 1;
+		return NULL;
+	}
+
+	pNewHeader = (micro_ini_doc_block*) micro_ini_allocator_realloc(pMemory->pAllocator, pHeader, sizeof(micro_ini_doc_block) + size);
+	if(!pNewHeader)
+	{
+		return NULL;
+	}
+
+	pNewHeader->size = size;
+	pMemory->used = pMemory->used - oldSize + size;
+
+	if(pMemory->used > pMemory->peak)
+	{
+		pMemory->peak = pMemory->used;
+	}
+
+	return pNewHeader + 1;
+}
+
+/**
+ * @brief   Resize a block of memory, charging the change to a document's budget (internal use only).
+ * @return  Resized block, or NULL if out of memory (the original block is left untouched).
+ */
+static void* prv_micro_ini_doc_mem_realloc(micro_ini_doc_memory* const pMemory, void* const pBlock, const size_t size)
+{
+	void* pNewBlock;
+
+	MICRO_INI_DOC_LOCK(pMemory);
+	pNewBlock = prv_micro_ini_doc_mem_realloc_locked(pMemory, pBlock, size);
+	MICRO_INI_DOC_UNLOCK(pMemory);
+
+	return pNewBlock;
+}
+
+/**
+ * @brief   Allocate a block of memory charged to a document's budget (internal use only).
+ * @return  New block, or NULL if out of memory.
+ */
+static void* prv_micro_ini_doc_mem_alloc(micro_ini_doc_memory* const pMemory, const size_t size)
+{
+	return prv_micro_ini_doc_mem_realloc(pMemory, NULL, size);
+}
+
+/**
+ * @brief   Allocate a zero-filled array charged to a document's budget (internal use only).
+ * @return  New block, or NULL if out of memory.
+ */
+static void* prv_micro_ini_doc_mem_calloc(micro_ini_doc_memory* const pMemory, const size_t count, const size_t size)
+{
+	void* pBlock;
+
+	if(size != 0 && count > ((size_t) -1) / size)
+	{
+		return NULL;
+	}
+
+	pBlock = prv_micro_ini_doc_mem_alloc(pMemory, count * size);
+	if(pBlock)
+	{
+		memset(pBlock, 0, count * size);
+	}
+
+	return pBlock;
+}
+
+/**
+ * @brief  Release a block of memory and refund it to a document's budget (internal use only).
+ */
+static void prv_micro_ini_doc_mem_free(micro_ini_doc_memory* const pMemory, void* const pBlock)
+{
+	if(pBlock)
+	{
+		micro_ini_doc_block* const pHeader = ((micro_ini_doc_block*) pBlock) - 1;
+
+		MICRO_INI_DOC_LOCK(pMemory);
+		pMemory->used -= pHeader->size;
+		micro_ini_allocator_free(pMemory->pAllocator, pHeader);
+		MICRO_INI_DOC_UNLOCK(pMemory);
+	}
+}
+
+/**
+ * @brief   Grow a dense offset array to a new capacity (internal use only).
+ * @return  Non-zero on success.
+ */
+static int prv_micro_ini_doc_grow_array(micro_ini_doc_memory* const pMemory, uint32_t** const ppArray, const uint32_t capacity)
+{
+	uint32_t* const pNewArray = (uint32_t*) prv_micro_ini_doc_mem_realloc(pMemory, *ppArray, sizeof(uint32_t) * capacity);
+
+	if(!pNewArray)
+	{
+		return 0;
+	}
+
+	(*ppArray) = pNewArray;
+	return 1;
+}
+
+/**
+ * @brief  Release the arrays of a hash table (internal use only).
+ */
+static void prv_micro_ini_doc_table_free(micro_ini_doc_memory* const pMemory, micro_ini_doc_table* const pTable)
+{
+	prv_micro_ini_doc_mem_free(pMemory, pTable->hashes);
+	prv_micro_ini_doc_mem_free(pMemory, pTable->entries);
+
+	pTable->mask = 0;
+	pTable->hashes = NULL;
+	pTable->entries = NULL;
+}
+
+/**
+ * @brief   Allocate an empty hash table (internal use only).
+ * @return  Non-zero on success.
+ *
+ * @param[in]  pMemory    Memory accounting to charge.
+ * @param[in]  pTable     Table to initialize.
+ * @param[in]  slotCount  Number of slots (must be a power of two).
+ */
+static int prv_micro_ini_doc_table_alloc(micro_ini_doc_memory* const pMemory, micro_ini_doc_table* const pTable, const uint32_t slotCount)
+{
+	pTable->mask = slotCount - 1;
+	pTable->hashes = (uint32_t*) prv_micro_ini_doc_mem_calloc(pMemory, slotCount, sizeof(uint32_t));
+	pTable->entries = (uint32_t*) prv_micro_ini_doc_mem_alloc(pMemory, sizeof(uint32_t) * slotCount);
+
+	if(!pTable->hashes || !pTable->entries)
+	{
+		prv_micro_ini_doc_table_free(pMemory, pTable);
+		return 0;
+	}
+
+	return 1;
+}
+
+/**
+ * @brief   Copy a hash table (internal use only).
+ * @return  Non-zero on success.
+ */
+static int prv_micro_ini_doc_table_copy(
+	micro_ini_doc_memory* const pMemory,
+	micro_ini_doc_table* const pDest,
+	const micro_ini_doc_table* const pSource
+)
+{
+	if(!pSource->hashes)
+	{
+		pDest->mask = 0;
+		pDest->hashes = NULL;
+		pDest->entries = NULL;
+		return 1;
+	}
+
+	if(!prv_micro_ini_doc_table_alloc(pMemory, pDest, pSource->mask + 1))
+	{
+		return 0;
+	}
+
+	memcpy(pDest->hashes, pSource->hashes, sizeof(uint32_t) * (pSource->mask + 1));
+	memcpy(pDest->entries, pSource->entries, sizeof(uint32_t) * (pSource->mask + 1));
+
+	return 1;
+}
+
+/**
+ * @brief   Find the entry matching a string in a hash table (internal use only).
+ * @return  Dense entry index, or MICRO_INI_DOC_NPOS if the string was not found.
+ *
+ * @param[in]  pTable   Table to probe.
+ * @param[in]  pool     String pool referenced by the offsets.
+ * @param[in]  offsets  Pool offset of the string belonging to each dense entry.
+ * @param[in]  str      String to find.
+ * @param[in]  len      Length of the string.
+ * @param[in]  hash     Hash of the string.
+ */
+static size_t prv_micro_ini_doc_table_find(
+	const micro_ini_doc_table* const pTable,
+	const char* const pool,
+	const uint32_t* const offsets,
+	const char* const str,
+	const size_t len,
+	const uint32_t hash
+)
+{
+	uint32_t slot;
+
+	if(!pTable->hashes)
+	{
+		return MICRO_INI_DOC_NPOS;
+	}
+
+	slot = hash & pTable->mask;
+
+	while(pTable->hashes[slot] != 0)
+	{
+		if(pTable->hashes[slot] == hash)
+		{
+			const uint32_t entry = pTable->entries[slot];
+
+			/* Comparing the terminator as well rejects longer strings sharing the same prefix. */
+			if(memcmp(pool + offsets[entry], str, len + 1) == 0)
+			{
+				return entry;
+			}
+		}
+
+		slot = (slot + 1) & pTable->mask;
+	}
+
+	return MICRO_INI_DOC_NPOS;
+}
+
+/**
+ * @brief  Insert an entry into a hash table that is known to have a free slot (internal use only).
+ */
+static void prv_micro_ini_doc_table_insert(micro_ini_doc_table* const pTable, const uint32_t hash, const uint32_t entry)
+{
+	uint32_t slot = hash & pTable->mask;
+
+	while(pTable->hashes[slot] != 0)
+	{
+		slot = (slot + 1) & pTable->mask;
+	}
+
+	pTable->hashes[slot] = hash;
+	pTable->entries[slot] = entry;
+}
+
+/**
+ * @brief   Make sure a hash table can hold one more entry at a load factor of 50% (internal use only).
+ * @return  Non-zero on success.
+ *
+ * @param[in]  pMemory  Memory accounting to charge.
+ * @param[in]  pTable   Table to grow.
+ * @param[in]  count    Number of entries currently stored in the table.
+ */
+static int prv_micro_ini_doc_table_reserve(micro_ini_doc_memory* const pMemory, micro_ini_doc_table* const pTable, const uint32_t count)
+{
+	micro_ini_doc_table newTable;
+	uint32_t slotCount;
+	uint32_t slot;
+
+	if(pTable->hashes && (count + 1) * 2 <= pTable->mask + 1)
+	{
+		/* There is still enough room. */
+		return 1;
+	}
+
+	slotCount = pTable->hashes ? (pTable->mask + 1) * 2 : MICRO_INI_DOC_MIN_SLOTS;
+	if(slotCount == 0 || !prv_micro_ini_doc_table_alloc(pMemory, &newTable, slotCount))
+	{
+		return 0;
+	}
+
+	if(pTable->hashes)
+	{
+		for(slot = 0; slot <= pTable->mask; ++slot)
+		{
+			/* The stored hashes are reused, so the strings do not need to be touched. */
+			if(pTable->hashes[slot] != 0)
+			{
+				prv_micro_ini_doc_table_insert(&newTable, pTable->hashes[slot], pTable->entries[slot]);
+			}
+		}
+	}
+
+	prv_micro_ini_doc_table_free(pMemory, pTable);
+	(*pTable) = newTable;
+
+	return 1;
+}
+
+/**
+ * @brief   Create an empty string pool (internal use only).
+ * @return  New pool with a single reference, or NULL if out of memory.
+ */
+static micro_ini_doc_pool* prv_micro_ini_doc_pool_create(micro_ini_doc_memory* const pMemory)
+{
+	micro_ini_doc_pool* const pPool = (micro_ini_doc_pool*) prv_micro_ini_doc_mem_calloc(pMemory, 1, sizeof(micro_ini_doc_pool));
+
+	if(pPool)
+	{
+		pPool->refCount = 1;
+		pPool->pMemory = pMemory;
+
+		++pMemory->refCount;
+	}
+
+	return pPool;
+}
+
+/**
+ * @brief  Stop interning the strings added to a pool and release its table of distinct strings (internal use only).
+ */
+static void prv_micro_ini_doc_pool_seal(micro_ini_doc_pool* const pPool)
+{
+	prv_micro_ini_doc_table_free(pPool->pMemory, &pPool->internTable);
+	prv_micro_ini_doc_mem_free(pPool->pMemory, pPool->interned);
+
+	pPool->interning = 0;
+	pPool->internHits = 0;
+	pPool->internCount = 0;
+	pPool->internCapacity = 0;
+	pPool->interned = NULL;
+}
+
+/**
+ * @brief  Drop a reference to a string pool, releasing it with the last reference (internal use only).
+ */
+static void prv_micro_ini_doc_pool_release(micro_ini_doc_pool* const pPool)
+{
+	if(pPool && --pPool->refCount == 0)
+	{
+		micro_ini_doc_memory* const pMemory = pPool->pMemory;
+
+		prv_micro_ini_doc_pool_seal(pPool);
+		prv_micro_ini_doc_mem_free(pMemory, pPool->data);
+		prv_micro_ini_doc_mem_free(pMemory, pPool);
+		prv_micro_ini_doc_memory_release(pMemory);
+	}
+}
+
+/**
+ * @brief   Make sure a string pool has room for a number of bytes without growing (internal use only).
+ * @return  Non-zero on success.
+ */
+static int prv_micro_ini_doc_pool_reserve(micro_ini_doc_pool* const pPool, const size_t capacity)
+{
+	char* pNewData;
+
+	if(capacity <= pPool->capacity)
+	{
+		return 1;
+	}
+	else if(capacity > UINT32_MAX)
+	{
+		/* Pool offsets are 32-bit. */
+		return 0;
+	}
+
+	pNewData = (char*) prv_micro_ini_doc_mem_realloc(pPool->pMemory, pPool->data, capacity);
+	if(!pNewData)
+	{
+		return 0;
+	}
+
+	pPool->data = pNewData;
+	pPool->capacity = (uint32_t) capacity;
+
+	return 1;
+}
+
+/**
+ * @brief   Copy a string with a known hash into a string pool (internal use only).
+ * @return  Non-zero on success.
+ *
+ * @param[in]  pPool       Pool receiving the string.
+ * @param[in]  str         Null terminated string to copy.
+ * @param[in]  len         Length of the string.
+ * @param[in]  hash        Hash of the string (only used when the pool is interning).
+ * @param[out] pOutOffset  Receives the pool offset of the copied string, which is the offset of an
+ *                         identical string already in the pool when the pool is interning.
+ */
+static int prv_micro_ini_doc_pool_add_hashed(
+	micro_ini_doc_pool* const pPool,
+	const char* const str,
+	const size_t len,
+	const uint32_t hash,
+	uint32_t* const pOutOffset
+)
+{
+	const size_t required = (size_t) pPool->size + len + 1;
+
+	if(pPool->interning)
+	{
+		const size_t existing = prv_micro_ini_doc_table_find(&pPool->internTable, pPool->data, pPool->interned, str, len, hash);
+
+		if(existing != MICRO_INI_DOC_NPOS)
+		{
+			++pPool->internHits;
+			(*pOutOffset) = pPool->interned[existing];
+			return 1;
+		}
+
+		if(pPool->internCount == pPool->internCapacity)
+		{
+			const uint32_t newCapacity = pPool->internCapacity ? pPool->internCapacity * 2 : 64;
+
+			if(pPool->internCount >= MICRO_INI_DOC_INTERN_CHECK && pPool->internHits < pPool->internCount / 4)
+			{
+				/* Too few strings repeat for the table to pay for itself. */
+				prv_micro_ini_doc_pool_seal(pPool);
+			}
+			else if(!prv_micro_ini_doc_grow_array(pPool->pMemory, &pPool->interned, newCapacity))
+			{
+				return 0;
+			}
+			else
+			{
+				pPool->internCapacity = newCapacity;
+			}
+		}
+
+		if(pPool->interning && !prv_micro_ini_doc_table_reserve(pPool->pMemory, &pPool->internTable, pPool->internCount))
+		{
+			return 0;
+		}
+	}
+
+	if(required > UINT32_MAX)
+	{
+		/* Pool offsets are 32-bit. */
+		return 0;
+	}
+
+	if(required > pPool->capacity)
+	{
+		size_t newCapacity = pPool->capacity ? (size_t) pPool->capacity * 2 : MICRO_INI_DOC_MIN_POOL_CAPACITY;
+		char* pNewData;
+
+		while(newCapacity < required)
+		{
+			newCapacity *= 2;
+		}
+
+		if(newCapacity > UINT32_MAX)
+		{
+			newCapacity = UINT32_MAX;
+		}
+
+		pNewData = (char*) prv_micro_ini_doc_mem_realloc(pPool->pMemory, pPool->data, newCapacity);
+		if(!pNewData && pPool->pMemory->limitReached && newCapacity > required)
+		{
+			/* Doubling would exceed the memory limit, but an exact fit may not. */
+			pPool->pMemory->limitReached = 0;
+			newCapacity = required;
+			pNewData = (char*) prv_micro_ini_doc_mem_realloc(pPool->pMemory, pPool->data, newCapacity);
+		}
+
+		if(!pNewData)
+		{
+			return 0;
+		}
+
+		pPool->data = pNewData;
+		pPool->capacity = (uint32_t) newCapacity;
+	}
+
+	memcpy(pPool->data + pPool->size, str, len);
+	pPool->data[pPool->size + len] = '\0';
+
+	(*pOutOffset) = pPool->size;
+	pPool->size += (uint32_t)(len + 1);
+
+	if(pPool->interning)
+	{
+		pPool->interned[pPool->internCount] = (*pOutOffset);
+		prv_micro_ini_doc_table_insert(&pPool->internTable, hash, pPool->internCount);
+		++pPool->internCount;
+	}
+
+	return 1;
+}
+
+/**
+ * @brief   Copy a string into a string pool (internal use only).
+ * @return  Non-zero on success.
+ *
+ * @param[in]  pPool       Pool receiving the string.
+ * @param[in]  str         Null terminated string to copy.
+ * @param[in]  len         Length of the string.
+ * @param[out] pOutOffset  Receives the pool offset of the copied string.
+ */
+static int prv_micro_ini_doc_pool_add(
+	micro_ini_doc_pool* const pPool,
+	const char* const str,
+	const size_t len,
+	uint32_t* const pOutOffset
+)
+{
+	const uint32_t hash = pPool->interning ? prv_micro_ini_doc_hash(pPool->pMemory, str, len) : 0;
+
+	return prv_micro_ini_doc_pool_add_hashed(pPool, str, len, hash, pOutOffset);
+}
+
+/**
+ * @brief  Empty a typed value slot (internal use only).
+ *
+ * Only called on sections owned exclusively by the caller, so no reader can observe the slot.
+ */
+static void prv_micro_ini_doc_typed_reset(micro_ini_doc_typed_slot* const pSlot)
+{
+	pSlot->state = 0;
+	pSlot->value.integer = 0;
+}
+
+/**
+ * @brief  Copy a typed value slot into a new section (internal use only).
+ *
+ * The source may be read concurrently, so only published values are copied.
+ */
+static void prv_micro_ini_doc_typed_copy(micro_ini_doc_typed_slot* const pDest, const micro_ini_doc_typed_slot* const pSource)
+{
+	prv_micro_ini_doc_typed_reset(pDest);
+
+#if !defined(MICRO_INI_DOC_NO_TYPED_CACHE)
+	{
+		const int state = (int) MICRO_INI_DOC_ATOMIC_LOAD((micro_ini_doc_atomic*) &pSource->state);
+
+		if(state & MICRO_INI_DOC_TYPED_READY)
+		{
+			pDest->state = state;
+			pDest->value = pSource->value;
+		}
+	}
+#else
+	(void) pSource;
+#endif
+}
+
+/**
+ * @brief   Get the typed value slots of a section as published so far (internal use only).
+ * @return  Slots for every key of the section, or NULL if no typed lookup has allocated them yet.
+ */
+static micro_ini_doc_typed_slot* prv_micro_ini_doc_typed_peek(const micro_ini_doc_section* const pSection)
+{
+#if !defined(MICRO_INI_DOC_NO_TYPED_CACHE)
+	return (micro_ini_doc_typed_slot*) MICRO_INI_DOC_ATOMIC_LOAD_POINTER(&((micro_ini_doc_section*) pSection)->typed);
+#else
+	(void) pSection;
+	return NULL;
+#endif
+}
+
+/**
+ * @brief  Drop the typed value slots of a section after an edit (internal use only).
+ *
+ * Only called on sections owned exclusively by the caller; the next typed lookup allocates them again.
+ */
+static void prv_micro_ini_doc_typed_drop(micro_ini_doc_section* const pSection)
+{
+	prv_micro_ini_doc_mem_free(pSection->pPool->pMemory, pSection->typed);
+	pSection->typed = NULL;
+}
+
+/**
+ * @brief   Get the name of a section (internal use only).
+ * @return  Section name.
+ */
+static const char* prv_micro_ini_doc_section_name(const micro_ini_doc_section* const pSection)
+{
+	return pSection->pPool->data + pSection->name;
+}
+
+/**
+ * @brief   Create an empty section (internal use only).
+ * @return  New section with a single reference, or NULL if out of memory.
+ *
+ * @param[in]  pMemory  Memory accounting to charge.
+ * @param[in]  pPool    Pool to store the section's strings in (NULL to give the section a pool of its own).
+ * @param[in]  name     Section name.
+ * @param[in]  len      Length of the section name.
+ */
+static micro_ini_doc_section* prv_micro_ini_doc_section_create(
+	micro_ini_doc_memory* const pMemory,
+	micro_ini_doc_pool* const pPool,
+	const char* const name,
+	const size_t len
+)
+{
+	micro_ini_doc_section* const pSection = (micro_ini_doc_section*) prv_micro_ini_doc_mem_calloc(pMemory, 1, sizeof(micro_ini_doc_section));
+
+	if(!pSection)
+	{
+		return NULL;
+	}
+
+	if(pPool)
+	{
+		++pPool->refCount;
+		pSection->pPool = pPool;
+	}
+	else
+	{
+		pSection->pPool = prv_micro_ini_doc_pool_create(pMemory);
+	}
+
+	pSection->refCount = 1;
+	pSection->parent = MICRO_INI_DOC_NO_PARENT;
+
+	if(!pSection->pPool || !prv_micro_ini_doc_pool_add(pSection->pPool, name, len, &pSection->name))
+	{
+		prv_micro_ini_doc_mem_free(pMemory, pSection);
+		prv_micro_ini_doc_pool_release(pSection->pPool);
+		return NULL;
+	}
+
+	return pSection;
+}
+
+/**
+ * @brief  Drop a reference to a section, releasing it with the last reference (internal use only).
+ */
+static void prv_micro_ini_doc_section_release(micro_ini_doc_section* const pSection)
+{
+	if(pSection && --pSection->refCount == 0)
+	{
+		micro_ini_doc_pool* const pPool = pSection->pPool;
+		micro_ini_doc_memory* const pMemory = pPool->pMemory;
+
+		prv_micro_ini_doc_table_free(pMemory, &pSection->table);
+		prv_micro_ini_doc_mem_free(pMemory, pSection->keys);
+		prv_micro_ini_doc_mem_free(pMemory, pSection->values);
+		prv_micro_ini_doc_mem_free(pMemory, pSection->typed);
+		prv_micro_ini_doc_mem_free(pMemory, pSection);
+
+		/* The pool goes last since it may hold the final reference to the memory accounting. */
+		prv_micro_ini_doc_pool_release(pPool);
+	}
+}
+
+/**
+ * @brief   Copy a section into a different pool (internal use only).
+ * @return  New section with a single reference, or NULL if out of memory.
+ *
+ * @param[in]  pSource  Section to copy.
+ * @param[in]  pPool    Pool to store the copied strings in (NULL to give the copy a pool of its own).
+ *
+ * Only the strings still referenced by the section are copied, so the copy starts
+ * out without any of the garbage left in the source pool by replaced values.
+ */
+static micro_ini_doc_section* prv_micro_ini_doc_section_clone(const micro_ini_doc_section* const pSource, micro_ini_doc_pool* const pPool)
+{
+	micro_ini_doc_memory* const pMemory = pSource->pPool->pMemory;
+	const char* const name = prv_micro_ini_doc_section_name(pSource);
+
+	micro_ini_doc_section* const pSection = prv_micro_ini_doc_section_create(pMemory, pPool, name, strlen(name));
+	const micro_ini_doc_typed_slot* pSourceTyped = NULL;
+	uint32_t entry;
+
+	if(!pSection)
+	{
+		return NULL;
+	}
+
+	if(pSource->parent != MICRO_INI_DOC_NO_PARENT)
+	{
+		const char* const parent = pSource->pPool->data + pSource->parent;
+
+		if(!prv_micro_ini_doc_pool_add(pSection->pPool, parent, strlen(parent), &pSection->parent))
+		{
+			prv_micro_ini_doc_section_release(pSection);
+			return NULL;
+		}
+
+		pSection->parentLine = pSource->parentLine;
+	}
+
+	if(pSource->count > 0)
+	{
+		pSection->keys = (uint32_t*) prv_micro_ini_doc_mem_alloc(pMemory, sizeof(uint32_t) * pSource->count);
+		pSection->values = (uint32_t*) prv_micro_ini_doc_mem_alloc(pMemory, sizeof(uint32_t) * pSource->count);
+		pSection->capacity = pSource->count;
+
+		if(!pSection->keys || !pSection->values || !prv_micro_ini_doc_table_copy(pMemory, &pSection->table, &pSource->table))
+		{
+			prv_micro_ini_doc_section_release(pSection);
+			return NULL;
+		}
+
+		/* Sections nobody queried with a typed getter stay without slots in the copy too. */
+		pSourceTyped = prv_micro_ini_doc_typed_peek(pSource);
+		if(pSourceTyped)
+		{
+			pSection->typed = (micro_ini_doc_typed_slot*) prv_micro_ini_doc_mem_alloc(pMemory, sizeof(micro_ini_doc_typed_slot) * pSource->count);
+
+			if(!pSection->typed)
+			{
+				prv_micro_ini_doc_section_release(pSection);
+				return NULL;
+			}
+		}
+	}
+
+	for(entry = 0; entry < pSource->count; ++entry)
+	{
+		/* Entries keep their dense index, so the copied hash table stays valid. */
+		const char* const key = pSource->pPool->data + pSource->keys[entry];
+		const char* const value = pSource->pPool->data + pSource->values[entry];
+
+		if(!prv_micro_ini_doc_pool_add(pSection->pPool, key, strlen(key), &pSection->keys[entry])
+			|| !prv_micro_ini_doc_pool_add(pSection->pPool, value, strlen(value), &pSection->values[entry]))
+		{
+			prv_micro_ini_doc_section_release(pSection);
+			return NULL;
+		}
+
+		if(pSourceTyped)
+		{
+			prv_micro_ini_doc_typed_copy(&pSection->typed[entry], &pSourceTyped[entry]);
+		}
+
+		++pSection->count;
+	}
+
+	return pSection;
+}
+
+/**
+ * @brief   Find a key in a section (internal use only).
+ * @return  Dense entry index, or MICRO_INI_DOC_NPOS if the key does not exist.
+ */
+static size_t prv_micro_ini_doc_section_find(const micro_ini_doc_section* const pSection, const char* const key, const size_t len)
+{
+	return prv_micro_ini_doc_table_find(
+		&pSection->table,
+		pSection->pPool->data,
+		pSection->keys,
+		key,
+		len,
+		prv_micro_ini_doc_hash(pSection->pPool->pMemory, key, len)
+	);
+}
+
+/**
+ * @brief   Set the value of a key in a section, adding the key if it does not exist (internal use only).
+ * @return  Non-zero on success.
+ */
+static int prv_micro_ini_doc_section_set(micro_ini_doc_section* const pSection, const char* const key, const char* const value)
+{
+	micro_ini_doc_memory* const pMemory = pSection->pPool->pMemory;
+
+	const size_t keyLen = strlen(key);
+	const uint32_t hash = prv_micro_ini_doc_hash(pMemory, key, keyLen);
+	const size_t existing = prv_micro_ini_doc_table_find(&pSection->table, pSection->pPool->data, pSection->keys, key, keyLen, hash);
+
+	uint32_t keyOffset;
+	uint32_t valueOffset;
+
+	if(existing != MICRO_INI_DOC_NPOS)
+	{
+		/* The last value assigned to a key wins. */
+		if(!prv_micro_ini_doc_pool_add(pSection->pPool, value, strlen(value), &valueOffset))
+		{
+			return 0;
+		}
+
+		pSection->values[existing] = valueOffset;
+
+		if(pSection->typed)
+		{
+			prv_micro_ini_doc_typed_reset(&pSection->typed[existing]);
+		}
+
+		return 1;
+	}
+
+	if(pSection->count == pSection->capacity)
+	{
+		const uint32_t newCapacity = pSection->capacity ? pSection->capacity * 2 : 8;
+
+		if(!prv_micro_ini_doc_grow_array(pMemory, &pSection->keys, newCapacity)
+			|| !prv_micro_ini_doc_grow_array(pMemory, &pSection->values, newCapacity))
+		{
+			return 0;
+		}
+
+		pSection->capacity = newCapacity;
+	}
+
+	if(!prv_micro_ini_doc_table_reserve(pMemory, &pSection->table, pSection->count))
+	{
+		return 0;
+	}
+
+	/* The key was hashed with the same seed to probe the section, so the pool can reuse its hash. */
+	if(!prv_micro_ini_doc_pool_add_hashed(pSection->pPool, key, keyLen, hash, &keyOffset)
+		|| !prv_micro_ini_doc_pool_add(pSection->pPool, value, strlen(value), &valueOffset))
+	{
+		return 0;
+	}
+
+	pSection->keys[pSection->count] = keyOffset;
+	pSection->values[pSection->count] = valueOffset;
+
+	/* The slots cover only the keys that existed when they were allocated. */
+	prv_micro_ini_doc_typed_drop(pSection);
+
+	prv_micro_ini_doc_table_insert(&pSection->table, hash, pSection->count);
+	++pSection->count;
+
+	return 1;
+}
+
+/**
+ * @brief  Remove an entry from a section, preserving the order of the remaining keys (internal use only).
+ */
+static void prv_micro_ini_doc_section_remove(micro_ini_doc_section* const pSection, const size_t entry)
+{
+	uint32_t index;
+
+	--pSection->count;
+
+	for(index = (uint32_t) entry; index < pSection->count; ++index)
+	{
+		pSection->keys[index] = pSection->keys[index + 1];
+		pSection->values[index] = pSection->values[index + 1];
+
+		if(pSection->typed)
+		{
+			pSection->typed[index] = pSection->typed[index + 1];
+		}
+	}
+
+	/* Entry indices shifted, so rebuild the hash table in place. */
+	memset(pSection->table.hashes, 0, sizeof(uint32_t) * (pSection->table.mask + 1));
+
+	for(index = 0; index < pSection->count; ++index)
+	{
+		const char* const key = pSection->pPool->data + pSection->keys[index];
+
+		prv_micro_ini_doc_table_insert(&pSection->table, prv_micro_ini_doc_hash(pSection->pPool->pMemory, key, strlen(key)), index);
+	}
+}
+
+/**
+ * @brief   Find a section in a document (internal use only).
+ * @return  Section index, or MICRO_INI_DOC_NPOS if the section does not exist.
+ */
+static size_t prv_micro_ini_doc_find_section(
+	const micro_ini_doc* const pDoc,
+	const char* const name,
+	const size_t len,
+	const uint32_t hash
+)
+{
+	const micro_ini_doc_table* const pTable = &pDoc->sectionTable;
+	uint32_t slot;
+
+	if(!pTable->hashes)
+	{
+		return MICRO_INI_DOC_NPOS;
+	}
+
+	slot = hash & pTable->mask;
+
+	while(pTable->hashes[slot] != 0)
+	{
+		if(pTable->hashes[slot] == hash)
+		{
+			const uint32_t entry = pTable->entries[slot];
+
+			if(memcmp(prv_micro_ini_doc_section_name(pDoc->ppSections[entry]), name, len + 1) == 0)
+			{
+				return entry;
+			}
+		}
+
+		slot = (slot + 1) & pTable->mask;
+	}
+
+	return MICRO_INI_DOC_NPOS;
+}
+
+/**
+ * @brief   Append a new section to a document, transferring the caller's reference (internal use only).
+ * @return  Non-zero on success.
+ */
+static int prv_micro_ini_doc_append_section(micro_ini_doc* const pDoc, micro_ini_doc_section* const pSection, const uint32_t hash)
+{
+	if(pDoc->sectionCount == pDoc->sectionCapacity)
+	{
+		const uint32_t newCapacity = pDoc->sectionCapacity ? pDoc->sectionCapacity * 2 : 8;
+		micro_ini_doc_section** const ppNewSections =
+			(micro_ini_doc_section**) prv_micro_ini_doc_mem_realloc(pDoc->pMemory, pDoc->ppSections, sizeof(micro_ini_doc_section*) * newCapacity);
+
+		if(!ppNewSections)
+		{
+			return 0;
+		}
+
+		pDoc->ppSections = ppNewSections;
+		pDoc->sectionCapacity = newCapacity;
+	}
+
+	if(!prv_micro_ini_doc_table_reserve(pDoc->pMemory, &pDoc->sectionTable, pDoc->sectionCount))
+	{
+		return 0;
+	}
+
+	pDoc->ppSections[pDoc->sectionCount] = pSection;
+	prv_micro_ini_doc_table_insert(&pDoc->sectionTable, hash, pDoc->sectionCount);
+
+	++pDoc->sectionCount;
+
+	return 1;
+}
+
+/**
+ * @brief   Find a section, creating it if it does not exist (internal use only).
+ * @return  Section owned by the document, or NULL if out of memory.
+ *
+ * @param[in]  pDoc   Document to search.
+ * @param[in]  pPool  Pool for a newly created section (NULL to give it a pool of its own).
+ * @param[in]  name   Section name.
+ */
+static micro_ini_doc_section* prv_micro_ini_doc_add_section(micro_ini_doc* const pDoc, micro_ini_doc_pool* const pPool, const char* const name)
+{
+	const size_t len = strlen(name);
+	const uint32_t hash = prv_micro_ini_doc_hash(pDoc->pMemory, name, len);
+	const size_t existing = prv_micro_ini_doc_find_section(pDoc, name, len, hash);
+
+	micro_ini_doc_section* pSection;
+
+	if(existing != MICRO_INI_DOC_NPOS)
+	{
+		return pDoc->ppSections[existing];
+	}
+
+	pSection = prv_micro_ini_doc_section_create(pDoc->pMemory, pPool, name, len);
+	if(!pSection)
+	{
+		return NULL;
+	}
+
+	if(!prv_micro_ini_doc_append_section(pDoc, pSection, hash))
+	{
+		prv_micro_ini_doc_section_release(pSection);
+		return NULL;
+	}
+
+	return pSection;
+}
+
+/**
+ * @brief   Make sure a section of a document is not shared before modifying it (internal use only).
+ * @return  Section that may be modified in place, or NULL if out of memory.
+ */
+static micro_ini_doc_section* prv_micro_ini_doc_own_section(micro_ini_doc* const pDoc, const size_t sectionIndex)
+{
+	micro_ini_doc_section* const pSection = pDoc->ppSections[sectionIndex];
+	micro_ini_doc_section* pCopy;
+
+	if(pSection->refCount == 1 && pSection->pPool->refCount == 1)
+	{
+		/* Nothing else can observe this section. */
+		return pSection;
+	}
+
+	pCopy = prv_micro_ini_doc_section_clone(pSection, NULL);
+	if(!pCopy)
+	{
+		return NULL;
+	}
+
+	/* The position in the document is unchanged, so the section table stays valid. */
+	pDoc->ppSections[sectionIndex] = pCopy;
+	prv_micro_ini_doc_section_release(pSection);
+
+	return pCopy;
+}
+
+/**
+ * @brief   Find a key in a section or the sections it inherits from (internal use only).
+ * @return  Dense entry index within the section holding the key, or MICRO_INI_DOC_NPOS if the key does not exist.
+ *
+ * @param[in]  pDoc          Document to search.
+ * @param[in]  sectionIndex  Index of the section to start from.
+ * @param[in]  key           Key name.
+ * @param[out] ppOwner       Receives the section holding the key.
+ */
+static size_t prv_micro_ini_doc_lookup(
+	const micro_ini_doc* const pDoc,
+	const size_t sectionIndex,
+	const char* const key,
+	micro_ini_doc_section** const ppOwner
+)
+{
+	const size_t len = strlen(key);
+	const uint32_t hash = prv_micro_ini_doc_hash(pDoc->pMemory, key, len);
+
+	uint32_t node = (uint32_t) sectionIndex;
+
+	/* The key is hashed once and probed against the section and then each of its ancestors, nearest first. */
+	while(node != MICRO_INI_DOC_NO_PARENT)
+	{
+		micro_ini_doc_section* const pSection = pDoc->ppSections[node];
+		const size_t entry = prv_micro_ini_doc_table_find(&pSection->table, pSection->pPool->data, pSection->keys, key, len, hash);
+
+		if(entry != MICRO_INI_DOC_NPOS)
+		{
+			(*ppOwner) = pSection;
+			return entry;
+		}
+
+		node = pDoc->parents ? pDoc->parents[node] : MICRO_INI_DOC_NO_PARENT;
+	}
+
+	return MICRO_INI_DOC_NPOS;
+}
+
+/**
+ * @brief  Report a parent link that could not be followed (internal use only).
+ *
+ * @param[in]  pSection       Section whose header named the parent.
+ * @param[in]  errorCallback  Callback for the report (may be NULL).
+ * @param[in]  pUserData      Pointer to user data that is passed to the callback.
+ */
+static void prv_micro_ini_doc_report_parent(const micro_ini_doc_section* const pSection, const micro_ini_error_fn errorCallback, void* const pUserData)
+{
+	char line[MICRO_INI_MAX_LINE_LENGTH + 1];
+	const char* parts[5];
+	size_t len = 0;
+	size_t part;
+
+	if(!errorCallback)
+	{
+		return;
+	}
+
+	parts[0] = "[";
+	parts[1] = prv_micro_ini_doc_section_name(pSection);
+	parts[2] = " : ";
+	parts[3] = pSection->pPool->data + pSection->parent;
+	parts[4] = "]";
+
+	/* Rebuild the header, truncated to the longest line the parser could have read. */
+	for(part = 0; part < sizeof(parts) / sizeof(parts[0]); ++part)
+	{
+		const char* str = parts[part];
+
+		for(; *str != '\0' && len < MICRO_INI_MAX_LINE_LENGTH; ++str)
+		{
+			line[len++] = *str;
+		}
+	}
+
+	line[len] = '\0';
+
+	errorCallback(pUserData, line, (int) pSection->parentLine);
+}
+
+/**
+ * @brief   Resolve the parent links of a document into section indices (internal use only).
+ * @return  Number of broken links, or an error code.
+ *
+ * @param[in]  pDoc           Document to link.
+ * @param[in]  errorCallback  Callback for reporting broken links (may be NULL).
+ * @param[in]  pUserData      Pointer to user data that is passed to the callback.
+ *
+ * Links to a missing section are dropped, and so is the link that closes a cycle, so
+ * every chain ends.  Only the index of each section's parent is stored, never keys or
+ * whole chains, so linking takes time and memory linear in the number of sections
+ * however deep the inheritance goes.
+ */
+static int prv_micro_ini_doc_link_sections(micro_ini_doc* const pDoc, const micro_ini_error_fn errorCallback, void* const pUserData)
+{
+	micro_ini_allocator* const pAllocator = pDoc->pMemory->pAllocator;
+	uint32_t* parents = NULL;
+	uint32_t* path = NULL;
+	unsigned char* marks = NULL;
+
+	uint32_t index;
+	int numErrors = 0;
+
+	prv_micro_ini_doc_mem_free(pDoc->pMemory, pDoc->parents);
+	pDoc->parents = NULL;
+
+	for(index = 0; index < pDoc->sectionCount; ++index)
+	{
+		if(pDoc->ppSections[index]->parent != MICRO_INI_DOC_NO_PARENT)
+		{
+			break;
+		}
+	}
+
+	if(index == pDoc->sectionCount)
+	{
+		/* Nothing inherits, so every section only searches itself. */
+		return 0;
+	}
+
+	/* Temporary storage; it is not charged to the document. */
+	parents = (uint32_t*) micro_ini_allocator_calloc(pAllocator, pDoc->sectionCount, sizeof(uint32_t));
+	path = (uint32_t*) micro_ini_allocator_calloc(pAllocator, pDoc->sectionCount, sizeof(uint32_t));
+	marks = (unsigned char*) micro_ini_allocator_calloc(pAllocator, pDoc->sectionCount, 1);
+
+	if(!parents || !path || !marks)
+	{
+		micro_ini_allocator_free(pAllocator, parents);
+		micro_ini_allocator_free(pAllocator, path);
+		micro_ini_allocator_free(pAllocator, marks);
+		return MICRO_INI_ERROR_OUT_OF_MEMORY;
+	}
+
+	for(index = 0; index < pDoc->sectionCount; ++index)
+	{
+		const micro_ini_doc_section* const pSection = pDoc->ppSections[index];
+
+		parents[index] = MICRO_INI_DOC_NO_PARENT;
+
+		if(pSection->parent != MICRO_INI_DOC_NO_PARENT)
+		{
+			const size_t parentIndex = micro_ini_doc_find_section(pDoc, pSection->pPool->data + pSection->parent);
+
+			if(parentIndex == MICRO_INI_DOC_NPOS)
+			{
+				prv_micro_ini_doc_report_parent(pSection, errorCallback, pUserData);
+				++numErrors;
+			}
+			else
+			{
+				parents[index] = (uint32_t) parentIndex;
+			}
+		}
+	}
+
+	/* Walk up from each section; meeting a section already on the current walk means the last link closed a cycle. */
+	for(index = 0; index < pDoc->sectionCount; ++index)
+	{
+		uint32_t depth = 0;
+		uint32_t node = index;
+
+		while(node != MICRO_INI_DOC_NO_PARENT && marks[node] == 0)
+		{
+			marks[node] = 1;
+			path[depth++] = node;
+			node = parents[node];
+		}
+
+		if(node != MICRO_INI_DOC_NO_PARENT && marks[node] == 1)
+		{
+			prv_micro_ini_doc_report_parent(pDoc->ppSections[path[depth - 1]], errorCallback, pUserData);
+			++numErrors;
+
+			parents[path[depth - 1]] = MICRO_INI_DOC_NO_PARENT;
+		}
+
+		while(depth > 0)
+		{
+			marks[path[--depth]] = 2;
+		}
+	}
+
+	pDoc->parents = (uint32_t*) prv_micro_ini_doc_mem_alloc(pDoc->pMemory, sizeof(uint32_t) * pDoc->sectionCount);
+	if(!pDoc->parents)
+	{
+		numErrors = prv_micro_ini_doc_memory_error(pDoc->pMemory);
+	}
+	else
+	{
+		memcpy(pDoc->parents, parents, sizeof(uint32_t) * pDoc->sectionCount);
+	}
+
+	micro_ini_allocator_free(pAllocator, parents);
+	micro_ini_allocator_free(pAllocator, path);
+	micro_ini_allocator_free(pAllocator, marks);
+
+	return numErrors;
+}
+
+/**
+ * @brief   Remove every section that no longer has any keys or a parent (internal use only).
+ * @return  Non-zero on success.
+ */
+static int prv_micro_ini_doc_remove_empty_sections(micro_ini_doc* const pDoc)
+{
+	uint32_t readIndex;
+	uint32_t writeIndex = 0;
+
+	for(readIndex = 0; readIndex < pDoc->sectionCount; ++readIndex)
+	{
+		micro_ini_doc_section* const pSection = pDoc->ppSections[readIndex];
+
+		if(pSection->count == 0 && pSection->parent == MICRO_INI_DOC_NO_PARENT)
+		{
+			/* A section without keys still matters when it passes on inherited keys. */
+			prv_micro_ini_doc_section_release(pSection);
+		}
+		else
+		{
+			pDoc->ppSections[writeIndex] = pSection;
+			++writeIndex;
+		}
+	}
+
+	if(writeIndex == pDoc->sectionCount)
+	{
+		return 1;
+	}
+
+	pDoc->sectionCount = writeIndex;
+
+	/* Section indices shifted, so rebuild the section table in place. */
+	memset(pDoc->sectionTable.hashes, 0, sizeof(uint32_t) * (pDoc->sectionTable.mask + 1));
+
+	for(readIndex = 0; readIndex < pDoc->sectionCount; ++readIndex)
+	{
+		const char* const name = prv_micro_ini_doc_section_name(pDoc->ppSections[readIndex]);
+
+		prv_micro_ini_doc_table_insert(&pDoc->sectionTable, prv_micro_ini_doc_hash(pDoc->pMemory, name, strlen(name)), readIndex);
+	}
+
+	return 1;
+}
+
+/**
+ * @brief  Parser callback that stores each key/value pair in the document being built (internal use only).
+ */
+static void prv_micro_ini_doc_handler(void* const pUserData, const char* const section, const char* const key, const char* const value)
+{
+	micro_ini_doc_builder* const pBuilder = (micro_ini_doc_builder*) pUserData;
+
+	if(pBuilder->err != MICRO_INI_SUCCESS)
+	{
+		/* The parser cannot be stopped from a callback, so ignore everything after a failure. */
+		return;
+	}
+
+	if(!pBuilder->pCurrentSection || strcmp(prv_micro_ini_doc_section_name(pBuilder->pCurrentSection), section) != 0)
+	{
+		/* Keys arrive grouped by section, so the section only needs to be resolved when it changes. */
+		pBuilder->pCurrentSection = prv_micro_ini_doc_add_section(pBuilder->pDoc, pBuilder->pPool, section);
+
+		if(!pBuilder->pCurrentSection)
+		{
+			pBuilder->err = prv_micro_ini_doc_memory_error(pBuilder->pDoc->pMemory);
+			return;
+		}
+	}
+
+	if(!key)
+	{
+		/* Parent link from a "[section : parent]" header; the last header naming a parent wins. */
+		if(!prv_micro_ini_doc_pool_add(pBuilder->pCurrentSection->pPool, value, strlen(value), &pBuilder->pCurrentSection->parent))
+		{
+			pBuilder->err = prv_micro_ini_doc_memory_error(pBuilder->pDoc->pMemory);
+		}
+
+		pBuilder->pCurrentSection->parentLine = pBuilder->state.lineno;
+		return;
+	}
+
+	if(!prv_micro_ini_doc_section_set(pBuilder->pCurrentSection, key, value))
+	{
+		pBuilder->err = prv_micro_ini_doc_memory_error(pBuilder->pDoc->pMemory);
+	}
+}
+
+/**
+ * @brief  Parser error callback that forwards to the user's callback (internal use only).
+ */
+static void prv_micro_ini_doc_error(void* const pUserData, const char* const line, const int lineno)
+{
+	micro_ini_doc_builder* const pBuilder = (micro_ini_doc_builder*) pUserData;
+
+	if(pBuilder->errorCallback)
+	{
+		pBuilder->errorCallback(pBuilder->pUserData, line, lineno);
+	}
+}
+
+/**
+ * @brief   Create an empty document (internal use only).
+ * @return  New document, or NULL if out of memory.
+ *
+ * @param[in]  pMemory  Memory accounting the document is charged to (a reference is added).
+ */
+static micro_ini_doc* prv_micro_ini_doc_create(micro_ini_doc_memory* const pMemory)
+{
+	micro_ini_doc* const pDoc = (micro_ini_doc*) prv_micro_ini_doc_mem_calloc(pMemory, 1, sizeof(micro_ini_doc));
+
+	if(pDoc)
+	{
+		pDoc->pMemory = pMemory;
+		++pMemory->refCount;
+	}
+
+	return pDoc;
+}
+
+/**
+ * @brief   Prepare a builder with an empty document (internal use only).
+ * @return  MICRO_INI_SUCCESS or an error code.
+ */
+static int prv_micro_ini_doc_builder_init(
+	micro_ini_doc_builder* const pBuilder,
+	const micro_ini_doc_options* const pOptions,
+	const micro_ini_error_fn errorCallback,
+	void* const pUserData
+)
+{
+	micro_ini_doc_memory* const pMemory = prv_micro_ini_doc_memory_create(pOptions);
+
+	int err = MICRO_INI_SUCCESS;
+
+	if(!pMemory)
+	{
+		return MICRO_INI_ERROR_OUT_OF_MEMORY;
+	}
+
+	pBuilder->pDoc = prv_micro_ini_doc_create(pMemory);
+	pBuilder->pPool = prv_micro_ini_doc_pool_create(pMemory);
+
+	if(pBuilder->pPool)
+	{
+		/* Keys and values tend to repeat across sections, so each distinct string is stored once. */
+		pBuilder->pPool->interning = 1;
+	}
+
+	pBuilder->errorCallback = errorCallback;
+	pBuilder->pUserData = pUserData;
+	pBuilder->pCurrentSection = NULL;
+	pBuilder->err = MICRO_INI_SUCCESS;
+
+	micro_ini_state_init(&pBuilder->state);
+
+	if(!pBuilder->pDoc || !pBuilder->pPool)
+	{
+		err = prv_micro_ini_doc_memory_error(pMemory);
+
+		micro_ini_doc_free(pBuilder->pDoc);
+		prv_micro_ini_doc_pool_release(pBuilder->pPool);
+	}
+
+	/* The document and pool hold their own references. */
+	prv_micro_ini_doc_memory_release(pMemory);
+
+	return err;
+}
+
+/**
+ * @brief   Hand the built document to the caller or release it on failure (internal use only).
+ * @return  Final result of the load.
+ *
+ * @param[in]  pBuilder  Builder holding the document.
+ * @param[in]  result    Value returned by the parser.
+ * @param[out] ppOutDoc  Receives the document.
+ */
+static int prv_micro_ini_doc_builder_finish(micro_ini_doc_builder* const pBuilder, int result, micro_ini_doc** const ppOutDoc)
+{
+	/* The sections hold their own references to the pool; strings added by later edits are not interned. */
+	prv_micro_ini_doc_pool_seal(pBuilder->pPool);
+	prv_micro_ini_doc_pool_release(pBuilder->pPool);
+
+	if(result >= 0 && pBuilder->err != MICRO_INI_SUCCESS)
+	{
+		result = pBuilder->err;
+	}
+
+	if(result >= 0)
+	{
+		/* Broken parent links are reported like parsing errors. */
+		const int linkResult = prv_micro_ini_doc_link_sections(pBuilder->pDoc, pBuilder->errorCallback, pBuilder->pUserData);
+
+		result = (linkResult < 0) ? linkResult : result + linkResult;
+	}
+
+	if(result < 0)
+	{
+		micro_ini_doc_free(pBuilder->pDoc);
+		(*ppOutDoc) = NULL;
+	}
+	else
+	{
+		(*ppOutDoc) = pBuilder->pDoc;
+	}
+
+	return result;
+}
+
+
+int micro_ini_doc_load(
+	micro_ini_doc** const ppOutDoc,
+	const char* const filePath,
+	const int flags,
+	const micro_ini_doc_options* const pOptions,
+	const micro_ini_error_fn errorCallback,
+	void* const pUserData
+)
+{
+	micro_ini_doc_builder builder;
+	int result;
+
+	if(!ppOutDoc)
+	{
+		/* Invalid document output pointer. */
+		return MICRO_INI_ERROR_INVALID_DOCUMENT;
+	}
+
+	result = prv_micro_ini_doc_builder_init(&builder, pOptions, errorCallback, pUserData);
+	if(result != MICRO_INI_SUCCESS)
+	{
+		(*ppOutDoc) = NULL;
+		return result;
+	}
+
+	result = micro_ini_resume(&builder.state, filePath, flags, prv_micro_ini_doc_handler, prv_micro_ini_doc_error, &builder);
+
+	return prv_micro_ini_doc_builder_finish(&builder, result, ppOutDoc);
+}
+
+
+int micro_ini_doc_load_file(
+	micro_ini_doc** const ppOutDoc,
+	FILE* const pFile,
+	const int flags,
+	const micro_ini_doc_options* const pOptions,
+	const micro_ini_error_fn errorCallback,
+	void* const pUserData
+)
+{
+	micro_ini_doc_builder builder;
+	int result;
+
+	if(!ppOutDoc)
+	{
+		/* Invalid document output pointer. */
+		return MICRO_INI_ERROR_INVALID_DOCUMENT;
+	}
+
+	result = prv_micro_ini_doc_builder_init(&builder, pOptions, errorCallback, pUserData);
+	if(result != MICRO_INI_SUCCESS)
+	{
+		(*ppOutDoc) = NULL;
+		return result;
+	}
+
+	result = micro_ini_resume_file(&builder.state, pFile, flags, prv_micro_ini_doc_handler, prv_micro_ini_doc_error, &builder);
+
+	return prv_micro_ini_doc_builder_finish(&builder, result, ppOutDoc);
+}
+
+
+int micro_ini_doc_load_stream(
+	micro_ini_doc** const ppOutDoc,
+	void* const pStream,
+	const int flags,
+	const micro_ini_doc_options* const pOptions,
+	const micro_ini_error_fn errorCallback,
+	const micro_ini_reader_fn readerCallback,
+	const micro_ini_eof_fn eofCallback,
+	void* const pUserData
+)
+{
+	micro_ini_doc_builder builder;
+	int result;
+
+	if(!ppOutDoc)
+	{
+		/* Invalid document output pointer. */
+		return MICRO_INI_ERROR_INVALID_DOCUMENT;
+	}
+
+	result = prv_micro_ini_doc_builder_init(&builder, pOptions, errorCallback, pUserData);
+	if(result != MICRO_INI_SUCCESS)
+	{
+		(*ppOutDoc) = NULL;
+		return result;
+	}
+
+	result = micro_ini_resume_stream(
+		&builder.state,
+		pStream,
+		flags,
+		prv_micro_ini_doc_handler,
+		prv_micro_ini_doc_error,
+		readerCallback,
+		eofCallback,
+		&builder
+	);
+
+	return prv_micro_ini_doc_builder_finish(&builder, result, ppOutDoc);
+}
+
+
+int micro_ini_doc_load_buffer(
+	micro_ini_doc** const ppOutDoc,
+	const char* const pData,
+	const size_t size,
+	const int flags,
+	const micro_ini_doc_options* const pOptions,
+	const micro_ini_error_fn errorCallback,
+	void* const pUserData
+)
+{
+	micro_ini_doc_builder builder;
+	int result;
+
+	if(!ppOutDoc)
+	{
+		/* Invalid document output pointer. */
+		return MICRO_INI_ERROR_INVALID_DOCUMENT;
+	}
+
+	result = prv_micro_ini_doc_builder_init(&builder, pOptions, errorCallback, pUserData);
+	if(result != MICRO_INI_SUCCESS)
+	{
+		(*ppOutDoc) = NULL;
+		return result;
+	}
+
+	result = micro_ini_resume_buffer(&builder.state, pData, size, flags, prv_micro_ini_doc_handler, prv_micro_ini_doc_error, &builder);
+
+	return prv_micro_ini_doc_builder_finish(&builder, result, ppOutDoc);
+}
+
+
+void micro_ini_doc_free(micro_ini_doc* const pDoc)
+{
+	micro_ini_doc_memory* pMemory;
+	uint32_t index;
+
+	if(!pDoc)
+	{
+		return;
+	}
+
+	pMemory = pDoc->pMemory;
+
+	for(index = 0; index < pDoc->sectionCount; ++index)
+	{
+		prv_micro_ini_doc_section_release(pDoc->ppSections[index]);
+	}
+
+	prv_micro_ini_doc_table_free(pMemory, &pDoc->sectionTable);
+	prv_micro_ini_doc_mem_free(pMemory, pDoc->ppSections);
+	prv_micro_ini_doc_mem_free(pMemory, pDoc->parents);
+	prv_micro_ini_doc_mem_free(pMemory, pDoc);
+	prv_micro_ini_doc_memory_release(pMemory);
+}
+
+
+const char* micro_ini_doc_get(const micro_ini_doc* const pDoc, const char* const section, const char* const key)
+{
+	return micro_ini_doc_section_get(pDoc, micro_ini_doc_find_section(pDoc, section), key);
+}
+
+
+size_t micro_ini_doc_find_section(const micro_ini_doc* const pDoc, const char* const section)
+{
+	size_t len;
+
+	if(!pDoc || !section)
+	{
+		return MICRO_INI_DOC_NPOS;
+	}
+
+	len = strlen(section);
+
+	return prv_micro_ini_doc_find_section(pDoc, section, len, prv_micro_ini_doc_hash(pDoc->pMemory, section, len));
+}
+
+
+const char* micro_ini_doc_section_get(const micro_ini_doc* const pDoc, const size_t sectionIndex, const char* const key)
+{
+	micro_ini_doc_section* pSection;
+	size_t entry;
+
+	if(!pDoc || !key || sectionIndex >= pDoc->sectionCount)
+	{
+		return NULL;
+	}
+
+	entry = prv_micro_ini_doc_lookup(pDoc, sectionIndex, key, &pSection);
+
+	return (entry != MICRO_INI_DOC_NPOS) ? pSection->pPool->data + pSection->values[entry] : NULL;
+}
+
+
+size_t micro_ini_doc_section_parent(const micro_ini_doc* const pDoc, const size_t sectionIndex)
+{
+	if(!pDoc || !pDoc->parents || sectionIndex >= pDoc->sectionCount || pDoc->parents[sectionIndex] == MICRO_INI_DOC_NO_PARENT)
+	{
+		return MICRO_INI_DOC_NPOS;
+	}
+
+	return pDoc->parents[sectionIndex];
+}
+
+
+size_t micro_ini_doc_section_count(const micro_ini_doc* const pDoc)
+{
+	return pDoc ? pDoc->sectionCount : 0;
+}
+
+
+const char* micro_ini_doc_section_name(const micro_ini_doc* const pDoc, const size_t sectionIndex)
+{
+	if(!pDoc || sectionIndex >= pDoc->sectionCount)
+	{
+		return NULL;
+	}
+
+	return prv_micro_ini_doc_section_name(pDoc->ppSections[sectionIndex]);
+}
+
+
+size_t micro_ini_doc_key_count(const micro_ini_doc* const pDoc, const size_t sectionIndex)
+{
+	if(!pDoc || sectionIndex >= pDoc->sectionCount)
+	{
+		return 0;
+	}
+
+	return pDoc->ppSections[sectionIndex]->count;
+}
+
+
+const char* micro_ini_doc_key(const micro_ini_doc* const pDoc, const size_t sectionIndex, const size_t keyIndex)
+{
+	const micro_ini_doc_section* pSection;
+
+	if(!pDoc || sectionIndex >= pDoc->sectionCount || keyIndex >= pDoc->ppSections[sectionIndex]->count)
+	{
+		return NULL;
+	}
+
+	pSection = pDoc->ppSections[sectionIndex];
+
+	return pSection->pPool->data + pSection->keys[keyIndex];
+}
+
+
+const char* micro_ini_doc_value(const micro_ini_doc* const pDoc, const size_t sectionIndex, const size_t keyIndex)
+{
+	const micro_ini_doc_section* pSection;
+
+	if(!pDoc || sectionIndex >= pDoc->sectionCount || keyIndex >= pDoc->ppSections[sectionIndex]->count)
+	{
+		return NULL;
+	}
+
+	pSection = pDoc->ppSections[sectionIndex];
+
+	return pSection->pPool->data + pSection->values[keyIndex];
+}
+
+
+int micro_ini_doc_fingerprint(const micro_ini_doc* const pDoc, micro_ini_fingerprint* const pOutFingerprint)
+{
+	const micro_ini_doc_section* pSection;
+	const char* name;
+	size_t parent;
+	uint32_t index;
+	uint32_t key;
+
+	if(!pDoc || !pOutFingerprint)
+	{
+		/* Invalid document or fingerprint output pointer. */
+		return MICRO_INI_ERROR_INVALID_DOCUMENT;
+	}
+
+	pOutFingerprint->low = 0;
+	pOutFingerprint->high = 0;
+
+	for(index = 0; index < pDoc->sectionCount; ++index)
+	{
+		pSection = pDoc->ppSections[index];
+		name = micro_ini_doc_section_name(pDoc, index);
+
+		parent = micro_ini_doc_section_parent(pDoc, index);
+		if(parent != MICRO_INI_DOC_NPOS)
+		{
+			micro_ini_fingerprint_add(pOutFingerprint, name, NULL, micro_ini_doc_section_name(pDoc, parent));
+		}
+
+		for(key = 0; key < pSection->count; ++key)
+		{
+			micro_ini_fingerprint_add(pOutFingerprint, name, pSection->pPool->data + pSection->keys[key], pSection->pPool->data + pSection->values[key]);
+		}
+	}
+
+	return MICRO_INI_SUCCESS;
+}
+
+
+/**
+ * @brief   Compare a string against a lowercase word, ignoring case (internal use only).
+ * @return  Non-zero if they match.
+ */
+static int prv_micro_ini_doc_equals_word(const char* str, const char* word)
+{
+	for(; *str != '\0' && *word != '\0'; ++str, ++word)
+	{
+		if(tolower((unsigned char) *str) != *word)
+		{
+			return 0;
+		}
+	}
+
+	return *str == *word;
+}
+
+/**
+ * @brief   Decode a value as a given kind (internal use only).
+ * @return  Non-zero on success.
+ *
+ * @param[in]  kind    Kind of value to decode.
+ * @param[in]  str     Value string.
+ * @param[out] pValue  Receives the decoded value.
+ */
+static int prv_micro_ini_doc_decode(const int kind, const char* const str, micro_ini_doc_typed* const pValue)
+{
+	char* end = NULL;
+
+	/* The parser strips values, so leading whitespace can only come from an edit; reject it like any other junk. */
+	if(str[0] == '\0' || isspace((unsigned char) str[0]))
+	{
+		return 0;
+	}
+
+	errno = 0;
+
+	switch(kind)
+	{
+		case TYPED_KIND_INT:
+		{
+			const char* digits = str + ((str[0] == '-' || str[0] == '+') ? 1 : 0);
+			const int base = (digits[0] == '0' && (digits[1] == 'x' || digits[1] == 'X')) ? 16 : 10;
+
+			pValue->integer = strtol(str, &end, base);
+			return end != str && *end == '\0' && errno == 0;
+		}
+
+		case TYPED_KIND_DOUBLE:
+			pValue->number = strtod(str, &end);
+			return end != str && *end == '\0' && errno == 0;
+
+		case TYPED_KIND_BOOL:
+			if(prv_micro_ini_doc_equals_word(str, "true") || prv_micro_ini_doc_equals_word(str, "yes")
+				|| prv_micro_ini_doc_equals_word(str, "on") || strcmp(str, "1") == 0)
+			{
+				pValue->integer = 1;
+				return 1;
+			}
+
+			if(prv_micro_ini_doc_equals_word(str, "false") || prv_micro_ini_doc_equals_word(str, "no")
+				|| prv_micro_ini_doc_equals_word(str, "off") || strcmp(str, "0") == 0)
+			{
+				pValue->integer = 0;
+				return 1;
+			}
+
+			return 0;
+
+		case TYPED_KIND_DURATION:
+		{
+			double scale = 0.0;
+
+			pValue->number = strtod(str, &end);
+			if(end == str || errno != 0 || !(pValue->number >= 0.0))
+			{
+				return 0;
+			}
+
+			while(isspace((unsigned char) *end))
+			{
+				++end;
+			}
+
+			if(*end == '\0' || prv_micro_ini_doc_equals_word(end, "s"))
+			{
+				scale = 1.0;
+			}
+			else if(prv_micro_ini_doc_equals_word(end, "ms"))
+			{
+				scale = 1.0e-3;
+			}
+			else if(prv_micro_ini_doc_equals_word(end, "us"))
+			{
+				scale = 1.0e-6;
+			}
+			else if(prv_micro_ini_doc_equals_word(end, "ns"))
+			{
+				scale = 1.0e-9;
+			}
+			else if(prv_micro_ini_doc_equals_word(end, "m") || prv_micro_ini_doc_equals_word(end, "min"))
+			{
+				scale = 60.0;
+			}
+			else if(prv_micro_ini_doc_equals_word(end, "h"))
+			{
+				scale = 3600.0;
+			}
+			else if(prv_micro_ini_doc_equals_word(end, "d"))
+			{
+				scale = 86400.0;
+			}
+			else
+			{
+				return 0;
+			}
+
+			pValue->number *= scale;
+			return 1;
+		}
+
+		default:
+			return 0;
+	}
+}
+
+#if !defined(MICRO_INI_DOC_NO_TYPED_CACHE)
+/**
+ * @brief   Get the typed value slots of a section, allocating them on first use (internal use only).
+ * @return  Slots for every key of the section, or NULL if they could not be allocated.
+ *
+ * Any number of readers may get here at once, so the slots are allocated under the
+ * accounting lock and published with a release store; readers that lose the race
+ * find them allocated once they hold the lock.
+ */
+static micro_ini_doc_typed_slot* prv_micro_ini_doc_typed_slots(micro_ini_doc_section* const pSection)
+{
+	micro_ini_doc_memory* const pMemory = pSection->pPool->pMemory;
+	micro_ini_doc_typed_slot* pSlots = prv_micro_ini_doc_typed_peek(pSection);
+
+	if(pSlots)
+	{
+		return pSlots;
+	}
+
+	MICRO_INI_DOC_LOCK(pMemory);
+
+	pSlots = pSection->typed;
+	if(!pSlots)
+	{
+		const int limitReached = pMemory->limitReached;
+
+		pSlots = (micro_ini_doc_typed_slot*) prv_micro_ini_doc_mem_realloc_locked(pMemory, NULL, sizeof(micro_ini_doc_typed_slot) * pSection->count);
+
+		if(pSlots)
+		{
+			memset(pSlots, 0, sizeof(micro_ini_doc_typed_slot) * pSection->count);
+			MICRO_INI_DOC_ATOMIC_STORE_POINTER(&pSection->typed, pSlots);
+		}
+		else
+		{
+			/* A lookup that cannot memoize is not an error, so an edit must not report it as its own. */
+			pMemory->limitReached = limitReached;
+		}
+	}
+
+	MICRO_INI_DOC_UNLOCK(pMemory);
+	return pSlots;
+}
+#endif
+
+/**
+ * @brief   Look up a value and decode it, going through its typed value slot (internal use only).
+ * @return  MICRO_INI_SUCCESS, MICRO_INI_ERROR_KEY_NOT_FOUND or MICRO_INI_ERROR_INVALID_VALUE.
+ *
+ * @param[in]  pDoc     Document to query.
+ * @param[in]  section  Section name.
+ * @param[in]  key      Key name.
+ * @param[in]  kind     Kind of value to decode.
+ * @param[out] pValue   Receives the decoded value.
+ */
+static int prv_micro_ini_doc_get_typed(
+	const micro_ini_doc* const pDoc,
+	const char* const section,
+	const char* const key,
+	const int kind,
+	micro_ini_doc_typed* const pValue
+)
+{
+	const size_t sectionIndex = micro_ini_doc_find_section(pDoc, section);
+	micro_ini_doc_section* pSection;
+#if !defined(MICRO_INI_DOC_NO_TYPED_CACHE)
+	micro_ini_doc_typed_slot* pSlots;
+#endif
+	micro_ini_doc_typed decoded;
+	size_t entry;
+	int valid;
+
+	if(sectionIndex == MICRO_INI_DOC_NPOS || !key)
+	{
+		return MICRO_INI_ERROR_KEY_NOT_FOUND;
+	}
+
+	entry = prv_micro_ini_doc_lookup(pDoc, sectionIndex, key, &pSection);
+
+	if(entry == MICRO_INI_DOC_NPOS)
+	{
+		return MICRO_INI_ERROR_KEY_NOT_FOUND;
+	}
+
+	decoded.integer = 0;
+
+#if !defined(MICRO_INI_DOC_NO_TYPED_CACHE)
+	pSlots = prv_micro_ini_doc_typed_slots(pSection);
+
+	if(pSlots)
+	{
+		micro_ini_doc_typed_slot* const pSlot = &pSlots[entry];
+		int state = (int) MICRO_INI_DOC_ATOMIC_LOAD(&pSlot->state);
+
+		if((state & MICRO_INI_DOC_TYPED_READY) && (state >> MICRO_INI_DOC_TYPED_SHIFT) == kind)
+		{
+			if(state & MICRO_INI_DOC_TYPED_INVALID)
+			{
+				return MICRO_INI_ERROR_INVALID_VALUE;
+			}
+
+			(*pValue) = pSlot->value;
+			return MICRO_INI_SUCCESS;
+		}
+
+		valid = prv_micro_ini_doc_decode(kind, pSection->pPool->data + pSection->values[entry], &decoded);
+
+		/* Only the reader that claims an empty slot fills it; everyone else keeps their own result. */
+		if(state == 0)
+		{
+			micro_ini_doc_atomic expected = 0;
+
+			if(MICRO_INI_DOC_ATOMIC_CLAIM(&pSlot->state, &expected, MICRO_INI_DOC_TYPED_CLAIMED))
+			{
+				state = MICRO_INI_DOC_TYPED_READY | (kind << MICRO_INI_DOC_TYPED_SHIFT) | (valid ? 0 : MICRO_INI_DOC_TYPED_INVALID);
+
+				pSlot->value = decoded;
+				MICRO_INI_DOC_ATOMIC_STORE(&pSlot->state, state);
+			}
+		}
+	}
+	else
+	{
+		/* Without slots the value is still decoded, it is just not memoized. */
+		valid = prv_micro_ini_doc_decode(kind, pSection->pPool->data + pSection->values[entry], &decoded);
+	}
+#else
+	valid = prv_micro_ini_doc_decode(kind, pSection->pPool->data + pSection->values[entry], &decoded);
+#endif
+
+	if(!valid)
+	{
+		return MICRO_INI_ERROR_INVALID_VALUE;
+	}
+
+	(*pValue) = decoded;
+	return MICRO_INI_SUCCESS;
+}
+
+
+int micro_ini_doc_get_int(const micro_ini_doc* const pDoc, const char* const section, const char* const key, long* const pOutValue)
+{
+	micro_ini_doc_typed value;
+	const int result = prv_micro_ini_doc_get_typed(pDoc, section, key, TYPED_KIND_INT, &value);
+
+	if(result == MICRO_INI_SUCCESS && pOutValue)
+	{
+		(*pOutValue) = value.integer;
+	}
+
+	return result;
+}
+
+
+int micro_ini_doc_get_double(const micro_ini_doc* const pDoc, const char* const section, const char* const key, double* const pOutValue)
+{
+	micro_ini_doc_typed value;
+	const int result = prv_micro_ini_doc_get_typed(pDoc, section, key, TYPED_KIND_DOUBLE, &value);
+
+	if(result == MICRO_INI_SUCCESS && pOutValue)
+	{
+		(*pOutValue) = value.number;
+	}
+
+	return result;
+}
+
+
+int micro_ini_doc_get_bool(const micro_ini_doc* const pDoc, const char* const section, const char* const key, int* const pOutValue)
+{
+	micro_ini_doc_typed value;
+	const int result = prv_micro_ini_doc_get_typed(pDoc, section, key, TYPED_KIND_BOOL, &value);
+
+	if(result == MICRO_INI_SUCCESS && pOutValue)
+	{
+		(*pOutValue) = (int) value.integer;
+	}
+
+	return result;
+}
+
+
+int micro_ini_doc_get_duration(const micro_ini_doc* const pDoc, const char* const section, const char* const key, double* const pOutSeconds)
+{
+	micro_ini_doc_typed value;
+	const int result = prv_micro_ini_doc_get_typed(pDoc, section, key, TYPED_KIND_DURATION, &value);
+
+	if(result == MICRO_INI_SUCCESS && pOutSeconds)
+	{
+		(*pOutSeconds) = value.number;
+	}
+
+	return result;
+}
+
+
+/**
+ * @brief   Compare two index entries by section, then key (internal use only).
+ * @return  Result in the style of strcmp().
+ */
+static int prv_micro_ini_doc_compare_by_section(const void* const pLeft, const void* const pRight)
+{
+	const micro_ini_doc_index_entry* const pA = (const micro_ini_doc_index_entry*) pLeft;
+	const micro_ini_doc_index_entry* const pB = (const micro_ini_doc_index_entry*) pRight;
+	const int result = strcmp(pA->section, pB->section);
+
+	return (result != 0) ? result : strcmp(pA->key, pB->key);
+}
+
+/**
+ * @brief   Compare two index entry pointers by key, then section (internal use only).
+ * @return  Result in the style of strcmp().
+ */
+static int prv_micro_ini_doc_compare_by_key(const void* const pLeft, const void* const pRight)
+{
+	const micro_ini_doc_index_entry* const pA = *(const micro_ini_doc_index_entry* const*) pLeft;
+	const micro_ini_doc_index_entry* const pB = *(const micro_ini_doc_index_entry* const*) pRight;
+	const int result = strcmp(pA->key, pB->key);
+
+	return (result != 0) ? result : strcmp(pA->section, pB->section);
+}
+
+/**
+ * @brief   Get the length of the literal prefix of a glob pattern (internal use only).
+ * @return  Number of characters before the first wildcard.
+ */
+static size_t prv_micro_ini_doc_glob_prefix(const char* const pattern)
+{
+	size_t len = 0;
+
+	if(!pattern)
+	{
+		return 0;
+	}
+
+	while(pattern[len] != '\0' && pattern[len] != '*' && pattern[len] != '?')
+	{
+		++len;
+	}
+
+	return len;
+}
+
+/**
+ * @brief   Match a string against a glob pattern (internal use only).
+ * @return  Non-zero if the string matches.
+ *
+ * @param[in]  pattern  Glob pattern ('*' and '?' are the only wildcards; NULL matches everything).
+ * @param[in]  str      String to match.
+ *
+ * Only the most recent '*' is ever backtracked to, which keeps the match time bounded
+ * by the product of the pattern and string lengths regardless of the number of stars.
+ */
+static int prv_micro_ini_doc_glob_match(const char* pattern, const char* str)
+{
+	const char* starPattern = NULL;
+	const char* starStr = NULL;
+
+	if(!pattern)
+	{
+		return 1;
+	}
+
+	while(*str != '\0')
+	{
+		if(*pattern == '*')
+		{
+			/* Remember where to resume if the rest of the pattern fails to match. */
+			starPattern = ++pattern;
+			starStr = str;
+		}
+		else if(*pattern == '?' || *pattern == *str)
+		{
+			++pattern;
+			++str;
+		}
+		else if(starPattern)
+		{
+			/* Let the last star absorb one more character. */
+			pattern = starPattern;
+			str = ++starStr;
+		}
+		else
+		{
+			return 0;
+		}
+	}
+
+	while(*pattern == '*')
+	{
+		++pattern;
+	}
+
+	return *pattern == '\0';
+}
+
+/**
+ * @brief   Get the field of an index entry that a search order is sorted on first (internal use only).
+ * @return  Section or key string of the entry.
+ */
+static const char* prv_micro_ini_doc_index_field(const micro_ini_doc_index* const pIndex, const int order, const size_t position)
+{
+	return (order == INDEX_ORDER_SECTION)
+		? pIndex->pBySection[position].section
+		: pIndex->ppByKey[position]->key;
+}
+
+/**
+ * @brief   Binary search for the range of index positions whose leading field starts with a prefix (internal use only).
+ *
+ * @param[in]  pIndex     Index to search.
+ * @param[in]  order      Search order (one of the IndexOrder values).
+ * @param[in]  prefix     Literal prefix.
+ * @param[in]  prefixLen  Length of the prefix.
+ * @param[out] pOutFirst  Receives the first position in the range.
+ * @param[out] pOutLast   Receives one past the last position in the range.
+ */
+static void prv_micro_ini_doc_index_range(
+	const micro_ini_doc_index* const pIndex,
+	const int order,
+	const char* const prefix,
+	const size_t prefixLen,
+	size_t* const pOutFirst,
+	size_t* const pOutLast
+)
+{
+	size_t low = 0;
+	size_t high = pIndex->count;
+
+	while(low < high)
+	{
+		/* Find the first entry that does not sort before the prefix. */
+		const size_t middle = low + (high - low) / 2;
+
+		if(strncmp(prv_micro_ini_doc_index_field(pIndex, order, middle), prefix, prefixLen) < 0)
+		{
+			low = middle + 1;
+		}
+		else
+		{
+			high = middle;
+		}
+	}
+
+	(*pOutFirst) = low;
+	high = pIndex->count;
+
+	while(low < high)
+	{
+		/* Find the first entry that sorts after everything starting with the prefix. */
+		const size_t middle = low + (high - low) / 2;
+
+		if(strncmp(prv_micro_ini_doc_index_field(pIndex, order, middle), prefix, prefixLen) <= 0)
+		{
+			low = middle + 1;
+		}
+		else
+		{
+			high = middle;
+		}
+	}
+
+	(*pOutLast) = low;
+}
+
+
+int micro_ini_doc_index_build(micro_ini_doc_index** const ppOutIndex, const micro_ini_doc* const pDoc)
+{
+	micro_ini_doc_index* pIndex;
+	size_t count = 0;
+	size_t position = 0;
+	uint32_t sectionIndex;
+
+	if(!ppOutIndex)
+	{
+		/* Invalid index output pointer. */
+		return MICRO_INI_ERROR_INVALID_DOCUMENT;
+	}
+
+	(*ppOutIndex) = NULL;
+
+	if(!pDoc)
+	{
+		/* Invalid document. */
+		return MICRO_INI_ERROR_INVALID_DOCUMENT;
+	}
+
+	for(sectionIndex = 0; sectionIndex < pDoc->sectionCount; ++sectionIndex)
+	{
+		count += pDoc->ppSections[sectionIndex]->count;
+	}
+
+	/* Both sort orders share the index's only allocation. */
+	pIndex = (micro_ini_doc_index*) prv_micro_ini_doc_mem_alloc(
+		pDoc->pMemory,
+		sizeof(micro_ini_doc_index)
+		+ (sizeof(micro_ini_doc_index_entry) + sizeof(micro_ini_doc_index_entry*)) * count
+	);
+	if(!pIndex)
+	{
+		return prv_micro_ini_doc_memory_error(pDoc->pMemory);
+	}
+
+	pIndex->pMemory = pDoc->pMemory;
+	pIndex->count = count;
+	pIndex->pBySection = (micro_ini_doc_index_entry*)(pIndex + 1);
+	pIndex->ppByKey = (micro_ini_doc_index_entry**)(pIndex->pBySection + count);
+
+	for(sectionIndex = 0; sectionIndex < pDoc->sectionCount; ++sectionIndex)
+	{
+		const micro_ini_doc_section* const pSection = pDoc->ppSections[sectionIndex];
+		const char* const sectionName = prv_micro_ini_doc_section_name(pSection);
+		uint32_t entry;
+
+		for(entry = 0; entry < pSection->count; ++entry)
+		{
+			micro_ini_doc_index_entry* const pEntry = &pIndex->pBySection[position];
+
+			pEntry->section = sectionName;
+			pEntry->key = pSection->pPool->data + pSection->keys[entry];
+			pEntry->value = pSection->pPool->data + pSection->values[entry];
+
+			++position;
+		}
+	}
+
+	qsort(pIndex->pBySection, count, sizeof(micro_ini_doc_index_entry), prv_micro_ini_doc_compare_by_section);
+
+	for(position = 0; position < count; ++position)
+	{
+		pIndex->ppByKey[position] = &pIndex->pBySection[position];
+	}
+
+	qsort(pIndex->ppByKey, count, sizeof(micro_ini_doc_index_entry*), prv_micro_ini_doc_compare_by_key);
+
+	(*ppOutIndex) = pIndex;
+	return MICRO_INI_SUCCESS;
+}
+
+
+void micro_ini_doc_index_free(micro_ini_doc_index* const pIndex)
+{
+	if(pIndex)
+	{
+		/* The document outlives its index, so the memory accounting is still valid. */
+		prv_micro_ini_doc_mem_free(pIndex->pMemory, pIndex);
+	}
+}
+
+
+size_t micro_ini_doc_index_query(
+	const micro_ini_doc_index* const pIndex,
+	const char* const sectionPattern,
+	const char* const keyPattern,
+	const micro_ini_doc_query_fn queryCallback,
+	void* const pUserData
+)
+{
+	const size_t sectionPrefixLen = prv_micro_ini_doc_glob_prefix(sectionPattern);
+	const size_t keyPrefixLen = prv_micro_ini_doc_glob_prefix(keyPattern);
+
+	size_t first = 0;
+	size_t last = 0;
+	size_t position;
+	size_t matches = 0;
+	int order;
+
+	if(!pIndex)
+	{
+		return 0;
+	}
+
+	if(sectionPrefixLen == 0 && keyPrefixLen > 0)
+	{
+		/* Only the key narrows the search, so use the key-major order. */
+		order = INDEX_ORDER_KEY;
+		prv_micro_ini_doc_index_range(pIndex, order, keyPattern, keyPrefixLen, &first, &last);
+	}
+	else
+	{
+		order = INDEX_ORDER_SECTION;
+
+		if(sectionPrefixLen > 0)
+		{
+			prv_micro_ini_doc_index_range(pIndex, order, sectionPattern, sectionPrefixLen, &first, &last);
+		}
+		else
+		{
+			last = pIndex->count;
+		}
+	}
+
+	for(position = first; position < last; ++position)
+	{
+		const micro_ini_doc_index_entry* const pEntry = (order == INDEX_ORDER_SECTION)
+			? &pIndex->pBySection[position]
+			: pIndex->ppByKey[position];
+
+		if(prv_micro_ini_doc_glob_match(sectionPattern, pEntry->section)
+			&& prv_micro_ini_doc_glob_match(keyPattern, pEntry->key))
+		{
+			if(queryCallback)
+			{
+				queryCallback(pUserData, pEntry->section, pEntry->key, pEntry->value);
+			}
+
+			++matches;
+		}
+	}
+
+	return matches;
+}
+
+
+int micro_ini_doc_edit_begin(micro_ini_doc_edit** const ppOutEdit, const micro_ini_doc* const pBase)
+{
+	micro_ini_doc_edit* pEdit;
+	micro_ini_doc* pWork;
+	uint32_t index;
+
+	if(!ppOutEdit)
+	{
+		/* Invalid edit output pointer. */
+		return MICRO_INI_ERROR_INVALID_DOCUMENT;
+	}
+
+	(*ppOutEdit) = NULL;
+
+	if(!pBase)
+	{
+		/* Invalid document. */
+		return MICRO_INI_ERROR_INVALID_DOCUMENT;
+	}
+
+	pEdit = (micro_ini_doc_edit*) prv_micro_ini_doc_mem_alloc(pBase->pMemory, sizeof(micro_ini_doc_edit));
+	pWork = prv_micro_ini_doc_create(pBase->pMemory);
+
+	if(!pEdit || !pWork)
+	{
+		const int err = prv_micro_ini_doc_memory_error(pBase->pMemory);
+
+		prv_micro_ini_doc_mem_free(pBase->pMemory, pEdit);
+		micro_ini_doc_free(pWork);
+		return err;
+	}
+
+	if(pBase->sectionCount > 0)
+	{
+		pWork->ppSections = (micro_ini_doc_section**) prv_micro_ini_doc_mem_alloc(
+			pBase->pMemory,
+			sizeof(micro_ini_doc_section*) * pBase->sectionCount
+		);
+
+		if(!pWork->ppSections || !prv_micro_ini_doc_table_copy(pBase->pMemory, &pWork->sectionTable, &pBase->sectionTable))
+		{
+			const int err = prv_micro_ini_doc_memory_error(pBase->pMemory);
+
+			prv_micro_ini_doc_mem_free(pBase->pMemory, pEdit);
+			micro_ini_doc_free(pWork);
+			return err;
+		}
+
+		pWork->sectionCapacity = pBase->sectionCount;
+	}
+
+	for(index = 0; index < pBase->sectionCount; ++index)
+	{
+		/* Every section starts out shared with the base version. */
+		pWork->ppSections[index] = pBase->ppSections[index];
+		++pWork->ppSections[index]->refCount;
+	}
+
+	pWork->sectionCount = pBase->sectionCount;
+	pEdit->pWork = pWork;
+
+	(*ppOutEdit) = pEdit;
+	return MICRO_INI_SUCCESS;
+}
+
+
+int micro_ini_doc_edit_set(
+	micro_ini_doc_edit* const pEdit,
+	const char* const section,
+	const char* const key,
+	const char* const value
+)
+{
+	micro_ini_doc* pWork;
+	micro_ini_doc_section* pSection;
+	size_t sectionIndex;
+
+	if(!pEdit || !section || !key || !value)
+	{
+		/* Invalid edit. */
+		return MICRO_INI_ERROR_INVALID_DOCUMENT;
+	}
+
+	pWork = pEdit->pWork;
+	sectionIndex = micro_ini_doc_find_section(pWork, section);
+
+	pSection = (sectionIndex != MICRO_INI_DOC_NPOS)
+		? prv_micro_ini_doc_own_section(pWork, sectionIndex)
+		: prv_micro_ini_doc_add_section(pWork, NULL, section);
+
+	if(!pSection || !prv_micro_ini_doc_section_set(pSection, key, value))
+	{
+		return prv_micro_ini_doc_memory_error(pWork->pMemory);
+	}
+
+	return MICRO_INI_SUCCESS;
+}
+
+
+int micro_ini_doc_edit_remove(micro_ini_doc_edit* const pEdit, const char* const section, const char* const key)
+{
+	micro_ini_doc* pWork;
+	micro_ini_doc_section* pSection;
+	size_t sectionIndex;
+	size_t entry;
+
+	if(!pEdit || !section || !key)
+	{
+		/* Invalid edit. */
+		return MICRO_INI_ERROR_INVALID_DOCUMENT;
+	}
+
+	pWork = pEdit->pWork;
+	sectionIndex = micro_ini_doc_find_section(pWork, section);
+
+	if(sectionIndex == MICRO_INI_DOC_NPOS)
+	{
+		return MICRO_INI_SUCCESS;
+	}
+
+	/* Look the key up before copying so removing a missing key never copies the section. */
+	entry = prv_micro_ini_doc_section_find(pWork->ppSections[sectionIndex], key, strlen(key));
+	if(entry == MICRO_INI_DOC_NPOS)
+	{
+		return MICRO_INI_SUCCESS;
+	}
+
+	pSection = prv_micro_ini_doc_own_section(pWork, sectionIndex);
+	if(!pSection)
+	{
+		return prv_micro_ini_doc_memory_error(pWork->pMemory);
+	}
+
+	prv_micro_ini_doc_section_remove(pSection, entry);
+
+	return MICRO_INI_SUCCESS;
+}
+
+
+int micro_ini_doc_edit_commit(micro_ini_doc_edit* const pEdit, micro_ini_doc** const ppOutDoc)
+{
+	int result;
+
+	if(!pEdit || !ppOutDoc)
+	{
+		/* Invalid edit or document output pointer. */
+		return MICRO_INI_ERROR_INVALID_DOCUMENT;
+	}
+
+	prv_micro_ini_doc_remove_empty_sections(pEdit->pWork);
+
+	/* Sections may have been added or removed, so the parent links are resolved again. */
+	result = prv_micro_ini_doc_link_sections(pEdit->pWork, NULL, NULL);
+	if(result < 0)
+	{
+		return result;
+	}
+
+	(*ppOutDoc) = pEdit->pWork;
+	prv_micro_ini_doc_mem_free(pEdit->pWork->pMemory, pEdit);
+
+	return MICRO_INI_SUCCESS;
+}
+
+
+void micro_ini_doc_edit_abort(micro_ini_doc_edit* const pEdit)
+{
+	if(pEdit)
+	{
+		micro_ini_doc* const pWork = pEdit->pWork;
+
+		/* Free the edit first since the working copy may hold the last reference to the memory accounting. */
+		prv_micro_ini_doc_mem_free(pWork->pMemory, pEdit);
+		micro_ini_doc_free(pWork);
+	}
+}
+
+
+int micro_ini_doc_compact(micro_ini_doc* const pDoc)
+{
+	micro_ini_doc_pool* pPool;
+	micro_ini_doc_section** ppCopies;
+	char* pNewData;
+	size_t liveBytes = 0;
+	uint32_t index;
+	int err = MICRO_INI_SUCCESS;
+
+	if(!pDoc)
+	{
+		/* Invalid document. */
+		return MICRO_INI_ERROR_INVALID_DOCUMENT;
+	}
+	else if(pDoc->sectionCount == 0)
+	{
+		return MICRO_INI_SUCCESS;
+	}
+
+	for(index = 0; index < pDoc->sectionCount; ++index)
+	{
+		/* Measure the live strings so the new pool does not have to grow while it is filled. */
+		const micro_ini_doc_section* const pSection = pDoc->ppSections[index];
+		uint32_t entry;
+
+		liveBytes += strlen(prv_micro_ini_doc_section_name(pSection)) + 1;
+
+		for(entry = 0; entry < pSection->count; ++entry)
+		{
+			liveBytes += strlen(pSection->pPool->data + pSection->keys[entry]) + 1;
+			liveBytes += strlen(pSection->pPool->data + pSection->values[entry]) + 1;
+		}
+	}
+
+	pPool = prv_micro_ini_doc_pool_create(pDoc->pMemory);
+	ppCopies = (micro_ini_doc_section**) prv_micro_ini_doc_mem_calloc(pDoc->pMemory, pDoc->sectionCount, sizeof(micro_ini_doc_section*));
+
+	if(!pPool || !ppCopies || !prv_micro_ini_doc_pool_reserve(pPool, liveBytes))
+	{
+		err = prv_micro_ini_doc_memory_error(pDoc->pMemory);
+	}
+	else
+	{
+		/* Strings repeated by edits, or across pools of copied sections, are stored once again. */
+		pPool->interning = 1;
+
+		for(index = 0; index < pDoc->sectionCount; ++index)
+		{
+			/* Sections may be shared with other versions, so they are copied rather than repacked in place. */
+			ppCopies[index] = prv_micro_ini_doc_section_clone(pDoc->ppSections[index], pPool);
+
+			if(!ppCopies[index])
+			{
+				err = prv_micro_ini_doc_memory_error(pDoc->pMemory);
+				break;
+			}
+		}
+
+		prv_micro_ini_doc_pool_seal(pPool);
+
+		/* Shared strings leave part of the reservation unused, so the pool is trimmed to fit. */
+		pNewData = (err == MICRO_INI_SUCCESS && pPool->size < pPool->capacity)
+			? (char*) prv_micro_ini_doc_mem_realloc(pDoc->pMemory, pPool->data, pPool->size)
+			: NULL;
+
+		if(pNewData)
+		{
+			pPool->data = pNewData;
+			pPool->capacity = pPool->size;
+		}
+	}
+
+	if(ppCopies)
+	{
+		for(index = 0; index < pDoc->sectionCount; ++index)
+		{
+			if(err == MICRO_INI_SUCCESS)
+			{
+				/* Section order is unchanged, so the section table stays valid. */
+				prv_micro_ini_doc_section_release(pDoc->ppSections[index]);
+				pDoc->ppSections[index] = ppCopies[index];
+			}
+			else
+			{
+				/* Leave the document untouched on failure. */
+				prv_micro_ini_doc_section_release(ppCopies[index]);
+			}
+		}
+
+		prv_micro_ini_doc_mem_free(pDoc->pMemory, ppCopies);
+	}
+
+	prv_micro_ini_doc_pool_release(pPool);
+
+	return err;
+}
+
+/**
+ * @brief   Compare the pools of two sections (internal use only).
+ * @return  Result in the style of strcmp().
+ */
+static int prv_micro_ini_doc_compare_pools(const void* const pLeft, const void* const pRight)
+{
+	const char* const pA = (const char*) (*(const micro_ini_doc_section* const*) pLeft)->pPool;
+	const char* const pB = (const char*) (*(const micro_ini_doc_section* const*) pRight)->pPool;
+
+	return (pA < pB) ? -1 : ((pA > pB) ? 1 : 0);
+}
+
+/**
+ * @brief   Count a string reachable from a document unless it has already been counted (internal use only).
+ * @return  Size of the string including its terminator, or zero if it was counted before.
+ *
+ * @param[in]  pPool   Pool holding the string.
+ * @param[in]  marks   One bit for each byte of the pool, set at the offset of every string counted so far.
+ * @param[in]  offset  Pool offset of the string.
+ */
+static size_t prv_micro_ini_doc_count_live(const micro_ini_doc_pool* const pPool, unsigned char* const marks, const uint32_t offset)
+{
+	const unsigned char bit = (unsigned char) (1u << (offset & 7));
+
+	if(marks[offset >> 3] & bit)
+	{
+		/* Interned strings are shared by every name and value equal to them. */
+		return 0;
+	}
+
+	marks[offset >> 3] |= bit;
+
+	return strlen(pPool->data + offset) + 1;
+}
+
+
+int micro_ini_doc_get_stats(const micro_ini_doc* const pDoc, micro_ini_doc_stats* const pOutStats)
+{
+	micro_ini_allocator* const pAllocator = pDoc ? pDoc->pMemory->pAllocator : NULL;
+	const micro_ini_doc_section** ppSorted = NULL;
+	unsigned char* marks;
+	uint32_t first;
+	uint32_t last;
+
+	if(!pDoc || !pOutStats)
+	{
+		/* Invalid document or stats output pointer. */
+		return MICRO_INI_ERROR_INVALID_DOCUMENT;
+	}
+
+	memset(pOutStats, 0, sizeof(micro_ini_doc_stats));
+
+	MICRO_INI_DOC_LOCK(pDoc->pMemory);
+	pOutStats->memoryUsed = pDoc->pMemory->used;
+	pOutStats->memoryPeak = pDoc->pMemory->peak;
+	pOutStats->memoryLimit = pDoc->pMemory->limit;
+	MICRO_INI_DOC_UNLOCK(pDoc->pMemory);
+	pOutStats->sectionCount = pDoc->sectionCount;
+
+	if(pDoc->sectionCount == 0)
+	{
+		return MICRO_INI_SUCCESS;
+	}
+
+	/* Temporary storage used to visit the sections of each shared pool together; it is not charged to the document. */
+	ppSorted = (const micro_ini_doc_section**) micro_ini_allocator_alloc(pAllocator, sizeof(micro_ini_doc_section*) * pDoc->sectionCount);
+	if(!ppSorted)
+	{
+		return MICRO_INI_ERROR_OUT_OF_MEMORY;
+	}
+
+	memcpy((void*) ppSorted, pDoc->ppSections, sizeof(micro_ini_doc_section*) * pDoc->sectionCount);
+	qsort((void*) ppSorted, pDoc->sectionCount, sizeof(micro_ini_doc_section*), prv_micro_ini_doc_compare_pools);
+
+	for(first = 0; first < pDoc->sectionCount; first = last)
+	{
+		const micro_ini_doc_pool* const pPool = ppSorted[first]->pPool;
+
+		++pOutStats->poolCount;
+		pOutStats->poolCapacity += pPool->capacity;
+		pOutStats->poolUsed += pPool->size;
+
+		/* Strings may be shared, so each one is only counted the first time it is reached. */
+		marks = (unsigned char*) micro_ini_allocator_calloc(pAllocator, ((size_t) pPool->size >> 3) + 1, 1);
+		if(!marks)
+		{
+			micro_ini_allocator_free(pAllocator, (void*) ppSorted);
+			return MICRO_INI_ERROR_OUT_OF_MEMORY;
+		}
+
+		for(last = first; last < pDoc->sectionCount && ppSorted[last]->pPool == pPool; ++last)
+		{
+			const micro_ini_doc_section* const pSection = ppSorted[last];
+			uint32_t entry;
+
+			pOutStats->keyCount += pSection->count;
+			pOutStats->poolLive += prv_micro_ini_doc_count_live(pPool, marks, pSection->name);
+
+			if(pSection->parent != MICRO_INI_DOC_NO_PARENT)
+			{
+				pOutStats->poolLive += prv_micro_ini_doc_count_live(pPool, marks, pSection->parent);
+			}
+
+			for(entry = 0; entry < pSection->count; ++entry)
+			{
+				pOutStats->poolLive += prv_micro_ini_doc_count_live(pPool, marks, pSection->keys[entry]);
+				pOutStats->poolLive += prv_micro_ini_doc_count_live(pPool, marks, pSection->values[entry]);
+			}
+		}
+
+		micro_ini_allocator_free(pAllocator, marks);
+	}
+
+	micro_ini_allocator_free(pAllocator, (void*) ppSorted);
+
+	return MICRO_INI_SUCCESS;
+}
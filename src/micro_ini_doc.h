@@ -0,0 +1,482 @@
+/**
+ * Copyright (c) 2021, Zoe J. Bare
+ *
+ * MIT License
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ */
+
+#pragma once
+
+#include "micro_ini.h"
+#include "micro_ini_alloc.h"
+
+#include <stddef.h>
+
+/* Returned by the index queries when a section or key does not exist. */
+#define MICRO_INI_DOC_NPOS ((size_t) -1)
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * In-memory document built from a single parse.  This is an optional module layered
+ * on top of the callback parser; unlike the parser, it allocates memory.
+ *
+ * Each section stores its keys and values as dense arrays of offsets into a single
+ * string pool owned by the document.  Lookups probe an open-addressed array holding
+ * only key hashes, so the key strings are not touched until a hash matches.
+ */
+typedef struct micro_ini_doc micro_ini_doc;
+
+/**
+ * Batch of edits applied to a document.  Committing the batch produces a new document
+ * version; the base document is never modified.  Only the sections touched by the
+ * batch are copied, and every other section is shared between the two versions, so
+ * the cost of a batch scales with the sections it touches rather than the document.
+ *
+ * Document versions may be read from any number of threads, but creating, committing
+ * and releasing versions must be serialized by the caller.
+ */
+typedef struct micro_ini_doc_edit micro_ini_doc_edit;
+
+/**
+ * Sorted index over every key/value pair of a document, used for prefix and wildcard
+ * queries.  The index references strings owned by the document, so the document must
+ * outlive it.  All of its storage is a single allocation.
+ */
+typedef struct micro_ini_doc_index micro_ini_doc_index;
+
+/**
+ * Options for loading a document.  A NULL options pointer selects the defaults.
+ */
+typedef struct micro_ini_doc_options
+{
+	size_t memoryLimit;  /* Maximum number of bytes the document and every version derived from it may allocate (0 for no limit). */
+
+	micro_ini_allocator* pAllocator;  /* Allocator for the document and every version derived from it (NULL for malloc()). */
+} micro_ini_doc_options;
+
+/**
+ * Memory and fragmentation statistics for a document.
+ *
+ * Strings are never freed individually, so replaced and removed values leave garbage
+ * behind in their pool.  The garbage is (poolUsed - poolLive) bytes and the unused
+ * tail of the pools is (poolCapacity - poolUsed) bytes; micro_ini_doc_compact()
+ * reclaims both.
+ */
+typedef struct micro_ini_doc_stats
+{
+	size_t memoryUsed;   /* Bytes allocated by the document and every version sharing its memory budget. */
+	size_t memoryPeak;   /* Highest value memoryUsed has reached. */
+	size_t memoryLimit;  /* Memory budget of the document (0 for no limit). */
+
+	size_t sectionCount;
+	size_t keyCount;
+
+	size_t poolCount;     /* Number of string pools referenced by the document. */
+	size_t poolCapacity;  /* Bytes reserved by those pools. */
+	size_t poolUsed;      /* Bytes written to those pools. */
+	size_t poolLive;      /* Bytes of those pools holding strings reachable from this document, counting shared strings once. */
+} micro_ini_doc_stats;
+
+/* Query result handling function. */
+typedef void (*micro_ini_doc_query_fn)(void* pUserData, const char* section, const char* key, const char* value);
+
+/**
+ * @brief   Parse an ini file into a new document.
+ * @return  Error code or number of parsing errors that occurred.
+ *
+ * @param[out] ppOutDoc       Receives the new document (set to NULL when an error code is returned).
+ * @param[in]  filePath       Path to the ini file to read.
+ * @param[in]  flags          Flags for configuring the parser.
+ * @param[in]  pOptions       Options for the document (may be NULL to use the defaults).
+ * @param[in]  errorCallback  Callback for handling parsing errors (this callback is optional and may be NULL if unneeded).
+ * @param[in]  pUserData      Pointer to user data that is passed to the error callback.
+ *
+ * When a key appears more than once in the same section, the last value wins.
+ * If the document would exceed its memory limit, loading stops allocating and
+ * MICRO_INI_ERROR_MEMORY_LIMIT is returned.  The document must be released with
+ * micro_ini_doc_free().
+ */
+MICRO_INI_API int micro_ini_doc_load(
+	micro_ini_doc** const ppOutDoc,
+	const char* const filePath,
+	const int flags,
+	const micro_ini_doc_options* const pOptions,
+	const micro_ini_error_fn errorCallback,
+	void* const pUserData
+);
+
+/**
+ * @brief   Parse an ini file from a FILE object into a new document.
+ * @return  Error code or number of parsing errors that occurred.
+ *
+ * @param[out] ppOutDoc       Receives the new document (set to NULL when an error code is returned).
+ * @param[in]  pFile          Pointer to an existing FILE object.
+ * @param[in]  flags          Flags for configuring the parser.
+ * @param[in]  pOptions       Options for the document (may be NULL to use the defaults).
+ * @param[in]  errorCallback  Callback for handling parsing errors (this callback is optional and may be NULL if unneeded).
+ * @param[in]  pUserData      Pointer to user data that is passed to the error callback.
+ */
+MICRO_INI_API int micro_ini_doc_load_file(
+	micro_ini_doc** const ppOutDoc,
+	FILE* const pFile,
+	const int flags,
+	const micro_ini_doc_options* const pOptions,
+	const micro_ini_error_fn errorCallback,
+	void* const pUserData
+);
+
+/**
+ * @brief   Parse an ini file from a custom stream object into a new document.
+ * @return  Error code or number of parsing errors that occurred.
+ *
+ * @param[out] ppOutDoc        Receives the new document (set to NULL when an error code is returned).
+ * @param[in]  pStream         Pointer to an existing stream object.
+ * @param[in]  flags           Flags for configuring the parser.
+ * @param[in]  pOptions        Options for the document (may be NULL to use the defaults).
+ * @param[in]  errorCallback   Callback for handling parsing errors (this callback is optional and may be NULL if unneeded).
+ * @param[in]  readerCallback  Callback for reading lines in the ini file (must conform to fgets() functionality).
+ * @param[in]  eofCallback     Callback for checking if the end of the ini file has been reached (must conform to feof() functionality).
+ * @param[in]  pUserData       Pointer to user data that is passed to the error callback.
+ */
+MICRO_INI_API int micro_ini_doc_load_stream(
+	micro_ini_doc** const ppOutDoc,
+	void* const pStream,
+	const int flags,
+	const micro_ini_doc_options* const pOptions,
+	const micro_ini_error_fn errorCallback,
+	const micro_ini_reader_fn readerCallback,
+	const micro_ini_eof_fn eofCallback,
+	void* const pUserData
+);
+
+/**
+ * @brief   Parse an in-memory ini file into a new document.
+ * @return  Error code or number of parsing errors that occurred.
+ *
+ * @param[out] ppOutDoc       Receives the new document (set to NULL when an error code is returned).
+ * @param[in]  pData          Contents of the ini file (does not need to be null terminated).
+ * @param[in]  size           Number of bytes in the ini file.
+ * @param[in]  flags          Flags for configuring the parser.
+ * @param[in]  pOptions       Options for the document (may be NULL to use the defaults).
+ * @param[in]  errorCallback  Callback for handling parsing errors (this callback is optional and may be NULL if unneeded).
+ * @param[in]  pUserData      Pointer to user data that is passed to the error callback.
+ */
+MICRO_INI_API int micro_ini_doc_load_buffer(
+	micro_ini_doc** const ppOutDoc,
+	const char* const pData,
+	const size_t size,
+	const int flags,
+	const micro_ini_doc_options* const pOptions,
+	const micro_ini_error_fn errorCallback,
+	void* const pUserData
+);
+
+/**
+ * @brief  Release a document and all memory owned by it.
+ *
+ * @param[in]  pDoc  Document to release (may be NULL).
+ */
+MICRO_INI_API void micro_ini_doc_free(micro_ini_doc* const pDoc);
+
+/**
+ * @brief   Repack every string of a document into a single new pool.
+ * @return  MICRO_INI_SUCCESS or an error code (the document is unchanged on failure).
+ *
+ * @param[in]  pDoc  Document to compact.
+ *
+ * Garbage left by edits is dropped and the new pool is allocated at its exact size.
+ * Sections shared with other versions are copied rather than modified, so the other
+ * versions are unaffected.  The old and new strings exist at the same time during
+ * the call, which must be accounted for when the document has a memory limit.  The
+ * document must not be read by other threads during the call.
+ */
+MICRO_INI_API int micro_ini_doc_compact(micro_ini_doc* const pDoc);
+
+/**
+ * @brief   Get memory and fragmentation statistics for a document.
+ * @return  MICRO_INI_SUCCESS or an error code.
+ *
+ * @param[in]  pDoc       Document to inspect.
+ * @param[out] pOutStats  Receives the statistics.
+ */
+MICRO_INI_API int micro_ini_doc_get_stats(const micro_ini_doc* const pDoc, micro_ini_doc_stats* const pOutStats);
+
+/**
+ * @brief   Look up the value of a key.
+ * @return  Value string owned by the document, or NULL if the key does not exist.
+ *
+ * @param[in]  pDoc     Document to query.
+ * @param[in]  section  Section name (use "" for keys that appear before the first section).
+ * @param[in]  key      Key name.
+ */
+MICRO_INI_API const char* micro_ini_doc_get(const micro_ini_doc* const pDoc, const char* const section, const char* const key);
+
+/**
+ * @brief   Find the index of a section.
+ * @return  Section index, or MICRO_INI_DOC_NPOS if the section does not exist.
+ *
+ * @param[in]  pDoc     Document to query.
+ * @param[in]  section  Section name.
+ *
+ * Hot paths that query the same section repeatedly can resolve the index once
+ * and use micro_ini_doc_section_get() to skip the section probe.
+ */
+MICRO_INI_API size_t micro_ini_doc_find_section(const micro_ini_doc* const pDoc, const char* const section);
+
+/**
+ * @brief   Look up the value of a key within a section index.
+ * @return  Value string owned by the document, or NULL if the key does not exist.
+ *
+ * @param[in]  pDoc          Document to query.
+ * @param[in]  sectionIndex  Index returned by micro_ini_doc_find_section().
+ * @param[in]  key           Key name.
+ */
+MICRO_INI_API const char* micro_ini_doc_section_get(const micro_ini_doc* const pDoc, const size_t sectionIndex, const char* const key);
+
+/**
+ * @brief   Get the section a section inherits from.
+ * @return  Index of the parent section, or MICRO_INI_DOC_NPOS if the section has no parent.
+ *
+ * @param[in]  pDoc          Document to query.
+ * @param[in]  sectionIndex  Index of the section.
+ *
+ * Documents loaded with MICRO_INI_FLAG_INHERITANCE link each "[child : parent]" section
+ * to its parent.  Lookups through micro_ini_doc_get(), micro_ini_doc_section_get() and
+ * the typed getters fall back to the parent, then its parent and so on, without any
+ * key being copied into the child.  The enumeration functions below only report the
+ * keys a section holds itself.  A parent that does not exist, or a link that would
+ * close a cycle, is dropped and reported to the error callback as a parsing error
+ * along with the line number of the header that named it.
+ */
+MICRO_INI_API size_t micro_ini_doc_section_parent(const micro_ini_doc* const pDoc, const size_t sectionIndex);
+
+/**
+ * @brief   Get the number of sections in a document.
+ * @return  Number of sections (only sections containing at least one key or naming a parent are stored).
+ */
+MICRO_INI_API size_t micro_ini_doc_section_count(const micro_ini_doc* const pDoc);
+
+/**
+ * @brief   Get the name of a section, in the order sections first appeared in the file.
+ * @return  Section name, or NULL if the index is out of range.
+ */
+MICRO_INI_API const char* micro_ini_doc_section_name(const micro_ini_doc* const pDoc, const size_t sectionIndex);
+
+/**
+ * @brief   Get the number of keys in a section.
+ * @return  Number of keys, or 0 if the index is out of range.
+ */
+MICRO_INI_API size_t micro_ini_doc_key_count(const micro_ini_doc* const pDoc, const size_t sectionIndex);
+
+/**
+ * @brief   Get a key of a section, in the order keys first appeared in the file.
+ * @return  Key name, or NULL if either index is out of range.
+ */
+MICRO_INI_API const char* micro_ini_doc_key(const micro_ini_doc* const pDoc, const size_t sectionIndex, const size_t keyIndex);
+
+/**
+ * @brief   Get the value of a key of a section by index.
+ * @return  Value string, or NULL if either index is out of range.
+ */
+MICRO_INI_API const char* micro_ini_doc_value(const micro_ini_doc* const pDoc, const size_t sectionIndex, const size_t keyIndex);
+
+/**
+ * @brief   Compute the fingerprint of a document's content.
+ * @return  MICRO_INI_SUCCESS or MICRO_INI_ERROR_INVALID_DOCUMENT.
+ *
+ * @param[in]  pDoc             Document to fingerprint.
+ * @param[out] pOutFingerprint  Receives the fingerprint.
+ *
+ * Only the final value of each key counts, so this matches the fingerprint of a parse
+ * with MICRO_INI_FLAG_FINGERPRINT whenever no key is repeated and every parent exists.
+ * Documents built from different files, or changed by edits, can be compared with it.
+ */
+MICRO_INI_API int micro_ini_doc_fingerprint(const micro_ini_doc* const pDoc, micro_ini_fingerprint* const pOutFingerprint);
+
+/**
+ * @brief   Look up the value of a key as an integer.
+ * @return  MICRO_INI_SUCCESS, MICRO_INI_ERROR_KEY_NOT_FOUND or MICRO_INI_ERROR_INVALID_VALUE.
+ *
+ * @param[in]  pDoc       Document to query.
+ * @param[in]  section    Section name.
+ * @param[in]  key        Key name.
+ * @param[out] pOutValue  Receives the value (left untouched on failure).
+ *
+ * The value must be a decimal integer, or hexadecimal with a "0x" prefix, that fits in a long.
+ *
+ * Typed lookups decode the value on first access and memoize the result next to the
+ * value, so later lookups of the same key as the same type skip the conversion.  The
+ * first typed lookup in a section allocates its cache, 16 bytes per key on most
+ * platforms, so documents only read as strings never pay for it.  The cache holds one
+ * type per key; looking a key up as a different type still works but decodes it every
+ * time.  Results are published atomically, so any number of threads may perform typed
+ * lookups on the same document concurrently.  On compilers without
+ * supported atomics, or when MICRO_INI_DOC_NO_TYPED_CACHE is defined, values are
+ * decoded on every lookup instead.
+ */
+MICRO_INI_API int micro_ini_doc_get_int(const micro_ini_doc* const pDoc, const char* const section, const char* const key, long* const pOutValue);
+
+/**
+ * @brief   Look up the value of a key as a floating point number.
+ * @return  MICRO_INI_SUCCESS, MICRO_INI_ERROR_KEY_NOT_FOUND or MICRO_INI_ERROR_INVALID_VALUE.
+ *
+ * @param[in]  pDoc       Document to query.
+ * @param[in]  section    Section name.
+ * @param[in]  key        Key name.
+ * @param[out] pOutValue  Receives the value (left untouched on failure).
+ *
+ * The value is converted with strtod(), and the whole value must be consumed.
+ */
+MICRO_INI_API int micro_ini_doc_get_double(const micro_ini_doc* const pDoc, const char* const section, const char* const key, double* const pOutValue);
+
+/**
+ * @brief   Look up the value of a key as a boolean.
+ * @return  MICRO_INI_SUCCESS, MICRO_INI_ERROR_KEY_NOT_FOUND or MICRO_INI_ERROR_INVALID_VALUE.
+ *
+ * @param[in]  pDoc       Document to query.
+ * @param[in]  section    Section name.
+ * @param[in]  key        Key name.
+ * @param[out] pOutValue  Receives 1 or 0 (left untouched on failure).
+ *
+ * "true", "yes", "on" and "1" are true and "false", "no", "off" and "0" are false,
+ * ignoring case.
+ */
+MICRO_INI_API int micro_ini_doc_get_bool(const micro_ini_doc* const pDoc, const char* const section, const char* const key, int* const pOutValue);
+
+/**
+ * @brief   Look up the value of a key as a duration.
+ * @return  MICRO_INI_SUCCESS, MICRO_INI_ERROR_KEY_NOT_FOUND or MICRO_INI_ERROR_INVALID_VALUE.
+ *
+ * @param[in]  pDoc         Document to query.
+ * @param[in]  section      Section name.
+ * @param[in]  key          Key name.
+ * @param[out] pOutSeconds  Receives the duration in seconds (left untouched on failure).
+ *
+ * The value is a non-negative number followed by an optional unit: "ns", "us", "ms",
+ * "s", "m" or "min", "h" or "d".  A number without a unit is in seconds.
+ */
+MICRO_INI_API int micro_ini_doc_get_duration(const micro_ini_doc* const pDoc, const char* const section, const char* const key, double* const pOutSeconds);
+
+/**
+ * @brief   Start a batch of edits against a document.
+ * @return  MICRO_INI_SUCCESS or an error code.
+ *
+ * @param[out] ppOutEdit  Receives the new edit batch (set to NULL when an error code is returned).
+ * @param[in]  pBase      Document the edits are based on.
+ *
+ * The base document may be released before the batch is committed.  Every batch must
+ * be finished with either micro_ini_doc_edit_commit() or micro_ini_doc_edit_abort().
+ */
+MICRO_INI_API int micro_ini_doc_edit_begin(micro_ini_doc_edit** const ppOutEdit, const micro_ini_doc* const pBase);
+
+/**
+ * @brief   Set the value of a key, adding the key and its section if they do not exist.
+ * @return  MICRO_INI_SUCCESS or an error code.
+ *
+ * @param[in]  pEdit    Edit batch.
+ * @param[in]  section  Section name.
+ * @param[in]  key      Key name.
+ * @param[in]  value    New value.
+ *
+ * The first edit to a section copies it; later edits to the same section modify the copy.
+ */
+MICRO_INI_API int micro_ini_doc_edit_set(
+	micro_ini_doc_edit* const pEdit,
+	const char* const section,
+	const char* const key,
+	const char* const value
+);
+
+/**
+ * @brief   Remove a key.
+ * @return  MICRO_INI_SUCCESS or an error code (removing a key that does not exist is not an error).
+ *
+ * @param[in]  pEdit    Edit batch.
+ * @param[in]  section  Section name.
+ * @param[in]  key      Key name.
+ *
+ * Sections left without any keys are removed when the batch is committed.
+ */
+MICRO_INI_API int micro_ini_doc_edit_remove(micro_ini_doc_edit* const pEdit, const char* const section, const char* const key);
+
+/**
+ * @brief   Finish a batch of edits, producing a new document version.
+ * @return  MICRO_INI_SUCCESS or an error code.
+ *
+ * @param[in]  pEdit     Edit batch (released by this call on success).
+ * @param[out] ppOutDoc  Receives the new document, which must be released with micro_ini_doc_free().
+ */
+MICRO_INI_API int micro_ini_doc_edit_commit(micro_ini_doc_edit* const pEdit, micro_ini_doc** const ppOutDoc);
+
+/**
+ * @brief  Discard a batch of edits.
+ *
+ * @param[in]  pEdit  Edit batch to release (may be NULL).
+ */
+MICRO_INI_API void micro_ini_doc_edit_abort(micro_ini_doc_edit* const pEdit);
+
+/**
+ * @brief   Build a sorted index over a document.
+ * @return  MICRO_INI_SUCCESS or an error code.
+ *
+ * @param[out] ppOutIndex  Receives the new index (set to NULL when an error code is returned).
+ * @param[in]  pDoc        Document to index.
+ *
+ * The index must be released with micro_ini_doc_index_free() before the document is released.
+ */
+MICRO_INI_API int micro_ini_doc_index_build(micro_ini_doc_index** const ppOutIndex, const micro_ini_doc* const pDoc);
+
+/**
+ * @brief  Release an index.
+ *
+ * @param[in]  pIndex  Index to release (may be NULL).
+ */
+MICRO_INI_API void micro_ini_doc_index_free(micro_ini_doc_index* const pIndex);
+
+/**
+ * @brief   Report every key/value pair whose section and key match a pair of patterns.
+ * @return  Number of matching pairs.
+ *
+ * @param[in]  pIndex          Index to query.
+ * @param[in]  sectionPattern  Pattern for the section name (NULL matches every section).
+ * @param[in]  keyPattern      Pattern for the key name (NULL matches every key).
+ * @param[in]  queryCallback   Callback for each match (this callback is optional and may be NULL to only count matches).
+ * @param[in]  pUserData       Pointer to user data that is passed to the callback.
+ *
+ * Patterns are globs where '*' matches any run of characters and '?' matches any single
+ * character.  The characters before the first wildcard are used to binary search the
+ * index, so queries such as ("upstream.*", NULL) or (NULL, "route_*") only visit the
+ * pairs sharing that literal prefix.  Matches are reported sorted by section and then
+ * key, or by key and then section when only the key pattern has a literal prefix.
+ */
+MICRO_INI_API size_t micro_ini_doc_index_query(
+	const micro_ini_doc_index* const pIndex,
+	const char* const sectionPattern,
+	const char* const keyPattern,
+	const micro_ini_doc_query_fn queryCallback,
+	void* const pUserData
+);
+
+#ifdef __cplusplus
+}
+#endif
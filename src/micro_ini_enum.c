@@ -0,0 +1,627 @@
+/**
+ * Copyright (c) 2021, Zoe J. Bare
+ *
+ * MIT License
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ */
+
+#include "micro_ini_enum.h"
+
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+/**
+ * Number of seeds tried for a domain's perfect hash before its table is doubled.
+ */
+#define MICRO_INI_ENUM_SEED_ATTEMPTS 64
+
+/**
+ * Enumerated values of a single key (internal use only).
+ *
+ * Slot (hash(value, seed) & mask) of the domain's slot range holds the value's
+ * index plus one, or zero when no value hashes there.
+ */
+typedef struct micro_ini_enum_domain
+{
+	uint32_t section;  /* Pool offset of the section name. */
+	uint32_t key;      /* Pool offset of the key name. */
+	uint32_t hash;     /* Hash of the section and key. */
+
+	uint32_t seed;       /* Seed of the domain's perfect hash. */
+	uint32_t mask;       /* Number of slots minus one (the slot count is always a power of two). */
+	uint32_t firstSlot;  /* Index of the domain's first slot. */
+
+	uint32_t firstValue;  /* Index of the domain's first value. */
+	uint32_t valueCount;
+} micro_ini_enum_domain;
+
+/**
+ * Single enumerated value (internal use only).
+ */
+typedef struct micro_ini_enum_value
+{
+	uint32_t offset;  /* Pool offset of the value string. */
+	uint32_t length;  /* Length of the value string. */
+} micro_ini_enum_value;
+
+struct micro_ini_enum_set
+{
+	micro_ini_allocator* pAllocator;  /* Allocator every array came from (NULL for malloc()). */
+
+	char*  pool;  /* Every section, key and value string, each one null terminated. */
+	size_t poolSize;
+	size_t poolCapacity;
+
+	micro_ini_enum_domain* domains;
+	size_t domainCount;
+	size_t domainCapacity;
+
+	micro_ini_enum_value* values;
+	size_t valueCount;
+	size_t valueCapacity;
+
+	uint32_t* slots;
+	size_t slotCount;
+	size_t slotCapacity;
+
+	uint32_t* table;      /* Open-addressed table holding each domain's index plus one (zero for empty slots). */
+	uint32_t  tableMask;  /* Number of table slots minus one. */
+};
+
+/**
+ * @brief   Hash a string with a seed (FNV-1a with a final mix, internal use only).
+ * @return  Hash of the string.
+ *
+ * @param[in]  hash  Initial hash, which may be the result of hashing a previous string.
+ * @param[in]  str   String to hash.
+ * @param[out] pLen  Receives the length of the string (optional, may be NULL).
+ */
+static uint32_t prv_micro_ini_enum_hash_string(uint32_t hash, const char* const str, size_t* const pLen)
+{
+	size_t len = 0;
+
+	for(; str[len] != '\0'; ++len)
+	{
+		hash ^= (unsigned char) str[len];
+		hash *= 16777619u;
+	}
+
+	if(pLen)
+	{
+		(*pLen) = len;
+	}
+
+	return hash;
+}
+
+/**
+ * @brief   Mix the bits of a hash so its low bits can be used as a slot index (internal use only).
+ * @return  Mixed hash.
+ */
+static uint32_t prv_micro_ini_enum_mix(uint32_t hash)
+{
+	hash ^= hash >> 16;
+	hash *= 0x85EBCA6Bu;
+	hash ^= hash >> 13;
+
+	return hash;
+}
+
+/**
+ * @brief   Hash a value for a domain's perfect hash (internal use only).
+ * @return  Hash of the value.
+ */
+static uint32_t prv_micro_ini_enum_hash_value(const char* const value, const uint32_t seed, size_t* const pLen)
+{
+	return prv_micro_ini_enum_mix(prv_micro_ini_enum_hash_string(2166136261u ^ (seed * 0x9E3779B1u), value, pLen));
+}
+
+/**
+ * @brief   Hash a section and key to find their domain (internal use only).
+ * @return  Hash of the pair.
+ */
+static uint32_t prv_micro_ini_enum_hash_key(const char* const section, const char* const key)
+{
+	uint32_t hash = prv_micro_ini_enum_hash_string(2166136261u, section, NULL);
+
+	/* Separate the two strings so ("ab", "c") and ("a", "bc") hash differently. */
+	hash ^= 0xFF;
+	hash *= 16777619u;
+
+	return prv_micro_ini_enum_mix(prv_micro_ini_enum_hash_string(hash, key, NULL));
+}
+
+/**
+ * @brief   Make room for more elements in a growable array (internal use only).
+ * @return  Non-zero on success.
+ *
+ * @param[in]     pAllocator   Allocator the array came from.
+ * @param[in,out] ppArray      Array to grow.
+ * @param[in,out] pCapacity    Capacity of the array in elements.
+ * @param[in]     required     Number of elements the array must be able to hold.
+ * @param[in]     elementSize  Size of each element in bytes.
+ */
+static int prv_micro_ini_enum_reserve(micro_ini_allocator* const pAllocator, void** const ppArray, size_t* const pCapacity, const size_t required, const size_t elementSize)
+{
+	size_t capacity = (*pCapacity) ? (*pCapacity) : 16;
+	void* pNewArray;
+
+	if(required <= (*pCapacity))
+	{
+		return 1;
+	}
+
+	while(capacity < required)
+	{
+		capacity *= 2;
+	}
+
+	if(capacity > (size_t) UINT32_MAX)
+	{
+		/* Everything is addressed with 32-bit offsets. */
+		return 0;
+	}
+
+	pNewArray = micro_ini_allocator_realloc(pAllocator, *ppArray, capacity * elementSize);
+	if(!pNewArray)
+	{
+		return 0;
+	}
+
+	(*ppArray) = pNewArray;
+	(*pCapacity) = capacity;
+
+	return 1;
+}
+
+/**
+ * @brief   Copy a string into the pool (internal use only).
+ * @return  Non-zero on success.
+ */
+static int prv_micro_ini_enum_pool_add(micro_ini_enum_set* const pEnumSet, const char* const str, const size_t len, uint32_t* const pOutOffset)
+{
+	void* pPool = pEnumSet->pool;
+
+	if(!prv_micro_ini_enum_reserve(pEnumSet->pAllocator, &pPool, &pEnumSet->poolCapacity, pEnumSet->poolSize + len + 1, 1))
+	{
+		return 0;
+	}
+
+	pEnumSet->pool = (char*) pPool;
+
+	memcpy(pEnumSet->pool + pEnumSet->poolSize, str, len + 1);
+	(*pOutOffset) = (uint32_t) pEnumSet->poolSize;
+	pEnumSet->poolSize += len + 1;
+
+	return 1;
+}
+
+/**
+ * @brief  Insert a domain into the domain table, which must have a free slot (internal use only).
+ */
+static void prv_micro_ini_enum_table_insert(micro_ini_enum_set* const pEnumSet, const uint32_t domainIndex)
+{
+	uint32_t slot = pEnumSet->domains[domainIndex].hash & pEnumSet->tableMask;
+
+	while(pEnumSet->table[slot] != 0)
+	{
+		slot = (slot + 1) & pEnumSet->tableMask;
+	}
+
+	pEnumSet->table[slot] = domainIndex + 1;
+}
+
+/**
+ * @brief   Keep the domain table at most half full (internal use only).
+ * @return  Non-zero on success.
+ *
+ * @param[in]  pEnumSet  Enum set whose table is grown.
+ * @param[in]  count     Number of domains the table must be able to hold.
+ */
+static int prv_micro_ini_enum_table_reserve(micro_ini_enum_set* const pEnumSet, const size_t count)
+{
+	size_t slotCount = pEnumSet->table ? (size_t) pEnumSet->tableMask + 1 : 0;
+	uint32_t* pNewTable;
+	uint32_t index;
+
+	if(count * 2 <= slotCount)
+	{
+		return 1;
+	}
+
+	slotCount = slotCount ? slotCount : 16;
+
+	while(slotCount < count * 2)
+	{
+		slotCount *= 2;
+	}
+
+	pNewTable = (uint32_t*) micro_ini_allocator_calloc(pEnumSet->pAllocator, slotCount, sizeof(uint32_t));
+	if(!pNewTable)
+	{
+		return 0;
+	}
+
+	micro_ini_allocator_free(pEnumSet->pAllocator, pEnumSet->table);
+	pEnumSet->table = pNewTable;
+	pEnumSet->tableMask = (uint32_t) (slotCount - 1);
+
+	for(index = 0; index < pEnumSet->domainCount; ++index)
+	{
+		prv_micro_ini_enum_table_insert(pEnumSet, index);
+	}
+
+	return 1;
+}
+
+/**
+ * @brief   Find a seed giving a domain's values distinct slots (internal use only).
+ * @return  MICRO_INI_SUCCESS or an error code.
+ *
+ * @param[in]  pEnumSet  Enum set holding the domain.
+ * @param[in]  pDomain   Domain whose values have been added, but not its slots.
+ */
+static int prv_micro_ini_enum_build_domain(micro_ini_enum_set* const pEnumSet, micro_ini_enum_domain* const pDomain)
+{
+	size_t slotCount = 1;
+
+	while(slotCount < pDomain->valueCount)
+	{
+		slotCount *= 2;
+	}
+
+	for(;;)
+	{
+		void* pSlots = pEnumSet->slots;
+		uint32_t seed;
+
+		if(!prv_micro_ini_enum_reserve(pEnumSet->pAllocator, &pSlots, &pEnumSet->slotCapacity, pEnumSet->slotCount + slotCount, sizeof(uint32_t)))
+		{
+			return MICRO_INI_ERROR_OUT_OF_MEMORY;
+		}
+
+		pEnumSet->slots = (uint32_t*) pSlots;
+
+		for(seed = 1; seed <= MICRO_INI_ENUM_SEED_ATTEMPTS; ++seed)
+		{
+			uint32_t* const pDomainSlots = pEnumSet->slots + pEnumSet->slotCount;
+			uint32_t index = 0;
+
+			memset(pDomainSlots, 0, sizeof(uint32_t) * slotCount);
+
+			for(; index < pDomain->valueCount; ++index)
+			{
+				const micro_ini_enum_value* const pValue = &pEnumSet->values[pDomain->firstValue + index];
+				const uint32_t slot = prv_micro_ini_enum_hash_value(pEnumSet->pool + pValue->offset, seed, NULL) & (uint32_t) (slotCount - 1);
+
+				if(pDomainSlots[slot] != 0)
+				{
+					const micro_ini_enum_value* const pOther = &pEnumSet->values[pDomain->firstValue + pDomainSlots[slot] - 1];
+
+					if(strcmp(pEnumSet->pool + pValue->offset, pEnumSet->pool + pOther->offset) == 0)
+					{
+						/* No seed can separate identical values. */
+						return MICRO_INI_ERROR_DUPLICATE_KEY;
+					}
+
+					break;
+				}
+
+				pDomainSlots[slot] = index + 1;
+			}
+
+			if(index == pDomain->valueCount)
+			{
+				pDomain->seed = seed;
+				pDomain->mask = (uint32_t) (slotCount - 1);
+				pDomain->firstSlot = (uint32_t) pEnumSet->slotCount;
+
+				pEnumSet->slotCount += slotCount;
+				return MICRO_INI_SUCCESS;
+			}
+		}
+
+		/* Doubling the table makes a perfect hash much easier to find for small domains. */
+		slotCount *= 2;
+	}
+}
+
+
+int micro_ini_enum_set_create(micro_ini_enum_set** const ppOutEnumSet, micro_ini_allocator* const pAllocator)
+{
+	if(!ppOutEnumSet)
+	{
+		return MICRO_INI_ERROR_INVALID_ENUM_SET;
+	}
+
+	(*ppOutEnumSet) = (micro_ini_enum_set*) micro_ini_allocator_calloc(pAllocator, 1, sizeof(micro_ini_enum_set));
+	if(!(*ppOutEnumSet))
+	{
+		return MICRO_INI_ERROR_OUT_OF_MEMORY;
+	}
+
+	(*ppOutEnumSet)->pAllocator = pAllocator;
+
+	return MICRO_INI_SUCCESS;
+}
+
+
+void micro_ini_enum_set_free(micro_ini_enum_set* const pEnumSet)
+{
+	if(!pEnumSet)
+	{
+		return;
+	}
+
+	micro_ini_allocator_free(pEnumSet->pAllocator, pEnumSet->pool);
+	micro_ini_allocator_free(pEnumSet->pAllocator, pEnumSet->domains);
+	micro_ini_allocator_free(pEnumSet->pAllocator, pEnumSet->values);
+	micro_ini_allocator_free(pEnumSet->pAllocator, pEnumSet->slots);
+	micro_ini_allocator_free(pEnumSet->pAllocator, pEnumSet->table);
+	micro_ini_allocator_free(pEnumSet->pAllocator, pEnumSet);
+}
+
+
+int micro_ini_enum_set_add(
+	micro_ini_enum_set* const pEnumSet,
+	const char* const section,
+	const char* const key,
+	const char* const* const pValues,
+	const size_t valueCount,
+	size_t* const pOutDomainIndex)
+{
+	micro_ini_enum_domain domain;
+	void* pArray;
+	size_t index;
+	int err;
+
+	if(!pEnumSet || !section || !key || (!pValues && valueCount > 0))
+	{
+		return MICRO_INI_ERROR_INVALID_ENUM_SET;
+	}
+
+	for(index = 0; index < valueCount; ++index)
+	{
+		if(!pValues[index])
+		{
+			return MICRO_INI_ERROR_INVALID_ENUM_SET;
+		}
+	}
+
+	if(micro_ini_enum_set_find(pEnumSet, section, key) != MICRO_INI_ENUM_NPOS)
+	{
+		return MICRO_INI_ERROR_DUPLICATE_KEY;
+	}
+
+	memset(&domain, 0, sizeof(domain));
+
+	domain.hash = prv_micro_ini_enum_hash_key(section, key);
+	domain.firstValue = (uint32_t) pEnumSet->valueCount;
+	domain.valueCount = (uint32_t) valueCount;
+
+	pArray = pEnumSet->values;
+	if(!prv_micro_ini_enum_reserve(pEnumSet->pAllocator, &pArray, &pEnumSet->valueCapacity, pEnumSet->valueCount + valueCount, sizeof(micro_ini_enum_value)))
+	{
+		return MICRO_INI_ERROR_OUT_OF_MEMORY;
+	}
+
+	pEnumSet->values = (micro_ini_enum_value*) pArray;
+
+	/* Strings left in the pool by a failed registration are harmless, so nothing below is rolled back except the counts. */
+	if(!prv_micro_ini_enum_pool_add(pEnumSet, section, strlen(section), &domain.section)
+		|| !prv_micro_ini_enum_pool_add(pEnumSet, key, strlen(key), &domain.key))
+	{
+		return MICRO_INI_ERROR_OUT_OF_MEMORY;
+	}
+
+	for(index = 0; index < valueCount; ++index)
+	{
+		micro_ini_enum_value* const pValue = &pEnumSet->values[domain.firstValue + index];
+		const size_t len = strlen(pValues[index]);
+
+		if(!prv_micro_ini_enum_pool_add(pEnumSet, pValues[index], len, &pValue->offset))
+		{
+			return MICRO_INI_ERROR_OUT_OF_MEMORY;
+		}
+
+		pValue->length = (uint32_t) len;
+	}
+
+	err = prv_micro_ini_enum_build_domain(pEnumSet, &domain);
+	if(err != MICRO_INI_SUCCESS)
+	{
+		return err;
+	}
+
+	pArray = pEnumSet->domains;
+	if(prv_micro_ini_enum_reserve(pEnumSet->pAllocator, &pArray, &pEnumSet->domainCapacity, pEnumSet->domainCount + 1, sizeof(micro_ini_enum_domain)))
+	{
+		pEnumSet->domains = (micro_ini_enum_domain*) pArray;
+	}
+
+	if(pEnumSet->domains != pArray || !prv_micro_ini_enum_table_reserve(pEnumSet, pEnumSet->domainCount + 1))
+	{
+		pEnumSet->slotCount -= (size_t) domain.mask + 1;
+		return MICRO_INI_ERROR_OUT_OF_MEMORY;
+	}
+
+	pEnumSet->valueCount += valueCount;
+	pEnumSet->domains[pEnumSet->domainCount] = domain;
+	prv_micro_ini_enum_table_insert(pEnumSet, (uint32_t) pEnumSet->domainCount);
+
+	if(pOutDomainIndex)
+	{
+		(*pOutDomainIndex) = pEnumSet->domainCount;
+	}
+
+	++pEnumSet->domainCount;
+
+	return MICRO_INI_SUCCESS;
+}
+
+
+size_t micro_ini_enum_set_find(const micro_ini_enum_set* const pEnumSet, const char* const section, const char* const key)
+{
+	uint32_t hash;
+	uint32_t slot;
+
+	if(!pEnumSet || !pEnumSet->table || !section || !key)
+	{
+		return MICRO_INI_ENUM_NPOS;
+	}
+
+	hash = prv_micro_ini_enum_hash_key(section, key);
+	slot = hash & pEnumSet->tableMask;
+
+	while(pEnumSet->table[slot] != 0)
+	{
+		const micro_ini_enum_domain* const pDomain = &pEnumSet->domains[pEnumSet->table[slot] - 1];
+
+		if(pDomain->hash == hash
+			&& strcmp(pEnumSet->pool + pDomain->key, key) == 0
+			&& strcmp(pEnumSet->pool + pDomain->section, section) == 0)
+		{
+			return pEnumSet->table[slot] - 1;
+		}
+
+		slot = (slot + 1) & pEnumSet->tableMask;
+	}
+
+	return MICRO_INI_ENUM_NPOS;
+}
+
+
+int micro_ini_enum_set_code(const micro_ini_enum_set* const pEnumSet, const size_t domainIndex, const char* const value)
+{
+	const micro_ini_enum_domain* pDomain;
+	const micro_ini_enum_value* pValue;
+	uint32_t entry;
+	size_t len;
+
+	if(!pEnumSet || !value || domainIndex >= pEnumSet->domainCount)
+	{
+		return MICRO_INI_ERROR_INVALID_VALUE;
+	}
+
+	pDomain = &pEnumSet->domains[domainIndex];
+	entry = pEnumSet->slots[pDomain->firstSlot + (prv_micro_ini_enum_hash_value(value, pDomain->seed, &len) & pDomain->mask)];
+
+	if(entry == 0)
+	{
+		return MICRO_INI_ERROR_INVALID_VALUE;
+	}
+
+	/* The hash is perfect for registered values only, so the single candidate still has to be verified. */
+	pValue = &pEnumSet->values[pDomain->firstValue + entry - 1];
+
+	if(pValue->length != len || memcmp(pEnumSet->pool + pValue->offset, value, len) != 0)
+	{
+		return MICRO_INI_ERROR_INVALID_VALUE;
+	}
+
+	return (int) (entry - 1);
+}
+
+
+const char* micro_ini_enum_set_value(const micro_ini_enum_set* const pEnumSet, const size_t domainIndex, const int code)
+{
+	const micro_ini_enum_domain* pDomain;
+
+	if(!pEnumSet || domainIndex >= pEnumSet->domainCount || code < 0)
+	{
+		return NULL;
+	}
+
+	pDomain = &pEnumSet->domains[domainIndex];
+
+	if((uint32_t) code >= pDomain->valueCount)
+	{
+		return NULL;
+	}
+
+	return pEnumSet->pool + pEnumSet->values[pDomain->firstValue + (uint32_t) code].offset;
+}
+
+
+void micro_ini_enum_handler(void* const pUserData, const char* const section, const char* const key, const char* const value)
+{
+	micro_ini_enum_dispatch* const pDispatch = (micro_ini_enum_dispatch*) pUserData;
+	size_t domainIndex;
+	int code;
+
+	if(!pDispatch)
+	{
+		return;
+	}
+
+	domainIndex = micro_ini_enum_set_find(pDispatch->pEnumSet, section, key);
+
+	if(domainIndex == MICRO_INI_ENUM_NPOS)
+	{
+		if(pDispatch->otherCallback)
+		{
+			pDispatch->otherCallback(pDispatch->pUserData, section, key, value);
+		}
+
+		return;
+	}
+
+	code = micro_ini_enum_set_code(pDispatch->pEnumSet, domainIndex, value);
+
+	if(code >= 0)
+	{
+		if(pDispatch->enumCallback)
+		{
+			pDispatch->enumCallback(pDispatch->pUserData, domainIndex, code, section, key);
+		}
+
+		return;
+	}
+
+	++pDispatch->invalidCount;
+
+	if(pDispatch->errorCallback)
+	{
+		/* Rebuild the pair for the report, truncated to the longest line the parser could have read. */
+		char line[MICRO_INI_MAX_LINE_LENGTH + 1];
+		size_t len = 0;
+		size_t index;
+
+		for(index = 0; key[index] != '\0' && len < MICRO_INI_MAX_LINE_LENGTH; ++index)
+		{
+			line[len++] = key[index];
+		}
+
+		for(index = 0; index < 3 && len < MICRO_INI_MAX_LINE_LENGTH; ++index)
+		{
+			line[len++] = " = "[index];
+		}
+
+		for(index = 0; value[index] != '\0' && len < MICRO_INI_MAX_LINE_LENGTH; ++index)
+		{
+			line[len++] = value[index];
+		}
+
+		line[len] = '\0';
+
+		pDispatch->errorCallback(pDispatch->pUserData, line, pDispatch->pState ? (int) pDispatch->pState->lineno : 0);
+	}
+}
@@ -0,0 +1,162 @@
+/**
+ * Copyright (c) 2021, Zoe J. Bare
+ *
+ * MIT License
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ */
+
+#pragma once
+
+#include "micro_ini.h"
+#include "micro_ini_alloc.h"
+
+#include <stddef.h>
+
+/* Returned by micro_ini_enum_set_find() when a key has no enum domain. */
+#define MICRO_INI_ENUM_NPOS ((size_t) -1)
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * Enum domains registered per key, used to turn enumerated values such as
+ * "log_level = debug" into integer codes while parsing.  This is an optional module
+ * layered on top of the callback parser; unlike the parser, it allocates memory.
+ *
+ * Each domain is a list of the values a key may take; the code of a value is its
+ * index in that list.  Domains get a small perfect hash when they are registered, so
+ * mapping a value to its code hashes the value once and compares it against the one
+ * candidate in its slot.  Keys are found through a hash table keyed on section and key.
+ */
+typedef struct micro_ini_enum_set micro_ini_enum_set;
+
+/* Handling function for values of keys that have an enum domain. */
+typedef void (*micro_ini_enum_fn)(void* pUserData, size_t domainIndex, int code, const char* section, const char* key);
+
+/**
+ * Routing for micro_ini_enum_handler().  Pass a pointer to this structure as the
+ * user data of any of the load functions.
+ */
+typedef struct micro_ini_enum_dispatch
+{
+	const micro_ini_enum_set* pEnumSet;
+
+	/* State given to the micro_ini_resume* function doing the parse, used for line numbers (optional, may be NULL). */
+	const micro_ini_state* pState;
+
+	micro_ini_enum_fn    enumCallback;   /* Called with the code of each valid enumerated value. */
+	micro_ini_handler_fn otherCallback;  /* Called for pairs whose key has no enum domain (optional, may be NULL). */
+	micro_ini_error_fn   errorCallback;  /* Called for values outside of their domain (optional, may be NULL). */
+
+	void* pUserData;  /* Pointer to user data that is passed to the callbacks. */
+
+	size_t invalidCount;  /* Number of values found outside of their domain (updated by the handler). */
+} micro_ini_enum_dispatch;
+
+/**
+ * @brief   Create an empty enum set.
+ * @return  MICRO_INI_SUCCESS or an error code.
+ *
+ * @param[out] ppOutEnumSet  Receives the new enum set (set to NULL when an error code is returned).
+ * @param[in]  pAllocator    Allocator for the enum set's memory (NULL for malloc()).
+ *
+ * The enum set must be released with micro_ini_enum_set_free().
+ */
+MICRO_INI_API int micro_ini_enum_set_create(micro_ini_enum_set** const ppOutEnumSet, micro_ini_allocator* const pAllocator);
+
+/**
+ * @brief  Release an enum set.
+ *
+ * @param[in]  pEnumSet  Enum set to release (may be NULL).
+ */
+MICRO_INI_API void micro_ini_enum_set_free(micro_ini_enum_set* const pEnumSet);
+
+/**
+ * @brief   Register the domain of a key.
+ * @return  MICRO_INI_SUCCESS or an error code.
+ *
+ * @param[in]  pEnumSet          Enum set to add the domain to.
+ * @param[in]  section           Section of the key (use "" for keys that appear before the first section).
+ * @param[in]  key               Key name.
+ * @param[in]  pValues           Values the key may take; the code of each value is its index in this array.
+ * @param[in]  valueCount        Number of values.
+ * @param[out] pOutDomainIndex   Receives the index of the new domain (optional, may be NULL).
+ *
+ * The strings are copied.  Registering a key twice, or the same value twice within
+ * a domain, returns MICRO_INI_ERROR_DUPLICATE_KEY.
+ */
+MICRO_INI_API int micro_ini_enum_set_add(
+	micro_ini_enum_set* const pEnumSet,
+	const char* const section,
+	const char* const key,
+	const char* const* const pValues,
+	const size_t valueCount,
+	size_t* const pOutDomainIndex
+);
+
+/**
+ * @brief   Find the domain of a key.
+ * @return  Domain index, or MICRO_INI_ENUM_NPOS if the key has no domain.
+ *
+ * @param[in]  pEnumSet  Enum set to search.
+ * @param[in]  section   Section of the key.
+ * @param[in]  key       Key name.
+ */
+MICRO_INI_API size_t micro_ini_enum_set_find(const micro_ini_enum_set* const pEnumSet, const char* const section, const char* const key);
+
+/**
+ * @brief   Map a value to its code within a domain.
+ * @return  Code of the value, or MICRO_INI_ERROR_INVALID_VALUE if the value is not in the domain.
+ *
+ * @param[in]  pEnumSet     Enum set to search.
+ * @param[in]  domainIndex  Index of the domain.
+ * @param[in]  value        Value to map.
+ */
+MICRO_INI_API int micro_ini_enum_set_code(const micro_ini_enum_set* const pEnumSet, const size_t domainIndex, const char* const value);
+
+/**
+ * @brief   Get the value string of a code.
+ * @return  Value registered with the code, or NULL if either index is out of range.
+ *
+ * @param[in]  pEnumSet     Enum set to query.
+ * @param[in]  domainIndex  Index of the domain.
+ * @param[in]  code         Code of the value.
+ */
+MICRO_INI_API const char* micro_ini_enum_set_value(const micro_ini_enum_set* const pEnumSet, const size_t domainIndex, const int code);
+
+/**
+ * @brief  Key/value handler that maps enumerated values to their codes.
+ *
+ * @param[in]  pUserData  Pointer to a micro_ini_enum_dispatch.
+ * @param[in]  section    Section of the pair.
+ * @param[in]  key        Key of the pair.
+ * @param[in]  value      Value of the pair.
+ *
+ * This conforms to micro_ini_handler_fn so it can be passed straight to any of the
+ * load functions.  A value outside of its domain is reported to the error callback
+ * as "key = value" along with its line number, which is taken from the dispatch's
+ * parser state; without a state, the line number is reported as 0.
+ */
+MICRO_INI_API void micro_ini_enum_handler(void* const pUserData, const char* const section, const char* const key, const char* const value);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,581 @@
+/**
+ * Copyright (c) 2021, Zoe J. Bare
+ *
+ * MIT License
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ */
+
+#include "micro_ini_image.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+/**
+ * Version of the image layout, bumped whenever it changes.
+ */
+#define MICRO_INI_IMAGE_VERSION 2
+
+/**
+ * Written in the byte order of the machine building an image, so images built on a
+ * machine with a different byte order are rejected.
+ */
+#define MICRO_INI_IMAGE_BYTE_ORDER 0x01020304UL
+
+/**
+ * Header of an image (internal use only).  The header is followed by the sections, the
+ * pairs and the string pool.
+ */
+typedef struct micro_ini_image_header
+{
+	char     magic[8];   /* "MICROIMG" */
+	uint32_t version;    /* MICRO_INI_IMAGE_VERSION */
+	uint32_t byteOrder;  /* MICRO_INI_IMAGE_BYTE_ORDER */
+	uint32_t sectionCount;
+	uint32_t pairCount;
+	uint32_t poolSize;
+	uint32_t reserved;
+} micro_ini_image_header;
+
+/**
+ * Parent index of a section without a parent (internal use only).
+ */
+#define MICRO_INI_IMAGE_NO_PARENT UINT32_MAX
+
+/**
+ * Section of an image (internal use only).
+ */
+typedef struct micro_ini_image_section
+{
+	uint32_t name;       /* Pool offset of the section name. */
+	uint32_t firstPair;  /* Index of the section's first pair. */
+	uint32_t pairCount;
+	uint32_t parent;     /* Index of the parent section, or MICRO_INI_IMAGE_NO_PARENT. */
+} micro_ini_image_section;
+
+/**
+ * Key/value pair of an image (internal use only).
+ */
+typedef struct micro_ini_image_pair
+{
+	uint32_t key;    /* Pool offset of the key name. */
+	uint32_t value;  /* Pool offset of the value. */
+} micro_ini_image_pair;
+
+/**
+ * Pair gathered while building an image (internal use only).
+ */
+typedef struct micro_ini_image_entry
+{
+	const char* key;
+	const char* value;
+} micro_ini_image_entry;
+
+/**
+ * Section gathered while building an image (internal use only).
+ */
+typedef struct micro_ini_image_group
+{
+	const char* name;
+	size_t sectionIndex;
+} micro_ini_image_group;
+
+/**
+ * @brief   Order two gathered pairs by key (internal use only).
+ * @return  Result of strcmp() on the keys.
+ */
+static int prv_micro_ini_image_compare_entries(const void* pA, const void* pB)
+{
+	return strcmp(((const micro_ini_image_entry*) pA)->key, ((const micro_ini_image_entry*) pB)->key);
+}
+
+/**
+ * @brief   Order two gathered sections by name (internal use only).
+ * @return  Result of strcmp() on the names.
+ */
+static int prv_micro_ini_image_compare_groups(const void* pA, const void* pB)
+{
+	return strcmp(((const micro_ini_image_group*) pA)->name, ((const micro_ini_image_group*) pB)->name);
+}
+
+/**
+ * @brief   Append a string to the pool of an image being built (internal use only).
+ * @return  Pool offset of the string.
+ */
+static uint32_t prv_micro_ini_image_add_string(char* const pPool, size_t* const pPoolSize, const char* const str)
+{
+	const size_t length = strlen(str) + 1;
+	const uint32_t offset = (uint32_t) (*pPoolSize);
+
+	memcpy(pPool + (*pPoolSize), str, length);
+	(*pPoolSize) += length;
+
+	return offset;
+}
+
+/**
+ * @brief   Gather the pairs of a section, sorted by key (internal use only).
+ * @return  Number of pairs written to the entry array.
+ *
+ * @param[in]  pDoc          Document.
+ * @param[in]  sectionIndex  Section to gather.
+ * @param[out] pEntries      Array receiving the pairs (sized for the largest section).
+ *
+ * Only the section's own pairs are gathered; inherited keys are found through the
+ * parent links when the image is queried.
+ */
+static size_t prv_micro_ini_image_gather(const micro_ini_doc* const pDoc, const size_t sectionIndex, micro_ini_image_entry* const pEntries)
+{
+	const size_t count = micro_ini_doc_key_count(pDoc, sectionIndex);
+	size_t i;
+
+	for(i = 0; i < count; ++i)
+	{
+		pEntries[i].key = micro_ini_doc_key(pDoc, sectionIndex, i);
+		pEntries[i].value = micro_ini_doc_value(pDoc, sectionIndex, i);
+	}
+
+	qsort(pEntries, count, sizeof(micro_ini_image_entry), prv_micro_ini_image_compare_entries);
+
+	return count;
+}
+
+/**
+ * @brief   Get a section of an image by index (internal use only).
+ * @return  The section, or NULL if the index is out of range or the section is corrupt.
+ */
+static const micro_ini_image_section* prv_micro_ini_image_section(const micro_ini_image* const pImage, const size_t sectionIndex)
+{
+	const micro_ini_image_section* pSection;
+
+	if(!pImage || sectionIndex >= pImage->sectionCount)
+	{
+		return NULL;
+	}
+
+	pSection = (const micro_ini_image_section*) pImage->pSections + sectionIndex;
+	if(pSection->firstPair > pImage->pairCount || pSection->pairCount > pImage->pairCount - pSection->firstPair)
+	{
+		return NULL;
+	}
+
+	return pSection;
+}
+
+/**
+ * @brief   Get a string of an image by its pool offset (internal use only).
+ * @return  The string, or NULL if the offset is out of range.
+ *
+ * The pool is known to end with a null, so every offset inside it yields a terminated string.
+ */
+static const char* prv_micro_ini_image_string(const micro_ini_image* const pImage, const uint32_t offset)
+{
+	return (offset < pImage->poolSize) ? pImage->pool + offset : NULL;
+}
+
+/**
+ * @brief   Find a key among the pairs of one section, without following its parent (internal use only).
+ * @return  The pair, or NULL if the section does not hold the key.
+ */
+static const micro_ini_image_pair* prv_micro_ini_image_find_pair(
+	const micro_ini_image* const pImage,
+	const micro_ini_image_section* const pSection,
+	const char* const key
+)
+{
+	const micro_ini_image_pair* const pairs = (const micro_ini_image_pair*) pImage->pPairs + pSection->firstPair;
+	const char* name;
+	size_t low = 0;
+	size_t high = pSection->pairCount;
+	size_t middle;
+	int order;
+
+	while(low < high)
+	{
+		middle = low + (high - low) / 2;
+
+		name = prv_micro_ini_image_string(pImage, pairs[middle].key);
+		if(!name)
+		{
+			return NULL;
+		}
+
+		order = strcmp(key, name);
+		if(order == 0)
+		{
+			return &pairs[middle];
+		}
+
+		if(order < 0)
+		{
+			high = middle;
+		}
+		else
+		{
+			low = middle + 1;
+		}
+	}
+
+	return NULL;
+}
+
+/**
+ * @brief   Find the nearest section of a chain holding a key (internal use only).
+ * @return  The pair, or NULL if no section of the chain holds the key.
+ *
+ * @param[in]  pImage        Image view.
+ * @param[in]  sectionIndex  Section the chain starts at.
+ * @param[in]  key           Key name.
+ *
+ * A chain never visits more sections than the image has, so parent links looping
+ * through a corrupt image end the search rather than hang it.
+ */
+static const micro_ini_image_pair* prv_micro_ini_image_find_inherited(const micro_ini_image* const pImage, size_t sectionIndex, const char* const key)
+{
+	const micro_ini_image_section* pSection;
+	const micro_ini_image_pair* pPair;
+	size_t hops;
+
+	if(!key)
+	{
+		return NULL;
+	}
+
+	for(hops = 0; hops < pImage->sectionCount; ++hops)
+	{
+		pSection = prv_micro_ini_image_section(pImage, sectionIndex);
+		if(!pSection)
+		{
+			return NULL;
+		}
+
+		pPair = prv_micro_ini_image_find_pair(pImage, pSection, key);
+		if(pPair)
+		{
+			return pPair;
+		}
+
+		if(pSection->parent == MICRO_INI_IMAGE_NO_PARENT)
+		{
+			return NULL;
+		}
+
+		sectionIndex = pSection->parent;
+	}
+
+	return NULL;
+}
+
+
+int micro_ini_image_build(void** const ppOutData, size_t* const pOutSize, const micro_ini_doc* const pDoc, micro_ini_allocator* const pAllocator)
+{
+	const size_t sectionCount = micro_ini_doc_section_count(pDoc);
+	micro_ini_image_group* groups;
+	micro_ini_image_entry* entries;
+	micro_ini_image_header* pHeader;
+	micro_ini_image_section* sections;
+	micro_ini_image_pair* pairs;
+	uint32_t* ranks;
+	unsigned char* pData;
+	char* pool;
+	size_t pairBound = 0;
+	size_t sectionBound = 0;
+	size_t poolSize = 0;
+	size_t pairCount;
+	size_t count;
+	size_t parent;
+	size_t i;
+	size_t j;
+
+	if(!ppOutData || !pOutSize || !pDoc)
+	{
+		/* Invalid output pointers or document. */
+		return MICRO_INI_ERROR_INVALID_DOCUMENT;
+	}
+
+	(*ppOutData) = NULL;
+	(*pOutSize) = 0;
+
+	/* Every section stores only its own pairs, so the sizes are known exactly. */
+	for(i = 0; i < sectionCount; ++i)
+	{
+		count = micro_ini_doc_key_count(pDoc, i);
+		poolSize += strlen(micro_ini_doc_section_name(pDoc, i)) + 1;
+
+		for(j = 0; j < count; ++j)
+		{
+			poolSize += strlen(micro_ini_doc_key(pDoc, i, j)) + strlen(micro_ini_doc_value(pDoc, i, j)) + 2;
+		}
+
+		pairBound += count;
+		if(count > sectionBound)
+		{
+			sectionBound = count;
+		}
+	}
+
+	if(poolSize > UINT32_MAX || pairBound > UINT32_MAX || sectionCount >= MICRO_INI_IMAGE_NO_PARENT)
+	{
+		/* Offsets and indices are 32 bits wide. */
+		return MICRO_INI_ERROR_MEMORY_LIMIT;
+	}
+
+	groups = (micro_ini_image_group*) micro_ini_allocator_alloc(pAllocator, (sectionCount + 1) * sizeof(micro_ini_image_group));
+	ranks = (uint32_t*) micro_ini_allocator_alloc(pAllocator, (sectionCount + 1) * sizeof(uint32_t));
+	entries = (micro_ini_image_entry*) micro_ini_allocator_alloc(pAllocator, (sectionBound + 1) * sizeof(micro_ini_image_entry));
+	pData = (unsigned char*) micro_ini_allocator_alloc(pAllocator, sizeof(micro_ini_image_header)
+		+ sectionCount * sizeof(micro_ini_image_section)
+		+ pairBound * sizeof(micro_ini_image_pair)
+		+ poolSize);
+
+	if(!groups || !ranks || !entries || !pData)
+	{
+		micro_ini_allocator_free(pAllocator, pData);
+		micro_ini_allocator_free(pAllocator, entries);
+		micro_ini_allocator_free(pAllocator, ranks);
+		micro_ini_allocator_free(pAllocator, groups);
+		return MICRO_INI_ERROR_OUT_OF_MEMORY;
+	}
+
+	for(i = 0; i < sectionCount; ++i)
+	{
+		groups[i].name = micro_ini_doc_section_name(pDoc, i);
+		groups[i].sectionIndex = i;
+	}
+
+	qsort(groups, sectionCount, sizeof(micro_ini_image_group), prv_micro_ini_image_compare_groups);
+
+	/* Parent links refer to sections by their position in the sorted image. */
+	for(i = 0; i < sectionCount; ++i)
+	{
+		ranks[groups[i].sectionIndex] = (uint32_t) i;
+	}
+
+	pHeader = (micro_ini_image_header*) pData;
+	sections = (micro_ini_image_section*) (pHeader + 1);
+	pairs = (micro_ini_image_pair*) (sections + sectionCount);
+	pool = (char*) (pairs + pairBound);
+	pairCount = 0;
+	poolSize = 0;
+
+	for(i = 0; i < sectionCount; ++i)
+	{
+		count = prv_micro_ini_image_gather(pDoc, groups[i].sectionIndex, entries);
+		parent = micro_ini_doc_section_parent(pDoc, groups[i].sectionIndex);
+
+		sections[i].name = prv_micro_ini_image_add_string(pool, &poolSize, groups[i].name);
+		sections[i].firstPair = (uint32_t) pairCount;
+		sections[i].pairCount = (uint32_t) count;
+		sections[i].parent = (parent != MICRO_INI_DOC_NPOS) ? ranks[parent] : MICRO_INI_IMAGE_NO_PARENT;
+
+		for(j = 0; j < count; ++j)
+		{
+			pairs[pairCount].key = prv_micro_ini_image_add_string(pool, &poolSize, entries[j].key);
+			pairs[pairCount].value = prv_micro_ini_image_add_string(pool, &poolSize, entries[j].value);
+			++pairCount;
+		}
+	}
+
+	micro_ini_allocator_free(pAllocator, entries);
+	micro_ini_allocator_free(pAllocator, ranks);
+	micro_ini_allocator_free(pAllocator, groups);
+
+	memcpy(pHeader->magic, "MICROIMG", 8);
+	pHeader->version = MICRO_INI_IMAGE_VERSION;
+	pHeader->byteOrder = MICRO_INI_IMAGE_BYTE_ORDER;
+	pHeader->sectionCount = (uint32_t) sectionCount;
+	pHeader->pairCount = (uint32_t) pairCount;
+	pHeader->poolSize = (uint32_t) poolSize;
+	pHeader->reserved = 0;
+
+	(*ppOutData) = pData;
+	(*pOutSize) = (size_t) ((unsigned char*) (pairs + pairCount) + poolSize - pData);
+
+	return MICRO_INI_SUCCESS;
+}
+
+
+int micro_ini_image_open(micro_ini_image* const pOutImage, const void* const pData, const size_t size)
+{
+	const micro_ini_image_header* const pHeader = (const micro_ini_image_header*) pData;
+	size_t expected;
+
+	if(!pOutImage || !pData || size < sizeof(micro_ini_image_header))
+	{
+		return MICRO_INI_ERROR_INVALID_IMAGE;
+	}
+
+	if(memcmp(pHeader->magic, "MICROIMG", 8) != 0
+		|| pHeader->version != MICRO_INI_IMAGE_VERSION
+		|| pHeader->byteOrder != MICRO_INI_IMAGE_BYTE_ORDER)
+	{
+		/* Not an image, or built by an incompatible version or platform. */
+		return MICRO_INI_ERROR_INVALID_IMAGE;
+	}
+
+	expected = sizeof(micro_ini_image_header)
+		+ (size_t) pHeader->sectionCount * sizeof(micro_ini_image_section)
+		+ (size_t) pHeader->pairCount * sizeof(micro_ini_image_pair)
+		+ (size_t) pHeader->poolSize;
+
+	if(expected != size || (pHeader->poolSize > 0 && ((const char*) pData)[size - 1] != '\0'))
+	{
+		/* Truncated or corrupt. */
+		return MICRO_INI_ERROR_INVALID_IMAGE;
+	}
+
+	pOutImage->pHeader = pHeader;
+	pOutImage->pSections = pHeader + 1;
+	pOutImage->pPairs = (const micro_ini_image_section*) pOutImage->pSections + pHeader->sectionCount;
+	pOutImage->pool = (const char*) ((const micro_ini_image_pair*) pOutImage->pPairs + pHeader->pairCount);
+	pOutImage->sectionCount = pHeader->sectionCount;
+	pOutImage->pairCount = pHeader->pairCount;
+	pOutImage->poolSize = pHeader->poolSize;
+
+	return MICRO_INI_SUCCESS;
+}
+
+
+const char* micro_ini_image_get(const micro_ini_image* const pImage, const char* const section, const char* const key)
+{
+	return micro_ini_image_section_get(pImage, micro_ini_image_find_section(pImage, section), key);
+}
+
+
+size_t micro_ini_image_find_section(const micro_ini_image* const pImage, const char* const section)
+{
+	const micro_ini_image_section* sections;
+	const char* name;
+	size_t low = 0;
+	size_t high;
+	size_t middle;
+	int order;
+
+	if(!pImage || !section)
+	{
+		return MICRO_INI_IMAGE_NPOS;
+	}
+
+	sections = (const micro_ini_image_section*) pImage->pSections;
+	high = pImage->sectionCount;
+
+	while(low < high)
+	{
+		middle = low + (high - low) / 2;
+
+		name = prv_micro_ini_image_string(pImage, sections[middle].name);
+		if(!name)
+		{
+			return MICRO_INI_IMAGE_NPOS;
+		}
+
+		order = strcmp(section, name);
+		if(order == 0)
+		{
+			return middle;
+		}
+
+		if(order < 0)
+		{
+			high = middle;
+		}
+		else
+		{
+			low = middle + 1;
+		}
+	}
+
+	return MICRO_INI_IMAGE_NPOS;
+}
+
+
+const char* micro_ini_image_section_get(const micro_ini_image* const pImage, const size_t sectionIndex, const char* const key)
+{
+	const micro_ini_image_pair* pPair;
+
+	if(!pImage)
+	{
+		return NULL;
+	}
+
+	pPair = prv_micro_ini_image_find_inherited(pImage, sectionIndex, key);
+
+	return pPair ? prv_micro_ini_image_string(pImage, pPair->value) : NULL;
+}
+
+
+size_t micro_ini_image_section_count(const micro_ini_image* const pImage)
+{
+	return pImage ? pImage->sectionCount : 0;
+}
+
+
+const char* micro_ini_image_section_name(const micro_ini_image* const pImage, const size_t sectionIndex)
+{
+	const micro_ini_image_section* const pSection = prv_micro_ini_image_section(pImage, sectionIndex);
+
+	return pSection ? prv_micro_ini_image_string(pImage, pSection->name) : NULL;
+}
+
+
+size_t micro_ini_image_section_parent(const micro_ini_image* const pImage, const size_t sectionIndex)
+{
+	const micro_ini_image_section* const pSection = prv_micro_ini_image_section(pImage, sectionIndex);
+
+	if(!pSection || pSection->parent == MICRO_INI_IMAGE_NO_PARENT || pSection->parent >= pImage->sectionCount)
+	{
+		return MICRO_INI_IMAGE_NPOS;
+	}
+
+	return pSection->parent;
+}
+
+
+size_t micro_ini_image_key_count(const micro_ini_image* const pImage, const size_t sectionIndex)
+{
+	const micro_ini_image_section* const pSection = prv_micro_ini_image_section(pImage, sectionIndex);
+
+	return pSection ? pSection->pairCount : 0;
+}
+
+
+const char* micro_ini_image_key(const micro_ini_image* const pImage, const size_t sectionIndex, const size_t keyIndex)
+{
+	const micro_ini_image_section* const pSection = prv_micro_ini_image_section(pImage, sectionIndex);
+
+	if(!pSection || keyIndex >= pSection->pairCount)
+	{
+		return NULL;
+	}
+
+	return prv_micro_ini_image_string(pImage, ((const micro_ini_image_pair*) pImage->pPairs)[pSection->firstPair + keyIndex].key);
+}
+
+
+const char* micro_ini_image_value(const micro_ini_image* const pImage, const size_t sectionIndex, const size_t keyIndex)
+{
+	const micro_ini_image_section* const pSection = prv_micro_ini_image_section(pImage, sectionIndex);
+
+	if(!pSection || keyIndex >= pSection->pairCount)
+	{
+		return NULL;
+	}
+
+	return prv_micro_ini_image_string(pImage, ((const micro_ini_image_pair*) pImage->pPairs)[pSection->firstPair + keyIndex].value);
+}
@@ -0,0 +1,169 @@
+/**
+ * Copyright (c) 2021, Zoe J. Bare
+ *
+ * MIT License
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ */
+
+#pragma once
+
+#include "micro_ini_doc.h"
+
+#include <stddef.h>
+#include <stdint.h>
+
+/* Returned by micro_ini_image_find_section() when a section does not exist. */
+#define MICRO_INI_IMAGE_NPOS ((size_t) -1)
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * Read-only view of a flat, position independent image of a document.  This is an
+ * optional module layered on top of the document module.
+ *
+ * An image is a single block of memory holding the sections sorted by name, the
+ * pairs of every section sorted by key, and a string pool, all linked by 32-bit
+ * offsets.  Since it contains no pointers, an image can be written to a file or a
+ * shared memory object and queried in place by any process that maps it, with each
+ * lookup being a pair of binary searches.  Each section holds only its own pairs and
+ * the index of its parent, so a lookup that misses a section continues in its parent
+ * and an image grows with the pairs of the file rather than with the depth of its
+ * inheritance chains.
+ *
+ * The fields of this structure are for internal use only.  A view does not own the
+ * memory it was opened over, which must outlive it.
+ */
+typedef struct micro_ini_image
+{
+	const void* pHeader;
+	const void* pSections;
+	const void* pPairs;
+	const char* pool;
+	uint32_t sectionCount;
+	uint32_t pairCount;
+	uint32_t poolSize;
+} micro_ini_image;
+
+/**
+ * @brief   Build the image of a document.
+ * @return  MICRO_INI_SUCCESS or an error code.
+ *
+ * @param[out] ppOutData   Receives the image (set to NULL when an error code is returned), released with
+ *                         micro_ini_allocator_free() on the same allocator (free() when it is NULL).
+ * @param[out] pOutSize    Receives the size of the image in bytes.
+ * @param[in]  pDoc        Document to build the image of.
+ * @param[in]  pAllocator  Allocator for the image and its temporaries (NULL for malloc()).
+ *
+ * The image is stored in the byte order of the machine that built it.  Documents
+ * whose strings add up to 4 GiB or more return MICRO_INI_ERROR_MEMORY_LIMIT.
+ */
+MICRO_INI_API int micro_ini_image_build(void** const ppOutData, size_t* const pOutSize, const micro_ini_doc* const pDoc, micro_ini_allocator* const pAllocator);
+
+/**
+ * @brief   Open a view over an image.
+ * @return  MICRO_INI_SUCCESS or MICRO_INI_ERROR_INVALID_IMAGE.
+ *
+ * @param[out] pOutImage  Receives the view.
+ * @param[in]  pData      Image data, which must be aligned to 8 bytes.
+ * @param[in]  size       Size of the image data in bytes.
+ *
+ * Only the header is checked here, so opening an image costs the same regardless of
+ * its size.  Every offset is checked as it is used, so lookups in a corrupt image
+ * fail rather than read outside of it.
+ */
+MICRO_INI_API int micro_ini_image_open(micro_ini_image* const pOutImage, const void* const pData, const size_t size);
+
+/**
+ * @brief   Look up a value in an image.
+ * @return  The value, or NULL if the section or key does not exist.
+ *
+ * @param[in]  pImage   Image view.
+ * @param[in]  section  Section name.
+ * @param[in]  key      Key name.
+ */
+MICRO_INI_API const char* micro_ini_image_get(const micro_ini_image* const pImage, const char* const section, const char* const key);
+
+/**
+ * @brief   Find the index of a section.
+ * @return  Section index, or MICRO_INI_IMAGE_NPOS if the section does not exist.
+ *
+ * @param[in]  pImage   Image view.
+ * @param[in]  section  Section name.
+ *
+ * Sections are indexed in order of their names.
+ */
+MICRO_INI_API size_t micro_ini_image_find_section(const micro_ini_image* const pImage, const char* const section);
+
+/**
+ * @brief   Look up a value in a section found with micro_ini_image_find_section().
+ * @return  The value, or NULL if the key does not exist.
+ *
+ * @param[in]  pImage        Image view.
+ * @param[in]  sectionIndex  Section index.
+ * @param[in]  key           Key name.
+ *
+ * Keys the section does not hold are looked up in its parents, nearest first.
+ */
+MICRO_INI_API const char* micro_ini_image_section_get(const micro_ini_image* const pImage, const size_t sectionIndex, const char* const key);
+
+/**
+ * @brief   Get the parent of a section.
+ * @return  Index of the parent section, or MICRO_INI_IMAGE_NPOS if it has none.
+ *
+ * Listing every key visible in a section means walking its parents and keeping only
+ * the nearest copy of each key, which is the one micro_ini_image_section_get() returns.
+ */
+MICRO_INI_API size_t micro_ini_image_section_parent(const micro_ini_image* const pImage, const size_t sectionIndex);
+
+/**
+ * @brief   Get the number of sections in an image.
+ * @return  Number of sections.
+ */
+MICRO_INI_API size_t micro_ini_image_section_count(const micro_ini_image* const pImage);
+
+/**
+ * @brief   Get the name of a section, in sorted order.
+ * @return  Section name, or NULL if the index is out of range.
+ */
+MICRO_INI_API const char* micro_ini_image_section_name(const micro_ini_image* const pImage, const size_t sectionIndex);
+
+/**
+ * @brief   Get the number of keys a section holds itself, not counting the keys it inherits.
+ * @return  Number of keys, or 0 if the index is out of range.
+ */
+MICRO_INI_API size_t micro_ini_image_key_count(const micro_ini_image* const pImage, const size_t sectionIndex);
+
+/**
+ * @brief   Get a key of a section, in sorted order.
+ * @return  Key name, or NULL if either index is out of range.
+ */
+MICRO_INI_API const char* micro_ini_image_key(const micro_ini_image* const pImage, const size_t sectionIndex, const size_t keyIndex);
+
+/**
+ * @brief   Get the value of a key of a section by index.
+ * @return  Value string, or NULL if either index is out of range.
+ */
+MICRO_INI_API const char* micro_ini_image_value(const micro_ini_image* const pImage, const size_t sectionIndex, const size_t keyIndex);
+
+#ifdef __cplusplus
+}
+#endif
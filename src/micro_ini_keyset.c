@@ -0,0 +1,504 @@
+/**
+ * Copyright (c) 2021, Zoe J. Bare
+ *
+ * MIT License
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ */
+
+#include "micro_ini_keyset.h"
+
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+#if !defined(MICRO_INI_KEYSET_NO_SIMD)
+	#if defined(__SSE2__) || defined(_M_X64) || defined(_M_AMD64) || (defined(_M_IX86_FP) && (_M_IX86_FP >= 2))
+		#include <emmintrin.h>
+		#define MICRO_INI_KEYSET_SSE2
+	#endif
+
+	#if defined(__AVX2__)
+		#include <immintrin.h>
+		#define MICRO_INI_KEYSET_AVX2
+	#endif
+#endif
+
+/**
+ * Width in bytes of the widest lane, which is also the size of a probe.
+ */
+#define MICRO_INI_KEYSET_PROBE_SIZE 32
+
+/**
+ * Number of lane classes: 16 byte lanes, 32 byte lanes and keys too long for a lane.
+ */
+#define MICRO_INI_KEYSET_CLASS_COUNT 3
+
+/**
+ * Keys of one lane class grouped into buckets (internal use only).
+ *
+ * Entries are stored in bucket order, so a lookup scans a contiguous run of lanes.
+ * Bucket b holds the entries from starts[b] up to starts[b + 1].
+ */
+typedef struct micro_ini_keyset_class
+{
+	uint32_t mask;    /* Number of buckets minus one (the bucket count is always a power of two). */
+	size_t   width;   /* Width in bytes of each lane (0 when the keys are compared as strings). */
+
+	uint32_t*      starts;  /* First entry of each bucket, followed by the entry count. */
+	uint32_t*      ids;     /* Key index of each entry. */
+	unsigned char* lanes;   /* Zero padded key of each entry, aligned to MICRO_INI_KEYSET_PROBE_SIZE. */
+	void*          pLaneBlock;
+} micro_ini_keyset_class;
+
+struct micro_ini_keyset
+{
+	size_t count;
+
+	micro_ini_allocator* pAllocator;  /* Allocator every array came from (NULL for malloc()). */
+
+	char*   strings;  /* Copy of every key, each one null terminated. */
+	size_t* offsets;  /* Offset of each key in the string copy. */
+
+	micro_ini_keyset_class classes[MICRO_INI_KEYSET_CLASS_COUNT];
+};
+
+/**
+ * @brief   Copy a key into a zero padded probe (internal use only).
+ * @return  Length of the key.
+ *
+ * @param[out] pProbe  Receives the first MICRO_INI_KEYSET_PROBE_SIZE bytes of the key, zero padded.
+ * @param[in]  key     Key to copy.
+ */
+static size_t prv_micro_ini_keyset_probe(unsigned char* const pProbe, const char* const key)
+{
+	size_t len = 0;
+
+	memset(pProbe, 0, MICRO_INI_KEYSET_PROBE_SIZE);
+
+	for(; len < MICRO_INI_KEYSET_PROBE_SIZE && key[len] != '\0'; ++len)
+	{
+		pProbe[len] = (unsigned char) key[len];
+	}
+
+	if(len == MICRO_INI_KEYSET_PROBE_SIZE)
+	{
+		len += strlen(key + len);
+	}
+
+	return len;
+}
+
+/**
+ * @brief   Get the lane class of a key (internal use only).
+ * @return  Index of the class.
+ *
+ * @param[in]  len  Length of the key.
+ */
+static size_t prv_micro_ini_keyset_class_index(const size_t len)
+{
+	return (len <= 16) ? 0 : (len <= 32) ? 1 : 2;
+}
+
+/**
+ * @brief   Hash a probe (internal use only).
+ * @return  Hash of the key length and its first 16 bytes.
+ *
+ * @param[in]  pProbe  Zero padded probe.
+ * @param[in]  len     Length of the key.
+ *
+ * Hashing the leading bytes rather than only the first character keeps buckets short
+ * for key sets that share a common prefix, such as numbered keys.
+ */
+static uint32_t prv_micro_ini_keyset_hash(const unsigned char* const pProbe, const size_t len)
+{
+	uint32_t hash = (uint32_t) len * 0x9E3779B1u;
+	size_t index = 0;
+
+	for(; index < 16; index += 4)
+	{
+		const uint32_t word =
+			((uint32_t) pProbe[index]) |
+			((uint32_t) pProbe[index + 1] << 8) |
+			((uint32_t) pProbe[index + 2] << 16) |
+			((uint32_t) pProbe[index + 3] << 24);
+
+		hash = (hash ^ word) * 0x85EBCA6Bu;
+		hash ^= hash >> 13;
+	}
+
+	return hash;
+}
+
+/**
+ * @brief   Search the bucket of a probe (internal use only).
+ * @return  Index of the matching key, or MICRO_INI_KEYSET_NPOS.
+ *
+ * @param[in]  pKeySet  Key set to search.
+ * @param[in]  pClass   Lane class of the key.
+ * @param[in]  pProbe   Zero padded probe of the key.
+ * @param[in]  key      Key being searched for.
+ * @param[in]  len      Length of the key.
+ */
+static size_t prv_micro_ini_keyset_search(
+	const micro_ini_keyset* const pKeySet,
+	const micro_ini_keyset_class* const pClass,
+	const unsigned char* const pProbe,
+	const char* const key,
+	const size_t len)
+{
+	const uint32_t bucket = prv_micro_ini_keyset_hash(pProbe, len) & pClass->mask;
+	const uint32_t end = pClass->starts[bucket + 1];
+	uint32_t entry = pClass->starts[bucket];
+
+	/* Keys can't contain a null byte, so comparing the zero padded lanes is exact and also compares the lengths. */
+	if(pClass->width == 16)
+	{
+#if defined(MICRO_INI_KEYSET_SSE2)
+		const __m128i probe = _mm_loadu_si128((const __m128i*) pProbe);
+
+		for(; entry < end; ++entry)
+		{
+			const __m128i lane = _mm_load_si128((const __m128i*) (pClass->lanes + (size_t) entry * 16));
+
+			if(_mm_movemask_epi8(_mm_cmpeq_epi8(probe, lane)) == 0xFFFF)
+			{
+				return pClass->ids[entry];
+			}
+		}
+#else
+		for(; entry < end; ++entry)
+		{
+			if(memcmp(pProbe, pClass->lanes + (size_t) entry * 16, 16) == 0)
+			{
+				return pClass->ids[entry];
+			}
+		}
+#endif
+	}
+	else if(pClass->width == 32)
+	{
+#if defined(MICRO_INI_KEYSET_AVX2)
+		const __m256i probe = _mm256_loadu_si256((const __m256i*) pProbe);
+
+		for(; entry < end; ++entry)
+		{
+			const __m256i lane = _mm256_load_si256((const __m256i*) (pClass->lanes + (size_t) entry * 32));
+
+			if(_mm256_movemask_epi8(_mm256_cmpeq_epi8(probe, lane)) == -1)
+			{
+				return pClass->ids[entry];
+			}
+		}
+#elif defined(MICRO_INI_KEYSET_SSE2)
+		const __m128i probeLow = _mm_loadu_si128((const __m128i*) pProbe);
+		const __m128i probeHigh = _mm_loadu_si128((const __m128i*) (pProbe + 16));
+
+		for(; entry < end; ++entry)
+		{
+			const unsigned char* const pLane = pClass->lanes + (size_t) entry * 32;
+			const __m128i low = _mm_cmpeq_epi8(probeLow, _mm_load_si128((const __m128i*) pLane));
+			const __m128i high = _mm_cmpeq_epi8(probeHigh, _mm_load_si128((const __m128i*) (pLane + 16)));
+
+			if(_mm_movemask_epi8(_mm_and_si128(low, high)) == 0xFFFF)
+			{
+				return pClass->ids[entry];
+			}
+		}
+#else
+		for(; entry < end; ++entry)
+		{
+			if(memcmp(pProbe, pClass->lanes + (size_t) entry * 32, 32) == 0)
+			{
+				return pClass->ids[entry];
+			}
+		}
+#endif
+	}
+	else
+	{
+		for(; entry < end; ++entry)
+		{
+			if(strcmp(key, pKeySet->strings + pKeySet->offsets[pClass->ids[entry]]) == 0)
+			{
+				return pClass->ids[entry];
+			}
+		}
+	}
+
+	return MICRO_INI_KEYSET_NPOS;
+}
+
+/**
+ * @brief   Allocate the buckets and lanes of a class (internal use only).
+ * @return  Non-zero if successful.
+ *
+ * @param[in]  pAllocator  Allocator to use.
+ * @param[in]  pClass      Class to allocate.
+ * @param[in]  entryCount  Number of keys in the class.
+ */
+static int prv_micro_ini_keyset_class_alloc(micro_ini_allocator* const pAllocator, micro_ini_keyset_class* const pClass, const size_t entryCount)
+{
+	size_t bucketCount = 1;
+
+	while(bucketCount < entryCount)
+	{
+		bucketCount *= 2;
+	}
+
+	pClass->mask = (uint32_t) (bucketCount - 1);
+	pClass->starts = (uint32_t*) micro_ini_allocator_calloc(pAllocator, bucketCount + 1, sizeof(uint32_t));
+	pClass->ids = (uint32_t*) micro_ini_allocator_alloc(pAllocator, sizeof(uint32_t) * (entryCount ? entryCount : 1));
+
+	if(!pClass->starts || !pClass->ids)
+	{
+		return 0;
+	}
+
+	if(pClass->width > 0)
+	{
+		pClass->pLaneBlock = micro_ini_allocator_calloc(pAllocator, 1, pClass->width * entryCount + MICRO_INI_KEYSET_PROBE_SIZE);
+		if(!pClass->pLaneBlock)
+		{
+			return 0;
+		}
+
+		pClass->lanes = (unsigned char*) pClass->pLaneBlock;
+		pClass->lanes += (MICRO_INI_KEYSET_PROBE_SIZE - ((size_t) pClass->lanes % MICRO_INI_KEYSET_PROBE_SIZE)) % MICRO_INI_KEYSET_PROBE_SIZE;
+	}
+
+	return 1;
+}
+
+
+int micro_ini_keyset_create(
+	micro_ini_keyset** const ppOutKeySet,
+	const char* const* const pKeys,
+	const size_t keyCount,
+	micro_ini_allocator* const pAllocator)
+{
+	unsigned char probe[MICRO_INI_KEYSET_PROBE_SIZE];
+	size_t classCounts[MICRO_INI_KEYSET_CLASS_COUNT];
+
+	micro_ini_keyset* pKeySet = NULL;
+	size_t stringSize = 0;
+	size_t index = 0;
+
+	if(!ppOutKeySet)
+	{
+		return MICRO_INI_ERROR_INVALID_KEYSET;
+	}
+
+	(*ppOutKeySet) = NULL;
+
+	if(!pKeys && keyCount > 0)
+	{
+		return MICRO_INI_ERROR_INVALID_KEYSET;
+	}
+
+	for(index = 0; index < keyCount; ++index)
+	{
+		if(!pKeys[index])
+		{
+			return MICRO_INI_ERROR_INVALID_KEYSET;
+		}
+
+		stringSize += strlen(pKeys[index]) + 1;
+	}
+
+	if(keyCount > (size_t) UINT32_MAX)
+	{
+		return MICRO_INI_ERROR_OUT_OF_MEMORY;
+	}
+
+	pKeySet = (micro_ini_keyset*) micro_ini_allocator_calloc(pAllocator, 1, sizeof(micro_ini_keyset));
+	if(!pKeySet)
+	{
+		return MICRO_INI_ERROR_OUT_OF_MEMORY;
+	}
+
+	pKeySet->count = keyCount;
+	pKeySet->pAllocator = pAllocator;
+	pKeySet->strings = (char*) micro_ini_allocator_alloc(pAllocator, stringSize ? stringSize : 1);
+	pKeySet->offsets = (size_t*) micro_ini_allocator_alloc(pAllocator, sizeof(size_t) * (keyCount ? keyCount : 1));
+
+	if(!pKeySet->strings || !pKeySet->offsets)
+	{
+		micro_ini_keyset_free(pKeySet);
+		return MICRO_INI_ERROR_OUT_OF_MEMORY;
+	}
+
+	pKeySet->classes[0].width = 16;
+	pKeySet->classes[1].width = 32;
+	pKeySet->classes[2].width = 0;
+
+	memset(classCounts, 0, sizeof(classCounts));
+	stringSize = 0;
+
+	/* Copy the keys and count the keys of each class. */
+	for(index = 0; index < keyCount; ++index)
+	{
+		const size_t len = strlen(pKeys[index]);
+
+		memcpy(pKeySet->strings + stringSize, pKeys[index], len + 1);
+		pKeySet->offsets[index] = stringSize;
+		stringSize += len + 1;
+
+		++classCounts[prv_micro_ini_keyset_class_index(len)];
+	}
+
+	for(index = 0; index < MICRO_INI_KEYSET_CLASS_COUNT; ++index)
+	{
+		if(!prv_micro_ini_keyset_class_alloc(pAllocator, &pKeySet->classes[index], classCounts[index]))
+		{
+			micro_ini_keyset_free(pKeySet);
+			return MICRO_INI_ERROR_OUT_OF_MEMORY;
+		}
+	}
+
+	/* Count the entries of each bucket, then turn the counts into the end of each bucket. */
+	for(index = 0; index < keyCount; ++index)
+	{
+		const size_t len = prv_micro_ini_keyset_probe(probe, pKeySet->strings + pKeySet->offsets[index]);
+		micro_ini_keyset_class* const pClass = &pKeySet->classes[prv_micro_ini_keyset_class_index(len)];
+
+		++pClass->starts[prv_micro_ini_keyset_hash(probe, len) & pClass->mask];
+	}
+
+	for(index = 0; index < MICRO_INI_KEYSET_CLASS_COUNT; ++index)
+	{
+		micro_ini_keyset_class* const pClass = &pKeySet->classes[index];
+		uint32_t bucket = 1;
+
+		for(; bucket <= pClass->mask + 1; ++bucket)
+		{
+			pClass->starts[bucket] += pClass->starts[bucket - 1];
+		}
+	}
+
+	/* Place the keys in reverse so each bucket keeps registration order and its end slides back to its start. */
+	for(index = keyCount; index > 0; --index)
+	{
+		const size_t len = prv_micro_ini_keyset_probe(probe, pKeySet->strings + pKeySet->offsets[index - 1]);
+		micro_ini_keyset_class* const pClass = &pKeySet->classes[prv_micro_ini_keyset_class_index(len)];
+		const uint32_t entry = --pClass->starts[prv_micro_ini_keyset_hash(probe, len) & pClass->mask];
+
+		pClass->ids[entry] = (uint32_t) (index - 1);
+
+		if(pClass->width > 0)
+		{
+			memcpy(pClass->lanes + (size_t) entry * pClass->width, probe, pClass->width);
+		}
+	}
+
+	/* A duplicate key is shadowed by the earlier registration, so it can't find itself. */
+	for(index = 0; index < keyCount; ++index)
+	{
+		if(micro_ini_keyset_find(pKeySet, pKeySet->strings + pKeySet->offsets[index]) != index)
+		{
+			micro_ini_keyset_free(pKeySet);
+			return MICRO_INI_ERROR_DUPLICATE_KEY;
+		}
+	}
+
+	(*ppOutKeySet) = pKeySet;
+
+	return MICRO_INI_SUCCESS;
+}
+
+
+void micro_ini_keyset_free(micro_ini_keyset* const pKeySet)
+{
+	size_t index = 0;
+
+	if(!pKeySet)
+	{
+		return;
+	}
+
+	for(; index < MICRO_INI_KEYSET_CLASS_COUNT; ++index)
+	{
+		micro_ini_allocator_free(pKeySet->pAllocator, pKeySet->classes[index].starts);
+		micro_ini_allocator_free(pKeySet->pAllocator, pKeySet->classes[index].ids);
+		micro_ini_allocator_free(pKeySet->pAllocator, pKeySet->classes[index].pLaneBlock);
+	}
+
+	micro_ini_allocator_free(pKeySet->pAllocator, pKeySet->strings);
+	micro_ini_allocator_free(pKeySet->pAllocator, pKeySet->offsets);
+	micro_ini_allocator_free(pKeySet->pAllocator, pKeySet);
+}
+
+
+size_t micro_ini_keyset_find(const micro_ini_keyset* const pKeySet, const char* const key)
+{
+	unsigned char probe[MICRO_INI_KEYSET_PROBE_SIZE];
+	size_t len = 0;
+
+	if(!pKeySet || !key || pKeySet->count == 0)
+	{
+		return MICRO_INI_KEYSET_NPOS;
+	}
+
+	len = prv_micro_ini_keyset_probe(probe, key);
+
+	return prv_micro_ini_keyset_search(pKeySet, &pKeySet->classes[prv_micro_ini_keyset_class_index(len)], probe, key, len);
+}
+
+
+size_t micro_ini_keyset_count(const micro_ini_keyset* const pKeySet)
+{
+	return pKeySet ? pKeySet->count : 0;
+}
+
+
+const char* micro_ini_keyset_key(const micro_ini_keyset* const pKeySet, const size_t keyIndex)
+{
+	if(!pKeySet || keyIndex >= pKeySet->count)
+	{
+		return NULL;
+	}
+
+	return pKeySet->strings + pKeySet->offsets[keyIndex];
+}
+
+
+void micro_ini_keyset_handler(void* const pUserData, const char* const section, const char* const key, const char* const value)
+{
+	const micro_ini_keyset_dispatch* const pDispatch = (const micro_ini_keyset_dispatch*) pUserData;
+	size_t keyIndex = 0;
+
+	if(!pDispatch)
+	{
+		return;
+	}
+
+	keyIndex = micro_ini_keyset_find(pDispatch->pKeySet, key);
+
+	if(keyIndex != MICRO_INI_KEYSET_NPOS)
+	{
+		if(pDispatch->matchCallback)
+		{
+			pDispatch->matchCallback(pDispatch->pUserData, keyIndex, section, key, value);
+		}
+	}
+	else if(pDispatch->otherCallback)
+	{
+		pDispatch->otherCallback(pDispatch->pUserData, section, key, value);
+	}
+}
@@ -0,0 +1,140 @@
+/**
+ * Copyright (c) 2021, Zoe J. Bare
+ *
+ * MIT License
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ */
+
+#pragma once
+
+#include "micro_ini.h"
+#include "micro_ini_alloc.h"
+
+#include <stddef.h>
+
+/* Returned by micro_ini_keyset_find() when a key is not in the set. */
+#define MICRO_INI_KEYSET_NPOS ((size_t) -1)
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * Immutable set of keys registered up front, used to match parsed keys without
+ * string comparisons.  This is an optional module layered on top of the callback
+ * parser; unlike the parser, it allocates memory.
+ *
+ * Keys of up to 16 bytes are stored zero padded in 16 byte lanes and keys of up to
+ * 32 bytes in 32 byte lanes, grouped into buckets by their length and leading bytes.
+ * Matching a key copies it once into a padded probe, after which each candidate in
+ * its bucket costs a single vector compare (SSE2 and AVX2 when the compiler targets
+ * them, with a portable fallback otherwise).  Longer keys fall back to strcmp().
+ *
+ * Define MICRO_INI_KEYSET_NO_SIMD to always use the portable fallback.
+ */
+typedef struct micro_ini_keyset micro_ini_keyset;
+
+/* Handling function for pairs whose key is in a key set. */
+typedef void (*micro_ini_keyset_fn)(void* pUserData, size_t keyIndex, const char* section, const char* key, const char* value);
+
+/**
+ * Routing for micro_ini_keyset_handler().  Pass a pointer to this structure as the
+ * user data of any of the load functions.
+ */
+typedef struct micro_ini_keyset_dispatch
+{
+	const micro_ini_keyset* pKeySet;
+
+	micro_ini_keyset_fn  matchCallback;  /* Called with the index of the key for pairs whose key is in the set. */
+	micro_ini_handler_fn otherCallback;  /* Called for every other pair (optional, may be NULL). */
+
+	void* pUserData;  /* Pointer to user data that is passed to both callbacks. */
+} micro_ini_keyset_dispatch;
+
+/**
+ * @brief   Build a key set.
+ * @return  MICRO_INI_SUCCESS or an error code.
+ *
+ * @param[out] ppOutKeySet  Receives the new key set (set to NULL when an error code is returned).
+ * @param[in]  pKeys        Keys to register; each key is identified by its index in this array.
+ * @param[in]  keyCount     Number of keys.
+ * @param[in]  pAllocator   Allocator for the key set's memory (NULL for malloc()).
+ *
+ * The keys are copied, so the array does not need to outlive the key set.  Registering
+ * the same key twice returns MICRO_INI_ERROR_DUPLICATE_KEY.  The key set must be
+ * released with micro_ini_keyset_free().
+ */
+MICRO_INI_API int micro_ini_keyset_create(
+	micro_ini_keyset** const ppOutKeySet,
+	const char* const* const pKeys,
+	const size_t keyCount,
+	micro_ini_allocator* const pAllocator
+);
+
+/**
+ * @brief  Release a key set.
+ *
+ * @param[in]  pKeySet  Key set to release (may be NULL).
+ */
+MICRO_INI_API void micro_ini_keyset_free(micro_ini_keyset* const pKeySet);
+
+/**
+ * @brief   Look up a key.
+ * @return  Index the key was registered with, or MICRO_INI_KEYSET_NPOS when it is not in the set.
+ *
+ * @param[in]  pKeySet  Key set to search.
+ * @param[in]  key      Key to look up.
+ */
+MICRO_INI_API size_t micro_ini_keyset_find(const micro_ini_keyset* const pKeySet, const char* const key);
+
+/**
+ * @brief   Get the number of keys in a key set.
+ * @return  Number of keys.
+ *
+ * @param[in]  pKeySet  Key set to query.
+ */
+MICRO_INI_API size_t micro_ini_keyset_count(const micro_ini_keyset* const pKeySet);
+
+/**
+ * @brief   Get a registered key.
+ * @return  Key registered at the index, or NULL if the index is out of range.
+ *
+ * @param[in]  pKeySet   Key set to query.
+ * @param[in]  keyIndex  Index of the key.
+ */
+MICRO_INI_API const char* micro_ini_keyset_key(const micro_ini_keyset* const pKeySet, const size_t keyIndex);
+
+/**
+ * @brief  Key/value handler that routes pairs through a key set.
+ *
+ * @param[in]  pUserData  Pointer to a micro_ini_keyset_dispatch.
+ * @param[in]  section    Section of the pair.
+ * @param[in]  key        Key of the pair.
+ * @param[in]  value      Value of the pair.
+ *
+ * This conforms to micro_ini_handler_fn so it can be passed straight to any of the
+ * load functions, replacing a chain of strcmp() calls in a user handler with a
+ * single lookup followed by a switch on the key index.
+ */
+MICRO_INI_API void micro_ini_keyset_handler(void* const pUserData, const char* const section, const char* const key, const char* const value);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,482 @@
+/**
+ * Copyright (c) 2021, Zoe J. Bare
+ *
+ * MIT License
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ */
+
+#if !defined(_WIN32) && !defined(_POSIX_C_SOURCE) && !defined(_GNU_SOURCE)
+	/* Expose clock_gettime() even when compiling in strict ANSI mode. */
+	#define _POSIX_C_SOURCE 200112L
+#endif
+
+#include "micro_ini_metrics.h"
+
+#include <string.h>
+
+#if defined(_WIN32)
+	#include <windows.h>
+#else
+	#include <time.h>
+#endif
+
+#if defined(__GNUC__) || defined(__clang__)
+	#define MICRO_INI_METRICS_ADD(pCounter, value)  __atomic_fetch_add((pCounter), (value), __ATOMIC_RELAXED)
+	#define MICRO_INI_METRICS_LOAD(pCounter)        __atomic_load_n((pCounter), __ATOMIC_RELAXED)
+	#define MICRO_INI_METRICS_ATTACH(ppMetrics, p)  __atomic_store_n((ppMetrics), (p), __ATOMIC_RELEASE)
+	#define MICRO_INI_METRICS_ATTACHED(ppMetrics)   __atomic_load_n((ppMetrics), __ATOMIC_ACQUIRE)
+	#define MICRO_INI_THREAD_LOCAL __thread
+
+#elif defined(_MSC_VER) && defined(_M_X64)
+	#include <intrin.h>
+
+	/* Aligned 64-bit accesses are atomic on x64, and volatile accesses have acquire and release semantics. */
+	#define MICRO_INI_METRICS_ADD(pCounter, value)  _InterlockedExchangeAdd64((volatile __int64*) (pCounter), (__int64) (value))
+	#define MICRO_INI_METRICS_LOAD(pCounter)        (*(volatile const uint64_t*) (pCounter))
+	#define MICRO_INI_METRICS_ATTACH(ppMetrics, p)  (*(micro_ini_metrics* volatile*) (ppMetrics) = (p))
+	#define MICRO_INI_METRICS_ATTACHED(ppMetrics)   (*(micro_ini_metrics* volatile*) (ppMetrics))
+	#define MICRO_INI_THREAD_LOCAL __declspec(thread)
+
+#else
+	/* Without a known way to add atomically, recording is not thread safe. */
+	#define MICRO_INI_METRICS_ADD(pCounter, value)  (*(pCounter) += (value))
+	#define MICRO_INI_METRICS_LOAD(pCounter)        (*(pCounter))
+	#define MICRO_INI_METRICS_ATTACH(ppMetrics, p)  (*(ppMetrics) = (p))
+	#define MICRO_INI_METRICS_ATTACHED(ppMetrics)   (*(ppMetrics))
+#endif
+
+/**
+ * Metrics the load functions record into, or NULL.
+ */
+static micro_ini_metrics* prv_micro_ini_metrics_attached = NULL;
+
+#if defined(MICRO_INI_THREAD_LOCAL)
+/**
+ * Shard of the calling thread plus one, or zero before the thread's first recording.
+ */
+static MICRO_INI_THREAD_LOCAL unsigned prv_micro_ini_metrics_thread_shard = 0;
+
+/**
+ * Number of threads given a shard so far, used to hand shards out in turn.
+ */
+static unsigned prv_micro_ini_metrics_next_shard = 0;
+#endif
+
+/**
+ * @brief   Find the shard of the calling thread (internal use only).
+ * @return  Shard index.
+ */
+static unsigned prv_micro_ini_metrics_shard(void)
+{
+#if defined(MICRO_INI_THREAD_LOCAL)
+	if(prv_micro_ini_metrics_thread_shard == 0)
+	{
+	#if defined(_MSC_VER)
+		prv_micro_ini_metrics_thread_shard = (unsigned) _InterlockedIncrement((volatile long*) &prv_micro_ini_metrics_next_shard);
+	#else
+		prv_micro_ini_metrics_thread_shard = __atomic_add_fetch(&prv_micro_ini_metrics_next_shard, 1, __ATOMIC_RELAXED);
+	#endif
+		prv_micro_ini_metrics_thread_shard = (prv_micro_ini_metrics_thread_shard - 1) % MICRO_INI_METRICS_SHARDS + 1;
+	}
+
+	return prv_micro_ini_metrics_thread_shard - 1;
+#else
+	/* Each thread has its own stack, so the address of a local tells threads apart. */
+	int local;
+
+	return (unsigned) (((size_t) &local >> 12) % MICRO_INI_METRICS_SHARDS);
+#endif
+}
+
+/**
+ * @brief   Find the bucket of a sample (internal use only).
+ * @return  Bucket index, or MICRO_INI_HISTOGRAM_BUCKETS for an overflow sample.
+ */
+static size_t prv_micro_ini_histogram_bucket(const uint64_t value)
+{
+	unsigned exponent = 0;
+
+	if(value < MICRO_INI_HISTOGRAM_SUB_BUCKETS)
+	{
+		return (size_t) value;
+	}
+
+	while(exponent < 63 && (value >> (exponent + 1)) != 0)
+	{
+		++exponent;
+	}
+
+	if(exponent > MICRO_INI_HISTOGRAM_MAX_EXPONENT)
+	{
+		return MICRO_INI_HISTOGRAM_BUCKETS;
+	}
+
+	/* The three bits below the leading one select the sub-bucket. */
+	return (size_t) (exponent - 2) * MICRO_INI_HISTOGRAM_SUB_BUCKETS + (size_t) ((value >> (exponent - 3)) & (MICRO_INI_HISTOGRAM_SUB_BUCKETS - 1));
+}
+
+/**
+ * @brief   Get the largest sample that falls in a bucket (internal use only).
+ * @return  Inclusive upper bound of the bucket.
+ */
+static uint64_t prv_micro_ini_histogram_upper_bound(const size_t bucket)
+{
+	unsigned exponent;
+	uint64_t lower;
+
+	if(bucket < MICRO_INI_HISTOGRAM_SUB_BUCKETS)
+	{
+		return (uint64_t) bucket;
+	}
+
+	exponent = (unsigned) (bucket / MICRO_INI_HISTOGRAM_SUB_BUCKETS) + 2;
+	lower = (uint64_t) (MICRO_INI_HISTOGRAM_SUB_BUCKETS + bucket % MICRO_INI_HISTOGRAM_SUB_BUCKETS) << (exponent - 3);
+
+	return lower + ((uint64_t) 1 << (exponent - 3)) - 1;
+}
+
+/**
+ * @brief  Add a sample to a histogram (internal use only).
+ */
+static void prv_micro_ini_histogram_record(micro_ini_histogram* const pHistogram, const uint64_t value)
+{
+	const size_t bucket = prv_micro_ini_histogram_bucket(value);
+
+	MICRO_INI_METRICS_ADD(&pHistogram->count, 1);
+	MICRO_INI_METRICS_ADD(&pHistogram->sum, value);
+	MICRO_INI_METRICS_ADD((bucket < MICRO_INI_HISTOGRAM_BUCKETS) ? &pHistogram->buckets[bucket] : &pHistogram->overflow, 1);
+}
+
+/**
+ * @brief  Add the samples of one histogram to another (internal use only).
+ */
+static void prv_micro_ini_histogram_merge(micro_ini_histogram* const pTotal, const micro_ini_histogram* const pHistogram)
+{
+	size_t i;
+
+	pTotal->count += MICRO_INI_METRICS_LOAD(&pHistogram->count);
+	pTotal->sum += MICRO_INI_METRICS_LOAD(&pHistogram->sum);
+	pTotal->overflow += MICRO_INI_METRICS_LOAD(&pHistogram->overflow);
+
+	for(i = 0; i < MICRO_INI_HISTOGRAM_BUCKETS; ++i)
+	{
+		pTotal->buckets[i] += MICRO_INI_METRICS_LOAD(&pHistogram->buckets[i]);
+	}
+}
+
+/**
+ * Output of an export in progress (internal use only).
+ */
+typedef struct micro_ini_metrics_writer
+{
+	char*  pBuffer;
+	size_t bufferSize;
+	size_t length;  /* Length of the complete text so far, which may exceed the buffer. */
+
+	FILE* pFile;  /* File written to instead of the buffer, or NULL. */
+	int   failed; /* Non-zero once a write to the file has failed. */
+} micro_ini_metrics_writer;
+
+/**
+ * @brief  Append a string to an export, truncating it to fit the buffer (internal use only).
+ */
+static void prv_micro_ini_metrics_write(micro_ini_metrics_writer* const pWriter, const char* const str)
+{
+	const size_t length = strlen(str);
+	size_t room;
+
+	if(pWriter->pFile)
+	{
+		if(!pWriter->failed && fwrite(str, 1, length, pWriter->pFile) != length)
+		{
+			pWriter->failed = 1;
+		}
+	}
+	else if(pWriter->pBuffer && pWriter->length + 1 < pWriter->bufferSize)
+	{
+		room = pWriter->bufferSize - 1 - pWriter->length;
+		memcpy(pWriter->pBuffer + pWriter->length, str, (length < room) ? length : room);
+	}
+
+	pWriter->length += length;
+}
+
+/**
+ * @brief  Append one histogram to an export (internal use only).
+ *
+ * @param[in]  pWriter     Export in progress.
+ * @param[in]  prefix      Prefix of the metric name.
+ * @param[in]  name        Name of the metric.
+ * @param[in]  help        Description of the metric.
+ * @param[in]  pHistogram  Merged histogram.
+ * @param[in]  scale       Divisor converting samples to the unit of the metric.
+ *
+ * A bucket is written at every power of two, for samples up to 2^k - 1, which always
+ * falls on a boundary of the log-linear buckets.  Overflow samples have no finite bound,
+ * so only the "+Inf" bucket, which holds every sample, counts them.
+ */
+static void prv_micro_ini_metrics_write_histogram(
+	micro_ini_metrics_writer* const pWriter,
+	const char* const prefix,
+	const char* const name,
+	const char* const help,
+	const micro_ini_histogram* const pHistogram,
+	const double scale
+)
+{
+	char line[512];
+	uint64_t cumulative = 0;
+	size_t bucket = 0;
+	size_t end;
+	unsigned k;
+
+	sprintf(line, "# HELP %.64s_%s %s\n# TYPE %.64s_%s histogram\n", prefix, name, help, prefix, name);
+	prv_micro_ini_metrics_write(pWriter, line);
+
+	for(k = 0; k <= MICRO_INI_HISTOGRAM_MAX_EXPONENT + 1; ++k)
+	{
+		/* Index of the first bucket of samples of 2^k or more. */
+		end = (k <= 3) ? ((size_t) 1 << k) : (size_t) (k - 2) * MICRO_INI_HISTOGRAM_SUB_BUCKETS;
+
+		for(; bucket < end; ++bucket)
+		{
+			cumulative += pHistogram->buckets[bucket];
+		}
+
+		sprintf(line, "%.64s_%s_bucket{le=\"%.9g\"} %lu\n", prefix, name, (double) (((uint64_t) 1 << k) - 1) / scale, (unsigned long) cumulative);
+		prv_micro_ini_metrics_write(pWriter, line);
+	}
+
+	sprintf(line, "%.64s_%s_bucket{le=\"+Inf\"} %lu\n", prefix, name, (unsigned long) pHistogram->count);
+	prv_micro_ini_metrics_write(pWriter, line);
+
+	sprintf(line, "%.64s_%s_sum %.9g\n%.64s_%s_count %lu\n",
+		prefix, name, (double) pHistogram->sum / scale,
+		prefix, name, (unsigned long) pHistogram->count);
+	prv_micro_ini_metrics_write(pWriter, line);
+}
+
+
+void micro_ini_metrics_reset(micro_ini_metrics* const pMetrics)
+{
+	if(pMetrics)
+	{
+		memset(pMetrics, 0, sizeof(micro_ini_metrics));
+	}
+}
+
+
+void micro_ini_metrics_attach(micro_ini_metrics* const pMetrics)
+{
+	MICRO_INI_METRICS_ATTACH(&prv_micro_ini_metrics_attached, pMetrics);
+}
+
+
+uint64_t micro_ini_metrics_clock(void)
+{
+#if defined(_WIN32)
+	LARGE_INTEGER counter;
+	LARGE_INTEGER frequency;
+
+	QueryPerformanceCounter(&counter);
+	QueryPerformanceFrequency(&frequency);
+
+	/* Split the conversion so the multiplication cannot overflow. */
+	return (uint64_t) (counter.QuadPart / frequency.QuadPart) * 1000000000u
+		+ (uint64_t) (counter.QuadPart % frequency.QuadPart) * 1000000000u / (uint64_t) frequency.QuadPart;
+#else
+	struct timespec now;
+
+	clock_gettime(CLOCK_MONOTONIC, &now);
+
+	return (uint64_t) now.tv_sec * 1000000000u + (uint64_t) now.tv_nsec;
+#endif
+}
+
+
+void micro_ini_metrics_record(
+	micro_ini_metrics* const pMetrics,
+	const uint64_t nanoseconds,
+	const uint64_t bytes,
+	const int result
+)
+{
+	micro_ini_metrics_shard* pShard;
+
+	if(!pMetrics)
+	{
+		return;
+	}
+
+	pShard = &pMetrics->shards[prv_micro_ini_metrics_shard()];
+
+	if(result < 0)
+	{
+		MICRO_INI_METRICS_ADD(&pShard->failures, 1);
+	}
+
+	prv_micro_ini_histogram_record(&pShard->duration, nanoseconds);
+	prv_micro_ini_histogram_record(&pShard->bytes, bytes);
+	prv_micro_ini_histogram_record(&pShard->errors, (result > 0) ? (uint64_t) result : 0);
+}
+
+
+int micro_ini_metrics_observe(const uint64_t start, const uint64_t bytes, const int result)
+{
+	micro_ini_metrics* const pMetrics = MICRO_INI_METRICS_ATTACHED(&prv_micro_ini_metrics_attached);
+
+	if(pMetrics)
+	{
+		micro_ini_metrics_record(pMetrics, micro_ini_metrics_clock() - start, bytes, result);
+	}
+
+	return result;
+}
+
+
+void micro_ini_metrics_merge(const micro_ini_metrics* const pMetrics, micro_ini_metrics_shard* const pOutTotal)
+{
+	size_t i;
+
+	if(!pOutTotal)
+	{
+		return;
+	}
+
+	memset(pOutTotal, 0, sizeof(micro_ini_metrics_shard));
+
+	for(i = 0; pMetrics && i < MICRO_INI_METRICS_SHARDS; ++i)
+	{
+		pOutTotal->failures += MICRO_INI_METRICS_LOAD(&pMetrics->shards[i].failures);
+
+		prv_micro_ini_histogram_merge(&pOutTotal->duration, &pMetrics->shards[i].duration);
+		prv_micro_ini_histogram_merge(&pOutTotal->bytes, &pMetrics->shards[i].bytes);
+		prv_micro_ini_histogram_merge(&pOutTotal->errors, &pMetrics->shards[i].errors);
+	}
+}
+
+
+uint64_t micro_ini_histogram_quantile(const micro_ini_histogram* const pHistogram, const double quantile)
+{
+	uint64_t total = 0;
+	uint64_t seen = 0;
+	uint64_t rank;
+	size_t i;
+
+	if(!pHistogram)
+	{
+		return 0;
+	}
+
+	/* The count is summed from the buckets, which may be ahead of the count while recording is in progress. */
+	for(i = 0; i < MICRO_INI_HISTOGRAM_BUCKETS; ++i)
+	{
+		total += pHistogram->buckets[i];
+	}
+
+	total += pHistogram->overflow;
+
+	if(total == 0)
+	{
+		return 0;
+	}
+
+	rank = (quantile <= 0.0) ? 1 : (quantile >= 1.0) ? total : (uint64_t) (quantile * (double) total + 0.5);
+	if(rank == 0)
+	{
+		rank = 1;
+	}
+
+	for(i = 0; i < MICRO_INI_HISTOGRAM_BUCKETS; ++i)
+	{
+		seen += pHistogram->buckets[i];
+		if(seen >= rank)
+		{
+			return prv_micro_ini_histogram_upper_bound(i);
+		}
+	}
+
+	/* The rank lies past every finite bucket, among the overflow samples. */
+	return MICRO_INI_HISTOGRAM_OVERFLOW;
+}
+
+
+/**
+ * @brief  Write every metric to an export (internal use only).
+ */
+static void prv_micro_ini_metrics_write_all(micro_ini_metrics_writer* const pWriter, const micro_ini_metrics* const pMetrics, const char* const prefix)
+{
+	micro_ini_metrics_shard total;
+	const char* const name = prefix ? prefix : "microini";
+	char line[512];
+
+	micro_ini_metrics_merge(pMetrics, &total);
+
+	sprintf(line, "# HELP %.64s_load_failures_total Loads that returned an error code.\n# TYPE %.64s_load_failures_total counter\n%.64s_load_failures_total %lu\n",
+		name, name, name, (unsigned long) total.failures);
+	prv_micro_ini_metrics_write(pWriter, line);
+
+	prv_micro_ini_metrics_write_histogram(pWriter, name, "load_duration_seconds", "Time taken by each load.", &total.duration, 1e9);
+	prv_micro_ini_metrics_write_histogram(pWriter, name, "load_bytes", "Bytes read by each load.", &total.bytes, 1.0);
+	prv_micro_ini_metrics_write_histogram(pWriter, name, "load_errors", "Parsing errors reported by each load.", &total.errors, 1.0);
+}
+
+
+size_t micro_ini_metrics_export(
+	const micro_ini_metrics* const pMetrics,
+	const char* const prefix,
+	char* const pOutBuffer,
+	const size_t bufferSize
+)
+{
+	micro_ini_metrics_writer writer;
+
+	memset(&writer, 0, sizeof(writer));
+	writer.pBuffer = pOutBuffer;
+	writer.bufferSize = bufferSize;
+
+	prv_micro_ini_metrics_write_all(&writer, pMetrics, prefix);
+
+	if(pOutBuffer && bufferSize > 0)
+	{
+		pOutBuffer[(writer.length < bufferSize) ? writer.length : bufferSize - 1] = '\0';
+	}
+
+	return writer.length;
+}
+
+
+int micro_ini_metrics_export_file(const micro_ini_metrics* const pMetrics, const char* const prefix, FILE* const pFile)
+{
+	micro_ini_metrics_writer writer;
+
+	if(!pFile)
+	{
+		return MICRO_INI_ERROR_INVALID_FILE_OBJECT;
+	}
+
+	/* Each line goes straight to the file, so nothing is allocated. */
+	memset(&writer, 0, sizeof(writer));
+	writer.pFile = pFile;
+
+	prv_micro_ini_metrics_write_all(&writer, pMetrics, prefix);
+
+	return writer.failed ? MICRO_INI_ERROR_WRITE_FAILED : MICRO_INI_SUCCESS;
+}
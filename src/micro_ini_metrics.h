@@ -0,0 +1,210 @@
+/**
+ * Copyright (c) 2021, Zoe J. Bare
+ *
+ * MIT License
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ */
+
+#pragma once
+
+#include "micro_ini.h"
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+
+/**
+ * Number of shards each metric is spread over.  Threads record into their own shard,
+ * so recording never contends on a cache line with other threads; shards are only
+ * merged when the metrics are read.
+ */
+#ifndef MICRO_INI_METRICS_SHARDS
+	#define MICRO_INI_METRICS_SHARDS 8
+#endif
+
+/**
+ * Number of linear sub-buckets each power of two is split into.  With 8, every bucket
+ * spans at most 12.5% of its lower bound.
+ */
+#define MICRO_INI_HISTOGRAM_SUB_BUCKETS 8
+
+/**
+ * Largest power of two tracked exactly; values of 2^(MICRO_INI_HISTOGRAM_MAX_EXPONENT + 1)
+ * or more are only counted as overflow.  2^48 nanoseconds is a little over three days.
+ */
+#define MICRO_INI_HISTOGRAM_MAX_EXPONENT 47
+
+/**
+ * Quantile reported for samples counted as overflow, which have no upper bound.
+ */
+#define MICRO_INI_HISTOGRAM_OVERFLOW ((uint64_t) -1)
+
+/**
+ * Number of buckets in a histogram: values below MICRO_INI_HISTOGRAM_SUB_BUCKETS each
+ * get their own bucket, followed by MICRO_INI_HISTOGRAM_SUB_BUCKETS buckets for every
+ * power of two up to MICRO_INI_HISTOGRAM_MAX_EXPONENT.
+ */
+#define MICRO_INI_HISTOGRAM_BUCKETS ((MICRO_INI_HISTOGRAM_MAX_EXPONENT - 1) * MICRO_INI_HISTOGRAM_SUB_BUCKETS)
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * Log-linear histogram of unsigned integer samples, in the style of HDR histograms.
+ */
+typedef struct micro_ini_histogram
+{
+	uint64_t count;     /* Number of samples. */
+	uint64_t sum;       /* Sum of every sample. */
+	uint64_t overflow;  /* Samples too large for the last bucket. */
+	uint64_t buckets[MICRO_INI_HISTOGRAM_BUCKETS];
+} micro_ini_histogram;
+
+/**
+ * Metrics of the loads recorded into one shard, or of every shard once merged.
+ */
+typedef struct micro_ini_metrics_shard
+{
+	uint64_t failures;  /* Loads that returned an error code. */
+
+	micro_ini_histogram duration;  /* Time taken by each load, in nanoseconds. */
+	micro_ini_histogram bytes;     /* Bytes read by each load. */
+	micro_ini_histogram errors;    /* Parsing errors reported by each load. */
+} micro_ini_metrics_shard;
+
+/**
+ * Load metrics owned by the caller.  This is an optional module; it is only fed by the
+ * parser when MicroIni is built with MICRO_INI_ENABLE_METRICS defined, in which case
+ * micro_ini_load() and the micro_ini_load_file(), _stream(), _fd() and _buffer()
+ * variants record every call into the metrics given to micro_ini_metrics_attach().
+ *
+ * Recording only performs relaxed atomic additions on the calling thread's shard, so
+ * it is lock-free and safe from any number of threads.  Without atomic operations
+ * (compilers other than GCC, Clang and MSVC) recording is not thread safe.
+ */
+typedef struct micro_ini_metrics
+{
+	micro_ini_metrics_shard shards[MICRO_INI_METRICS_SHARDS];
+} micro_ini_metrics;
+
+/**
+ * @brief  Clear a set of metrics.
+ *
+ * @param[in]  pMetrics  Metrics to clear (must not be recorded into at the same time).
+ */
+MICRO_INI_API void micro_ini_metrics_reset(micro_ini_metrics* const pMetrics);
+
+/**
+ * @brief  Set the metrics the load functions record into.
+ *
+ * @param[in]  pMetrics  Metrics to record into, or NULL to stop recording.
+ *
+ * The metrics are shared by every thread of the process and must stay valid until
+ * they are detached and every load in progress has finished.
+ */
+MICRO_INI_API void micro_ini_metrics_attach(micro_ini_metrics* const pMetrics);
+
+/**
+ * @brief   Read the monotonic clock used to time loads.
+ * @return  Current time in nanoseconds from an arbitrary starting point.
+ */
+MICRO_INI_API uint64_t micro_ini_metrics_clock(void);
+
+/**
+ * @brief  Record one load.
+ *
+ * @param[in]  pMetrics     Metrics to record into.
+ * @param[in]  nanoseconds  Time taken by the load.
+ * @param[in]  bytes        Bytes read by the load.
+ * @param[in]  result       Result of the load: an error code or the number of parsing errors.
+ *
+ * The load functions call this themselves; it is public so that loads made through
+ * other paths, such as the document module, can be recorded too.
+ */
+MICRO_INI_API void micro_ini_metrics_record(
+	micro_ini_metrics* const pMetrics,
+	const uint64_t nanoseconds,
+	const uint64_t bytes,
+	const int result
+);
+
+/**
+ * @brief   Record a finished load into the attached metrics (used by the load functions).
+ * @return  The result, unchanged.
+ *
+ * @param[in]  start   Value of micro_ini_metrics_clock() when the load started.
+ * @param[in]  bytes   Bytes read by the load.
+ * @param[in]  result  Result of the load.
+ */
+MICRO_INI_API int micro_ini_metrics_observe(const uint64_t start, const uint64_t bytes, const int result);
+
+/**
+ * @brief  Merge every shard of a set of metrics.
+ *
+ * @param[in]  pMetrics   Metrics to read (may be recorded into at the same time).
+ * @param[out] pOutTotal  Receives the merged metrics.
+ */
+MICRO_INI_API void micro_ini_metrics_merge(const micro_ini_metrics* const pMetrics, micro_ini_metrics_shard* const pOutTotal);
+
+/**
+ * @brief   Estimate a quantile of a histogram.
+ * @return  Upper bound of the bucket holding the quantile, MICRO_INI_HISTOGRAM_OVERFLOW
+ *          when it falls among the overflow samples, or 0 for an empty histogram.
+ *
+ * @param[in]  pHistogram  Histogram.
+ * @param[in]  quantile    Quantile between 0 and 1 (0.99 for the 99th percentile).
+ */
+MICRO_INI_API uint64_t micro_ini_histogram_quantile(const micro_ini_histogram* const pHistogram, const double quantile);
+
+/**
+ * @brief   Write a set of metrics in the Prometheus text exposition format.
+ * @return  Length of the complete text, not including the terminating null.
+ *
+ * @param[in]  pMetrics    Metrics to export.
+ * @param[in]  prefix      Prefix of every metric name (NULL for "microini").
+ * @param[out] pOutBuffer  Buffer receiving the text (may be NULL to measure it).
+ * @param[in]  bufferSize  Size of the buffer.
+ *
+ * Like snprintf(), the text is truncated to fit and the return value is the size the
+ * complete text needs, so a buffer that was too small can be grown and the call
+ * repeated.  Histograms are exported with a bucket at every power of two; overflow
+ * samples are only counted in the "+Inf" bucket.
+ */
+MICRO_INI_API size_t micro_ini_metrics_export(
+	const micro_ini_metrics* const pMetrics,
+	const char* const prefix,
+	char* const pOutBuffer,
+	const size_t bufferSize
+);
+
+/**
+ * @brief   Write a set of metrics in the Prometheus text exposition format to a file.
+ * @return  MICRO_INI_SUCCESS or an error code.
+ *
+ * @param[in]  pMetrics  Metrics to export.
+ * @param[in]  prefix    Prefix of every metric name (NULL for "microini").
+ * @param[in]  pFile     File to write to.
+ */
+MICRO_INI_API int micro_ini_metrics_export_file(const micro_ini_metrics* const pMetrics, const char* const prefix, FILE* const pFile);
+
+#ifdef __cplusplus
+}
+#endif
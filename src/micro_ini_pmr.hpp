@@ -0,0 +1,253 @@
+/**
+ * Copyright (c) 2021, Zoe J. Bare
+ *
+ * MIT License
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ */
+
+#pragma once
+
+#include "micro_ini.h"
+
+#include <cstring>
+#include <exception>
+#include <memory_resource>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+
+namespace micro_ini
+{
+
+/**
+ * Configuration parsed straight into polymorphic allocator containers.  This is an
+ * optional, header-only C++17 adapter over the callback parser.
+ *
+ * Every section table, key and value is allocated from the memory resource given to
+ * the constructor.  Pairing it with a std::pmr::monotonic_buffer_resource keeps the
+ * whole configuration in one arena, so loading it costs a handful of upstream
+ * allocations and releasing the arena frees all of it at once.  The resource must
+ * outlive the document.
+ */
+class pmr_document
+{
+public:
+
+	using string = std::pmr::string;
+	using section_map = std::pmr::unordered_map<string, string>;
+	using section_table = std::pmr::unordered_map<string, section_map>;
+
+	explicit pmr_document(std::pmr::memory_resource* const pResource = std::pmr::get_default_resource())
+		: m_sections(pResource)
+		, m_currentName(pResource)
+		, m_pCurrent(nullptr)
+	{
+	}
+
+	pmr_document(const pmr_document&) = delete;
+	pmr_document& operator=(const pmr_document&) = delete;
+
+	/**
+	 * @brief   Parse an ini file, adding its pairs to the document.
+	 * @return  Error code or number of parsing errors that occurred.
+	 *
+	 * @param[in]  filePath       Path to the ini file to read.
+	 * @param[in]  flags          Flags for configuring the parser.
+	 * @param[in]  errorCallback  Callback for handling parsing errors (this callback is optional and may be NULL if unneeded).
+	 * @param[in]  pUserData      Pointer to user data that is passed to the error callback.
+	 *
+	 * Later values replace earlier ones with the same section and key.  An exception
+	 * thrown by the memory resource is rethrown once the parser has returned.
+	 */
+	int load(const char* const filePath, const int flags = 0, const micro_ini_error_fn errorCallback = nullptr, void* const pUserData = nullptr)
+	{
+		loader context(*this, errorCallback, pUserData);
+
+		return context.finish(micro_ini_load(filePath, flags, prv_handle, errorCallback ? prv_error : nullptr, &context));
+	}
+
+	/**
+	 * @brief   Parse an ini file from a FILE object, adding its pairs to the document.
+	 * @return  Error code or number of parsing errors that occurred.
+	 *
+	 * @param[in]  pFile          Pointer to an existing FILE object.
+	 * @param[in]  flags          Flags for configuring the parser.
+	 * @param[in]  errorCallback  Callback for handling parsing errors (this callback is optional and may be NULL if unneeded).
+	 * @param[in]  pUserData      Pointer to user data that is passed to the error callback.
+	 */
+	int load_file(FILE* const pFile, const int flags = 0, const micro_ini_error_fn errorCallback = nullptr, void* const pUserData = nullptr)
+	{
+		loader context(*this, errorCallback, pUserData);
+
+		return context.finish(micro_ini_load_file(pFile, flags, prv_handle, errorCallback ? prv_error : nullptr, &context));
+	}
+
+	/**
+	 * @brief   Parse an in-memory ini file, adding its pairs to the document.
+	 * @return  Error code or number of parsing errors that occurred.
+	 *
+	 * @param[in]  data           Contents of the ini file.
+	 * @param[in]  flags          Flags for configuring the parser.
+	 * @param[in]  errorCallback  Callback for handling parsing errors (this callback is optional and may be NULL if unneeded).
+	 * @param[in]  pUserData      Pointer to user data that is passed to the error callback.
+	 */
+	int load_buffer(const std::string_view data, const int flags = 0, const micro_ini_error_fn errorCallback = nullptr, void* const pUserData = nullptr)
+	{
+		loader context(*this, errorCallback, pUserData);
+
+		return context.finish(micro_ini_load_buffer(data.data(), data.size(), flags, prv_handle, errorCallback ? prv_error : nullptr, &context));
+	}
+
+	/**
+	 * @brief   Look up a value.
+	 * @return  The value or nullptr if the section or key does not exist.
+	 *
+	 * @param[in]  section  Name of the section ("" for keys outside of any section).
+	 * @param[in]  key      Name of the key.
+	 *
+	 * The names are copied into a small stack arena for hashing, so lookups of
+	 * reasonably sized names never touch the heap or grow the document's arena.
+	 */
+	const string* get(const std::string_view section, const std::string_view key) const
+	{
+		alignas(std::max_align_t) char scratch[2 * (MICRO_INI_MAX_LINE_LENGTH + 1)];
+		std::pmr::monotonic_buffer_resource lookup(scratch, sizeof(scratch));
+
+		const auto sectionIt = m_sections.find(string(section, &lookup));
+		if(sectionIt == m_sections.end())
+		{
+			return nullptr;
+		}
+
+		const auto keyIt = sectionIt->second.find(string(key, &lookup));
+		if(keyIt == sectionIt->second.end())
+		{
+			return nullptr;
+		}
+
+		return &keyIt->second;
+	}
+
+	/**
+	 * @brief   Access every section of the document.
+	 * @return  Table of sections, each mapping keys to values.
+	 */
+	const section_table& sections() const
+	{
+		return m_sections;
+	}
+
+	/**
+	 * @brief   Get the memory resource the document allocates from.
+	 * @return  Memory resource given to the constructor.
+	 */
+	std::pmr::memory_resource* resource() const
+	{
+		return m_sections.get_allocator().resource();
+	}
+
+private:
+
+	/**
+	 * State of a single load (internal use only).
+	 */
+	struct loader
+	{
+		loader(pmr_document& document, const micro_ini_error_fn errorCallback, void* const pUserData)
+			: document(document)
+			, errorCallback(errorCallback)
+			, pUserData(pUserData)
+		{
+		}
+
+		int finish(const int err)
+		{
+			/* Forget the cached section so a later load starts clean. */
+			document.m_pCurrent = nullptr;
+			document.m_currentName.clear();
+
+			if(exception)
+			{
+				std::rethrow_exception(exception);
+			}
+
+			return err;
+		}
+
+		pmr_document& document;
+		micro_ini_error_fn errorCallback;
+		void* pUserData;
+		std::exception_ptr exception;
+	};
+
+	static void prv_handle(void* const pUserData, const char* const section, const char* const key, const char* const value)
+	{
+		loader& context = *static_cast<loader*>(pUserData);
+		pmr_document& document = context.document;
+
+		if(context.exception)
+		{
+			/* The parser can't be stopped from a callback, so ignore the rest of the file after a failure. */
+			return;
+		}
+
+		if(!key)
+		{
+			/* Parent links from MICRO_INI_FLAG_INHERITANCE are not modelled by this container. */
+			return;
+		}
+
+		/* Exceptions must not unwind through the C parser, so hold on to them until it returns. */
+		try
+		{
+			if(!document.m_pCurrent || document.m_currentName != section)
+			{
+				/* Pairs arrive grouped by section, so only hash the section name when it changes. */
+				document.m_currentName.assign(section);
+				document.m_pCurrent = &document.m_sections[document.m_currentName];
+			}
+
+			section_map& pairs = *document.m_pCurrent;
+			const auto result = pairs.try_emplace(string(key, document.resource()), value);
+
+			if(!result.second)
+			{
+				result.first->second.assign(value);
+			}
+		}
+		catch(...)
+		{
+			context.exception = std::current_exception();
+		}
+	}
+
+	static void prv_error(void* const pUserData, const char* const line, const int lineno)
+	{
+		const loader& context = *static_cast<const loader*>(pUserData);
+
+		context.errorCallback(context.pUserData, line, lineno);
+	}
+
+	section_table m_sections;
+	string m_currentName;
+	section_map* m_pCurrent;
+};
+
+} /* namespace micro_ini */
@@ -0,0 +1,1120 @@
+/**
+ * Copyright (c) 2021, Zoe J. Bare
+ *
+ * MIT License
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ */
+
+#if defined(__linux__) && !defined(_GNU_SOURCE)
+	/* Expose memfd_create() and the file sealing flags. */
+	#define _GNU_SOURCE
+#endif
+
+#include "micro_ini_served.h"
+
+#if defined(__linux__)
+
+#include <errno.h>
+#include <fcntl.h>
+#include <limits.h>
+#include <linux/futex.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/syscall.h>
+#include <sys/un.h>
+#include <time.h>
+#include <unistd.h>
+
+/**
+ * Reply sent for every request (internal use only).  On success the image and control
+ * memfds are attached to it, in that order.
+ */
+typedef struct micro_ini_served_reply
+{
+	int32_t  status;      /* MICRO_INI_SUCCESS or an error code. */
+	uint32_t slot;        /* Index of the file's generation counter in the control memfd. */
+	uint32_t generation;  /* Generation of the attached image. */
+	uint32_t reserved;
+	uint64_t imageSize;
+} micro_ini_served_reply;
+
+/**
+ * Request read in part from a connection, waiting for the rest (internal use only).
+ */
+typedef struct micro_ini_served_pending
+{
+	int      socketFd;
+	uint32_t received;  /* Bytes of the request read so far. */
+	char     data[sizeof(uint32_t) + PATH_MAX];  /* Length of the path followed by the path. */
+} micro_ini_served_pending;
+
+/**
+ * Identity of a version of a file (internal use only).
+ */
+typedef struct micro_ini_served_stamp
+{
+	dev_t  device;
+	ino_t  inode;
+	off_t  size;
+	time_t modifiedSeconds;
+	long   modifiedNanoseconds;
+	time_t changedSeconds;
+} micro_ini_served_stamp;
+
+/**
+ * File served by a server (internal use only).
+ */
+typedef struct micro_ini_served_file
+{
+	char* path;          /* Path as given to the server. */
+	char* absolutePath;  /* Absolute path, or NULL if it could not be resolved. */
+
+	int      imageFd;    /* Sealed memfd holding the current image. */
+	uint64_t imageSize;
+	micro_ini_served_stamp stamp;
+} micro_ini_served_file;
+
+struct micro_ini_server
+{
+	micro_ini_served_file* files;
+	size_t fileCount;
+	int    flags;
+
+	micro_ini_allocator* pAllocator;  /* Allocator for the server, its documents and images (NULL for malloc()). */
+
+	int       controlFd;    /* Read-write memfd holding the generation counters. */
+	int       readOnlyFd;   /* Read-only descriptor of the same memfd, handed to clients. */
+	uint32_t* generations;  /* Mapping of the control memfd. */
+	size_t    controlSize;
+
+	micro_ini_served_pending** ppPending;  /* Connections whose request has only partly arrived. */
+	size_t pendingCount;
+	size_t pendingCapacity;
+};
+
+struct micro_ini_client
+{
+	int   socketFd;
+	char* filePath;  /* Path sent in each request. */
+
+	micro_ini_allocator* pAllocator;  /* Allocator for the client (NULL for malloc()). */
+
+	micro_ini_image image;
+	void*  pMapping;  /* Mapping of the current image. */
+	size_t mappingSize;
+
+	const uint32_t* generations;  /* Read-only mapping of the server's control memfd. */
+	size_t controlSize;
+	uint32_t slot;
+	uint32_t generation;  /* Generation of the current image. */
+};
+
+/**
+ * @brief   Read the stamp of a file (internal use only).
+ * @return  Non-zero if the file exists.
+ */
+static int prv_micro_ini_served_stamp(const char* const filePath, micro_ini_served_stamp* const pOutStamp)
+{
+	struct stat info;
+
+	if(stat(filePath, &info) != 0)
+	{
+		return 0;
+	}
+
+	memset(pOutStamp, 0, sizeof(micro_ini_served_stamp));
+	pOutStamp->device = info.st_dev;
+	pOutStamp->inode = info.st_ino;
+	pOutStamp->size = info.st_size;
+	pOutStamp->modifiedSeconds = info.st_mtim.tv_sec;
+	pOutStamp->modifiedNanoseconds = info.st_mtim.tv_nsec;
+	pOutStamp->changedSeconds = info.st_ctim.tv_sec;
+
+	return 1;
+}
+
+/**
+ * @brief   Parse a file and store its image in a new sealed memfd (internal use only).
+ * @return  MICRO_INI_SUCCESS or an error code.
+ *
+ * @param[in]  filePath   Path to the ini file.
+ * @param[in]  flags      Flags for configuring the parser.
+ * @param[in]  pAllocator Allocator for the document and the image while they are built.
+ * @param[out] pOutFd     Receives the memfd.
+ * @param[out] pOutSize   Receives the size of the image.
+ *
+ * The memfd is sealed against writing and resizing, so clients can map it knowing the
+ * image will never change underneath them.
+ */
+static int prv_micro_ini_served_build(const char* const filePath, const int flags, micro_ini_allocator* const pAllocator, int* const pOutFd, uint64_t* const pOutSize)
+{
+	micro_ini_doc_options options;
+	micro_ini_doc* pDoc;
+	void* pImage;
+	size_t size;
+	size_t written;
+	ssize_t count;
+	int result;
+	int fd;
+
+	memset(&options, 0, sizeof(options));
+	options.pAllocator = pAllocator;
+
+	result = micro_ini_doc_load(&pDoc, filePath, flags, &options, NULL, NULL);
+	if(result < 0)
+	{
+		return result;
+	}
+
+	result = micro_ini_image_build(&pImage, &size, pDoc, pAllocator);
+	micro_ini_doc_free(pDoc);
+
+	if(result != MICRO_INI_SUCCESS)
+	{
+		return result;
+	}
+
+	fd = memfd_create("microini-image", MFD_CLOEXEC | MFD_ALLOW_SEALING);
+	if(fd < 0)
+	{
+		micro_ini_allocator_free(pAllocator, pImage);
+		return MICRO_INI_ERROR_SYSTEM;
+	}
+
+	for(written = 0; written < size; written += (size_t) count)
+	{
+		count = write(fd, (const char*) pImage + written, size - written);
+		if(count < 0 && errno == EINTR)
+		{
+			count = 0;
+		}
+		else if(count <= 0)
+		{
+			break;
+		}
+	}
+
+	micro_ini_allocator_free(pAllocator, pImage);
+
+	if(written < size || fcntl(fd, F_ADD_SEALS, F_SEAL_SHRINK | F_SEAL_GROW | F_SEAL_WRITE | F_SEAL_SEAL) != 0)
+	{
+		close(fd);
+		return MICRO_INI_ERROR_SYSTEM;
+	}
+
+	(*pOutFd) = fd;
+	(*pOutSize) = (uint64_t) size;
+
+	return MICRO_INI_SUCCESS;
+}
+
+/**
+ * @brief   Wrapper for the futex system call, which has no glibc function (internal use only).
+ * @return  Result of the system call.
+ */
+static long prv_micro_ini_served_futex(const uint32_t* const pWord, const int operation, const uint32_t value, const struct timespec* const pTimeout)
+{
+	return syscall(SYS_futex, pWord, operation, value, pTimeout, NULL, 0);
+}
+
+/**
+ * @brief   Send the whole of a buffer, retrying after interruptions (internal use only).
+ * @return  Non-zero on success.
+ */
+static int prv_micro_ini_served_send(const int socketFd, const void* const pData, const size_t size)
+{
+	size_t sent = 0;
+	ssize_t count;
+
+	while(sent < size)
+	{
+		count = send(socketFd, (const char*) pData + sent, size - sent, MSG_NOSIGNAL);
+		if(count < 0 && errno == EINTR)
+		{
+			continue;
+		}
+
+		if(count <= 0)
+		{
+			return 0;
+		}
+
+		sent += (size_t) count;
+	}
+
+	return 1;
+}
+
+/**
+ * @brief   Find the partial request of a connection (internal use only).
+ * @return  Index of the partial request, or the number of partial requests if the connection has none.
+ */
+static size_t prv_micro_ini_served_find_pending(const micro_ini_server* const pServer, const int socketFd)
+{
+	size_t index = 0;
+
+	while(index < pServer->pendingCount && pServer->ppPending[index]->socketFd != socketFd)
+	{
+		++index;
+	}
+
+	return index;
+}
+
+/**
+ * @brief  Forget a partial request (internal use only).
+ */
+static void prv_micro_ini_served_remove_pending(micro_ini_server* const pServer, const size_t index)
+{
+	micro_ini_allocator_free(pServer->pAllocator, pServer->ppPending[index]);
+
+	/* The order does not matter, so the last request fills the gap. */
+	pServer->ppPending[index] = pServer->ppPending[--pServer->pendingCount];
+}
+
+/**
+ * @brief   Keep a partial request until the rest of it arrives (internal use only).
+ * @return  1 when the request is kept, or MICRO_INI_ERROR_OUT_OF_MEMORY.
+ */
+static int prv_micro_ini_served_keep_pending(micro_ini_server* const pServer, const micro_ini_served_pending* const pRequest)
+{
+	micro_ini_served_pending* pPending;
+
+	if(pRequest->received == 0)
+	{
+		/* Nothing has arrived, so there is nothing to keep. */
+		return 1;
+	}
+
+	if(pServer->pendingCount == pServer->pendingCapacity)
+	{
+		const size_t capacity = pServer->pendingCapacity ? pServer->pendingCapacity * 2 : 4;
+		micro_ini_served_pending** const ppPending = (micro_ini_served_pending**) micro_ini_allocator_realloc(
+			pServer->pAllocator,
+			pServer->ppPending,
+			capacity * sizeof(micro_ini_served_pending*)
+		);
+
+		if(!ppPending)
+		{
+			return MICRO_INI_ERROR_OUT_OF_MEMORY;
+		}
+
+		pServer->ppPending = ppPending;
+		pServer->pendingCapacity = capacity;
+	}
+
+	pPending = (micro_ini_served_pending*) micro_ini_allocator_alloc(pServer->pAllocator, sizeof(micro_ini_served_pending));
+	if(!pPending)
+	{
+		return MICRO_INI_ERROR_OUT_OF_MEMORY;
+	}
+
+	memcpy(pPending, pRequest, sizeof(micro_ini_served_pending));
+	pServer->ppPending[pServer->pendingCount++] = pPending;
+
+	return 1;
+}
+
+/**
+ * @brief   Read as much of a request as has arrived, without blocking (internal use only).
+ * @return  MICRO_INI_SUCCESS once the whole request has been read, 1 if the rest has not
+ *          arrived yet (the server keeps the part read so far), or an error code when the
+ *          connection should be closed.
+ *
+ * @param[in]  pServer   Server.
+ * @param[in]  socketFd  Connected socket.
+ * @param[out] pRequest  Receives the request, continuing any partial request of the socket.
+ */
+static int prv_micro_ini_served_read_request(micro_ini_server* const pServer, const int socketFd, micro_ini_served_pending* const pRequest)
+{
+	const size_t index = prv_micro_ini_served_find_pending(pServer, socketFd);
+
+	uint32_t length;
+	size_t wanted;
+	ssize_t count;
+
+	if(index < pServer->pendingCount)
+	{
+		memcpy(pRequest, pServer->ppPending[index], sizeof(micro_ini_served_pending));
+		prv_micro_ini_served_remove_pending(pServer, index);
+	}
+	else
+	{
+		pRequest->socketFd = socketFd;
+		pRequest->received = 0;
+	}
+
+	for(;;)
+	{
+		if(pRequest->received >= sizeof(length))
+		{
+			memcpy(&length, pRequest->data, sizeof(length));
+
+			if(length >= PATH_MAX)
+			{
+				/* Nothing sensible can follow, so the connection is dropped. */
+				return MICRO_INI_ERROR_BUFFER_OVERFLOW;
+			}
+
+			if(pRequest->received == sizeof(length) + length)
+			{
+				return MICRO_INI_SUCCESS;
+			}
+
+			wanted = sizeof(length) + length - pRequest->received;
+		}
+		else
+		{
+			wanted = sizeof(length) - pRequest->received;
+		}
+
+		/* Reading no further than this request leaves any request queued behind it on the socket. */
+		count = recv(socketFd, pRequest->data + pRequest->received, wanted, MSG_DONTWAIT);
+		if(count < 0 && errno == EINTR)
+		{
+			continue;
+		}
+
+		if(count < 0 && (errno == EAGAIN || errno == EWOULDBLOCK))
+		{
+			/* A client that stops part way through a request must not hold up the others. */
+			return prv_micro_ini_served_keep_pending(pServer, pRequest);
+		}
+
+		if(count <= 0)
+		{
+			/* The client hung up. */
+			return MICRO_INI_ERROR_READ_FAILED;
+		}
+
+		pRequest->received += (uint32_t) count;
+	}
+}
+
+/**
+ * @brief   Send a reply, attaching the image and control memfds on success (internal use only).
+ * @return  Non-zero on success.
+ */
+static int prv_micro_ini_served_reply(const int socketFd, const micro_ini_served_reply* const pReply, const int imageFd, const int controlFd)
+{
+	union
+	{
+		struct cmsghdr header;
+		char buffer[CMSG_SPACE(2 * sizeof(int))];
+	} control;
+	struct cmsghdr* pControl;
+	struct msghdr message;
+	struct iovec part;
+	int fds[2];
+	ssize_t count;
+
+	memset(&message, 0, sizeof(message));
+	part.iov_base = (void*) pReply;
+	part.iov_len = sizeof(micro_ini_served_reply);
+	message.msg_iov = &part;
+	message.msg_iovlen = 1;
+
+	if(pReply->status == MICRO_INI_SUCCESS)
+	{
+		memset(&control, 0, sizeof(control));
+		message.msg_control = control.buffer;
+		message.msg_controllen = sizeof(control.buffer);
+
+		fds[0] = imageFd;
+		fds[1] = controlFd;
+
+		pControl = CMSG_FIRSTHDR(&message);
+		pControl->cmsg_level = SOL_SOCKET;
+		pControl->cmsg_type = SCM_RIGHTS;
+		pControl->cmsg_len = CMSG_LEN(sizeof(fds));
+		memcpy(CMSG_DATA(pControl), fds, sizeof(fds));
+	}
+
+	/* A client that lets its replies pile up unread is dropped rather than waited for. */
+	do
+	{
+		count = sendmsg(socketFd, &message, MSG_NOSIGNAL | MSG_DONTWAIT);
+	}
+	while(count < 0 && errno == EINTR);
+
+	/* A reply this small is never split. */
+	return count == (ssize_t) sizeof(micro_ini_served_reply);
+}
+
+/**
+ * @brief   Send a request and receive the reply along with its memfds (internal use only).
+ * @return  MICRO_INI_SUCCESS or an error code.
+ *
+ * @param[in]  pClient     Client.
+ * @param[out] pOutReply   Receives the reply.
+ * @param[out] pOutFds     Receives the image and control memfds on success.
+ */
+static int prv_micro_ini_served_request(const micro_ini_client* const pClient, micro_ini_served_reply* const pOutReply, int* const pOutFds)
+{
+	union
+	{
+		struct cmsghdr header;
+		char buffer[CMSG_SPACE(2 * sizeof(int))];
+	} control;
+	struct cmsghdr* pControl;
+	struct msghdr message;
+	struct iovec part;
+	uint32_t length = (uint32_t) strlen(pClient->filePath);
+	ssize_t count;
+	int fdCount = 0;
+
+	if(!prv_micro_ini_served_send(pClient->socketFd, &length, sizeof(length))
+		|| !prv_micro_ini_served_send(pClient->socketFd, pClient->filePath, length))
+	{
+		return MICRO_INI_ERROR_WRITE_FAILED;
+	}
+
+	memset(&message, 0, sizeof(message));
+	memset(&control, 0, sizeof(control));
+	part.iov_base = pOutReply;
+	part.iov_len = sizeof(micro_ini_served_reply);
+	message.msg_iov = &part;
+	message.msg_iovlen = 1;
+	message.msg_control = control.buffer;
+	message.msg_controllen = sizeof(control.buffer);
+
+	do
+	{
+		count = recvmsg(pClient->socketFd, &message, MSG_CMSG_CLOEXEC);
+	}
+	while(count < 0 && errno == EINTR);
+
+	for(pControl = CMSG_FIRSTHDR(&message); pControl; pControl = CMSG_NXTHDR(&message, pControl))
+	{
+		if(pControl->cmsg_level == SOL_SOCKET && pControl->cmsg_type == SCM_RIGHTS)
+		{
+			fdCount = (int) ((pControl->cmsg_len - CMSG_LEN(0)) / sizeof(int));
+			fdCount = (fdCount < 2) ? fdCount : 2;
+			memcpy(pOutFds, CMSG_DATA(pControl), (size_t) fdCount * sizeof(int));
+		}
+	}
+
+	if(count != (ssize_t) sizeof(micro_ini_served_reply) || (message.msg_flags & MSG_CTRUNC) || pOutReply->status != MICRO_INI_SUCCESS || fdCount != 2)
+	{
+		/* The control buffer only has room for two descriptors; any more are discarded by the kernel. */
+		while(fdCount > 0)
+		{
+			close(pOutFds[--fdCount]);
+		}
+
+		if(count == (ssize_t) sizeof(micro_ini_served_reply) && pOutReply->status != MICRO_INI_SUCCESS)
+		{
+			return pOutReply->status;
+		}
+
+		return MICRO_INI_ERROR_READ_FAILED;
+	}
+
+	return MICRO_INI_SUCCESS;
+}
+
+/**
+ * @brief   Fetch and map the current image of the client's file (internal use only).
+ * @return  MICRO_INI_SUCCESS or an error code (the client keeps its old image on failure).
+ */
+static int prv_micro_ini_served_fetch(micro_ini_client* const pClient)
+{
+	micro_ini_served_reply reply;
+	micro_ini_image image;
+	struct stat info;
+	void* pMapping;
+	void* pControl;
+	int fds[2];
+	int result;
+
+	result = prv_micro_ini_served_request(pClient, &reply, fds);
+	if(result != MICRO_INI_SUCCESS)
+	{
+		return result;
+	}
+
+	pMapping = MAP_FAILED;
+	if(fstat(fds[0], &info) == 0 && (uint64_t) info.st_size == reply.imageSize && reply.imageSize > 0)
+	{
+		pMapping = mmap(NULL, (size_t) reply.imageSize, PROT_READ, MAP_SHARED, fds[0], 0);
+	}
+
+	if(!pClient->generations && pMapping != MAP_FAILED)
+	{
+		/* The control memfd never changes, so it is only mapped once. */
+		if(fstat(fds[1], &info) == 0 && (size_t) info.st_size >= ((size_t) reply.slot + 1) * sizeof(uint32_t))
+		{
+			pControl = mmap(NULL, (size_t) info.st_size, PROT_READ, MAP_SHARED, fds[1], 0);
+			if(pControl != MAP_FAILED)
+			{
+				pClient->generations = (const uint32_t*) pControl;
+				pClient->controlSize = (size_t) info.st_size;
+			}
+		}
+	}
+
+	close(fds[0]);
+	close(fds[1]);
+
+	if(pMapping == MAP_FAILED || !pClient->generations || ((size_t) reply.slot + 1) * sizeof(uint32_t) > pClient->controlSize)
+	{
+		if(pMapping != MAP_FAILED)
+		{
+			munmap(pMapping, (size_t) reply.imageSize);
+		}
+
+		return MICRO_INI_ERROR_SYSTEM;
+	}
+
+	if(micro_ini_image_open(&image, pMapping, (size_t) reply.imageSize) != MICRO_INI_SUCCESS)
+	{
+		munmap(pMapping, (size_t) reply.imageSize);
+		return MICRO_INI_ERROR_INVALID_IMAGE;
+	}
+
+	if(pClient->pMapping)
+	{
+		munmap(pClient->pMapping, pClient->mappingSize);
+	}
+
+	pClient->image = image;
+	pClient->pMapping = pMapping;
+	pClient->mappingSize = (size_t) reply.imageSize;
+	pClient->slot = reply.slot;
+	pClient->generation = reply.generation;
+
+	return MICRO_INI_SUCCESS;
+}
+
+
+int micro_ini_server_create(
+	micro_ini_server** const ppOutServer,
+	const char* const* const pFilePaths,
+	const size_t fileCount,
+	const int flags,
+	micro_ini_allocator* const pAllocator
+)
+{
+	micro_ini_server* pServer;
+	micro_ini_served_file* pFile;
+	char absolute[PATH_MAX];
+	char procPath[64];
+	const long pageSize = sysconf(_SC_PAGESIZE);
+	void* pMapping;
+	size_t length;
+	size_t i;
+	int result;
+
+	if(!ppOutServer)
+	{
+		return MICRO_INI_ERROR_INVALID_DOCUMENT;
+	}
+
+	(*ppOutServer) = NULL;
+
+	if(!pFilePaths || fileCount == 0 || fileCount > UINT32_MAX)
+	{
+		return MICRO_INI_ERROR_INVALID_FILE_OBJECT;
+	}
+
+	pServer = (micro_ini_server*) micro_ini_allocator_calloc(pAllocator, 1, sizeof(micro_ini_server));
+	if(!pServer)
+	{
+		return MICRO_INI_ERROR_OUT_OF_MEMORY;
+	}
+
+	pServer->flags = flags;
+	pServer->pAllocator = pAllocator;
+	pServer->controlFd = -1;
+	pServer->readOnlyFd = -1;
+
+	pServer->files = (micro_ini_served_file*) micro_ini_allocator_calloc(pAllocator, fileCount, sizeof(micro_ini_served_file));
+	if(!pServer->files)
+	{
+		micro_ini_allocator_free(pAllocator, pServer);
+		return MICRO_INI_ERROR_OUT_OF_MEMORY;
+	}
+
+	for(i = 0; i < fileCount; ++i)
+	{
+		pServer->files[i].imageFd = -1;
+	}
+
+	pServer->fileCount = fileCount;
+
+	/* One page (or more) of generation counters, shared with every client. */
+	pServer->controlSize = fileCount * sizeof(uint32_t);
+	pServer->controlSize = (pServer->controlSize + (size_t) pageSize - 1) & ~((size_t) pageSize - 1);
+
+	pServer->controlFd = memfd_create("microini-control", MFD_CLOEXEC | MFD_ALLOW_SEALING);
+	if(pServer->controlFd < 0
+		|| ftruncate(pServer->controlFd, (off_t) pServer->controlSize) != 0
+		|| fcntl(pServer->controlFd, F_ADD_SEALS, F_SEAL_SHRINK | F_SEAL_GROW | F_SEAL_SEAL) != 0)
+	{
+		micro_ini_server_free(pServer);
+		return MICRO_INI_ERROR_SYSTEM;
+	}
+
+	pMapping = mmap(NULL, pServer->controlSize, PROT_READ | PROT_WRITE, MAP_SHARED, pServer->controlFd, 0);
+	if(pMapping == MAP_FAILED)
+	{
+		micro_ini_server_free(pServer);
+		return MICRO_INI_ERROR_SYSTEM;
+	}
+
+	pServer->generations = (uint32_t*) pMapping;
+
+	/* Reopening the memfd read-only keeps clients from being able to map it writable. */
+	sprintf(procPath, "/proc/self/fd/%d", pServer->controlFd);
+	pServer->readOnlyFd = open(procPath, O_RDONLY | O_CLOEXEC);
+
+	for(i = 0; i < fileCount; ++i)
+	{
+		pFile = &pServer->files[i];
+		length = strlen(pFilePaths[i]);
+
+		pFile->path = (char*) micro_ini_allocator_alloc(pAllocator, length + 1);
+		if(!pFile->path)
+		{
+			micro_ini_server_free(pServer);
+			return MICRO_INI_ERROR_OUT_OF_MEMORY;
+		}
+
+		memcpy(pFile->path, pFilePaths[i], length + 1);
+
+		if(realpath(pFile->path, absolute))
+		{
+			length = strlen(absolute);
+
+			pFile->absolutePath = (char*) micro_ini_allocator_alloc(pAllocator, length + 1);
+			if(!pFile->absolutePath)
+			{
+				micro_ini_server_free(pServer);
+				return MICRO_INI_ERROR_OUT_OF_MEMORY;
+			}
+
+			memcpy(pFile->absolutePath, absolute, length + 1);
+		}
+
+		if(!prv_micro_ini_served_stamp(pFile->path, &pFile->stamp))
+		{
+			micro_ini_server_free(pServer);
+			return MICRO_INI_ERROR_INVALID_FILE_OBJECT;
+		}
+
+		result = prv_micro_ini_served_build(pFile->path, flags, pAllocator, &pFile->imageFd, &pFile->imageSize);
+		if(result != MICRO_INI_SUCCESS)
+		{
+			micro_ini_server_free(pServer);
+			return result;
+		}
+	}
+
+	(*ppOutServer) = pServer;
+
+	return MICRO_INI_SUCCESS;
+}
+
+
+void micro_ini_server_free(micro_ini_server* const pServer)
+{
+	size_t i;
+
+	if(!pServer)
+	{
+		return;
+	}
+
+	for(i = 0; i < pServer->fileCount; ++i)
+	{
+		if(pServer->files[i].imageFd >= 0)
+		{
+			close(pServer->files[i].imageFd);
+		}
+
+		micro_ini_allocator_free(pServer->pAllocator, pServer->files[i].path);
+		micro_ini_allocator_free(pServer->pAllocator, pServer->files[i].absolutePath);
+	}
+
+	if(pServer->generations)
+	{
+		munmap(pServer->generations, pServer->controlSize);
+	}
+
+	if(pServer->readOnlyFd >= 0)
+	{
+		close(pServer->readOnlyFd);
+	}
+
+	if(pServer->controlFd >= 0)
+	{
+		close(pServer->controlFd);
+	}
+
+	while(pServer->pendingCount > 0)
+	{
+		prv_micro_ini_served_remove_pending(pServer, pServer->pendingCount - 1);
+	}
+
+	micro_ini_allocator_free(pServer->pAllocator, pServer->ppPending);
+	micro_ini_allocator_free(pServer->pAllocator, pServer->files);
+	micro_ini_allocator_free(pServer->pAllocator, pServer);
+}
+
+
+int micro_ini_server_refresh(micro_ini_server* const pServer)
+{
+	micro_ini_served_file* pFile;
+	micro_ini_served_stamp stamp;
+	uint64_t size;
+	size_t i;
+	int rebuilt = 0;
+	int fd;
+
+	if(!pServer)
+	{
+		return MICRO_INI_ERROR_INVALID_DOCUMENT;
+	}
+
+	for(i = 0; i < pServer->fileCount; ++i)
+	{
+		pFile = &pServer->files[i];
+
+		if(!prv_micro_ini_served_stamp(pFile->path, &stamp) || memcmp(&stamp, &pFile->stamp, sizeof(stamp)) == 0)
+		{
+			continue;
+		}
+
+		if(prv_micro_ini_served_build(pFile->path, pServer->flags, pServer->pAllocator, &fd, &size) != MICRO_INI_SUCCESS)
+		{
+			continue;
+		}
+
+		close(pFile->imageFd);
+		pFile->imageFd = fd;
+		pFile->imageSize = size;
+		pFile->stamp = stamp;
+
+		/* Publish the new generation, then wake every client waiting on the old one. */
+		__atomic_add_fetch(&pServer->generations[i], 1, __ATOMIC_RELEASE);
+		prv_micro_ini_served_futex(&pServer->generations[i], FUTEX_WAKE, INT_MAX, NULL);
+
+		++rebuilt;
+	}
+
+	return rebuilt;
+}
+
+
+int micro_ini_server_handle(micro_ini_server* const pServer, const int socketFd)
+{
+	micro_ini_served_pending request;
+	micro_ini_served_reply reply;
+	micro_ini_served_file* pFile = NULL;
+	const char* path;
+	uint32_t length;
+	size_t i;
+	int result;
+
+	if(!pServer)
+	{
+		return MICRO_INI_ERROR_INVALID_DOCUMENT;
+	}
+
+	result = prv_micro_ini_served_read_request(pServer, socketFd, &request);
+	if(result != MICRO_INI_SUCCESS)
+	{
+		/* The connection stays open while the rest of the request is on its way. */
+		return (result > 0) ? MICRO_INI_SUCCESS : result;
+	}
+
+	memcpy(&length, request.data, sizeof(length));
+	request.data[sizeof(length) + length] = '\0';
+	path = request.data + sizeof(length);
+
+	for(i = 0; i < pServer->fileCount && !pFile; ++i)
+	{
+		if(strcmp(path, pServer->files[i].path) == 0
+			|| (pServer->files[i].absolutePath && strcmp(path, pServer->files[i].absolutePath) == 0))
+		{
+			pFile = &pServer->files[i];
+		}
+	}
+
+	memset(&reply, 0, sizeof(reply));
+
+	if(pFile)
+	{
+		reply.status = MICRO_INI_SUCCESS;
+		reply.slot = (uint32_t) (pFile - pServer->files);
+		reply.generation = __atomic_load_n(&pServer->generations[reply.slot], __ATOMIC_ACQUIRE);
+		reply.imageSize = pFile->imageSize;
+	}
+	else
+	{
+		reply.status = MICRO_INI_ERROR_INVALID_FILE_OBJECT;
+	}
+
+	if(!prv_micro_ini_served_reply(socketFd, &reply, pFile ? pFile->imageFd : -1, pServer->readOnlyFd >= 0 ? pServer->readOnlyFd : pServer->controlFd))
+	{
+		return MICRO_INI_ERROR_WRITE_FAILED;
+	}
+
+	return MICRO_INI_SUCCESS;
+}
+
+
+void micro_ini_server_forget(micro_ini_server* const pServer, const int socketFd)
+{
+	size_t index;
+
+	if(pServer)
+	{
+		index = prv_micro_ini_served_find_pending(pServer, socketFd);
+
+		if(index < pServer->pendingCount)
+		{
+			prv_micro_ini_served_remove_pending(pServer, index);
+		}
+	}
+}
+
+
+int micro_ini_client_connect(
+	micro_ini_client** const ppOutClient,
+	const char* const socketPath,
+	const char* const filePath,
+	micro_ini_allocator* const pAllocator
+)
+{
+	struct sockaddr_un address;
+	int fd;
+
+	if(!ppOutClient)
+	{
+		return MICRO_INI_ERROR_INVALID_DOCUMENT;
+	}
+
+	(*ppOutClient) = NULL;
+
+	if(!socketPath || strlen(socketPath) >= sizeof(address.sun_path))
+	{
+		return MICRO_INI_ERROR_INVALID_FILE_OBJECT;
+	}
+
+	fd = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+	if(fd < 0)
+	{
+		return MICRO_INI_ERROR_SYSTEM;
+	}
+
+	memset(&address, 0, sizeof(address));
+	address.sun_family = AF_UNIX;
+	strcpy(address.sun_path, socketPath);
+
+	if(connect(fd, (const struct sockaddr*) &address, sizeof(address)) != 0)
+	{
+		close(fd);
+		return MICRO_INI_ERROR_SYSTEM;
+	}
+
+	return micro_ini_client_attach(ppOutClient, fd, filePath, pAllocator);
+}
+
+
+int micro_ini_client_attach(
+	micro_ini_client** const ppOutClient,
+	const int socketFd,
+	const char* const filePath,
+	micro_ini_allocator* const pAllocator
+)
+{
+	micro_ini_client* pClient;
+	char absolute[PATH_MAX];
+	const char* name;
+	size_t length;
+	int result;
+
+	if(!ppOutClient)
+	{
+		close(socketFd);
+		return MICRO_INI_ERROR_INVALID_DOCUMENT;
+	}
+
+	(*ppOutClient) = NULL;
+
+	if(!filePath)
+	{
+		close(socketFd);
+		return MICRO_INI_ERROR_INVALID_FILE_OBJECT;
+	}
+
+	pClient = (micro_ini_client*) micro_ini_allocator_calloc(pAllocator, 1, sizeof(micro_ini_client));
+	if(!pClient)
+	{
+		close(socketFd);
+		return MICRO_INI_ERROR_OUT_OF_MEMORY;
+	}
+
+	pClient->socketFd = socketFd;
+	pClient->pAllocator = pAllocator;
+
+	/* Absolute paths let clients name a file from any working directory. */
+	name = realpath(filePath, absolute) ? absolute : filePath;
+	length = strlen(name);
+
+	pClient->filePath = (char*) micro_ini_allocator_alloc(pAllocator, length + 1);
+	if(!pClient->filePath)
+	{
+		micro_ini_client_free(pClient);
+		return MICRO_INI_ERROR_OUT_OF_MEMORY;
+	}
+
+	memcpy(pClient->filePath, name, length + 1);
+
+	result = prv_micro_ini_served_fetch(pClient);
+	if(result != MICRO_INI_SUCCESS)
+	{
+		micro_ini_client_free(pClient);
+		return result;
+	}
+
+	(*ppOutClient) = pClient;
+
+	return MICRO_INI_SUCCESS;
+}
+
+
+void micro_ini_client_free(micro_ini_client* const pClient)
+{
+	if(!pClient)
+	{
+		return;
+	}
+
+	if(pClient->pMapping)
+	{
+		munmap(pClient->pMapping, pClient->mappingSize);
+	}
+
+	if(pClient->generations)
+	{
+		munmap((void*) pClient->generations, pClient->controlSize);
+	}
+
+	close(pClient->socketFd);
+	micro_ini_allocator_free(pClient->pAllocator, pClient->filePath);
+	micro_ini_allocator_free(pClient->pAllocator, pClient);
+}
+
+
+const micro_ini_image* micro_ini_client_image(const micro_ini_client* const pClient)
+{
+	return pClient ? &pClient->image : NULL;
+}
+
+
+int micro_ini_client_is_stale(const micro_ini_client* const pClient)
+{
+	if(!pClient)
+	{
+		return 0;
+	}
+
+	return __atomic_load_n(&pClient->generations[pClient->slot], __ATOMIC_ACQUIRE) != pClient->generation;
+}
+
+
+int micro_ini_client_wait(const micro_ini_client* const pClient, const int timeoutMilliseconds)
+{
+	struct timespec now;
+	struct timespec deadline;
+	struct timespec remaining;
+
+	if(!pClient)
+	{
+		return 0;
+	}
+
+	clock_gettime(CLOCK_MONOTONIC, &deadline);
+	deadline.tv_sec += timeoutMilliseconds / 1000;
+	deadline.tv_nsec += (long) (timeoutMilliseconds % 1000) * 1000000L;
+	if(deadline.tv_nsec >= 1000000000L)
+	{
+		deadline.tv_nsec -= 1000000000L;
+		++deadline.tv_sec;
+	}
+
+	while(!micro_ini_client_is_stale(pClient))
+	{
+		if(timeoutMilliseconds < 0)
+		{
+			prv_micro_ini_served_futex(&pClient->generations[pClient->slot], FUTEX_WAIT, pClient->generation, NULL);
+			continue;
+		}
+
+		/* Wake-ups may be spurious, so the remaining time is worked out again each round. */
+		clock_gettime(CLOCK_MONOTONIC, &now);
+		remaining.tv_sec = deadline.tv_sec - now.tv_sec;
+		remaining.tv_nsec = deadline.tv_nsec - now.tv_nsec;
+		if(remaining.tv_nsec < 0)
+		{
+			remaining.tv_nsec += 1000000000L;
+			--remaining.tv_sec;
+		}
+
+		if(remaining.tv_sec < 0 || (remaining.tv_sec == 0 && remaining.tv_nsec == 0))
+		{
+			return 0;
+		}
+
+		prv_micro_ini_served_futex(&pClient->generations[pClient->slot], FUTEX_WAIT, pClient->generation, &remaining);
+	}
+
+	return 1;
+}
+
+
+int micro_ini_client_refresh(micro_ini_client* const pClient)
+{
+	int result;
+
+	if(!pClient)
+	{
+		return MICRO_INI_ERROR_INVALID_DOCUMENT;
+	}
+
+	if(!micro_ini_client_is_stale(pClient))
+	{
+		return 0;
+	}
+
+	result = prv_micro_ini_served_fetch(pClient);
+
+	return (result == MICRO_INI_SUCCESS) ? 1 : result;
+}
+
+#endif
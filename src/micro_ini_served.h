@@ -0,0 +1,217 @@
+/**
+ * Copyright (c) 2021, Zoe J. Bare
+ *
+ * MIT License
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ */
+
+#pragma once
+
+#include "micro_ini_image.h"
+
+#include <stddef.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*
+ * Sharing parsed images between processes over a Unix domain socket (Linux only).
+ * This is an optional module layered on top of the image module; unlike the parser,
+ * it allocates memory.
+ *
+ * A server parses each of its files once and builds its image in a sealed memfd.  A
+ * client connects, names a file, and receives the memfd along with a small shared
+ * control memfd through SCM_RIGHTS.  The client maps the image read-only and queries
+ * it in place, so every process on the host shares a single copy of each image and
+ * none of them parse anything.
+ *
+ * The control memfd holds one 32-bit generation counter per file.  When the server
+ * rebuilds an image it bumps the file's counter and wakes any clients blocked on it
+ * with a futex, after which clients call micro_ini_client_refresh() to fetch the new
+ * image.  Images are never modified once built, so a client can keep using the image
+ * it has until it chooses to refresh.
+ *
+ * The server does not own any sockets: micro_ini_server_handle() answers a single
+ * request on any connected socket, so the daemon in tools/microini_served.c, or a
+ * test using socketpair(), decides how connections are accepted and polled.
+ */
+typedef struct micro_ini_server micro_ini_server;
+
+/**
+ * Client of a micro_ini_server, holding the current image of one file.
+ */
+typedef struct micro_ini_client micro_ini_client;
+
+/**
+ * @brief   Create a server and build the images of its files.
+ * @return  MICRO_INI_SUCCESS or an error code.
+ *
+ * @param[out] ppOutServer  Receives the new server (set to NULL when an error code is returned).
+ * @param[in]  pFilePaths   Paths to the ini files to serve.
+ * @param[in]  fileCount    Number of files.
+ * @param[in]  flags        Flags for configuring the parser.
+ * @param[in]  pAllocator   Allocator for the server and for the documents and images it builds (NULL for malloc()).
+ *
+ * Clients name files by the path given here or by their absolute path.  The server
+ * must be released with micro_ini_server_free().
+ */
+MICRO_INI_API int micro_ini_server_create(
+	micro_ini_server** const ppOutServer,
+	const char* const* const pFilePaths,
+	const size_t fileCount,
+	const int flags,
+	micro_ini_allocator* const pAllocator
+);
+
+/**
+ * @brief  Release a server.
+ *
+ * @param[in]  pServer  Server to release (may be NULL).
+ *
+ * Images already handed to clients stay valid for as long as the clients map them.
+ */
+MICRO_INI_API void micro_ini_server_free(micro_ini_server* const pServer);
+
+/**
+ * @brief   Rebuild the images of every file that changed since it was last built.
+ * @return  Number of images rebuilt, or an error code.
+ *
+ * @param[in]  pServer  Server.
+ *
+ * Files are compared by device, inode, size and modification and change times.  A
+ * file that has been removed or can no longer be parsed keeps its last image.
+ */
+MICRO_INI_API int micro_ini_server_refresh(micro_ini_server* const pServer);
+
+/**
+ * @brief   Answer one request from a client.
+ * @return  MICRO_INI_SUCCESS, or an error code when the connection should be closed.
+ *
+ * @param[in]  pServer   Server.
+ * @param[in]  socketFd  Connected Unix domain stream socket that is ready for reading.
+ *
+ * The socket is never waited on, so a client that stops part way through a request
+ * cannot hold up the others.  Whatever part of the request has arrived is kept by the
+ * server and MICRO_INI_SUCCESS is returned without a reply; the next call for the same
+ * socket carries on from there.  At most one request is answered per call, and a client
+ * that leaves its replies unread until the socket buffer fills up is dropped.
+ *
+ * Requests for files the server does not serve are answered with
+ * MICRO_INI_ERROR_INVALID_FILE_OBJECT, which the client reports; the connection stays
+ * usable.  MICRO_INI_ERROR_READ_FAILED is returned once the client has hung up.  The
+ * partial request of a socket is discarded whenever an error code is returned.
+ */
+MICRO_INI_API int micro_ini_server_handle(micro_ini_server* const pServer, const int socketFd);
+
+/**
+ * @brief  Discard the partial request of a connection the caller is about to close.
+ *
+ * @param[in]  pServer   Server.
+ * @param[in]  socketFd  Socket being closed.
+ *
+ * Only needed when a connection is closed although micro_ini_server_handle() did not
+ * return an error code for it, so that a later connection reusing the descriptor does
+ * not continue its request.
+ */
+MICRO_INI_API void micro_ini_server_forget(micro_ini_server* const pServer, const int socketFd);
+
+/**
+ * @brief   Connect to a server listening on a Unix domain socket and fetch the image of a file.
+ * @return  MICRO_INI_SUCCESS or an error code.
+ *
+ * @param[out] ppOutClient  Receives the new client (set to NULL when an error code is returned).
+ * @param[in]  socketPath   Path of the server's socket.
+ * @param[in]  filePath     Path to the ini file, as known to the server.
+ * @param[in]  pAllocator   Allocator for the client (NULL for malloc()).
+ */
+MICRO_INI_API int micro_ini_client_connect(
+	micro_ini_client** const ppOutClient,
+	const char* const socketPath,
+	const char* const filePath,
+	micro_ini_allocator* const pAllocator
+);
+
+/**
+ * @brief   Fetch the image of a file over an already connected socket.
+ * @return  MICRO_INI_SUCCESS or an error code.
+ *
+ * @param[out] ppOutClient  Receives the new client (set to NULL when an error code is returned).
+ * @param[in]  socketFd     Connected Unix domain stream socket, which the client takes ownership of.
+ * @param[in]  filePath     Path to the ini file, as known to the server.
+ * @param[in]  pAllocator   Allocator for the client (NULL for malloc()).
+ *
+ * The socket is closed when the client is released, including when an error code is returned.
+ */
+MICRO_INI_API int micro_ini_client_attach(
+	micro_ini_client** const ppOutClient,
+	const int socketFd,
+	const char* const filePath,
+	micro_ini_allocator* const pAllocator
+);
+
+/**
+ * @brief  Release a client, unmapping its image.
+ *
+ * @param[in]  pClient  Client to release (may be NULL).
+ */
+MICRO_INI_API void micro_ini_client_free(micro_ini_client* const pClient);
+
+/**
+ * @brief   Get the image held by a client.
+ * @return  Image view, valid until the client is refreshed or released.
+ *
+ * @param[in]  pClient  Client.
+ */
+MICRO_INI_API const micro_ini_image* micro_ini_client_image(const micro_ini_client* const pClient);
+
+/**
+ * @brief   Check if the server has rebuilt the image held by a client.
+ * @return  Non-zero if a newer image is available.
+ *
+ * @param[in]  pClient  Client.
+ *
+ * This only reads the shared generation counter; it makes no system calls.
+ */
+MICRO_INI_API int micro_ini_client_is_stale(const micro_ini_client* const pClient);
+
+/**
+ * @brief   Wait until the server rebuilds the image held by a client.
+ * @return  Non-zero if a newer image is available, or zero if the timeout expired first.
+ *
+ * @param[in]  pClient              Client.
+ * @param[in]  timeoutMilliseconds  Time to wait, or a negative number to wait forever.
+ */
+MICRO_INI_API int micro_ini_client_wait(const micro_ini_client* const pClient, const int timeoutMilliseconds);
+
+/**
+ * @brief   Fetch the latest image if the server has rebuilt it.
+ * @return  1 if a new image was fetched, 0 if the image was current, or an error code.
+ *
+ * @param[in]  pClient  Client.
+ *
+ * Fetching a new image invalidates every string and view obtained from the old one.
+ * On failure the client keeps its old image.
+ */
+MICRO_INI_API int micro_ini_client_refresh(micro_ini_client* const pClient);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,126 @@
+/**
+ * Copyright (c) 2021, Zoe J. Bare
+ *
+ * MIT License
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ */
+
+/*
+ * Checks the limit on the seeds tried while building the perfect hash of a bound struct:
+ * the table is complete when the search may try exactly as many seeds as its hardest
+ * bucket needs and is reported as incomplete, instead of searching on, with one fewer.
+ * Loading through the table then fills every bound field.
+ *
+ * Build: c++ -std=c++17 -Isrc tests/bind_seed_limit.cpp src/micro_ini.c -o bind_seed_limit
+ *
+ * Exits with 0 when every check passes.  Building with -DMICRO_INI_BIND_MAX_SEEDS=0 must
+ * instead fail with "Could not build the key table for limits_config".
+ */
+
+#include "micro_ini_bind.hpp"
+
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+
+struct limits_config
+{
+	int width = 0;
+	int height = 0;
+	int depth = 0;
+	std::string title;
+	bool fullscreen = false;
+	double scale = 0.0;
+	std::string path;
+	int retries = 0;
+	bool verbose = false;
+	std::string user;
+	int port = 0;
+	double timeout = 0.0;
+};
+
+MICRO_INI_BIND(limits_config,
+	(width, "window", "width"),
+	(height, "window", "height"),
+	(depth, "window", "depth"),
+	(title, "window", "title"),
+	(fullscreen, "window", "fullscreen"),
+	(scale, "window", "scale"),
+	(path, "log", "path"),
+	(retries, "log", "retries"),
+	(verbose, "log", "verbose"),
+	(user, "server", "user"),
+	(port, "server", "port"),
+	(timeout, "server", "timeout")
+);
+
+/* Largest seed any bucket of the table settled on. */
+constexpr std::uint32_t seeds_needed()
+{
+	constexpr auto& layout = micro_ini::bind_layout_v<limits_config>;
+	std::uint32_t largest = 0;
+
+	for(const std::uint32_t seed : layout.seeds)
+	{
+		largest = (seed > largest) ? seed : largest;
+	}
+
+	return largest;
+}
+
+static_assert(seeds_needed() > 1, "Every bucket of the test table was placed with its first seed, so the limit is not exercised.");
+static_assert(micro_ini::prv_bind_build<limits_config>(seeds_needed()).complete, "The table needs more seeds than its own buckets settled on.");
+static_assert(!micro_ini::prv_bind_build<limits_config>(seeds_needed() - 1).complete, "The table was built with fewer seeds than its hardest bucket needs.");
+static_assert(!micro_ini::prv_bind_build<limits_config>(0).complete, "The table was built without trying any seed.");
+
+static int failures = 0;
+
+#define CHECK(condition) \
+	do \
+	{ \
+		if(!(condition)) \
+		{ \
+			std::fprintf(stderr, "%s:%d: check failed: %s\n", __FILE__, __LINE__, #condition); \
+			++failures; \
+		} \
+	} while(0)
+
+int main()
+{
+	static const char text[] =
+		"[window]\nwidth = 640\nheight = 480\ndepth = 24\ntitle = demo\nfullscreen = yes\nscale = 1.5\n"
+		"[log]\npath = /tmp/log\nretries = 3\nverbose = on\n"
+		"[server]\nuser = admin\nport = 8080\ntimeout = 2.5\nunbound = 1\n";
+
+	limits_config config;
+
+	CHECK(micro_ini::bind_load_buffer(text, config) == 0);
+	CHECK(config.width == 640 && config.height == 480 && config.depth == 24);
+	CHECK(config.title == "demo" && config.fullscreen && config.scale == 1.5);
+	CHECK(config.path == "/tmp/log" && config.retries == 3 && config.verbose);
+	CHECK(config.user == "admin" && config.port == 8080 && config.timeout == 2.5);
+
+	if(failures == 0)
+	{
+		std::printf("bind_seed_limit: ok (hardest bucket needs %u seeds)\n", static_cast<unsigned>(seeds_needed()));
+	}
+
+	return (failures == 0) ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,198 @@
+/**
+ * Copyright (c) 2021, Zoe J. Bare
+ *
+ * MIT License
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ */
+
+/*
+ * Checks that lookups in images return the value of the nearest section holding a key,
+ * including when a child repeats the value of its parent and both share one string in
+ * the document, that every section stores only its own keys, and that an image of a
+ * deep inheritance chain stays about the size of the file.
+ *
+ * Build: cc -Isrc tests/image_inherit.c src/micro_ini.c src/micro_ini_alloc.c src/micro_ini_doc.c src/micro_ini_image.c -o image_inherit
+ *
+ * Exits with 0 when every check passes.
+ */
+
+#include "micro_ini_image.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+static int failures = 0;
+
+#define CHECK(condition) \
+	do \
+	{ \
+		if(!(condition)) \
+		{ \
+			fprintf(stderr, "%s:%d: check failed: %s\n", __FILE__, __LINE__, #condition); \
+			++failures; \
+		} \
+	} while(0)
+
+/**
+ * @brief  Build the image of an ini file held in a string and check the pairs of one of its sections.
+ *
+ * @param[in]  text      Contents of the ini file, parsed with inheritance.
+ * @param[in]  section   Section to check.
+ * @param[in]  pPairs    Expected keys and values visible in the section, ending with a NULL key.
+ * @param[in]  ownCount  Number of keys the section holds itself.
+ */
+static void check_section(const char* const text, const char* const section, const char* const* const pPairs, const size_t ownCount)
+{
+	micro_ini_doc* pDoc;
+	micro_ini_image image;
+	void* pData;
+	size_t size;
+	size_t sectionIndex;
+	size_t owner;
+	size_t count = 0;
+	size_t chained = 0;
+	size_t i;
+	size_t j;
+
+	CHECK(micro_ini_doc_load_buffer(&pDoc, text, strlen(text), MICRO_INI_FLAG_INHERITANCE, NULL, NULL, NULL) == 0);
+	if(!pDoc)
+	{
+		return;
+	}
+
+	CHECK(micro_ini_image_build(&pData, &size, pDoc, NULL) == MICRO_INI_SUCCESS);
+	micro_ini_doc_free(pDoc);
+
+	if(!pData)
+	{
+		return;
+	}
+
+	CHECK(micro_ini_image_open(&image, pData, size) == MICRO_INI_SUCCESS);
+
+	while(pPairs[count * 2])
+	{
+		++count;
+	}
+
+	sectionIndex = micro_ini_image_find_section(&image, section);
+	CHECK(sectionIndex != MICRO_INI_DOC_NPOS);
+	CHECK(micro_ini_image_key_count(&image, sectionIndex) == ownCount);
+
+	for(i = 0; i < count; ++i)
+	{
+		const char* const value = micro_ini_image_get(&image, section, pPairs[i * 2]);
+
+		CHECK(value && strcmp(value, pPairs[i * 2 + 1]) == 0);
+	}
+
+	/* Every key held anywhere in the chain must be one of the expected keys. */
+	for(owner = sectionIndex; owner != MICRO_INI_IMAGE_NPOS; owner = micro_ini_image_section_parent(&image, owner))
+	{
+		for(j = 0; j < micro_ini_image_key_count(&image, owner); ++j)
+		{
+			for(i = 0; i < count && strcmp(pPairs[i * 2], micro_ini_image_key(&image, owner, j)) != 0; ++i)
+			{
+			}
+
+			CHECK(i < count);
+			++chained;
+		}
+	}
+
+	CHECK(chained >= count);
+	CHECK(micro_ini_image_get(&image, section, "missing") == NULL);
+
+	free(pData);
+}
+
+/**
+ * @brief  Check that the image of a long chain of sections grows with the file, not the chain.
+ */
+static void check_deep_chain(void)
+{
+	const size_t depth = 2500;
+	char* const text = (char*) malloc(depth * 64);
+	micro_ini_doc* pDoc = NULL;
+	micro_ini_image image;
+	void* pData = NULL;
+	size_t length = 0;
+	size_t size = 0;
+	size_t i;
+
+	CHECK(text != NULL);
+	if(!text)
+	{
+		return;
+	}
+
+	length += (size_t) sprintf(text, "[s0]\nk0 = v0\n");
+	for(i = 1; i < depth; ++i)
+	{
+		length += (size_t) sprintf(text + length, "[s%lu : s%lu]\nk%lu = v%lu\n", (unsigned long) i, (unsigned long) (i - 1), (unsigned long) i, (unsigned long) i);
+	}
+
+	CHECK(micro_ini_doc_load_buffer(&pDoc, text, length, MICRO_INI_FLAG_INHERITANCE, NULL, NULL, NULL) == 0);
+	if(pDoc)
+	{
+		CHECK(micro_ini_image_build(&pData, &size, pDoc, NULL) == MICRO_INI_SUCCESS);
+		micro_ini_doc_free(pDoc);
+	}
+
+	if(pData)
+	{
+		/* Copying every inherited key into each section would take about depth * depth / 2 pairs. */
+		CHECK(size < length * 4);
+		CHECK(micro_ini_image_open(&image, pData, size) == MICRO_INI_SUCCESS);
+		CHECK(micro_ini_image_get(&image, "s2499", "k0") && strcmp(micro_ini_image_get(&image, "s2499", "k0"), "v0") == 0);
+		CHECK(micro_ini_image_get(&image, "s2499", "k2499") && strcmp(micro_ini_image_get(&image, "s2499", "k2499"), "v2499") == 0);
+		CHECK(micro_ini_image_get(&image, "s0", "k1") == NULL);
+		free(pData);
+	}
+
+	free(text);
+}
+
+int main(void)
+{
+	static const char* const sameValue[] = { "level", "info", "port", "80", NULL };
+	static const char* const override[] = { "level", "debug", "port", "80", NULL };
+	static const char* const chain[] = { "a", "1", "b", "1", "c", "1", NULL };
+	static const char* const base[] = { "level", "info", "port", "80", NULL };
+
+	/* The child repeats the parent's value, which the document stores once. */
+	check_section("[base]\nlevel=info\nport=80\n[prod : base]\nlevel=info\n", "prod", sameValue, 1);
+	check_section("[base]\nlevel=info\nport=80\n[prod : base]\nlevel=info\n", "base", base, 2);
+
+	check_section("[base]\nlevel=info\nport=80\n[prod : base]\nlevel=debug\n", "prod", override, 1);
+
+	/* Every section of the chain holds a copy of some keys, all with the same value. */
+	check_section("[x]\na=1\nb=1\nc=1\n[y : x]\na=1\nb=1\n[z : y]\na=1\n", "z", chain, 1);
+
+	check_deep_chain();
+
+	if(failures == 0)
+	{
+		printf("image_inherit: ok\n");
+	}
+
+	return (failures == 0) ? EXIT_SUCCESS : EXIT_FAILURE;
+}
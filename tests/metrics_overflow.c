@@ -0,0 +1,119 @@
+/**
+ * Copyright (c) 2021, Zoe J. Bare
+ *
+ * MIT License
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ */
+
+/*
+ * Checks that samples too large for the last bucket of a histogram are counted as
+ * overflow: only the "+Inf" line of an export includes them, and a quantile landing
+ * among them is reported as MICRO_INI_HISTOGRAM_OVERFLOW rather than a finite bound.
+ *
+ * Build: cc -DMICRO_INI_ENABLE_METRICS -Isrc tests/metrics_overflow.c src/micro_ini_metrics.c -o metrics_overflow
+ *
+ * Exits with 0 when every check passes.
+ */
+
+#include "micro_ini_metrics.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+static int failures = 0;
+
+#define CHECK(condition) \
+	do \
+	{ \
+		if(!(condition)) \
+		{ \
+			fprintf(stderr, "%s:%d: check failed: %s\n", __FILE__, __LINE__, #condition); \
+			++failures; \
+		} \
+	} while(0)
+
+/**
+ * @brief   Check that an export holds a line.
+ * @return  Non-zero when the line is found.
+ */
+static int has_line(const char* const text, const char* const line)
+{
+	const size_t length = strlen(line);
+	const char* pFound = text;
+
+	while((pFound = strstr(pFound, line)) != NULL)
+	{
+		if((pFound == text || pFound[-1] == '\n') && pFound[length] == '\n')
+		{
+			return 1;
+		}
+
+		++pFound;
+	}
+
+	return 0;
+}
+
+int main(void)
+{
+	static micro_ini_metrics metrics;
+	static char text[65536];
+
+	const uint64_t largest = ((uint64_t) 1 << (MICRO_INI_HISTOGRAM_MAX_EXPONENT + 1)) - 1;
+	micro_ini_metrics_shard total;
+	int i;
+
+	micro_ini_metrics_reset(&metrics);
+
+	/* Three loads of 100 bytes, one of the largest size tracked and two beyond it. */
+	for(i = 0; i < 3; ++i)
+	{
+		micro_ini_metrics_record(&metrics, 1000, 100, 0);
+	}
+
+	micro_ini_metrics_record(&metrics, 1000, largest, 0);
+	micro_ini_metrics_record(&metrics, 1000, largest + 1, 0);
+	micro_ini_metrics_record(&metrics, 1000, (uint64_t) -1, 0);
+
+	micro_ini_metrics_merge(&metrics, &total);
+
+	CHECK(total.bytes.count == 6);
+	CHECK(total.bytes.overflow == 2);
+	CHECK(total.bytes.buckets[MICRO_INI_HISTOGRAM_BUCKETS - 1] == 1);
+	CHECK(total.duration.overflow == 0);
+
+	CHECK(micro_ini_histogram_quantile(&total.bytes, 0.5) >= 100 && micro_ini_histogram_quantile(&total.bytes, 0.5) < 128);
+	CHECK(micro_ini_histogram_quantile(&total.bytes, 4.0 / 6.0) == largest);
+	CHECK(micro_ini_histogram_quantile(&total.bytes, 0.99) == MICRO_INI_HISTOGRAM_OVERFLOW);
+	CHECK(micro_ini_histogram_quantile(&total.bytes, 1.0) == MICRO_INI_HISTOGRAM_OVERFLOW);
+
+	CHECK(micro_ini_metrics_export(&metrics, NULL, text, sizeof(text)) < sizeof(text));
+	CHECK(has_line(text, "microini_load_bytes_bucket{le=\"2.81474977e+14\"} 4"));
+	CHECK(has_line(text, "microini_load_bytes_bucket{le=\"+Inf\"} 6"));
+	CHECK(has_line(text, "microini_load_duration_seconds_bucket{le=\"+Inf\"} 6"));
+
+	if(failures == 0)
+	{
+		printf("metrics_overflow: ok\n");
+	}
+
+	return (failures == 0) ? EXIT_SUCCESS : EXIT_FAILURE;
+}
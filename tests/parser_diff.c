@@ -0,0 +1,556 @@
+/**
+ * Copyright (c) 2021, Zoe J. Bare
+ *
+ * MIT License
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ */
+
+/*
+ * Differential check of the line scanner against the sscanf() reference parser.
+ *
+ * Built with MICRO_INI_VERIFY_PARSER, every line the library parses goes through both
+ * prv_micro_ini_parse_line() and prv_micro_ini_parse_line_reference(), and the program
+ * aborts with both results as soon as their line type, section, key or value differ.
+ * On top of that, each input is parsed through every entry point with every
+ * combination of flags (0 to 31), recording the callback events, error lines and
+ * return codes of each, and every entry point must reproduce the events of
+ * micro_ini_load_stream() exactly.
+ *
+ * Build: cc -DMICRO_INI_VERIFY_PARSER -Isrc tests/parser_diff.c src/micro_ini.c -o parser_diff
+ * Usage: parser_diff [-n ITERATIONS] [-s SEED] [FILE...]
+ *
+ * The named files (such as fuzz/corpus/(any file)) are checked first, then ITERATIONS
+ * random inputs (2000 by default) built from fragments of ini syntax.  The file entry
+ * points read a copy of each input written to parser_diff.tmp in the current
+ * directory, which is removed at the end.  Exits with 0
+ * when everything matches and prints the input and both event logs of the first
+ * mismatch otherwise.
+ */
+
+#if !defined(_WIN32) && !defined(_POSIX_C_SOURCE) && !defined(_GNU_SOURCE)
+	/* Expose fileno() and pipe() even when compiling in strict ANSI mode. */
+	#define _POSIX_C_SOURCE 200112L
+#endif
+
+#include "micro_ini.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#if defined(__unix__) || defined(__APPLE__)
+	#include <unistd.h>
+	#define PARSER_DIFF_FD_SUPPORTED
+#endif
+
+#if !defined(MICRO_INI_VERIFY_PARSER)
+	#error "parser_diff must be built with MICRO_INI_VERIFY_PARSER defined."
+#endif
+
+/* Largest input given to micro_ini_load_fd() through a pipe, which must not fill the pipe. */
+#define PARSER_DIFF_PIPE_LIMIT 4096
+
+/* Number of scratch segments given to micro_ini_load_buffer_segments(). */
+#define PARSER_DIFF_SEGMENTS 4096
+
+/**
+ * Growing text log of the events of one parse.
+ */
+typedef struct parser_diff_log
+{
+	char* pText;
+	size_t length;
+	size_t capacity;
+
+	micro_ini_state* pState;  /* State to stop after every pair (NULL when not resuming). */
+} parser_diff_log;
+
+/**
+ * In-memory stream read with fgets() semantics.
+ */
+typedef struct parser_diff_stream
+{
+	const char* pData;
+	size_t size;
+	size_t offset;
+} parser_diff_stream;
+
+static micro_ini_segment diffSegments[PARSER_DIFF_SEGMENTS];
+
+static unsigned long diffSeed = 1;
+
+/**
+ * @brief  Append a formatted event to a log, exiting if out of memory.
+ */
+static void parser_diff_append(parser_diff_log* const pLog, const char* const tag, const char* const a, const char* const b, const char* const c, const long number)
+{
+	const size_t needed = strlen(tag) + (a ? strlen(a) : 1) + (b ? strlen(b) : 1) + (c ? strlen(c) : 1) + 32;
+
+	if(pLog->length + needed > pLog->capacity)
+	{
+		const size_t capacity = (pLog->capacity + needed) * 2;
+		char* const pText = (char*) realloc(pLog->pText, capacity);
+
+		if(!pText)
+		{
+			fprintf(stderr, "parser_diff: out of memory\n");
+			exit(EXIT_FAILURE);
+		}
+
+		pLog->pText = pText;
+		pLog->capacity = capacity;
+	}
+
+	/* A NULL key (an inheritance link) is logged differently from an empty one. */
+	pLog->length += (size_t) sprintf(pLog->pText + pLog->length, "%s|%s|%s|%s|%ld\n",
+		tag, a ? a : "\x01", b ? b : "\x01", c ? c : "\x01", number);
+}
+
+/**
+ * @brief  Free the text of a log and empty it.
+ */
+static void parser_diff_clear(parser_diff_log* const pLog)
+{
+	free(pLog->pText);
+	memset(pLog, 0, sizeof(parser_diff_log));
+}
+
+static void parser_diff_handler(void* pUserData, const char* section, const char* key, const char* value)
+{
+	parser_diff_log* const pLog = (parser_diff_log*) pUserData;
+
+	parser_diff_append(pLog, "V", section, key, value, 0);
+
+	if(pLog->pState)
+	{
+		/* Resuming after every pair covers every place a parse can be picked up again. */
+		micro_ini_state_stop(pLog->pState);
+	}
+}
+
+static void parser_diff_error(void* pUserData, const char* line, int lineno)
+{
+	parser_diff_append((parser_diff_log*) pUserData, "E", line, "", "", lineno);
+}
+
+static void parser_diff_segment_handler(void* pUserData, const char* section, const char* key, const micro_ini_segment* pSegments, size_t segmentCount)
+{
+	const size_t length = micro_ini_join_segments(NULL, 0, pSegments, segmentCount);
+	char* const value = (char*) malloc(length + 1);
+
+	if(!value)
+	{
+		fprintf(stderr, "parser_diff: out of memory\n");
+		exit(EXIT_FAILURE);
+	}
+
+	micro_ini_join_segments(value, length + 1, pSegments, segmentCount);
+	parser_diff_append((parser_diff_log*) pUserData, "V", section, key, value, 0);
+	free(value);
+}
+
+static char* parser_diff_read(char* str, int num, void* pStream)
+{
+	parser_diff_stream* const pDiffStream = (parser_diff_stream*) pStream;
+	int length = 0;
+
+	if(num <= 0 || pDiffStream->offset >= pDiffStream->size)
+	{
+		return NULL;
+	}
+
+	while(length < num - 1 && pDiffStream->offset < pDiffStream->size)
+	{
+		const char c = pDiffStream->pData[pDiffStream->offset++];
+
+		str[length++] = c;
+
+		if(c == '\n')
+		{
+			break;
+		}
+	}
+
+	str[length] = '\0';
+	return str;
+}
+
+static int parser_diff_eof(void* pStream)
+{
+	const parser_diff_stream* const pDiffStream = (const parser_diff_stream*) pStream;
+
+	return pDiffStream->offset >= pDiffStream->size;
+}
+
+/**
+ * @brief  Report a mismatch between two logs and exit.
+ */
+static void parser_diff_fail(
+	const char* const entryPoint,
+	const int flags,
+	const char* const pData,
+	const size_t size,
+	const parser_diff_log* const pExpected,
+	const parser_diff_log* const pActual
+)
+{
+	printf("MISMATCH in %s with flags %d on %lu byte input:\n", entryPoint, flags, (unsigned long) size);
+	fwrite(pData, 1, size, stdout);
+	printf("\n--- micro_ini_load_stream()\n%s--- %s\n%s", pExpected->pText, entryPoint, pActual->pText);
+	exit(EXIT_FAILURE);
+}
+
+/**
+ * @brief  Compare a log against the reference log, exiting on a mismatch, and clear it.
+ */
+static void parser_diff_check(
+	const char* const entryPoint,
+	const int flags,
+	const char* const pData,
+	const size_t size,
+	const parser_diff_log* const pExpected,
+	parser_diff_log* const pActual,
+	const int result
+)
+{
+	parser_diff_append(pActual, "R", "", "", "", result);
+
+	if(strcmp(pExpected->pText, pActual->pText) != 0)
+	{
+		parser_diff_fail(entryPoint, flags, pData, size, pExpected, pActual);
+	}
+
+	parser_diff_clear(pActual);
+}
+
+/**
+ * @brief   Resume a buffer parse until it finishes, stopping after every pair.
+ * @return  Result of the last call.
+ */
+static int parser_diff_resume_buffer(const char* const pData, const size_t size, const int flags, parser_diff_log* const pLog, micro_ini_fingerprint* const pFingerprint)
+{
+	micro_ini_state state;
+	int result;
+
+	micro_ini_state_init(&state);
+	pLog->pState = &state;
+
+	do
+	{
+		const uint64_t offset = state.offset;
+
+		result = micro_ini_resume_buffer(&state, pData, size, flags, parser_diff_handler, parser_diff_error, pLog);
+
+		if(result >= 0 && !state.finished && state.offset == offset && !(flags & MICRO_INI_FLAG_STOP_ON_FIRST_ERROR))
+		{
+			/* Every call must make progress, or a caller resuming in a loop would spin forever. */
+			parser_diff_append(pLog, "STALLED", "", "", "", (long) offset);
+			break;
+		}
+	} while(result >= 0 && !state.finished && !(state.numErrors > 0 && (flags & MICRO_INI_FLAG_STOP_ON_FIRST_ERROR)));
+
+	pLog->pState = NULL;
+	(*pFingerprint) = state.fingerprint;
+
+	return result;
+}
+
+/**
+ * @brief  Check one input with one set of flags through every entry point.
+ *
+ * @param[in]  pData  Contents of the input.
+ * @param[in]  size   Number of bytes in the input.
+ * @param[in]  flags  Flags to parse with.
+ * @param[in]  path   Path of a file holding the same bytes (NULL to skip the file entry points).
+ */
+static void parser_diff_input(const char* const pData, const size_t size, const int flags, const char* const path)
+{
+	parser_diff_log expected;
+	parser_diff_log actual;
+	parser_diff_stream stream;
+	micro_ini_state state;
+	micro_ini_fingerprint fingerprint;
+	micro_ini_fingerprint resumedFingerprint;
+	int expectedResult;
+	int result;
+
+	memset(&expected, 0, sizeof(expected));
+	memset(&actual, 0, sizeof(actual));
+
+	stream.pData = pData;
+	stream.size = size;
+	stream.offset = 0;
+
+	expectedResult = micro_ini_load_stream(&stream, flags, parser_diff_handler, parser_diff_error, parser_diff_read, parser_diff_eof, &expected);
+	parser_diff_append(&expected, "R", "", "", "", expectedResult);
+
+	result = micro_ini_load_buffer(pData, size, flags, parser_diff_handler, parser_diff_error, &actual);
+	parser_diff_check("micro_ini_load_buffer()", flags, pData, size, &expected, &actual, result);
+
+	/* Values too long for one line are only parsed by the segment entry point, so such inputs are skipped. */
+	if(expectedResult != MICRO_INI_ERROR_BUFFER_OVERFLOW)
+	{
+		result = micro_ini_load_buffer_segments(pData, size, flags, diffSegments, PARSER_DIFF_SEGMENTS, parser_diff_segment_handler, parser_diff_error, &actual);
+		parser_diff_check("micro_ini_load_buffer_segments()", flags, pData, size, &expected, &actual, result);
+	}
+
+	/* The resume entry points parse the same pairs and count the same errors, a few pairs at a time. */
+	stream.offset = 0;
+	micro_ini_state_init(&state);
+	result = micro_ini_resume_stream(&state, &stream, flags, parser_diff_handler, parser_diff_error, parser_diff_read, parser_diff_eof, &actual);
+	fingerprint = state.fingerprint;
+	parser_diff_check("micro_ini_resume_stream()", flags, pData, size, &expected, &actual, result);
+
+	result = parser_diff_resume_buffer(pData, size, flags, &actual, &resumedFingerprint);
+	parser_diff_check("micro_ini_resume_buffer()", flags, pData, size, &expected, &actual, result);
+
+	if(memcmp(&fingerprint, &resumedFingerprint, sizeof(fingerprint)) != 0)
+	{
+		parser_diff_append(&actual, "FINGERPRINT", "", "", "", 0);
+		parser_diff_fail("micro_ini_resume_buffer() fingerprint", flags, pData, size, &expected, &actual);
+	}
+
+	if(path)
+	{
+		FILE* pFile;
+
+		result = micro_ini_load(path, flags, parser_diff_handler, parser_diff_error, &actual);
+		parser_diff_check("micro_ini_load()", flags, pData, size, &expected, &actual, result);
+
+		pFile = fopen(path, "rb");
+		if(pFile)
+		{
+			result = micro_ini_load_file(pFile, flags, parser_diff_handler, parser_diff_error, &actual);
+			parser_diff_check("micro_ini_load_file()", flags, pData, size, &expected, &actual, result);
+
+#if defined(PARSER_DIFF_FD_SUPPORTED)
+			rewind(pFile);
+			result = micro_ini_load_fd(fileno(pFile), flags, parser_diff_handler, parser_diff_error, &actual);
+			parser_diff_check("micro_ini_load_fd()", flags, pData, size, &expected, &actual, result);
+#endif
+
+			fclose(pFile);
+		}
+
+		micro_ini_state_init(&state);
+		result = micro_ini_resume(&state, path, flags, parser_diff_handler, parser_diff_error, &actual);
+		parser_diff_check("micro_ini_resume()", flags, pData, size, &expected, &actual, result);
+
+		if(memcmp(&fingerprint, &state.fingerprint, sizeof(fingerprint)) != 0)
+		{
+			parser_diff_append(&actual, "FINGERPRINT", "", "", "", 0);
+			parser_diff_fail("micro_ini_resume() fingerprint", flags, pData, size, &expected, &actual);
+		}
+
+		pFile = fopen(path, "rb");
+		if(pFile)
+		{
+			micro_ini_state_init(&state);
+			result = micro_ini_resume_file(&state, pFile, flags, parser_diff_handler, parser_diff_error, &actual);
+			parser_diff_check("micro_ini_resume_file()", flags, pData, size, &expected, &actual, result);
+
+#if defined(PARSER_DIFF_FD_SUPPORTED)
+			rewind(pFile);
+			micro_ini_state_init(&state);
+			result = micro_ini_resume_fd(&state, fileno(pFile), flags, parser_diff_handler, parser_diff_error, &actual);
+			parser_diff_check("micro_ini_resume_fd()", flags, pData, size, &expected, &actual, result);
+#endif
+
+			fclose(pFile);
+		}
+	}
+
+#if defined(PARSER_DIFF_FD_SUPPORTED)
+	if(size <= PARSER_DIFF_PIPE_LIMIT)
+	{
+		int pipeFds[2];
+
+		if(pipe(pipeFds) == 0)
+		{
+			/* A pipe cannot be seeked or sized, so it takes the block reading path. */
+			if(size == 0 || write(pipeFds[1], pData, size) == (ssize_t) size)
+			{
+				close(pipeFds[1]);
+				result = micro_ini_load_fd(pipeFds[0], flags, parser_diff_handler, parser_diff_error, &actual);
+				parser_diff_check("micro_ini_load_fd() on a pipe", flags, pData, size, &expected, &actual, result);
+			}
+			else
+			{
+				close(pipeFds[1]);
+			}
+
+			close(pipeFds[0]);
+		}
+	}
+#endif
+
+	parser_diff_clear(&expected);
+}
+
+/**
+ * @brief  Check one input with every combination of flags.
+ */
+static void parser_diff_all_flags(const char* const pData, const size_t size, const char* const path)
+{
+	FILE* const pFile = path ? fopen(path, "wb") : NULL;
+	int flags;
+
+	if(pFile)
+	{
+		fwrite(pData, 1, size, pFile);
+		fclose(pFile);
+	}
+
+	for(flags = 0; flags < 32; ++flags)
+	{
+		parser_diff_input(pData, size, flags, pFile ? path : NULL);
+	}
+}
+
+/**
+ * @brief   Next pseudo-random number (the same sequence on every platform for a seed).
+ * @return  Number from 0 to 32767.
+ */
+static unsigned int parser_diff_random(void)
+{
+	diffSeed = diffSeed * 1103515245ul + 12345ul;
+	return (unsigned int) ((diffSeed >> 16) & 0x7FFF);
+}
+
+/**
+ * @brief   Build a random input out of fragments of ini syntax.
+ * @return  Number of bytes written to pData.
+ */
+static size_t parser_diff_generate(char* const pData)
+{
+	static const char* const fragments[] =
+	{
+		"[", "]", "=", "\"", "'", ";", "#", " ", "\t", "\\", ":", " : ",
+		"a", "b", "key", "value", "\n", "\n", "\n", "\r\n", "\r",
+		"\xEF\xBB\xBF", "x y", "==", "\"\"", "''", " = ", "[s]\n", "[c : s]\n", "[s:]\n",
+		"k=v\n", "\\\n", "k = \"a;b\" ; c\n"
+	};
+
+	const unsigned int count = parser_diff_random() % 200;
+	size_t size = 0;
+	unsigned int index;
+
+	for(index = 0; index < count; ++index)
+	{
+		if(parser_diff_random() % 60 == 0)
+		{
+			/* Runs around the maximum line length. */
+			const unsigned int length = 400 + parser_diff_random() % 200;
+			unsigned int character;
+
+			for(character = 0; character < length; ++character)
+			{
+				pData[size++] = (char) ('a' + parser_diff_random() % 3);
+			}
+		}
+		else
+		{
+			const char* const fragment = fragments[parser_diff_random() % (sizeof(fragments) / sizeof(fragments[0]))];
+			const size_t length = strlen(fragment);
+
+			memcpy(pData + size, fragment, length);
+			size += length;
+		}
+	}
+
+	return size;
+}
+
+/**
+ * @brief   Read a whole file into memory.
+ * @return  Contents of the file (free() it), or NULL if it cannot be read.
+ */
+static char* parser_diff_read_file(const char* const path, size_t* const pOutSize)
+{
+	FILE* const pFile = fopen(path, "rb");
+	char* pData = NULL;
+	long length;
+
+	if(!pFile)
+	{
+		return NULL;
+	}
+
+	if(fseek(pFile, 0, SEEK_END) == 0 && (length = ftell(pFile)) >= 0 && fseek(pFile, 0, SEEK_SET) == 0)
+	{
+		pData = (char*) malloc((size_t) length + 1);
+
+		if(pData && fread(pData, 1, (size_t) length, pFile) != (size_t) length)
+		{
+			free(pData);
+			pData = NULL;
+		}
+
+		(*pOutSize) = (size_t) length;
+	}
+
+	fclose(pFile);
+	return pData;
+}
+
+int main(int argc, char** argv)
+{
+	static char input[200 * 600];
+
+	const char* const path = "parser_diff.tmp";
+	unsigned long iterations = 2000;
+	unsigned long iteration;
+	int arg;
+
+	for(arg = 1; arg < argc; ++arg)
+	{
+		if(strcmp(argv[arg], "-n") == 0 && arg + 1 < argc)
+		{
+			iterations = strtoul(argv[++arg], NULL, 10);
+		}
+		else if(strcmp(argv[arg], "-s") == 0 && arg + 1 < argc)
+		{
+			diffSeed = strtoul(argv[++arg], NULL, 10);
+		}
+		else
+		{
+			size_t size = 0;
+			char* const pData = parser_diff_read_file(argv[arg], &size);
+
+			if(!pData)
+			{
+				fprintf(stderr, "parser_diff: cannot read %s\n", argv[arg]);
+				return EXIT_FAILURE;
+			}
+
+			parser_diff_all_flags(pData, size, path);
+			free(pData);
+		}
+	}
+
+	for(iteration = 0; iteration < iterations; ++iteration)
+	{
+		parser_diff_all_flags(input, parser_diff_generate(input), path);
+	}
+
+	remove(path);
+	printf("parser_diff: ok\n");
+	return EXIT_SUCCESS;
+}
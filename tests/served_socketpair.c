@@ -0,0 +1,299 @@
+/**
+ * Copyright (c) 2021, Zoe J. Bare
+ *
+ * MIT License
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ */
+
+/*
+ * Checks the served module over socketpair() connections, without the daemon: fetching
+ * an image, asking for a file that is not served, refreshing after the file changes
+ * (which bumps its generation), waiting with a timeout, and a client that stops part
+ * way through a request while another client is served (Linux only).
+ *
+ * Build: cc -Isrc tests/served_socketpair.c src/micro_ini_served.c src/micro_ini_image.c src/micro_ini_doc.c src/micro_ini_alloc.c src/micro_ini.c -lpthread -o served_socketpair
+ *
+ * Writes a temporary ini file under /tmp and exits with 0 when every check passes.
+ */
+
+#if !defined(_GNU_SOURCE)
+	#define _GNU_SOURCE
+#endif
+
+#include "micro_ini_served.h"
+
+#include <errno.h>
+#include <poll.h>
+#include <pthread.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/socket.h>
+#include <time.h>
+#include <unistd.h>
+
+static int failures = 0;
+
+#define CHECK(condition) \
+	do \
+	{ \
+		if(!(condition)) \
+		{ \
+			fprintf(stderr, "%s:%d: check failed: %s\n", __FILE__, __LINE__, #condition); \
+			++failures; \
+		} \
+	} while(0)
+
+/**
+ * Server end of one connection, answered by its own thread.
+ */
+typedef struct served_connection
+{
+	micro_ini_server* pServer;
+	int socketFd;
+	pthread_t thread;
+} served_connection;
+
+/**
+ * @brief  Answer requests on a connection until the client hangs up.
+ */
+static void* served_connection_run(void* pUserData)
+{
+	served_connection* const pConnection = (served_connection*) pUserData;
+	struct pollfd ready;
+
+	ready.fd = pConnection->socketFd;
+	ready.events = POLLIN;
+
+	while(poll(&ready, 1, -1) >= 0 || errno == EINTR)
+	{
+		if(micro_ini_server_handle(pConnection->pServer, pConnection->socketFd) != MICRO_INI_SUCCESS)
+		{
+			break;
+		}
+	}
+
+	close(pConnection->socketFd);
+	return NULL;
+}
+
+/**
+ * @brief   Connect a new client to a server through a socketpair.
+ * @return  Result of micro_ini_client_attach().
+ */
+static int served_attach(micro_ini_client** const ppOutClient, served_connection* const pConnection, micro_ini_server* const pServer, const char* const path)
+{
+	int fds[2];
+	int result;
+
+	(*ppOutClient) = NULL;
+
+	if(socketpair(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0, fds) != 0)
+	{
+		return MICRO_INI_ERROR_SYSTEM;
+	}
+
+	pConnection->pServer = pServer;
+	pConnection->socketFd = fds[0];
+
+	if(pthread_create(&pConnection->thread, NULL, served_connection_run, pConnection) != 0)
+	{
+		close(fds[0]);
+		close(fds[1]);
+		return MICRO_INI_ERROR_SYSTEM;
+	}
+
+	/* The client owns its end from here on, even when the attach fails. */
+	result = micro_ini_client_attach(ppOutClient, fds[1], path, NULL);
+	if(result != MICRO_INI_SUCCESS)
+	{
+		pthread_join(pConnection->thread, NULL);
+	}
+
+	return result;
+}
+
+/**
+ * @brief  Replace the contents of a file.
+ */
+static void served_write(const char* const path, const char* const text)
+{
+	FILE* const pFile = fopen(path, "wb");
+
+	CHECK(pFile != NULL);
+	if(pFile)
+	{
+		fputs(text, pFile);
+		fclose(pFile);
+	}
+}
+
+/**
+ * @brief   Read the monotonic clock.
+ * @return  Milliseconds since an arbitrary point.
+ */
+static long served_milliseconds(void)
+{
+	struct timespec now;
+
+	clock_gettime(CLOCK_MONOTONIC, &now);
+	return (long) now.tv_sec * 1000 + now.tv_nsec / 1000000;
+}
+
+/**
+ * @brief  A client that sends part of a request must not hold up other clients.
+ */
+static void served_check_partial(micro_ini_server* const pServer, const char* const path)
+{
+	served_connection connection;
+	micro_ini_client* pClient;
+	const uint32_t length = (uint32_t) strlen(path);
+	char reply[64];
+	int fds[2];
+
+	CHECK(socketpair(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0, fds) == 0);
+
+	/* Three of the four bytes of the length prefix. */
+	CHECK(send(fds[1], &length, 3, 0) == 3);
+	CHECK(micro_ini_server_handle(pServer, fds[0]) == MICRO_INI_SUCCESS);
+	CHECK(recv(fds[1], reply, sizeof(reply), MSG_DONTWAIT) < 0 && (errno == EAGAIN || errno == EWOULDBLOCK));
+
+	/* Another client is served while the first one is stuck. */
+	CHECK(served_attach(&pClient, &connection, pServer, path) == MICRO_INI_SUCCESS);
+	if(pClient)
+	{
+		CHECK(strcmp(micro_ini_image_get(micro_ini_client_image(pClient), "main", "port"), "80") == 0);
+		micro_ini_client_free(pClient);
+		pthread_join(connection.thread, NULL);
+	}
+
+	/* The rest of the request arrives in two more pieces. */
+	CHECK(send(fds[1], (const char*) &length + 3, 1, 0) == 1);
+	CHECK(micro_ini_server_handle(pServer, fds[0]) == MICRO_INI_SUCCESS);
+	CHECK(recv(fds[1], reply, sizeof(reply), MSG_DONTWAIT) < 0);
+
+	CHECK(send(fds[1], path, length, 0) == (ssize_t) length);
+	CHECK(micro_ini_server_handle(pServer, fds[0]) == MICRO_INI_SUCCESS);
+	CHECK(recv(fds[1], reply, sizeof(reply), MSG_DONTWAIT) > 0);
+
+	/* Nothing more is waiting, and a hang-up ends the connection. */
+	CHECK(micro_ini_server_handle(pServer, fds[0]) == MICRO_INI_SUCCESS);
+	close(fds[1]);
+	CHECK(micro_ini_server_handle(pServer, fds[0]) == MICRO_INI_ERROR_READ_FAILED);
+	close(fds[0]);
+}
+
+/**
+ * @brief  A length prefix longer than any path drops the connection.
+ */
+static void served_check_oversized(micro_ini_server* const pServer)
+{
+	const uint32_t length = 0xFFFFFFFFu;
+	int fds[2];
+
+	CHECK(socketpair(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0, fds) == 0);
+	CHECK(send(fds[1], &length, sizeof(length), 0) == (ssize_t) sizeof(length));
+	CHECK(micro_ini_server_handle(pServer, fds[0]) == MICRO_INI_ERROR_BUFFER_OVERFLOW);
+
+	close(fds[0]);
+	close(fds[1]);
+}
+
+int main(void)
+{
+	char path[] = "/tmp/served_socketpairXXXXXX";
+	const char* paths[1];
+	served_connection connection;
+	served_connection unknown;
+	micro_ini_server* pServer = NULL;
+	micro_ini_client* pClient = NULL;
+	micro_ini_client* pMissing = NULL;
+	long start;
+	int fd;
+
+	fd = mkstemp(path);
+	CHECK(fd >= 0);
+	if(fd < 0)
+	{
+		return EXIT_FAILURE;
+	}
+
+	close(fd);
+	served_write(path, "[main]\nlevel=info\n");
+
+	paths[0] = path;
+	CHECK(micro_ini_server_create(&pServer, paths, 1, 0, NULL) == MICRO_INI_SUCCESS);
+	if(!pServer)
+	{
+		remove(path);
+		return EXIT_FAILURE;
+	}
+
+	/* Fetch. */
+	CHECK(served_attach(&pClient, &connection, pServer, path) == MICRO_INI_SUCCESS);
+	if(pClient)
+	{
+		CHECK(strcmp(micro_ini_image_get(micro_ini_client_image(pClient), "main", "level"), "info") == 0);
+		CHECK(!micro_ini_client_is_stale(pClient));
+		CHECK(micro_ini_client_refresh(pClient) == 0);
+
+		/* Wait with a timeout while nothing changes. */
+		start = served_milliseconds();
+		CHECK(micro_ini_client_wait(pClient, 50) == 0);
+		CHECK(served_milliseconds() - start >= 45);
+
+		/* Refresh after the file changes, which bumps its generation. */
+		served_write(path, "[main]\nlevel=debug\nport=80\n");
+		CHECK(micro_ini_server_refresh(pServer) == 1);
+		CHECK(micro_ini_client_is_stale(pClient));
+		CHECK(micro_ini_client_wait(pClient, 1000) == 1);
+		CHECK(micro_ini_client_refresh(pClient) == 1);
+		CHECK(!micro_ini_client_is_stale(pClient));
+		CHECK(strcmp(micro_ini_image_get(micro_ini_client_image(pClient), "main", "level"), "debug") == 0);
+		CHECK(strcmp(micro_ini_image_get(micro_ini_client_image(pClient), "main", "port"), "80") == 0);
+
+		/* Nothing changed since, so there is nothing to rebuild or fetch. */
+		CHECK(micro_ini_server_refresh(pServer) == 0);
+		CHECK(micro_ini_client_refresh(pClient) == 0);
+
+		micro_ini_client_free(pClient);
+		pthread_join(connection.thread, NULL);
+	}
+
+	/* An unknown path is reported to the client. */
+	CHECK(served_attach(&pMissing, &unknown, pServer, "/nonexistent/file.ini") == MICRO_INI_ERROR_INVALID_FILE_OBJECT);
+	CHECK(pMissing == NULL);
+
+	served_check_partial(pServer, path);
+	served_check_oversized(pServer);
+
+	micro_ini_server_free(pServer);
+	remove(path);
+
+	if(failures > 0)
+	{
+		fprintf(stderr, "served_socketpair: %d check(s) failed\n", failures);
+		return EXIT_FAILURE;
+	}
+
+	printf("served_socketpair: ok\n");
+	return EXIT_SUCCESS;
+}
@@ -0,0 +1,634 @@
+/**
+ * Copyright (c) 2021, Zoe J. Bare
+ *
+ * MIT License
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ */
+
+/*
+ * microini - query ini files from shell scripts.
+ *
+ *     microini [-m] [-i] [-n] get FILE SECTION KEY [DEFAULT]
+ *     microini [-m] [-i] [-n] list FILE SECTION
+ *     microini [-m] [-i] [-n] sections FILE
+ *
+ * The first query of a file parses it into an image (see micro_ini_image.h) which is
+ * saved as an index in $XDG_CACHE_HOME/microini (or ~/.cache/microini).  The index
+ * records the device, inode, size and modification and change times of the file, and
+ * later queries map the index and binary search it as long as the file still matches,
+ * so they cost a couple of stat() calls instead of a parse.  When the file has changed, or the cache
+ * directory cannot be written, the index is simply built again.
+ *
+ * Options:
+ *     -m  Enable multi-line values (MICRO_INI_FLAG_MULTILINE).
+ *     -i  Enable "[child : parent]" inheritance; sections also list inherited keys.
+ *     -n  Do not read or write the index cache.
+ *
+ * "get" prints the value (or DEFAULT) and exits with 0, or exits with 1 when the key
+ * does not exist and no default was given.  "list" prints the keys of a section and
+ * "sections" the names of the sections, one per line, sorted by name.  Errors exit
+ * with 2.
+ *
+ * Build: cc -O2 -Isrc tools/microini.c src/micro_ini.c src/micro_ini_alloc.c src/micro_ini_doc.c src/micro_ini_image.c -o microini
+ *
+ * The index cache uses mmap() and is only available on POSIX systems; elsewhere the
+ * file is parsed on every run.
+ */
+
+#if !defined(_WIN32) && !defined(_XOPEN_SOURCE) && !defined(_GNU_SOURCE)
+	/* Expose mmap(), realpath() and the nanosecond file times even when compiling in strict ANSI mode. */
+	#define _XOPEN_SOURCE 700
+#endif
+
+#include "micro_ini_image.h"
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#if defined(_WIN32)
+	#define MICRO_INI_TOOL_NO_CACHE
+#else
+	#include <errno.h>
+	#include <fcntl.h>
+	#include <limits.h>
+	#include <sys/mman.h>
+	#include <sys/stat.h>
+	#include <sys/types.h>
+	#include <unistd.h>
+#endif
+
+#define MICRO_INI_TOOL_EXIT_FOUND     0
+#define MICRO_INI_TOOL_EXIT_NOT_FOUND 1
+#define MICRO_INI_TOOL_EXIT_ERROR     2
+
+/**
+ * Version of the cache file layout, bumped whenever it changes.
+ */
+#define MICRO_INI_TOOL_CACHE_VERSION 2
+
+/**
+ * Header of a cached index (internal use only).  The header is followed by the image
+ * of the ini file, as built by micro_ini_image_build().
+ */
+typedef struct micro_ini_tool_header
+{
+	char     magic[8];  /* "MICROIDX" */
+	uint32_t version;   /* MICRO_INI_TOOL_CACHE_VERSION */
+	uint32_t flags;     /* Parser flags the image was built with. */
+
+	/* Stamp of the ini file the image was built from. */
+	uint64_t device;
+	uint64_t inode;
+	uint64_t size;
+	uint64_t modifiedSeconds;
+	uint64_t modifiedNanoseconds;
+	uint64_t changedSeconds;
+} micro_ini_tool_header;
+
+/**
+ * Index ready to be queried, either mapped from the cache or built in memory (internal use only).
+ */
+typedef struct micro_ini_tool_index
+{
+	micro_ini_image image;
+
+	void*  pMapping;  /* Mapped cache file, or NULL. */
+	size_t mappingSize;
+	void*  pMemory;   /* Image built in memory, or NULL. */
+	size_t memorySize;
+} micro_ini_tool_index;
+
+/**
+ * Key visible in a listed section (internal use only).
+ */
+typedef struct micro_ini_tool_key
+{
+	const char* name;
+	size_t depth;  /* Number of parent links between the listed section and the section holding the key. */
+} micro_ini_tool_key;
+
+/**
+ * @brief   Order two listed keys by name, nearest section first (internal use only).
+ * @return  Result of strcmp() on the names, or the order of their depths when the names are equal.
+ */
+static int prv_micro_ini_tool_compare_keys(const void* pA, const void* pB)
+{
+	const micro_ini_tool_key* const pLeft = (const micro_ini_tool_key*) pA;
+	const micro_ini_tool_key* const pRight = (const micro_ini_tool_key*) pB;
+	const int order = strcmp(pLeft->name, pRight->name);
+
+	if(order != 0)
+	{
+		return order;
+	}
+
+	return (pLeft->depth < pRight->depth) ? -1 : ((pLeft->depth > pRight->depth) ? 1 : 0);
+}
+
+/**
+ * @brief   Print every key visible in a section once, sorted by name (internal use only).
+ * @return  Non-zero on success, or zero when out of memory.
+ *
+ * The image only links a section to its parent, so the keys of the whole chain are
+ * gathered and sorted, and only the nearest copy of each is printed.
+ */
+static int prv_micro_ini_tool_list(const micro_ini_image* const pImage, const size_t sectionIndex)
+{
+	micro_ini_tool_key* keys;
+	size_t count = 0;
+	size_t depth = 0;
+	size_t owner;
+	size_t i;
+
+	for(owner = sectionIndex; owner != MICRO_INI_IMAGE_NPOS && depth < micro_ini_image_section_count(pImage); owner = micro_ini_image_section_parent(pImage, owner))
+	{
+		count += micro_ini_image_key_count(pImage, owner);
+		++depth;
+	}
+
+	keys = (micro_ini_tool_key*) malloc((count + 1) * sizeof(micro_ini_tool_key));
+	if(!keys)
+	{
+		return 0;
+	}
+
+	count = 0;
+	depth = 0;
+
+	for(owner = sectionIndex; owner != MICRO_INI_IMAGE_NPOS && depth < micro_ini_image_section_count(pImage); owner = micro_ini_image_section_parent(pImage, owner))
+	{
+		for(i = 0; i < micro_ini_image_key_count(pImage, owner); ++i)
+		{
+			keys[count].name = micro_ini_image_key(pImage, owner, i);
+			keys[count].depth = depth;
+			++count;
+		}
+
+		++depth;
+	}
+
+	qsort(keys, count, sizeof(micro_ini_tool_key), prv_micro_ini_tool_compare_keys);
+
+	for(i = 0; i < count; ++i)
+	{
+		if(i == 0 || strcmp(keys[i - 1].name, keys[i].name) != 0)
+		{
+			puts(keys[i].name);
+		}
+	}
+
+	free(keys);
+	return 1;
+}
+
+/**
+ * @brief  Release an index (internal use only).
+ */
+static void prv_micro_ini_tool_index_close(micro_ini_tool_index* const pIndex)
+{
+#if !defined(MICRO_INI_TOOL_NO_CACHE)
+	if(pIndex->pMapping)
+	{
+		munmap(pIndex->pMapping, pIndex->mappingSize);
+	}
+#endif
+
+	free(pIndex->pMemory);
+}
+
+/**
+ * @brief   Record the stamp of an ini file in a header (internal use only).
+ * @return  Non-zero if the file exists.
+ */
+static int prv_micro_ini_tool_stamp(const char* const filePath, micro_ini_tool_header* const pOutStamp)
+{
+	memset(pOutStamp, 0, sizeof(micro_ini_tool_header));
+
+#if defined(MICRO_INI_TOOL_NO_CACHE)
+	{
+		FILE* const pFile = fopen(filePath, "rb");
+
+		if(!pFile)
+		{
+			return 0;
+		}
+
+		fclose(pFile);
+	}
+#else
+	{
+		struct stat info;
+
+		if(stat(filePath, &info) != 0)
+		{
+			return 0;
+		}
+
+		pOutStamp->device = (uint64_t) info.st_dev;
+		pOutStamp->inode = (uint64_t) info.st_ino;
+		pOutStamp->size = (uint64_t) info.st_size;
+		pOutStamp->modifiedSeconds = (uint64_t) info.st_mtime;
+		pOutStamp->changedSeconds = (uint64_t) info.st_ctime;
+
+	#if defined(__APPLE__)
+		pOutStamp->modifiedNanoseconds = (uint64_t) info.st_mtimespec.tv_nsec;
+	#elif defined(st_mtime)
+		/* st_mtime is a macro for st_mtim.tv_sec when the nanosecond times are available. */
+		pOutStamp->modifiedNanoseconds = (uint64_t) info.st_mtim.tv_nsec;
+	#endif
+	}
+#endif
+
+	return 1;
+}
+
+#if !defined(MICRO_INI_TOOL_NO_CACHE)
+
+/**
+ * @brief   Work out the path of the cached index of an ini file (internal use only).
+ * @return  Non-zero on success.
+ *
+ * @param[out] pOutPath  Buffer of PATH_MAX characters receiving the path.
+ * @param[in]  filePath  Path to the ini file.
+ * @param[in]  flags     Parser flags, which are part of the cache key.
+ * @param[in]  create    Non-zero to create the cache directory.
+ *
+ * Indexes are named after an FNV-1a hash of the absolute path of the ini file.  Two
+ * files sharing a name cannot read each other's index, since the device and inode
+ * recorded in it would not match; they would only keep rebuilding it.
+ */
+static int prv_micro_ini_tool_cache_path(char* const pOutPath, const char* const filePath, const int flags, const int create)
+{
+	char absolute[PATH_MAX];
+	char directory[PATH_MAX];
+	const char* base = getenv("XDG_CACHE_HOME");
+	const char* p;
+	uint32_t hash = 2166136261UL;
+	int length;
+
+	if(!realpath(filePath, absolute))
+	{
+		return 0;
+	}
+
+	for(p = absolute; (*p); ++p)
+	{
+		hash = (hash ^ (unsigned char) (*p)) * 16777619UL;
+	}
+
+	if(base && base[0] == '/')
+	{
+		length = snprintf(directory, sizeof(directory), "%s/microini", base);
+	}
+	else if((base = getenv("HOME")) != NULL && base[0] == '/')
+	{
+		length = snprintf(directory, sizeof(directory), "%s/.cache/microini", base);
+	}
+	else
+	{
+		return 0;
+	}
+
+	if(length < 0 || (size_t) length >= sizeof(directory))
+	{
+		return 0;
+	}
+
+	if(create)
+	{
+		/* Create the parent too, since ~/.cache may not exist yet. */
+		(*strrchr(directory, '/')) = '\0';
+		if(mkdir(directory, 0700) != 0 && errno != EEXIST)
+		{
+			return 0;
+		}
+
+		directory[strlen(directory)] = '/';
+		if(mkdir(directory, 0700) != 0 && errno != EEXIST)
+		{
+			return 0;
+		}
+	}
+
+	length = snprintf(pOutPath, PATH_MAX, "%s/%08lx-%d.idx", directory, (unsigned long) hash, flags);
+
+	return length > 0 && length < PATH_MAX;
+}
+
+/**
+ * @brief   Map the cached index of an ini file if it is still current (internal use only).
+ * @return  Non-zero if the index was mapped.
+ *
+ * @param[out] pIndex     Receives the mapped index.
+ * @param[in]  cachePath  Path to the cached index.
+ * @param[in]  pStamp     Current stamp of the ini file.
+ */
+static int prv_micro_ini_tool_cache_map(micro_ini_tool_index* const pIndex, const char* const cachePath, const micro_ini_tool_header* const pStamp)
+{
+	const micro_ini_tool_header* pHeader;
+	struct stat info;
+	void* pMapping;
+	int fd;
+
+	fd = open(cachePath, O_RDONLY);
+	if(fd < 0)
+	{
+		return 0;
+	}
+
+	if(fstat(fd, &info) != 0 || info.st_size <= 0)
+	{
+		close(fd);
+		return 0;
+	}
+
+	pMapping = mmap(NULL, (size_t) info.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+	close(fd);
+
+	if(pMapping == MAP_FAILED)
+	{
+		return 0;
+	}
+
+	pIndex->pMapping = pMapping;
+	pIndex->mappingSize = (size_t) info.st_size;
+	pIndex->pMemory = NULL;
+
+	pHeader = (const micro_ini_tool_header*) pMapping;
+	if(pIndex->mappingSize < sizeof(micro_ini_tool_header)
+		|| memcmp(pHeader->magic, "MICROIDX", 8) != 0
+		|| pHeader->version != MICRO_INI_TOOL_CACHE_VERSION
+		|| pHeader->flags != pStamp->flags
+		|| pHeader->device != pStamp->device
+		|| pHeader->inode != pStamp->inode
+		|| pHeader->size != pStamp->size
+		|| pHeader->modifiedSeconds != pStamp->modifiedSeconds
+		|| pHeader->modifiedNanoseconds != pStamp->modifiedNanoseconds
+		|| pHeader->changedSeconds != pStamp->changedSeconds
+		|| micro_ini_image_open(&pIndex->image, pHeader + 1, pIndex->mappingSize - sizeof(micro_ini_tool_header)) != MICRO_INI_SUCCESS)
+	{
+		/* Stale or unreadable, so it is rebuilt. */
+		munmap(pMapping, pIndex->mappingSize);
+		pIndex->pMapping = NULL;
+		return 0;
+	}
+
+	return 1;
+}
+
+/**
+ * @brief  Save an index to the cache (internal use only).
+ *
+ * @param[in]  pIndex     Index built in memory.
+ * @param[in]  pStamp     Stamp of the ini file the index was built from.
+ * @param[in]  cachePath  Path to the cached index.
+ *
+ * The index is written to a temporary file which is then renamed over the old one, so
+ * concurrent runs only ever see a complete index.  Failures are ignored; the index
+ * is simply built again next time.
+ */
+static void prv_micro_ini_tool_cache_save(const micro_ini_tool_index* const pIndex, const micro_ini_tool_header* const pStamp, const char* const cachePath)
+{
+	char temporary[PATH_MAX];
+	FILE* pFile;
+	int length;
+	int ok;
+
+	length = snprintf(temporary, sizeof(temporary), "%s.%ld.tmp", cachePath, (long) getpid());
+	if(length < 0 || (size_t) length >= sizeof(temporary))
+	{
+		return;
+	}
+
+	pFile = fopen(temporary, "wb");
+	if(!pFile)
+	{
+		return;
+	}
+
+	ok = fwrite(pStamp, sizeof(micro_ini_tool_header), 1, pFile) == 1;
+	ok &= fwrite(pIndex->pMemory, 1, pIndex->memorySize, pFile) == pIndex->memorySize;
+	ok &= fclose(pFile) == 0;
+
+	if(!ok || rename(temporary, cachePath) != 0)
+	{
+		remove(temporary);
+	}
+}
+
+#endif
+
+/**
+ * @brief   Load the index of an ini file, from the cache when it is current (internal use only).
+ * @return  Non-zero on success.
+ *
+ * @param[out] pIndex    Receives the index.
+ * @param[in]  filePath  Path to the ini file.
+ * @param[in]  flags     Parser flags.
+ * @param[in]  useCache  Non-zero to read and write the cache.
+ */
+static int prv_micro_ini_tool_load(micro_ini_tool_index* const pIndex, const char* const filePath, const int flags, const int useCache)
+{
+	micro_ini_tool_header stamp;
+	micro_ini_doc* pDoc;
+	int result;
+#if !defined(MICRO_INI_TOOL_NO_CACHE)
+	char cachePath[PATH_MAX];
+	const int cached = useCache && prv_micro_ini_tool_cache_path(cachePath, filePath, flags, 1);
+#else
+	(void) useCache;
+#endif
+
+	if(!prv_micro_ini_tool_stamp(filePath, &stamp))
+	{
+		fprintf(stderr, "microini: cannot open '%s'\n", filePath);
+		return 0;
+	}
+
+	memcpy(stamp.magic, "MICROIDX", 8);
+	stamp.version = MICRO_INI_TOOL_CACHE_VERSION;
+	stamp.flags = (uint32_t) flags;
+
+#if !defined(MICRO_INI_TOOL_NO_CACHE)
+	if(cached && prv_micro_ini_tool_cache_map(pIndex, cachePath, &stamp))
+	{
+		return 1;
+	}
+#endif
+
+	result = micro_ini_doc_load(&pDoc, filePath, flags, NULL, NULL, NULL);
+	if(result < 0)
+	{
+		fprintf(stderr, "microini: cannot load '%s' (error %d)\n", filePath, result);
+		return 0;
+	}
+
+	pIndex->pMapping = NULL;
+	pIndex->mappingSize = 0;
+
+	result = micro_ini_image_build(&pIndex->pMemory, &pIndex->memorySize, pDoc, NULL);
+	micro_ini_doc_free(pDoc);
+
+	if(result == MICRO_INI_SUCCESS)
+	{
+		result = micro_ini_image_open(&pIndex->image, pIndex->pMemory, pIndex->memorySize);
+	}
+
+	if(result != MICRO_INI_SUCCESS)
+	{
+		free(pIndex->pMemory);
+		fprintf(stderr, "microini: cannot index '%s' (error %d)\n", filePath, result);
+		return 0;
+	}
+
+#if !defined(MICRO_INI_TOOL_NO_CACHE)
+	if(cached)
+	{
+		prv_micro_ini_tool_cache_save(pIndex, &stamp, cachePath);
+	}
+#endif
+
+	return 1;
+}
+
+/**
+ * @brief  Print the usage message.
+ */
+static void prv_micro_ini_tool_usage(void)
+{
+	fputs(
+		"usage: microini [-m] [-i] [-n] get FILE SECTION KEY [DEFAULT]\n"
+		"       microini [-m] [-i] [-n] list FILE SECTION\n"
+		"       microini [-m] [-i] [-n] sections FILE\n"
+		"  -m  enable multi-line values\n"
+		"  -i  enable [child : parent] inheritance\n"
+		"  -n  do not use the index cache\n",
+		stderr
+	);
+}
+
+
+int main(int argc, char** argv)
+{
+	micro_ini_tool_index index;
+	const char* command;
+	const char* value;
+	int flags = MICRO_INI_FLAG_BOM;
+	int useCache = 1;
+	int status = MICRO_INI_TOOL_EXIT_FOUND;
+	size_t sectionIndex;
+	size_t i;
+	int arg;
+
+	for(arg = 1; arg < argc && argv[arg][0] == '-' && argv[arg][1] != '\0'; ++arg)
+	{
+		if(strcmp(argv[arg], "-m") == 0)
+		{
+			flags |= MICRO_INI_FLAG_MULTILINE;
+		}
+		else if(strcmp(argv[arg], "-i") == 0)
+		{
+			flags |= MICRO_INI_FLAG_INHERITANCE;
+		}
+		else if(strcmp(argv[arg], "-n") == 0)
+		{
+			useCache = 0;
+		}
+		else
+		{
+			prv_micro_ini_tool_usage();
+			return MICRO_INI_TOOL_EXIT_ERROR;
+		}
+	}
+
+	if(argc - arg < 2)
+	{
+		prv_micro_ini_tool_usage();
+		return MICRO_INI_TOOL_EXIT_ERROR;
+	}
+
+	command = argv[arg];
+
+	if(!((strcmp(command, "get") == 0 && (argc - arg == 4 || argc - arg == 5))
+		|| (strcmp(command, "list") == 0 && argc - arg == 3)
+		|| (strcmp(command, "sections") == 0 && argc - arg == 2)))
+	{
+		prv_micro_ini_tool_usage();
+		return MICRO_INI_TOOL_EXIT_ERROR;
+	}
+
+	if(!prv_micro_ini_tool_load(&index, argv[arg + 1], flags, useCache))
+	{
+		return MICRO_INI_TOOL_EXIT_ERROR;
+	}
+
+	if(command[0] == 's')
+	{
+		for(i = 0; i < micro_ini_image_section_count(&index.image); ++i)
+		{
+			puts(micro_ini_image_section_name(&index.image, i));
+		}
+	}
+	else
+	{
+		sectionIndex = micro_ini_image_find_section(&index.image, argv[arg + 2]);
+
+		if(command[0] == 'l')
+		{
+			if(sectionIndex == MICRO_INI_IMAGE_NPOS)
+			{
+				status = MICRO_INI_TOOL_EXIT_NOT_FOUND;
+			}
+			else if(!prv_micro_ini_tool_list(&index.image, sectionIndex))
+			{
+				fprintf(stderr, "microini: out of memory\n");
+				status = MICRO_INI_TOOL_EXIT_ERROR;
+			}
+		}
+		else
+		{
+			value = micro_ini_image_section_get(&index.image, sectionIndex, argv[arg + 3]);
+			if(!value && argc - arg == 5)
+			{
+				value = argv[arg + 4];
+			}
+
+			if(value)
+			{
+				puts(value);
+			}
+			else
+			{
+				status = MICRO_INI_TOOL_EXIT_NOT_FOUND;
+			}
+		}
+	}
+
+	prv_micro_ini_tool_index_close(&index);
+
+	if(fflush(stdout) != 0)
+	{
+		status = MICRO_INI_TOOL_EXIT_ERROR;
+	}
+
+	return status;
+}
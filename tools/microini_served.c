@@ -0,0 +1,288 @@
+/**
+ * Copyright (c) 2021, Zoe J. Bare
+ *
+ * MIT License
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ */
+
+/*
+ * microini-served - share parsed ini files with every process on a host (Linux only).
+ *
+ *     microini-served [-m] [-i] SOCKET FILE...
+ *
+ * Parses each FILE once into an image held in a sealed memfd and listens on the Unix
+ * domain socket SOCKET.  Processes use the client functions in micro_ini_served.h to
+ * receive the memfd of a file and query its image in place.  The directories holding
+ * the files are watched with inotify; whenever one of the files changes its image is
+ * rebuilt and clients waiting on it are woken.
+ *
+ * Options:
+ *     -m  Enable multi-line values (MICRO_INI_FLAG_MULTILINE).
+ *     -i  Enable "[child : parent]" inheritance.
+ *
+ * Build: cc -O2 -Isrc tools/microini_served.c src/micro_ini_served.c src/micro_ini_image.c src/micro_ini_doc.c src/micro_ini_alloc.c src/micro_ini.c -o microini-served
+ */
+
+#if !defined(_GNU_SOURCE)
+	#define _GNU_SOURCE
+#endif
+
+#include "micro_ini_served.h"
+
+#include <errno.h>
+#include <libgen.h>
+#include <limits.h>
+#include <poll.h>
+#include <signal.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/inotify.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+/**
+ * Number of connections the daemon can poll at once, after the listening socket and the inotify descriptor.
+ */
+#define MICRO_INI_SERVED_MAX_CLIENTS 1024
+
+/**
+ * Set by the signal handler to stop the daemon.
+ */
+static volatile sig_atomic_t prv_micro_ini_served_stop = 0;
+
+/**
+ * @brief  Signal handler asking the daemon to stop (internal use only).
+ */
+static void prv_micro_ini_served_signal(int signalNumber)
+{
+	(void) signalNumber;
+
+	prv_micro_ini_served_stop = 1;
+}
+
+/**
+ * @brief   Watch the directory of every served file (internal use only).
+ * @return  The inotify descriptor, or -1 on failure.
+ *
+ * Directories are watched rather than the files themselves, so that files replaced by
+ * renaming a new copy over them are still noticed.
+ */
+static int prv_micro_ini_served_watch(char** const pFilePaths, const int fileCount)
+{
+	char directory[PATH_MAX];
+	const int fd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+	int i;
+
+	if(fd < 0)
+	{
+		return -1;
+	}
+
+	for(i = 0; i < fileCount; ++i)
+	{
+		if(strlen(pFilePaths[i]) >= sizeof(directory))
+		{
+			continue;
+		}
+
+		/* dirname() may modify its argument, so it is given a copy. */
+		strcpy(directory, pFilePaths[i]);
+
+		if(inotify_add_watch(fd, dirname(directory), IN_CLOSE_WRITE | IN_MOVED_TO | IN_CREATE | IN_ATTRIB) < 0)
+		{
+			fprintf(stderr, "microini-served: cannot watch '%s': %s\n", directory, strerror(errno));
+		}
+	}
+
+	return fd;
+}
+
+/**
+ * @brief   Open the listening socket (internal use only).
+ * @return  The socket, or -1 on failure.
+ */
+static int prv_micro_ini_served_listen(const char* const socketPath)
+{
+	struct sockaddr_un address;
+	int fd;
+
+	if(strlen(socketPath) >= sizeof(address.sun_path))
+	{
+		fprintf(stderr, "microini-served: socket path is too long\n");
+		return -1;
+	}
+
+	fd = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+	if(fd < 0)
+	{
+		return -1;
+	}
+
+	memset(&address, 0, sizeof(address));
+	address.sun_family = AF_UNIX;
+	strcpy(address.sun_path, socketPath);
+
+	/* A socket left behind by a previous run would make bind() fail. */
+	unlink(socketPath);
+
+	if(bind(fd, (const struct sockaddr*) &address, sizeof(address)) != 0 || listen(fd, SOMAXCONN) != 0)
+	{
+		fprintf(stderr, "microini-served: cannot listen on '%s': %s\n", socketPath, strerror(errno));
+		close(fd);
+		return -1;
+	}
+
+	return fd;
+}
+
+
+int main(int argc, char** argv)
+{
+	struct pollfd fds[MICRO_INI_SERVED_MAX_CLIENTS + 2];
+	struct sigaction action;
+	micro_ini_server* pServer;
+	char events[4096];
+	const char* socketPath;
+	nfds_t count = 2;
+	nfds_t i;
+	int flags = MICRO_INI_FLAG_BOM;
+	int result;
+	int arg;
+	int fd;
+
+	for(arg = 1; arg < argc && argv[arg][0] == '-'; ++arg)
+	{
+		if(strcmp(argv[arg], "-m") == 0)
+		{
+			flags |= MICRO_INI_FLAG_MULTILINE;
+		}
+		else if(strcmp(argv[arg], "-i") == 0)
+		{
+			flags |= MICRO_INI_FLAG_INHERITANCE;
+		}
+		else
+		{
+			break;
+		}
+	}
+
+	if(argc - arg < 2)
+	{
+		fputs("usage: microini-served [-m] [-i] SOCKET FILE...\n", stderr);
+		return 2;
+	}
+
+	socketPath = argv[arg];
+
+	result = micro_ini_server_create(&pServer, (const char* const*) &argv[arg + 1], (size_t) (argc - arg - 1), flags, NULL);
+	if(result != MICRO_INI_SUCCESS)
+	{
+		fprintf(stderr, "microini-served: cannot load the files (error %d)\n", result);
+		return 1;
+	}
+
+	fds[0].fd = prv_micro_ini_served_listen(socketPath);
+	fds[1].fd = prv_micro_ini_served_watch(&argv[arg + 1], argc - arg - 1);
+
+	if(fds[0].fd < 0 || fds[1].fd < 0)
+	{
+		micro_ini_server_free(pServer);
+		return 1;
+	}
+
+	fds[0].events = POLLIN;
+	fds[1].events = POLLIN;
+
+	memset(&action, 0, sizeof(action));
+	action.sa_handler = prv_micro_ini_served_signal;
+	sigaction(SIGINT, &action, NULL);
+	sigaction(SIGTERM, &action, NULL);
+	signal(SIGPIPE, SIG_IGN);
+
+	while(!prv_micro_ini_served_stop)
+	{
+		if(poll(fds, count, -1) < 0)
+		{
+			if(errno == EINTR)
+			{
+				continue;
+			}
+
+			break;
+		}
+
+		if(fds[1].revents & POLLIN)
+		{
+			/* The events only say that something changed; the server compares stamps to find what. */
+			while(read(fds[1].fd, events, sizeof(events)) > 0)
+			{
+			}
+
+			micro_ini_server_refresh(pServer);
+		}
+
+		for(i = 2; i < count; ++i)
+		{
+			if(fds[i].revents & (POLLIN | POLLHUP | POLLERR))
+			{
+				if(micro_ini_server_handle(pServer, fds[i].fd) != MICRO_INI_SUCCESS)
+				{
+					close(fds[i].fd);
+
+					/* Fill the gap with the last connection, which is then checked again. */
+					fds[i] = fds[--count];
+					--i;
+				}
+			}
+		}
+
+		if(fds[0].revents & POLLIN)
+		{
+			/* Connections are only ever read when poll() says so, and never waited on. */
+			fd = accept4(fds[0].fd, NULL, NULL, SOCK_NONBLOCK | SOCK_CLOEXEC);
+			if(fd >= 0 && count < MICRO_INI_SERVED_MAX_CLIENTS + 2)
+			{
+				fds[count].fd = fd;
+				fds[count].events = POLLIN;
+				fds[count].revents = 0;
+				++count;
+			}
+			else if(fd >= 0)
+			{
+				close(fd);
+			}
+		}
+	}
+
+	for(i = 2; i < count; ++i)
+	{
+		close(fds[i].fd);
+	}
+
+	close(fds[0].fd);
+	close(fds[1].fd);
+	unlink(socketPath);
+
+	micro_ini_server_free(pServer);
+
+	return 0;
+}